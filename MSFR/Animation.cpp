@@ -1,142 +1,54 @@
-#include <fstream> //ifstream
-#include <filesystem> //filesystem path
-#include "Engine.h" //GetLogger
 #include "Animation.h" //Animation
+#include "AnimationFormat.h" //AnimationCommandInfo
 
-Animation::Animation() : Animation("./assets/images/characters/none_front.anm") {}
+Animation::Animation(const AnimationCommandInfo* commands_, size_t count)
+	: commands(count > 0 ? commands_ : nullptr)
+{
+	ResetAnimation();
+}
 
-Animation::Animation(const std::filesystem::path& fileName) : animSequenceIndex(0)
+void Animation::Update(double dt)
 {
-	if (fileName.extension() != ".anm")
-	{
-		throw std::runtime_error("Bad Filetype.  " + fileName.generic_string() + " not a sprite info file (.anm)");
-	}
-	std::ifstream inFile(fileName);
-	if (inFile.is_open() == false)
+	if (commands == nullptr || isAnimationDone == true)
 	{
-		throw std::runtime_error("Failed to load " + fileName.generic_string());
+		return;
 	}
-
-	std::string label;
-	while (inFile.eof() == false)
+	timer += dt;
+	if (timer < commands[commandIndex].duration)
 	{
-		inFile >> label;
-		if (label == "PlayFrame")
-		{
-			int frame;
-			float targetTime;
-			inFile >> frame;
-			inFile >> targetTime;
-
-			animations.push_back(new PlayFrame(frame, targetTime));
-		}
-		else if (label == "Loop")
-		{
-			int loopToFrame;
-			inFile >> loopToFrame;
-			animations.push_back(new Loop(loopToFrame));
-		}
-		else if (label == "End")
-		{
-			animations.push_back(new End());
-		}
-		else {
-			Engine::GetLogger().LogError("Unknown command " + label + " in anm file " + fileName.generic_string());
-		}
+		return;
 	}
-	ResetAnimation();
-}
+	timer = 0;
 
-Animation::~Animation()
-{
-	for (CommandData* command : animations)
+	// ValidateAnimation guarantees a command after every PlayFrame and a
+	// PlayFrame at every Loop target
+	uint32_t next = commandIndex + 1;
+	if (commands[next].type == AnimationCommandInfo::Type::Loop)
 	{
-		delete command;
+		next = static_cast<uint32_t>(commands[next].value);
 	}
-	animations.clear();
-}
-
-void Animation::Update(double dt)
-{
-	currPlayFrameData->Update(dt);
-	if (currPlayFrameData->IsFrameDone() == true)
+	if (commands[next].type == AnimationCommandInfo::Type::End)
 	{
-		currPlayFrameData->ResetTime();
-		++animSequenceIndex;
-		if (animations[animSequenceIndex]->GetType() == Command::PlayFrame)
-		{
-			currPlayFrameData = static_cast<PlayFrame*>(animations[animSequenceIndex]);
-		}
-		else if (animations[animSequenceIndex]->GetType() == Command::Loop)
-		{
-			Loop* loopData = static_cast<Loop*>(animations[animSequenceIndex]);
-			animSequenceIndex = loopData->GetLoopToIndex();
-			if (animations[animSequenceIndex]->GetType() == Command::PlayFrame)
-			{
-				currPlayFrameData = static_cast<PlayFrame*>(animations[animSequenceIndex]);
-			}
-			else
-			{
-				Engine::GetLogger().LogError("Loop does not go to PlayFrame");
-				ResetAnimation();
-			}
-		}
-		else if (animations[animSequenceIndex]->GetType() == Command::End)
-		{
-			isAnimationDone = true;
-			return;
-		}
+		// Stays on the last frame
+		isAnimationDone = true;
+		return;
 	}
+	commandIndex = next;
 }
 
-int Animation::GetDisplayFrame()
+int Animation::GetDisplayFrame() const
 {
-	return currPlayFrameData->GetFrameNum();
+	return commands != nullptr ? commands[commandIndex].value : 0;
 }
 
 void Animation::ResetAnimation()
 {
-	animSequenceIndex = 0;
-	currPlayFrameData = static_cast<PlayFrame*>(animations[animSequenceIndex]);
+	commandIndex = 0;
+	timer = 0;
 	isAnimationDone = false;
 }
 
-bool Animation::IsAnimationDone()
+bool Animation::IsAnimationDone() const
 {
 	return isAnimationDone;
 }
-
-Animation::PlayFrame::PlayFrame(int frame, double duration)
-	: frame(frame), targetTime(duration), timer(0) {
-}
-
-void Animation::PlayFrame::Update(double dt)
-{
-	timer += dt;
-}
-
-bool Animation::PlayFrame::IsFrameDone()
-{
-	if (timer >= targetTime)
-	{
-		return true;
-	}
-	return false;
-}
-
-void Animation::PlayFrame::ResetTime()
-{
-	timer = 0;
-}
-
-int Animation::PlayFrame::GetFrameNum()
-{
-	return frame;
-}
-
-Animation::Loop::Loop(int loopToIndex) : loopToIndex(loopToIndex) {}
-
-int Animation::Loop::GetLoopToIndex()
-{
-	return loopToIndex;
-}
\ No newline at end of file
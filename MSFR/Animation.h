@@ -1,65 +1,26 @@
 #pragma once
-#include <vector> //vector array
+#include <cstddef> //size_t
+#include <cstdint> //uint32_t
 
+struct AnimationCommandInfo;
+
+// Where a sprite is in one animation. The commands belong to the sprite's
+// SpriteDefinition, shared by every sprite of that file, so this is only
+// the playback position and costs nothing to make or copy.
 class Animation
 {
 public:
-	Animation();
-	Animation(const std::filesystem::path& fileName);
-	~Animation();
+	Animation() = default;
+	// commands must pass ValidateAnimation and outlive the Animation
+	Animation(const AnimationCommandInfo* commands, size_t count);
 	void Update(double dt);
-	int GetDisplayFrame();
+	int GetDisplayFrame() const;
 	void ResetAnimation();
-	bool IsAnimationDone();
+	bool IsAnimationDone() const;
 
 private:
-	enum class Command
-	{
-		PlayFrame,
-		Loop,
-		End,
-	};
-
-	class CommandData
-	{
-	public:
-		virtual ~CommandData() {}
-		virtual Command GetType() = 0;
-	};
-
-	class PlayFrame : public CommandData
-	{
-	public:
-		PlayFrame(int frame, double duration);
-		virtual Command GetType() override { return Command::PlayFrame; }
-		void Update(double dt);
-		bool IsFrameDone();
-		void ResetTime();
-		int GetFrameNum();
-	private:
-		int frame;
-		double targetTime;
-		double timer;
-	};
-
-	class Loop : public CommandData
-	{
-	public:
-		Loop(int loopToIndex);
-		virtual Command GetType() override { return Command::Loop; }
-		int GetLoopToIndex();
-	private:
-		int loopToIndex;
-	};
-
-	class End : public CommandData
-	{
-	public:
-		virtual Command GetType() override { return Command::End; }
-	};
-
-	bool isAnimationDone;
-	int animSequenceIndex;
-	PlayFrame* currPlayFrameData;
-	std::vector<CommandData*> animations;
-};
\ No newline at end of file
+	const AnimationCommandInfo* commands = nullptr;
+	uint32_t commandIndex = 0;	// always a PlayFrame
+	double timer = 0;
+	bool isAnimationDone = false;
+};
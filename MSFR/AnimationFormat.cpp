@@ -0,0 +1,93 @@
+#include "AnimationFormat.h"
+
+#include <istream>
+#include <ostream>
+
+bool ParseAnimationInfo(std::istream& in, std::vector<AnimationCommandInfo>& commands, std::vector<std::string>& errors)
+{
+    commands.clear();
+
+    std::string text;
+    while (in >> text)
+    {
+        AnimationCommandInfo command;
+        if (text == "PlayFrame")
+        {
+            command.type = AnimationCommandInfo::Type::PlayFrame;
+            in >> command.value >> command.duration;
+        }
+        else if (text == "Loop")
+        {
+            command.type = AnimationCommandInfo::Type::Loop;
+            in >> command.value;
+        }
+        else if (text == "End")
+        {
+            command.type = AnimationCommandInfo::Type::End;
+        }
+        else
+        {
+            errors.push_back("Unknown command " + text);
+            continue;
+        }
+        if (!in)
+        {
+            errors.push_back("Bad " + text + " arguments");
+            return false;
+        }
+        commands.push_back(command);
+    }
+    return true;
+}
+
+void WriteAnimationInfo(std::ostream& out, const std::vector<AnimationCommandInfo>& commands)
+{
+    for (const AnimationCommandInfo& command : commands)
+    {
+        switch (command.type)
+        {
+        case AnimationCommandInfo::Type::PlayFrame:
+            out << "PlayFrame " << command.value << ' ' << command.duration << '\n';
+            break;
+        case AnimationCommandInfo::Type::Loop:
+            out << "Loop " << command.value << '\n';
+            break;
+        default:
+            out << "End\n";
+            break;
+        }
+    }
+}
+
+bool ValidateAnimation(const AnimationCommandInfo* commands, size_t count, std::string& error)
+{
+    using Type = AnimationCommandInfo::Type;
+    if (count == 0 || commands[0].type != Type::PlayFrame)
+    {
+        error = "an animation must start with PlayFrame";
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        const AnimationCommandInfo& command = commands[i];
+        if (command.type == Type::Loop)
+        {
+            if (command.value < 0 || static_cast<size_t>(command.value) >= count || commands[command.value].type != Type::PlayFrame)
+            {
+                error = "Loop " + std::to_string(command.value) + " does not go to a PlayFrame";
+                return false;
+            }
+        }
+        else if (command.type != Type::PlayFrame && command.type != Type::End)
+        {
+            error = "unknown command type";
+            return false;
+        }
+    }
+    if (commands[count - 1].type == Type::PlayFrame)
+    {
+        error = "an animation must end with Loop or End";
+        return false;
+    }
+    return true;
+}
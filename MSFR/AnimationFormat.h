@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// One command of an animation (.anm) file, which holds one per line:
+//   PlayFrame frame seconds | Loop commandIndex | End
+// Cooked animations (SpriteBlob.h) store these as they are in memory.
+struct AnimationCommandInfo
+{
+    enum class Type : uint32_t { PlayFrame, Loop, End };
+
+    Type type = Type::End;
+    int32_t value = 0;          // PlayFrame: frame, Loop: command index
+    float duration = 0.0f;      // PlayFrame: seconds
+};
+
+static_assert(sizeof(AnimationCommandInfo) == 12, "AnimationCommandInfo is stored in cooked files");
+
+// Unknown commands are reported through errors and skipped.
+bool ParseAnimationInfo(std::istream& in, std::vector<AnimationCommandInfo>& commands, std::vector<std::string>& errors);
+void WriteAnimationInfo(std::ostream& out, const std::vector<AnimationCommandInfo>& commands);
+
+// What Animation relies on while playing: the first command is a PlayFrame,
+// every Loop goes to a PlayFrame and the last command is a Loop or an End.
+bool ValidateAnimation(const AnimationCommandInfo* commands, size_t count, std::string& error);
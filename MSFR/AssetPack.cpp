@@ -0,0 +1,292 @@
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Hash.h"
+#include "ImageCodec.h" //ZlibInflate, LoadFile
+
+namespace
+{
+    bool Fail(std::string* error, const std::string& message)
+    {
+        if (error) *error = message;
+        return false;
+    }
+
+    bool Less(const PackEntry& entry, uint64_t hash)
+    {
+        return entry.pathHash < hash;
+    }
+}
+
+std::string GetPackPath(const std::filesystem::path& path)
+{
+    std::string key = path.lexically_normal().generic_string();
+    while (key.compare(0, 2, "./") == 0) key.erase(0, 2);
+    return key;
+}
+
+AssetStream::Buffer::Buffer(const uint8_t* data, size_t size)
+{
+    // The get area is never written through
+    char* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+    setg(begin, begin, begin + size);
+}
+
+AssetStream::Buffer::pos_type AssetStream::Buffer::seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+    if (!(which & std::ios_base::in)) return pos_type(off_type(-1));
+    const off_type from = dir == std::ios_base::beg ? 0 : dir == std::ios_base::cur ? gptr() - eback() : egptr() - eback();
+    const off_type target = from + offset;
+    if (target < 0 || target > egptr() - eback()) return pos_type(off_type(-1));
+    setg(eback(), eback() + target, egptr());
+    return pos_type(target);
+}
+
+AssetStream::Buffer::pos_type AssetStream::Buffer::seekpos(pos_type position, std::ios_base::openmode which)
+{
+    return seekoff(off_type(position), std::ios_base::beg, which);
+}
+
+AssetStream::AssetStream(const AssetBytes& bytes)
+    : std::istream(nullptr), buffer(bytes.data, bytes.size)
+{
+    rdbuf(&buffer);
+}
+
+AssetPack::~AssetPack()
+{
+    Close();
+}
+
+bool AssetPack::Map(const std::filesystem::path& path, std::string* error)
+{
+#if defined(_WIN32)
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return Fail(error, "cannot open file");
+    fileHandle = file;
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(PackHeader)) return Fail(error, "not an asset pack");
+    mappedSize = (size_t)size.QuadPart;
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) return Fail(error, "cannot map file");
+    mappingHandle = mapping;
+
+    base = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (base == nullptr) return Fail(error, "cannot map file");
+#else
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) return Fail(error, "cannot open file");
+
+    struct stat status{};
+    if (::fstat(file, &status) != 0 || status.st_size < (off_t)sizeof(PackHeader))
+    {
+        ::close(file);
+        return Fail(error, "not an asset pack");
+    }
+    mappedSize = (size_t)status.st_size;
+
+    // The mapping keeps the file alive on its own
+    void* view = ::mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (view == MAP_FAILED) return Fail(error, "cannot map file");
+    base = static_cast<const uint8_t*>(view);
+#endif
+    return true;
+}
+
+bool AssetPack::Open(const std::filesystem::path& path, std::string* error)
+{
+    Close();
+    std::string reason;
+    if (!Map(path, &reason))
+    {
+        Close();
+        return Fail(error, path.generic_string() + ": " + reason);
+    }
+
+    PackHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    const uint64_t tocBytes = (uint64_t)header.entryCount * sizeof(PackEntry);
+    if (std::memcmp(header.magic, PackFormat::Magic, 4) != 0) reason = "not an asset pack";
+    else if (header.version != PackFormat::Version) reason = "unsupported version " + std::to_string(header.version);
+    else if (header.alignment < PackFormat::MinAlignment || (header.alignment & (header.alignment - 1)) != 0)
+        reason = "bad entry alignment " + std::to_string(header.alignment);
+    else if (header.tocOffset % alignof(PackEntry) != 0 || header.tocOffset > mappedSize || tocBytes > mappedSize - header.tocOffset)
+        reason = "truncated table of contents";
+    else if (header.namesOffset > mappedSize || header.namesSize > mappedSize - header.namesOffset) reason = "truncated path block";
+
+    if (reason.empty())
+    {
+        entries = reinterpret_cast<const PackEntry*>(base + header.tocOffset);
+        entryCount = header.entryCount;
+        names = reinterpret_cast<const char*>(base + header.namesOffset);
+        for (uint32_t i = 0; i < entryCount && reason.empty(); ++i)
+        {
+            const PackEntry& entry = entries[i];
+            if (entry.offset > mappedSize || entry.storedSize > mappedSize - entry.offset) reason = "entry data out of range";
+            else if ((uint64_t)entry.nameOffset + entry.nameLength > header.namesSize) reason = "entry path out of range";
+            else if (entry.compression > PackFormat::Zlib) reason = "unknown compression";
+            else if (entry.compression == PackFormat::Stored && entry.size != entry.storedSize) reason = "bad stored size";
+            else if (i > 0 && (entries[i - 1].pathHash > entry.pathHash ||
+                (entries[i - 1].pathHash == entry.pathHash && GetPath(entries[i - 1]) >= GetPath(entry))))
+                reason = "table of contents is not sorted";
+        }
+    }
+    if (!reason.empty())
+    {
+        Close();
+        return Fail(error, path.generic_string() + ": " + reason);
+    }
+
+    filePath = path;
+    return true;
+}
+
+void AssetPack::Close()
+{
+#if defined(_WIN32)
+    if (base) UnmapViewOfFile(base);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+#else
+    if (base) ::munmap(const_cast<uint8_t*>(base), mappedSize);
+#endif
+    base = nullptr;
+    mappedSize = 0;
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+    entries = nullptr;
+    entryCount = 0;
+    names = nullptr;
+    filePath.clear();
+}
+
+std::string_view AssetPack::GetPath(const PackEntry& entry) const
+{
+    return std::string_view(names + entry.nameOffset, entry.nameLength);
+}
+
+const PackEntry* AssetPack::Find(std::string_view path) const
+{
+    const uint64_t hash = HashString(path);
+    const PackEntry* end = entries + entryCount;
+    for (const PackEntry* entry = std::lower_bound(entries, end, hash, Less); entry != end && entry->pathHash == hash; ++entry)
+    {
+        if (GetPath(*entry) == path) return entry;
+    }
+    return nullptr;
+}
+
+bool AssetPack::Read(const PackEntry& entry, AssetBytes& out) const
+{
+    const uint8_t* stored = base + entry.offset;
+    if (entry.compression == PackFormat::Stored)
+    {
+        out.storage.clear();
+        out.data = stored;
+        out.size = (size_t)entry.size;
+        return true;
+    }
+
+    if (!ZlibInflate(stored, (size_t)entry.storedSize, out.storage, (size_t)entry.size) || out.storage.size() != entry.size)
+    {
+        out.storage.clear();
+        return false;
+    }
+    out.data = out.storage.data();
+    out.size = out.storage.size();
+    return true;
+}
+
+bool AssetFileSystem::Mount(const std::filesystem::path& packFile, std::string* error)
+{
+    auto pack = std::make_unique<AssetPack>();
+    if (!pack->Open(packFile, error)) return false;
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    packs.push_back(std::move(pack));
+    return true;
+}
+
+void AssetFileSystem::UnmountAll()
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    packs.clear();
+}
+
+const PackEntry* AssetFileSystem::Find(const std::filesystem::path& path, const AssetPack*& pack) const
+{
+    if (packs.empty()) return nullptr;
+    const std::string key = GetPackPath(path);
+    for (auto it = packs.rbegin(); it != packs.rend(); ++it)
+    {
+        if (const PackEntry* entry = (*it)->Find(key))
+        {
+            pack = it->get();
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+bool AssetFileSystem::ReadPacked(const std::filesystem::path& path, AssetBytes& out) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    const AssetPack* pack = nullptr;
+    const PackEntry* entry = Find(path, pack);
+    return entry && pack->Read(*entry, out);
+}
+
+bool AssetFileSystem::Read(const std::filesystem::path& path, AssetBytes& out) const
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        const AssetPack* pack = nullptr;
+        if (const PackEntry* entry = Find(path, pack)) return pack->Read(*entry, out);
+    }
+
+    if (!LoadFile(path, out.storage)) return false;
+    out.data = out.storage.data();
+    out.size = out.storage.size();
+    return true;
+}
+
+bool AssetFileSystem::IsPacked(const std::filesystem::path& path) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    const AssetPack* pack = nullptr;
+    return Find(path, pack) != nullptr;
+}
+
+std::filesystem::path AssetFileSystem::ResolveCooked(const std::filesystem::path& source, const char* cookedExtension) const
+{
+    if (source.extension() == cookedExtension) return source;
+    std::filesystem::path cooked = source;
+    cooked.replace_extension(cookedExtension);
+
+    if (IsPacked(cooked)) return cooked;
+    if (IsPacked(source)) return source;
+
+    std::error_code ec;
+    const auto cookedTime = std::filesystem::last_write_time(cooked, ec);
+    if (ec) return source;
+    const auto sourceTime = std::filesystem::last_write_time(source, ec);
+    if (!ec && sourceTime > cookedTime) return source;
+    return cooked;
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <memory>
+#include <shared_mutex>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Asset pack file (see Tools/AssetPacker.cpp), little-endian:
+//   PackHeader
+//   entry data, each entry starting on a multiple of header.alignment, at
+//     least MinAlignment so cooked blobs (SpriteBlob.h) can be read in place
+//   PackEntry[entryCount], sorted by pathHash and then path
+//   entry paths, UTF-8 without terminators
+// Paths are relative to the directory the game runs in, in generic form
+// ("assets/images/a.png"), and pathHash is HashString of the path. An entry
+// is stored as it is or as a zlib stream (ImageCodec.h), whichever the
+// packer found worth it.
+namespace PackFormat
+{
+    constexpr char Magic[4] = { 'M', 'P', 'A', 'K' };
+    constexpr uint32_t Version = 1;
+    constexpr uint32_t MinAlignment = 4;
+
+    enum Compression : uint32_t
+    {
+        Stored = 0,
+        Zlib = 1,
+    };
+}
+
+struct PackHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t alignment;
+    uint64_t tocOffset;
+    uint64_t namesOffset;
+    uint64_t namesSize;
+};
+
+struct PackEntry
+{
+    uint64_t pathHash;
+    uint64_t offset;
+    uint64_t storedSize;
+    uint64_t size;              // after inflating; storedSize when Stored
+    uint32_t nameOffset;        // into the path block
+    uint32_t nameLength;
+    uint32_t compression;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(PackHeader) == 40, "PackHeader is an on-disk layout");
+static_assert(sizeof(PackEntry) == 48, "PackEntry is an on-disk layout");
+
+// The key an asset path is looked up by: generic, lexically normal and
+// without a leading "./".
+std::string GetPackPath(const std::filesystem::path& path);
+
+// One asset's bytes. data points into a mapped pack when the entry was
+// stored, and at storage when it was inflated or read from a loose file.
+struct AssetBytes
+{
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    std::vector<uint8_t> storage;
+};
+
+// std::istream over an AssetBytes, without copying, for the parsers that
+// read streams. bytes must outlive the stream.
+class AssetStream : public std::istream
+{
+public:
+    explicit AssetStream(const AssetBytes& bytes);
+
+private:
+    class Buffer : public std::streambuf
+    {
+    public:
+        Buffer(const uint8_t* data, size_t size);
+
+    protected:
+        pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+        pos_type seekpos(pos_type position, std::ios_base::openmode which) override;
+    };
+
+    Buffer buffer;
+};
+
+// A pack mapped read-only into memory. Open checks the header and table of
+// contents up front, so lookups and reads trust them afterwards; reads of
+// a stored entry are a pointer into the mapping. Const members are safe
+// from any thread.
+class AssetPack
+{
+public:
+    AssetPack() = default;
+    ~AssetPack();
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    bool Open(const std::filesystem::path& path, std::string* error = nullptr);
+    void Close();
+    bool IsOpen() const { return base != nullptr; }
+
+    // path as GetPackPath gives it. Null when the pack doesn't have it.
+    const PackEntry* Find(std::string_view path) const;
+    bool Read(const PackEntry& entry, AssetBytes& out) const;
+
+    uint32_t GetEntryCount() const { return entryCount; }
+    const PackEntry& GetEntry(uint32_t index) const { return entries[index]; }
+    std::string_view GetPath(const PackEntry& entry) const;
+    const std::filesystem::path& GetFilePath() const { return filePath; }
+
+private:
+    bool Map(const std::filesystem::path& path, std::string* error);
+
+    std::filesystem::path filePath;
+    const uint8_t* base = nullptr;
+    size_t mappedSize = 0;
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+    const PackEntry* entries = nullptr;
+    uint32_t entryCount = 0;
+    const char* names = nullptr;
+};
+
+// Where the engine's loaders read assets from: the mounted packs, the last
+// mounted first, then the loose file. Packs only answer for what they hold,
+// so a game can ship some assets packed and keep others loose. Reads are
+// safe from any thread, decode threads included; views into a pack stay
+// valid until UnmountAll, which must wait until no AssetBytes uses them.
+class AssetFileSystem
+{
+public:
+    bool Mount(const std::filesystem::path& packFile, std::string* error = nullptr);
+    void UnmountAll();
+
+    bool Read(const std::filesystem::path& path, AssetBytes& out) const;
+    // Packs only; false leaves the loose file to the caller.
+    bool ReadPacked(const std::filesystem::path& path, AssetBytes& out) const;
+    bool IsPacked(const std::filesystem::path& path) const;
+    // source with cookedExtension (a .dds for a .png, a .sptc for a .spt)
+    // when that's packed, or on disk and not older than source; source
+    // otherwise. A pack never holds both: the packer keeps the newer one.
+    std::filesystem::path ResolveCooked(const std::filesystem::path& source, const char* cookedExtension) const;
+
+private:
+    const PackEntry* Find(const std::filesystem::path& path, const AssetPack*& pack) const;
+
+    mutable std::shared_mutex mutex;
+    std::vector<std::unique_ptr<AssetPack>> packs;
+};
@@ -0,0 +1,329 @@
+#include "AtlasAllocator.h"
+
+#include <algorithm>
+#include <climits>
+
+AtlasAllocator::AtlasAllocator(int pageWidth_, int pageHeight_, uint32_t maxPages_, int padding_)
+    : pageWidth(pageWidth_ > 0 ? pageWidth_ : 1)
+    , pageHeight(pageHeight_ > 0 ? pageHeight_ : 1)
+    , maxPages(maxPages_ > 0 ? maxPages_ : 1)
+    , padding(padding_ > 0 ? padding_ : 0)
+{
+}
+
+void AtlasAllocator::Reset()
+{
+    // Bump every generation so old ids never resolve again
+    for (uint32_t i = 0; i < slots.size(); ++i)
+    {
+        if (slots[i].live) Release(i);
+    }
+    pages.clear();
+    stats = {};
+}
+
+AtlasSlot AtlasAllocator::Allocate(int width, int height)
+{
+    if (width <= 0 || height <= 0 || width > pageWidth || height > pageHeight
+        || (freeSlots.empty() && slots.size() > IndexMask))
+    {
+        ++stats.failedAllocations;
+        return {};
+    }
+
+    // Padding goes right/below the content; it may be dropped at the page edge
+    const int w = std::min(width + padding, pageWidth);
+    const int h = std::min(height + padding, pageHeight);
+    AtlasRect rect;
+
+    for (uint32_t p = 0; p < pages.size(); ++p)
+    {
+        if (AllocateInPage(pages[p], w, h, rect)) return Commit(p, rect, width, height);
+    }
+
+    if (pages.size() < maxPages)
+    {
+        pages.emplace_back();
+        ResetPage(pages.back());
+        if (AllocateInPage(pages.back(), w, h, rect)) return Commit((uint32_t)pages.size() - 1, rect, width, height);
+    }
+
+    // Under pressure: the oldest stale slot that can hold the rect on its own
+    for (uint32_t i = lruHead; i != Nil && slots[i].lastUsed < frame; i = slots[i].next)
+    {
+        if (slots[i].rect.width >= w && slots[i].rect.height >= h)
+        {
+            const uint32_t page = slots[i].page;
+            Release(i);
+            ++stats.evictions;
+            if (AllocateInPage(pages[page], w, h, rect)) return Commit(page, rect, width, height);
+        }
+    }
+
+    // Otherwise empty the least recently used page that nothing this frame needs
+    uint32_t victim = Nil;
+    for (uint32_t p = 0; p < pages.size(); ++p)
+    {
+        if (pages[p].lastUsed < frame && (victim == Nil || pages[p].lastUsed < pages[victim].lastUsed)) victim = p;
+    }
+    if (victim != Nil)
+    {
+        for (uint32_t i = 0; i < slots.size() && pages[victim].liveSlots > 0; ++i)
+        {
+            if (slots[i].live && slots[i].page == victim)
+            {
+                Release(i);
+                ++stats.evictions;
+            }
+        }
+        if (AllocateInPage(pages[victim], w, h, rect)) return Commit(victim, rect, width, height);
+    }
+
+    ++stats.failedAllocations;
+    return {};
+}
+
+void AtlasAllocator::Free(AtlasSlot slot)
+{
+    if (Resolve(slot)) Release(slot.id & IndexMask);
+}
+
+bool AtlasAllocator::Touch(AtlasSlot slot)
+{
+    if (!Resolve(slot)) return false;
+
+    const uint32_t index = slot.id & IndexMask;
+    if (slots[index].lastUsed != frame)
+    {
+        slots[index].lastUsed = frame;
+        pages[slots[index].page].lastUsed = frame;
+        Unlink(index);
+        LinkTail(index);
+    }
+    return true;
+}
+
+bool AtlasAllocator::IsValid(AtlasSlot slot) const
+{
+    return Resolve(slot) != nullptr;
+}
+
+bool AtlasAllocator::GetRect(AtlasSlot slot, uint32_t& page, AtlasRect& rect) const
+{
+    const Slot* s = Resolve(slot);
+    if (!s) return false;
+
+    page = s->page;
+    rect = { s->rect.x, s->rect.y, s->width, s->height };
+    return true;
+}
+
+void AtlasAllocator::GetUVRect(const AtlasRect& rect, float uv[4]) const
+{
+    uv[0] = (float)rect.x / (float)pageWidth;
+    uv[1] = (float)rect.y / (float)pageHeight;
+    uv[2] = (float)(rect.x + rect.width) / (float)pageWidth;
+    uv[3] = (float)(rect.y + rect.height) / (float)pageHeight;
+}
+
+void AtlasAllocator::ResetPage(Page& page) const
+{
+    page.skyline.assign(1, { 0, 0, pageWidth });
+    page.freeRects.clear();
+    page.liveSlots = 0;
+}
+
+bool AtlasAllocator::AllocateInPage(Page& page, int width, int height, AtlasRect& out) const
+{
+    return TakeFreeRect(page, width, height, out) || TakeSkyline(page, width, height, out);
+}
+
+bool AtlasAllocator::TakeFreeRect(Page& page, int width, int height, AtlasRect& out) const
+{
+    size_t best = page.freeRects.size();
+    long long bestWaste = LLONG_MAX;
+    for (size_t i = 0; i < page.freeRects.size(); ++i)
+    {
+        const AtlasRect& f = page.freeRects[i];
+        if (f.width < width || f.height < height) continue;
+        const long long waste = (long long)f.width * f.height - (long long)width * height;
+        if (waste < bestWaste)
+        {
+            bestWaste = waste;
+            best = i;
+        }
+    }
+    if (best == page.freeRects.size()) return false;
+
+    const AtlasRect f = page.freeRects[best];
+    page.freeRects[best] = page.freeRects.back();
+    page.freeRects.pop_back();
+    out = { f.x, f.y, width, height };
+
+    // Guillotine split, giving the longer leftover the full extent
+    const int restW = f.width - width;
+    const int restH = f.height - height;
+    AtlasRect right, below;
+    if (restW > restH)
+    {
+        right = { f.x + width, f.y, restW, f.height };
+        below = { f.x, f.y + height, width, restH };
+    }
+    else
+    {
+        right = { f.x + width, f.y, restW, height };
+        below = { f.x, f.y + height, f.width, restH };
+    }
+    if (right.width > 0 && right.height > 0) page.freeRects.push_back(right);
+    if (below.width > 0 && below.height > 0) page.freeRects.push_back(below);
+    return true;
+}
+
+bool AtlasAllocator::TakeSkyline(Page& page, int width, int height, AtlasRect& out) const
+{
+    std::vector<Segment>& sky = page.skyline;
+
+    // Bottom-left: lowest resulting top edge, then leftmost
+    size_t bestIndex = sky.size();
+    int bestY = INT_MAX;
+    for (size_t i = 0; i < sky.size(); ++i)
+    {
+        const int x = sky[i].x;
+        if (x + width > pageWidth) break;
+
+        int y = 0;
+        int covered = 0;
+        for (size_t j = i; j < sky.size() && covered < width; ++j)
+        {
+            y = std::max(y, sky[j].y);
+            covered += sky[j].width;
+        }
+        if (y + height > pageHeight) continue;
+        if (y < bestY)
+        {
+            bestY = y;
+            bestIndex = i;
+        }
+    }
+    if (bestIndex == sky.size()) return false;
+
+    out = { sky[bestIndex].x, bestY, width, height };
+
+    // Replace the covered span with one segment at the new height
+    const int right = out.x + width;
+    sky.insert(sky.begin() + bestIndex, { out.x, bestY + height, width });
+    size_t i = bestIndex + 1;
+    while (i < sky.size() && sky[i].x < right)
+    {
+        const int end = sky[i].x + sky[i].width;
+        if (end <= right)
+        {
+            sky.erase(sky.begin() + i);
+        }
+        else
+        {
+            sky[i].width = end - right;
+            sky[i].x = right;
+            break;
+        }
+    }
+
+    // Merge neighbours at equal height
+    for (size_t k = 0; k + 1 < sky.size();)
+    {
+        if (sky[k].y == sky[k + 1].y)
+        {
+            sky[k].width += sky[k + 1].width;
+            sky.erase(sky.begin() + k + 1);
+        }
+        else
+        {
+            ++k;
+        }
+    }
+    return true;
+}
+
+AtlasSlot AtlasAllocator::Commit(uint32_t page, const AtlasRect& padded, int width, int height)
+{
+    uint32_t index;
+    if (!freeSlots.empty())
+    {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        index = (uint32_t)slots.size();
+        slots.emplace_back();
+    }
+
+    Slot& s = slots[index];
+    s.page = page;
+    s.rect = padded;
+    s.width = width;
+    s.height = height;
+    s.lastUsed = frame;
+    s.live = true;
+    LinkTail(index);
+
+    ++pages[page].liveSlots;
+    pages[page].lastUsed = frame;
+    ++stats.liveSlots;
+    ++stats.allocations;
+    stats.usedArea += (uint64_t)padded.width * padded.height;
+
+    return AtlasSlot{ (s.generation << IndexBits) | index };
+}
+
+void AtlasAllocator::Release(uint32_t index)
+{
+    Slot& s = slots[index];
+    Unlink(index);
+    s.live = false;
+    s.generation = (s.generation + 1) & (0xFFFFFFFF >> IndexBits);
+    if (s.generation == 0) s.generation = 1;
+    freeSlots.push_back(index);
+
+    --stats.liveSlots;
+    stats.usedArea -= (uint64_t)s.rect.width * s.rect.height;
+
+    Page& page = pages[s.page];
+    if (--page.liveSlots == 0)
+    {
+        ResetPage(page);
+        ++stats.pageResets;
+    }
+    else
+    {
+        page.freeRects.push_back(s.rect);
+    }
+}
+
+const AtlasAllocator::Slot* AtlasAllocator::Resolve(AtlasSlot slot) const
+{
+    const uint32_t index = slot.id & IndexMask;
+    if (!slot || index >= slots.size()) return nullptr;
+    const Slot& s = slots[index];
+    return (s.live && s.generation == slot.id >> IndexBits) ? &s : nullptr;
+}
+
+void AtlasAllocator::LinkTail(uint32_t index)
+{
+    Slot& s = slots[index];
+    s.prev = lruTail;
+    s.next = Nil;
+    if (lruTail != Nil) slots[lruTail].next = index;
+    else lruHead = index;
+    lruTail = index;
+}
+
+void AtlasAllocator::Unlink(uint32_t index)
+{
+    Slot& s = slots[index];
+    if (s.prev != Nil) slots[s.prev].next = s.next;
+    else lruHead = s.next;
+    if (s.next != Nil) slots[s.next].prev = s.prev;
+    else lruTail = s.prev;
+    s.prev = s.next = Nil;
+}
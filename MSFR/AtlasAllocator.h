@@ -0,0 +1,127 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+struct AtlasRect
+{
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// Generation-tagged slot id; a slot that has been freed or evicted stops
+// resolving even if its storage is reused.
+struct AtlasSlot
+{
+    uint32_t id = 0;
+    explicit operator bool() const noexcept { return id != 0; }
+};
+
+constexpr bool operator==(AtlasSlot a, AtlasSlot b) noexcept { return a.id == b.id; }
+constexpr bool operator!=(AtlasSlot a, AtlasSlot b) noexcept { return a.id != b.id; }
+
+// Sub-allocates rectangles from fixed-size pages. Fresh space comes from a
+// bottom-left skyline per page; freed or evicted rectangles are kept per page
+// and reused first. When every page is full the oldest slot big enough for the
+// request is evicted, failing that the least recently used page is emptied.
+// Nothing touched in the current frame is ever evicted. Pure bookkeeping: no
+// pixels, no GPU.
+class AtlasAllocator
+{
+public:
+    struct Stats
+    {
+        uint32_t liveSlots = 0;
+        uint32_t allocations = 0;
+        uint32_t failedAllocations = 0;
+        uint32_t evictions = 0;
+        uint32_t pageResets = 0;    // pages emptied by eviction and re-skylined
+        uint64_t usedArea = 0;      // padded texels held by live slots
+    };
+
+    AtlasAllocator(int pageWidth, int pageHeight, uint32_t maxPages, int padding = 1);
+
+    // Drops every page and slot; outstanding slots stop resolving.
+    void Reset();
+
+    // Advances the LRU clock; slots touched after this belong to the new frame.
+    void NextFrame() { ++frame; }
+    uint64_t GetFrame() const { return frame; }
+
+    // Returns an invalid slot if the rect cannot fit even after eviction.
+    AtlasSlot Allocate(int width, int height);
+    void Free(AtlasSlot slot);
+
+    // Marks the slot used this frame. False if it was freed or evicted.
+    bool Touch(AtlasSlot slot);
+    bool IsValid(AtlasSlot slot) const;
+
+    // Rect of the slot's content (padding excluded), in page texels.
+    bool GetRect(AtlasSlot slot, uint32_t& page, AtlasRect& rect) const;
+    // u0, v0 (top-left), u1, v1 in the page, same layout as SpriteDrawItem::uvRect
+    void GetUVRect(const AtlasRect& rect, float uv[4]) const;
+
+    int GetPageWidth() const { return pageWidth; }
+    int GetPageHeight() const { return pageHeight; }
+    uint32_t GetPageCount() const { return (uint32_t)pages.size(); }
+    const Stats& GetStats() const { return stats; }
+
+private:
+    static constexpr uint32_t Nil = 0xFFFFFFFF;
+    static constexpr uint32_t IndexBits = 20;
+    static constexpr uint32_t IndexMask = (1u << IndexBits) - 1;
+
+    struct Segment
+    {
+        int x;
+        int y;
+        int width;
+    };
+
+    struct Page
+    {
+        std::vector<Segment> skyline;
+        std::vector<AtlasRect> freeRects;
+        uint32_t liveSlots = 0;
+        uint64_t lastUsed = 0;      // newest use of any slot on the page
+    };
+
+    struct Slot
+    {
+        uint32_t page = 0;
+        AtlasRect rect;             // padded
+        int width = 0;
+        int height = 0;
+        uint64_t lastUsed = 0;
+        uint32_t generation = 1;
+        uint32_t prev = Nil;        // LRU list, oldest at head
+        uint32_t next = Nil;
+        bool live = false;
+    };
+
+    void ResetPage(Page& page) const;
+    bool AllocateInPage(Page& page, int width, int height, AtlasRect& out) const;
+    bool TakeFreeRect(Page& page, int width, int height, AtlasRect& out) const;
+    bool TakeSkyline(Page& page, int width, int height, AtlasRect& out) const;
+
+    AtlasSlot Commit(uint32_t page, const AtlasRect& padded, int width, int height);
+    void Release(uint32_t index);
+    const Slot* Resolve(AtlasSlot slot) const;
+
+    void LinkTail(uint32_t index);
+    void Unlink(uint32_t index);
+
+    int pageWidth;
+    int pageHeight;
+    uint32_t maxPages;
+    int padding;
+    uint64_t frame = 1;
+
+    std::vector<Page> pages;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    uint32_t lruHead = Nil;
+    uint32_t lruTail = Nil;
+    Stats stats;
+};
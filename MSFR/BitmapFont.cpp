@@ -0,0 +1,264 @@
+#include "BitmapFont.h"
+
+#include <algorithm>
+
+#include "FontFormat.h"
+#include "Hash.h"
+#include "SpriteBatch.h"
+
+namespace
+{
+    constexpr uint32_t Replacement = 0xFFFD;
+
+    uint64_t PairKey(uint32_t first, uint32_t second)
+    {
+        return (uint64_t)first << 32 | second;
+    }
+
+    // Decodes one UTF-8 sequence at text[i] and advances i; malformed bytes
+    // come out as U+FFFD one at a time
+    uint32_t NextCodepoint(std::string_view text, size_t& i)
+    {
+        const uint8_t lead = (uint8_t)text[i++];
+        if (lead < 0x80) return lead;
+
+        int extra = 0;
+        uint32_t cp = 0;
+        if ((lead & 0xE0) == 0xC0) { extra = 1; cp = lead & 0x1F; }
+        else if ((lead & 0xF0) == 0xE0) { extra = 2; cp = lead & 0x0F; }
+        else if ((lead & 0xF8) == 0xF0) { extra = 3; cp = lead & 0x07; }
+        else return Replacement;
+
+        if (i + extra > text.size()) return Replacement;
+        for (int k = 0; k < extra; ++k)
+        {
+            const uint8_t c = (uint8_t)text[i + k];
+            if ((c & 0xC0) != 0x80) return Replacement;
+            cp = cp << 6 | (c & 0x3F);
+        }
+        i += extra;
+        return cp;
+    }
+
+    uint64_t HashKey(const BitmapFont& font, std::string_view text)
+    {
+        const BitmapFont* address = &font;
+        return HashString(text, HashValue(address));
+    }
+}
+
+bool BitmapFont::Build(const FontInfo& info)
+{
+    glyphs.clear();
+    other.clear();
+    kerning.clear();
+    std::fill(std::begin(ascii), std::end(ascii), NoGlyph);
+    fallback = NoGlyph;
+    lineHeight = 0;
+    if (info.glyphs.empty() || info.scaleW <= 0 || info.scaleH <= 0) return false;
+
+    const float invW = 1.f / (float)info.scaleW;
+    const float invH = 1.f / (float)info.scaleH;
+    for (const FontGlyphInfo& source : info.glyphs)
+    {
+        Glyph glyph;
+        glyph.x = (float)source.xOffset;
+        glyph.y = (float)(info.base - source.yOffset - source.height);
+        glyph.width = source.width > 0 && source.height > 0 ? (float)source.width : 0.f;
+        glyph.height = (float)source.height;
+        glyph.advance = (float)source.xAdvance;
+        glyph.uvRect[0] = (float)source.x * invW;
+        glyph.uvRect[1] = (float)source.y * invH;
+        glyph.uvRect[2] = (float)(source.x + source.width) * invW;
+        glyph.uvRect[3] = (float)(source.y + source.height) * invH;
+
+        const uint32_t index = (uint32_t)glyphs.size();
+        glyphs.push_back(glyph);
+        if (source.id < AsciiCount) ascii[source.id] = index;
+        else other[source.id] = index;
+    }
+    for (const FontKerningInfo& pair : info.kernings)
+    {
+        if (pair.amount != 0) kerning[PairKey(pair.first, pair.second)] = (float)pair.amount;
+    }
+    fallback = ascii[(uint32_t)'?'];
+    lineHeight = (float)info.lineHeight;
+    return true;
+}
+
+const BitmapFont::Glyph* BitmapFont::Find(uint32_t codepoint) const
+{
+    uint32_t index = NoGlyph;
+    if (codepoint < AsciiCount)
+    {
+        index = ascii[codepoint];
+    }
+    else
+    {
+        auto it = other.find(codepoint);
+        if (it != other.end()) index = it->second;
+    }
+    if (index == NoGlyph) index = fallback;
+    return index == NoGlyph ? nullptr : &glyphs[index];
+}
+
+float BitmapFont::GetKerning(uint32_t first, uint32_t second) const
+{
+    if (kerning.empty()) return 0.f;
+    auto it = kerning.find(PairKey(first, second));
+    return it == kerning.end() ? 0.f : it->second;
+}
+
+uint32_t TextLayout::Update(const BitmapFont& font_, std::string_view text)
+{
+    if (font != &font_)
+    {
+        quads.clear();
+        font = &font_;
+    }
+
+    const size_t previous = quads.size();
+    size_t count = 0;
+    uint32_t rebuilt = 0;
+    uint32_t prev = 0;
+    float penX = 0;
+    float penY = 0;
+    float maxX = 0;
+    int lines = text.empty() ? 0 : 1;
+
+    for (size_t i = 0; i < text.size();)
+    {
+        const uint32_t cp = NextCodepoint(text, i);
+        if (cp == '\n')
+        {
+            penX = 0;
+            penY -= font->GetLineHeight();
+            prev = 0;
+            ++lines;
+        }
+        const BitmapFont::Glyph* glyph = cp == '\n' ? nullptr : font->Find(cp);
+        if (glyph) penX += font->GetKerning(prev, cp);
+
+        if (count == quads.size()) quads.emplace_back();
+        Quad& quad = quads[count++];
+        if (count > previous || quad.codepoint != cp || quad.penX != penX || quad.penY != penY)
+        {
+            quad = {};
+            quad.codepoint = cp;
+            quad.penX = penX;
+            quad.penY = penY;
+            if (glyph && glyph->width > 0)
+            {
+                quad.x = penX + glyph->x;
+                quad.y = penY + glyph->y;
+                quad.width = glyph->width;
+                quad.height = glyph->height;
+                std::copy(glyph->uvRect, glyph->uvRect + 4, quad.uvRect);
+            }
+            ++rebuilt;
+        }
+
+        if (glyph)
+        {
+            penX += glyph->advance;
+            maxX = std::max(maxX, penX);
+            prev = cp;
+        }
+    }
+
+    quads.resize(count);
+    width = maxX;
+    height = (float)lines * font->GetLineHeight();
+    return rebuilt;
+}
+
+void TextLayout::Clear()
+{
+    font = nullptr;
+    quads.clear();
+    width = 0;
+    height = 0;
+}
+
+void TextLayout::Draw(SpriteBatch& batch, TextureHandle texture, const float t[6],
+    uint32_t color, uint32_t layer, uint32_t depth) const
+{
+    SpriteDrawItem item;
+    item.texture = texture;
+    item.color = color;
+    for (const Quad& quad : quads)
+    {
+        if (quad.width == 0) continue;
+
+        // transform * (quad rect from the unit quad)
+        item.transform[0] = t[0] * quad.width;
+        item.transform[1] = t[1] * quad.width;
+        item.transform[2] = t[2] * quad.height;
+        item.transform[3] = t[3] * quad.height;
+        item.transform[4] = t[0] * quad.x + t[2] * quad.y + t[4];
+        item.transform[5] = t[1] * quad.x + t[3] * quad.y + t[5];
+        std::copy(quad.uvRect, quad.uvRect + 4, item.uvRect);
+        batch.Draw(item, layer, depth);
+    }
+}
+
+const TextLayout& TextLayoutCache::Get(const BitmapFont& font, std::string_view text)
+{
+    const uint64_t hash = HashKey(font, text);
+    auto range = entries.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        Entry& entry = it->second;
+        if (entry.font == &font && entry.text == text)
+        {
+            entry.lastUsed = frame;
+            ++stats.hits;
+            return entry.layout;
+        }
+    }
+
+    ++stats.misses;
+    Entry entry;
+    entry.font = &font;
+    entry.text = std::string(text);
+    entry.lastUsed = frame;
+    entry.layout.Update(font, text);
+    stats.entries = (uint32_t)entries.size() + 1;
+    return entries.emplace(hash, std::move(entry))->second.layout;
+}
+
+void TextLayoutCache::EndFrame()
+{
+    ++frame;
+    if (frame % 16 != 0) return;   // no need to sweep every frame
+
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (frame - it->second.lastUsed > maxIdleFrames)
+        {
+            it = entries.erase(it);
+            ++stats.evictions;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    stats.entries = (uint32_t)entries.size();
+}
+
+void TextLayoutCache::Remove(const BitmapFont& font)
+{
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (it->second.font == &font) it = entries.erase(it);
+        else ++it;
+    }
+    stats.entries = (uint32_t)entries.size();
+}
+
+void TextLayoutCache::Clear()
+{
+    entries.clear();
+    stats.entries = 0;
+}
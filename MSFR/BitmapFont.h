@@ -0,0 +1,123 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "RenderDevice.h"
+
+struct FontInfo;
+class SpriteBatch;
+
+// Glyph metrics of a bitmap font, ready for layout. Positions are texels in
+// layout space: x right, y up, the pen on the baseline.
+class BitmapFont
+{
+public:
+    struct Glyph
+    {
+        float x = 0;         // quad corner relative to the pen
+        float y = 0;
+        float width = 0;     // 0 for glyphs without ink (space)
+        float height = 0;
+        float advance = 0;
+        float uvRect[4] = {};   // u0, v0 (top-left), u1, v1 as in SpriteDrawItem
+    };
+
+    // Fails (and stays empty) without glyphs or a sheet size.
+    bool Build(const FontInfo& info);
+
+    // Falls back to '?' and then to nothing for missing code points.
+    const Glyph* Find(uint32_t codepoint) const;
+    float GetKerning(uint32_t first, uint32_t second) const;
+    float GetLineHeight() const { return lineHeight; }
+    bool IsEmpty() const { return glyphs.empty(); }
+
+private:
+    static constexpr uint32_t AsciiCount = 128;
+    static constexpr uint32_t NoGlyph = 0xFFFFFFFF;
+
+    std::vector<Glyph> glyphs;
+    uint32_t ascii[AsciiCount] = {};                // code point -> glyphs[]
+    std::unordered_map<uint32_t, uint32_t> other;   // beyond ASCII
+    std::unordered_map<uint64_t, float> kerning;    // (first, second) pair
+    uint32_t fallback = NoGlyph;
+    float lineHeight = 0;
+};
+
+// Glyph quads of one string, in layout space (origin on the first baseline,
+// lines going down). Update keeps every glyph whose code point and pen
+// position did not change, so a score or timer that changes a digit or two
+// per frame only rebuilds those digits.
+class TextLayout
+{
+public:
+    struct Quad
+    {
+        uint32_t codepoint = 0;
+        float penX = 0;
+        float penY = 0;
+        float x = 0, y = 0, width = 0, height = 0;   // width 0: nothing to draw
+        float uvRect[4] = {};
+    };
+
+    // Text is UTF-8. Returns how many glyphs had to be laid out again.
+    uint32_t Update(const BitmapFont& font, std::string_view text);
+    void Clear();
+
+    // One SpriteBatch draw per glyph, all sharing texture, layer and depth,
+    // so the batch issues the whole run as one draw call. transform maps
+    // layout space to screen (SpriteDrawItem's 2x3 layout).
+    void Draw(SpriteBatch& batch, TextureHandle texture, const float transform[6],
+        uint32_t color = 0xFFFFFFFF, uint32_t layer = 0, uint32_t depth = 0) const;
+
+    const std::vector<Quad>& GetQuads() const { return quads; }
+    float GetWidth() const { return width; }
+    float GetHeight() const { return height; }   // lines * line height
+
+private:
+    const BitmapFont* font = nullptr;
+    std::vector<Quad> quads;   // one per code point, newlines included
+    float width = 0;
+    float height = 0;
+};
+
+// Layouts of immediate-mode text keyed by font and string, so a label that
+// stays the same is laid out once. Entries not used for maxIdleFrames frames
+// are dropped at EndFrame.
+class TextLayoutCache
+{
+public:
+    struct Stats
+    {
+        uint32_t entries = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    explicit TextLayoutCache(uint32_t maxIdleFrames_ = 120) : maxIdleFrames(maxIdleFrames_) {}
+
+    const TextLayout& Get(const BitmapFont& font, std::string_view text);
+    void EndFrame();
+    // Call before a font goes away.
+    void Remove(const BitmapFont& font);
+    void Clear();
+
+    const Stats& GetStats() const { return stats; }
+
+private:
+    struct Entry
+    {
+        const BitmapFont* font = nullptr;
+        std::string text;
+        TextLayout layout;
+        uint64_t lastUsed = 0;
+    };
+
+    std::unordered_multimap<uint64_t, Entry> entries;
+    uint32_t maxIdleFrames;
+    uint64_t frame = 0;
+    Stats stats;
+};
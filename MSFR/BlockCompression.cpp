@@ -0,0 +1,1223 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "ImageCodec.h"
+#include "WorkerPool.h"
+
+namespace
+{
+    // BC7 partition tables (D3D11 functional spec). Two subsets: bit i is the
+    // subset of texel i. Three subsets: two bits per texel.
+    const uint16_t partitions2[64] =
+    {
+        0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+        0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+        0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+        0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+        0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+        0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+        0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+        0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+    };
+
+    const uint32_t partitions3[64] =
+    {
+        0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050,
+        0x5555A0A0, 0x5A5A5050, 0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090,
+        0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250, 0xA5945040, 0x0A425054,
+        0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+        0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414,
+        0x50A4A450, 0x6A5A0200, 0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424,
+        0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50, 0x500AA550, 0xAAAA4444,
+        0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+        0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580,
+        0xAA141414, 0x96960000, 0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000,
+        0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254,
+    };
+
+    // Texel holding each later subset's anchor index (subset 0's is texel 0)
+    const uint8_t anchors2[64] =
+    {
+        15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+        15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+        15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+        6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15,
+    };
+
+    const uint8_t anchors3Second[64] =
+    {
+        3, 3, 15, 15, 8, 3, 15, 15, 8, 8, 6, 6, 6, 5, 3, 3,
+        3, 3, 8, 15, 3, 3, 6, 10, 5, 8, 8, 6, 8, 5, 15, 15,
+        8, 15, 3, 5, 6, 10, 8, 15, 15, 3, 15, 5, 15, 15, 15, 15,
+        3, 15, 5, 5, 5, 8, 5, 10, 5, 10, 8, 13, 15, 12, 3, 3,
+    };
+
+    const uint8_t anchors3Third[64] =
+    {
+        15, 8, 8, 3, 15, 15, 3, 8, 15, 15, 15, 15, 15, 15, 15, 8,
+        15, 8, 15, 3, 15, 8, 15, 8, 3, 15, 6, 10, 15, 15, 10, 8,
+        15, 3, 15, 10, 10, 8, 9, 10, 6, 15, 8, 15, 3, 6, 6, 8,
+        15, 3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3, 15, 15, 8,
+    };
+
+    const uint8_t weights2[4] = { 0, 21, 43, 64 };
+    const uint8_t weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+    const uint8_t weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    struct ModeInfo
+    {
+        uint32_t subsets;
+        uint32_t partitionBits;
+        uint32_t rotationBits;
+        uint32_t indexSelectionBits;
+        uint32_t colorBits;
+        uint32_t alphaBits;         // 0: alpha is 255
+        uint32_t endpointPBits;     // one p-bit per endpoint
+        uint32_t sharedPBits;       // one p-bit per subset
+        uint32_t indexBits;
+        uint32_t index2Bits;        // second index set (modes 4 and 5)
+    };
+
+    const ModeInfo modes[8] =
+    {
+        { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+        { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+        { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+        { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+        { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+        { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+        { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+        { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+    };
+
+    const uint8_t* Weights(uint32_t bits)
+    {
+        return bits == 2 ? weights2 : bits == 3 ? weights3 : weights4;
+    }
+
+    uint32_t SubsetOf(uint32_t subsets, uint32_t partition, uint32_t texel)
+    {
+        if (subsets == 2) return (partitions2[partition] >> texel) & 1;
+        if (subsets == 3) return (partitions3[partition] >> (texel * 2)) & 3;
+        return 0;
+    }
+
+    uint32_t AnchorOf(uint32_t subsets, uint32_t partition, uint32_t subset)
+    {
+        if (subset == 0) return 0;
+        if (subsets == 2) return anchors2[partition];
+        return subset == 1 ? anchors3Second[partition] : anchors3Third[partition];
+    }
+
+    bool IsAnchor(uint32_t subsets, uint32_t partition, uint32_t texel)
+    {
+        for (uint32_t s = 0; s < subsets; ++s)
+        {
+            if (AnchorOf(subsets, partition, s) == texel) return true;
+        }
+        return false;
+    }
+
+    int Interpolate(int e0, int e1, int weight)
+    {
+        return ((64 - weight) * e0 + weight * e1 + 32) >> 6;
+    }
+
+    // Widens a quantized endpoint channel (p-bit included) to 8 bits by
+    // repeating its top bits.
+    int Unquantize(uint32_t value, uint32_t bits)
+    {
+        return (int)((value << (8 - bits)) | (value >> (2 * bits - 8)));
+    }
+
+    // BC7 blocks are one 128-bit little-endian bit stream
+    class BitWriter
+    {
+    public:
+        void Put(uint32_t value, uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; ++i, ++position)
+                bits[position >> 6] |= (uint64_t)((value >> i) & 1) << (position & 63);
+        }
+
+        void Store(uint8_t block[16]) const
+        {
+            for (uint32_t i = 0; i < 16; ++i) block[i] = (uint8_t)(bits[i >> 3] >> ((i & 7) * 8));
+        }
+
+    private:
+        uint64_t bits[2] = {};
+        uint32_t position = 0;
+    };
+
+    class BitReader
+    {
+    public:
+        explicit BitReader(const uint8_t block[16])
+        {
+            for (uint32_t i = 0; i < 16; ++i) bits[i >> 3] |= (uint64_t)block[i] << ((i & 7) * 8);
+        }
+
+        uint32_t Get(uint32_t count)
+        {
+            uint32_t value = 0;
+            for (uint32_t i = 0; i < count; ++i, ++position)
+                value |= (uint32_t)((bits[position >> 6] >> (position & 63)) & 1) << i;
+            return value;
+        }
+
+    private:
+        uint64_t bits[2] = {};
+        uint32_t position = 0;
+    };
+
+    // -------------------------------------------------------------------
+    // Endpoint fitting, shared by every format
+    // -------------------------------------------------------------------
+
+    float Clamp255(float v)
+    {
+        return std::min(std::max(v, 0.f), 255.f);
+    }
+
+    struct Moments
+    {
+        float mean[4] = {};
+        float covariance[4][4] = {};
+    };
+
+    // Count, sums and sums of products of a set of texels, which add up
+    // across sets; enough for the mean and covariance.
+    struct Sums
+    {
+        float count = 0.f;
+        float sum[4] = {};
+        float products[4][4] = {};
+
+        void Add(const uint8_t* texel, uint32_t channels)
+        {
+            count += 1.f;
+            for (uint32_t a = 0; a < channels; ++a)
+            {
+                sum[a] += texel[a];
+                for (uint32_t b = a; b < channels; ++b) products[a][b] += (float)(texel[a] * texel[b]);
+            }
+        }
+
+        void Add(const Sums& other, uint32_t channels)
+        {
+            count += other.count;
+            for (uint32_t a = 0; a < channels; ++a)
+            {
+                sum[a] += other.sum[a];
+                for (uint32_t b = a; b < channels; ++b) products[a][b] += other.products[a][b];
+            }
+        }
+
+        Moments ToMoments(uint32_t channels) const
+        {
+            Moments m;
+            if (count == 0.f) return m;
+            for (uint32_t c = 0; c < channels; ++c) m.mean[c] = sum[c] / count;
+            for (uint32_t a = 0; a < channels; ++a)
+            {
+                for (uint32_t b = a; b < channels; ++b)
+                {
+                    m.covariance[a][b] = m.covariance[b][a] = products[a][b] - sum[a] * m.mean[b];
+                }
+            }
+            return m;
+        }
+    };
+
+    // Over the texels in mask (bit i = texel i) and the first channels
+    // channels; the rest stay zero.
+    Moments ComputeMoments(const uint8_t tile[64], uint32_t mask, uint32_t channels)
+    {
+        Sums sums;
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            if ((mask >> i) & 1) sums.Add(tile + i * 4, channels);
+        }
+        return sums.ToMoments(channels);
+    }
+
+    // Unit principal axis by power iteration, started from the column of
+    // the channel that varies most. Flat texels get the grey diagonal.
+    void PrincipalAxis(const Moments& m, uint32_t channels, float axis[4], uint32_t iterations = 8)
+    {
+        uint32_t start = 0;
+        for (uint32_t c = 1; c < channels; ++c)
+        {
+            if (m.covariance[c][c] > m.covariance[start][start]) start = c;
+        }
+
+        float v[4] = {};
+        for (uint32_t c = 0; c < channels; ++c) v[c] = m.covariance[c][start];
+        for (uint32_t iteration = 0; iteration < iterations; ++iteration)
+        {
+            float next[4] = {};
+            float largest = 0.f;
+            for (uint32_t a = 0; a < channels; ++a)
+            {
+                for (uint32_t b = 0; b < channels; ++b) next[a] += m.covariance[a][b] * v[b];
+                largest = std::max(largest, std::fabs(next[a]));
+            }
+            if (largest <= 0.f) break;
+            for (uint32_t a = 0; a < channels; ++a) v[a] = next[a] / largest;
+        }
+
+        float length = 0.f;
+        for (uint32_t c = 0; c < channels; ++c) length += v[c] * v[c];
+        length = std::sqrt(length);
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            if (c >= channels) axis[c] = 0.f;
+            else axis[c] = length > 0.f ? v[c] / length : 1.f / std::sqrt((float)channels);
+        }
+    }
+
+    // What a line through the texels can't capture: the total variance
+    // minus the variance along the principal axis. A rough axis will do.
+    float LineError(const Sums& sums, uint32_t channels)
+    {
+        const Moments m = sums.ToMoments(channels);
+        float axis[4];
+        PrincipalAxis(m, channels, axis, 3);
+        float total = 0.f, along = 0.f;
+        for (uint32_t a = 0; a < channels; ++a)
+        {
+            total += m.covariance[a][a];
+            for (uint32_t b = 0; b < channels; ++b) along += axis[a] * m.covariance[a][b] * axis[b];
+        }
+        return total - along;
+    }
+
+    // Endpoints at the extremes of the texels' projections on the axis
+    void RangeFit(const uint8_t tile[64], uint32_t mask, uint32_t channels, float e0[4], float e1[4])
+    {
+        const Moments m = ComputeMoments(tile, mask, channels);
+        float axis[4];
+        PrincipalAxis(m, channels, axis);
+
+        float lo = FLT_MAX, hi = -FLT_MAX;
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            if (!((mask >> i) & 1)) continue;
+            float t = 0.f;
+            for (uint32_t c = 0; c < channels; ++c) t += (tile[i * 4 + c] - m.mean[c]) * axis[c];
+            lo = std::min(lo, t);
+            hi = std::max(hi, t);
+        }
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            e0[c] = c < channels ? Clamp255(m.mean[c] + lo * axis[c]) : 0.f;
+            e1[c] = c < channels ? Clamp255(m.mean[c] + hi * axis[c]) : 0.f;
+        }
+    }
+
+    // Endpoints with the least squared error for fixed interpolation
+    // weights (0 picks e0, 1 picks e1). False when every weight is the same.
+    bool LeastSquares(const uint8_t tile[64], uint32_t mask, uint32_t channels, const float weight[16], float e0[4], float e1[4])
+    {
+        float aa = 0.f, ab = 0.f, bb = 0.f;
+        float ax[4] = {}, bx[4] = {};
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            if (!((mask >> i) & 1)) continue;
+            const float b = weight[i], a = 1.f - b;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                ax[c] += a * tile[i * 4 + c];
+                bx[c] += b * tile[i * 4 + c];
+            }
+        }
+
+        const float det = aa * bb - ab * ab;
+        if (std::fabs(det) < 1e-6f) return false;
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            e0[c] = c < channels ? Clamp255((ax[c] * bb - bx[c] * ab) / det) : 0.f;
+            e1[c] = c < channels ? Clamp255((bx[c] * aa - ax[c] * ab) / det) : 0.f;
+        }
+        return true;
+    }
+
+    uint32_t RefineIterations(BlockQuality quality)
+    {
+        return quality == BlockQuality::Fast ? 1 : quality == BlockQuality::Normal ? 2 : 8;
+    }
+
+    // -------------------------------------------------------------------
+    // BC1 color blocks (also the color half of BC3)
+    // -------------------------------------------------------------------
+
+    struct ColorBlock
+    {
+        uint16_t c0 = 0;
+        uint16_t c1 = 0;
+        uint32_t indices = 0;
+        uint32_t error = UINT32_MAX;
+    };
+
+    uint16_t Pack565(const float c[4])
+    {
+        const uint32_t r = (uint32_t)std::lround(Clamp255(c[0]) * 31.f / 255.f);
+        const uint32_t g = (uint32_t)std::lround(Clamp255(c[1]) * 63.f / 255.f);
+        const uint32_t b = (uint32_t)std::lround(Clamp255(c[2]) * 31.f / 255.f);
+        return (uint16_t)(r << 11 | g << 5 | b);
+    }
+
+    void Unpack565(uint16_t color, int rgba[4])
+    {
+        const int r = color >> 11, g = (color >> 5) & 63, b = color & 31;
+        rgba[0] = (r << 3) | (r >> 2);
+        rgba[1] = (g << 2) | (g >> 4);
+        rgba[2] = (b << 3) | (b >> 2);
+        rgba[3] = 255;
+    }
+
+    // Four colors, or three and transparent black
+    void ColorPalette(uint16_t c0, uint16_t c1, bool fourColors, int palette[4][4])
+    {
+        Unpack565(c0, palette[0]);
+        Unpack565(c1, palette[1]);
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            const int a = palette[0][c], b = palette[1][c];
+            palette[2][c] = fourColors ? (2 * a + b) / 3 : (a + b) / 2;
+            palette[3][c] = fourColors ? (a + 2 * b) / 3 : 0;
+        }
+        palette[2][3] = 255;
+        palette[3][3] = fourColors ? 255 : 0;
+    }
+
+    // Orders the endpoints for the mode (c0 > c1 for four colors, c0 <= c1
+    // for three) and picks each texel's nearest color. Transparent texels
+    // take index 3 of the three color mode.
+    ColorBlock EvaluateColor(const uint8_t tile[64], uint32_t transparent, uint16_t a, uint16_t b, bool threeColors)
+    {
+        if (threeColors ? a > b : a < b) std::swap(a, b);
+        ColorBlock block;
+        block.c0 = a;
+        block.c1 = b;
+        block.error = 0;
+
+        int palette[4][4];
+        ColorPalette(a, b, !threeColors, palette);
+        // Equal endpoints read as three colors in BC1 and four in BC3; index
+        // 0 means the same in both
+        const uint32_t choices = threeColors ? 3 : (a == b ? 1 : 4);
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            if ((transparent >> i) & 1)
+            {
+                block.indices |= 3u << (i * 2);
+                continue;
+            }
+            uint32_t best = 0, bestError = UINT32_MAX;
+            for (uint32_t k = 0; k < choices; ++k)
+            {
+                uint32_t error = 0;
+                for (uint32_t c = 0; c < 3; ++c)
+                {
+                    const int d = tile[i * 4 + c] - palette[k][c];
+                    error += (uint32_t)(d * d);
+                }
+                if (error < bestError)
+                {
+                    bestError = error;
+                    best = k;
+                }
+            }
+            block.indices |= best << (i * 2);
+            block.error += bestError;
+        }
+        return block;
+    }
+
+    ColorBlock RefineColor(const uint8_t tile[64], uint32_t transparent, bool threeColors, uint32_t iterations, ColorBlock best)
+    {
+        static const float four[4] = { 0.f, 1.f, 1.f / 3.f, 2.f / 3.f };
+        static const float three[4] = { 0.f, 1.f, 0.5f, 0.f };
+        const uint32_t opaque = ~transparent & 0xFFFF;
+        for (uint32_t iteration = 0; iteration < iterations && best.error > 0; ++iteration)
+        {
+            float weight[16];
+            for (uint32_t i = 0; i < 16; ++i) weight[i] = (threeColors ? three : four)[(best.indices >> (i * 2)) & 3];
+            float e0[4], e1[4];
+            if (!LeastSquares(tile, opaque, 3, weight, e0, e1)) break;
+            const ColorBlock next = EvaluateColor(tile, transparent, Pack565(e0), Pack565(e1), threeColors);
+            if (next.error >= best.error) break;
+            best = next;
+        }
+        return best;
+    }
+
+    // Steps each 5:6:5 field of both endpoints by one while that helps
+    ColorBlock SearchColor(const uint8_t tile[64], uint32_t transparent, bool threeColors, ColorBlock best)
+    {
+        static const uint32_t shifts[3] = { 11, 5, 0 };
+        static const int limits[3] = { 31, 63, 31 };
+        for (uint32_t pass = 0; pass < 4 && best.error > 0; ++pass)
+        {
+            bool improved = false;
+            for (uint32_t end = 0; end < 2; ++end)
+            {
+                for (uint32_t field = 0; field < 3; ++field)
+                {
+                    for (int delta = -1; delta <= 1; delta += 2)
+                    {
+                        uint16_t ends[2] = { best.c0, best.c1 };
+                        const int value = ((ends[end] >> shifts[field]) & limits[field]) + delta;
+                        if (value < 0 || value > limits[field]) continue;
+                        ends[end] = (uint16_t)((ends[end] & ~(limits[field] << shifts[field])) | (value << shifts[field]));
+                        const ColorBlock next = EvaluateColor(tile, transparent, ends[0], ends[1], threeColors);
+                        if (next.error < best.error)
+                        {
+                            best = next;
+                            improved = true;
+                        }
+                    }
+                }
+            }
+            if (!improved) break;
+        }
+        return best;
+    }
+
+    // bc1: texels under 128 alpha go transparent, and the three color mode
+    // may be used for opaque tiles too.
+    ColorBlock EncodeColor(const uint8_t tile[64], BlockQuality quality, bool bc1)
+    {
+        uint32_t transparent = 0;
+        for (uint32_t i = 0; bc1 && i < 16; ++i)
+        {
+            if (tile[i * 4 + 3] < 128) transparent |= 1u << i;
+        }
+        const uint32_t opaque = ~transparent & 0xFFFF;
+        if (!opaque)
+        {
+            ColorBlock block;
+            block.indices = 0xFFFFFFFF;
+            block.error = 0;
+            return block;
+        }
+
+        float e0[4], e1[4];
+        RangeFit(tile, opaque, 3, e0, e1);
+        const uint32_t iterations = RefineIterations(quality);
+        const bool threeColors = transparent != 0;
+        ColorBlock best = RefineColor(tile, transparent, threeColors, iterations,
+            EvaluateColor(tile, transparent, Pack565(e0), Pack565(e1), threeColors));
+
+        if (quality == BlockQuality::Best)
+        {
+            best = SearchColor(tile, transparent, threeColors, best);
+            if (bc1 && !threeColors && best.error > 0)
+            {
+                ColorBlock three = RefineColor(tile, 0, true, iterations,
+                    EvaluateColor(tile, 0, Pack565(e0), Pack565(e1), true));
+                three = SearchColor(tile, 0, true, three);
+                if (three.error < best.error) best = three;
+            }
+        }
+        return best;
+    }
+
+    void StoreColor(const ColorBlock& color, uint8_t block[8])
+    {
+        block[0] = (uint8_t)color.c0;
+        block[1] = (uint8_t)(color.c0 >> 8);
+        block[2] = (uint8_t)color.c1;
+        block[3] = (uint8_t)(color.c1 >> 8);
+        for (uint32_t i = 0; i < 4; ++i) block[4 + i] = (uint8_t)(color.indices >> (i * 8));
+    }
+
+    void DecodeColor(const uint8_t block[8], bool alwaysFourColors, uint8_t tile[64])
+    {
+        const uint16_t c0 = (uint16_t)(block[0] | block[1] << 8);
+        const uint16_t c1 = (uint16_t)(block[2] | block[3] << 8);
+        const uint32_t indices = (uint32_t)block[4] | (uint32_t)block[5] << 8 | (uint32_t)block[6] << 16 | (uint32_t)block[7] << 24;
+
+        int palette[4][4];
+        ColorPalette(c0, c1, alwaysFourColors || c0 > c1, palette);
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            const int* color = palette[(indices >> (i * 2)) & 3];
+            for (uint32_t c = 0; c < 4; ++c) tile[i * 4 + c] = (uint8_t)color[c];
+        }
+    }
+
+    // -------------------------------------------------------------------
+    // BC3 alpha blocks
+    // -------------------------------------------------------------------
+
+    struct AlphaBlock
+    {
+        uint8_t a0 = 0;
+        uint8_t a1 = 0;
+        uint64_t indices = 0;
+        uint32_t error = UINT32_MAX;
+    };
+
+    // Eight values when a0 > a1, otherwise six, 0 and 255
+    void AlphaPalette(int a0, int a1, int palette[8])
+    {
+        palette[0] = a0;
+        palette[1] = a1;
+        if (a0 > a1)
+        {
+            for (int i = 1; i < 7; ++i) palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+        }
+        else
+        {
+            for (int i = 1; i < 5; ++i) palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    AlphaBlock EvaluateAlpha(const uint8_t tile[64], int a0, int a1)
+    {
+        AlphaBlock block;
+        block.a0 = (uint8_t)a0;
+        block.a1 = (uint8_t)a1;
+        block.error = 0;
+
+        int palette[8];
+        AlphaPalette(a0, a1, palette);
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            uint32_t best = 0, bestError = UINT32_MAX;
+            for (uint32_t k = 0; k < 8; ++k)
+            {
+                const int d = tile[i * 4 + 3] - palette[k];
+                if ((uint32_t)(d * d) < bestError)
+                {
+                    bestError = (uint32_t)(d * d);
+                    best = k;
+                }
+            }
+            block.indices |= (uint64_t)best << (i * 3);
+            block.error += bestError;
+        }
+        return block;
+    }
+
+    AlphaBlock EncodeAlpha(const uint8_t tile[64], BlockQuality quality)
+    {
+        int lo = 255, hi = 0, innerLo = 255, innerHi = 0;
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            const int a = tile[i * 4 + 3];
+            lo = std::min(lo, a);
+            hi = std::max(hi, a);
+            if (a != 0 && a != 255)
+            {
+                innerLo = std::min(innerLo, a);
+                innerHi = std::max(innerHi, a);
+            }
+        }
+        if (lo == hi) return EvaluateAlpha(tile, lo, lo);
+
+        AlphaBlock best = EvaluateAlpha(tile, hi, lo);
+        auto consider = [&](int a0, int a1)
+        {
+            const AlphaBlock next = EvaluateAlpha(tile, a0, a1);
+            if (next.error < best.error) best = next;
+        };
+
+        if (quality == BlockQuality::Fast || best.error == 0) return best;
+        // Six steps over the texels that aren't 0 or 255, which have
+        // indices of their own
+        if (innerLo <= innerHi) consider(innerLo, innerHi);
+
+        if (quality == BlockQuality::Best)
+        {
+            // Pulling the ends in trades the extremes for finer steps
+            for (int dl = 0; dl <= 4; ++dl)
+            {
+                for (int dh = 0; dh <= 4; ++dh)
+                {
+                    if (hi - dh > lo + dl) consider(hi - dh, lo + dl);
+                    if (innerLo + dl <= innerHi - dh) consider(innerLo + dl, innerHi - dh);
+                }
+            }
+        }
+        return best;
+    }
+
+    void StoreAlpha(const AlphaBlock& alpha, uint8_t block[8])
+    {
+        block[0] = alpha.a0;
+        block[1] = alpha.a1;
+        for (uint32_t i = 0; i < 6; ++i) block[2 + i] = (uint8_t)(alpha.indices >> (i * 8));
+    }
+
+    void DecodeAlpha(const uint8_t block[8], uint8_t tile[64])
+    {
+        int palette[8];
+        AlphaPalette(block[0], block[1], palette);
+        uint64_t indices = 0;
+        for (uint32_t i = 0; i < 6; ++i) indices |= (uint64_t)block[2 + i] << (i * 8);
+        for (uint32_t i = 0; i < 16; ++i) tile[i * 4 + 3] = (uint8_t)palette[(indices >> (i * 3)) & 7];
+    }
+
+    // -------------------------------------------------------------------
+    // BC7
+    // -------------------------------------------------------------------
+
+    struct Bc7Fit
+    {
+        uint32_t values[6][4] = {};     // stored endpoint bits, p-bit excluded
+        uint32_t pbits[6] = {};
+        uint8_t indices[16] = {};
+        uint32_t error = UINT32_MAX;
+    };
+
+    // Closest stored value for channel value x. Unquantize is monotonic, so
+    // the neighbors of the linear estimate are enough.
+    uint32_t QuantizeChannel(float x, uint32_t bits, bool hasPBit, uint32_t pbit, int& reconstructed)
+    {
+        const uint32_t total = bits + (hasPBit ? 1 : 0);
+        const float scaled = x * (float)((1u << total) - 1) / 255.f;
+        const int guess = (int)std::lround(hasPBit ? (scaled - (float)pbit) * 0.5f : scaled);
+        const int largest = (int)(1u << bits) - 1;
+
+        uint32_t best = 0;
+        float bestError = FLT_MAX;
+        for (int q = guess - 1; q <= guess + 1; ++q)
+        {
+            if (q < 0 || q > largest) continue;
+            const int v = Unquantize(hasPBit ? ((uint32_t)q << 1 | pbit) : (uint32_t)q, total);
+            const float error = std::fabs((float)v - x);
+            if (error < bestError)
+            {
+                bestError = error;
+                best = (uint32_t)q;
+                reconstructed = v;
+            }
+        }
+        return best;
+    }
+
+    // One endpoint with p-bit pbit; returns the squared error
+    float QuantizeEndpoint(const ModeInfo& info, const float end[4], uint32_t pbit, uint32_t values[4], int color[4])
+    {
+        const bool hasPBit = info.endpointPBits || info.sharedPBits;
+        float error = 0.f;
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            const uint32_t bits = c < 3 ? info.colorBits : info.alphaBits;
+            if (bits == 0)
+            {
+                values[c] = 0;
+                color[c] = 255;
+                continue;
+            }
+            values[c] = QuantizeChannel(end[c], bits, hasPBit, pbit, color[c]);
+            const float d = (float)color[c] - end[c];
+            error += d * d;
+        }
+        return error;
+    }
+
+    // Both endpoints of a subset, with the p-bits (per endpoint or shared)
+    // that land closest
+    void QuantizeEndpoints(const ModeInfo& info, const float ends[2][4], uint32_t values[2][4], uint32_t pbits[2], int colors[2][4])
+    {
+        if (!info.endpointPBits && !info.sharedPBits)
+        {
+            for (uint32_t e = 0; e < 2; ++e) QuantizeEndpoint(info, ends[e], 0, values[e], colors[e]);
+            pbits[0] = pbits[1] = 0;
+            return;
+        }
+
+        uint32_t v[2][2][4];
+        int rgba[2][2][4];
+        float error[2][2];
+        for (uint32_t e = 0; e < 2; ++e)
+        {
+            for (uint32_t p = 0; p < 2; ++p) error[e][p] = QuantizeEndpoint(info, ends[e], p, v[e][p], rgba[e][p]);
+        }
+
+        if (info.sharedPBits)
+        {
+            pbits[0] = pbits[1] = error[0][1] + error[1][1] < error[0][0] + error[1][0] ? 1 : 0;
+        }
+        else
+        {
+            for (uint32_t e = 0; e < 2; ++e) pbits[e] = error[e][1] < error[e][0] ? 1 : 0;
+        }
+        for (uint32_t e = 0; e < 2; ++e)
+        {
+            std::memcpy(values[e], v[e][pbits[e]], sizeof(values[e]));
+            std::memcpy(colors[e], rgba[e][pbits[e]], sizeof(colors[e]));
+        }
+    }
+
+    // Nearest palette entry for each texel in mask, guessed by projecting on
+    // the endpoint line and settled among its neighbors. Returns the error.
+    uint32_t AssignIndices(const uint8_t tile[64], uint32_t mask, const int colors[2][4], uint32_t indexBits, uint8_t indices[16])
+    {
+        const uint8_t* weights = Weights(indexBits);
+        const int count = 1 << indexBits;
+        int palette[16][4];
+        float direction[4], length = 0.f;
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            for (int k = 0; k < count; ++k) palette[k][c] = Interpolate(colors[0][c], colors[1][c], weights[k]);
+            direction[c] = (float)(colors[1][c] - colors[0][c]);
+            length += direction[c] * direction[c];
+        }
+
+        uint32_t total = 0;
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            if (!((mask >> i) & 1)) continue;
+            int guess = 0;
+            if (length > 0.f)
+            {
+                float t = 0.f;
+                for (uint32_t c = 0; c < 4; ++c) t += (tile[i * 4 + c] - colors[0][c]) * direction[c];
+                guess = std::min(std::max((int)std::lround(t / length * (count - 1)), 0), count - 1);
+            }
+
+            uint32_t bestError = UINT32_MAX;
+            for (int k = std::max(guess - 1, 0); k <= std::min(guess + 1, count - 1); ++k)
+            {
+                uint32_t error = 0;
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    const int d = tile[i * 4 + c] - palette[k][c];
+                    error += (uint32_t)(d * d);
+                }
+                if (error < bestError)
+                {
+                    bestError = error;
+                    indices[i] = (uint8_t)k;
+                }
+            }
+            total += bestError;
+        }
+        return total;
+    }
+
+    // Modes with one index set only (0, 1, 2, 3, 6, 7)
+    Bc7Fit FitBc7(const uint8_t tile[64], uint32_t mode, uint32_t partition, uint32_t iterations)
+    {
+        const ModeInfo& info = modes[mode];
+        const uint32_t channels = info.alphaBits ? 4 : 3;
+        const uint8_t* weights = Weights(info.indexBits);
+        const uint32_t largest = (1u << info.indexBits) - 1;
+
+        Bc7Fit fit;
+        fit.error = 0;
+        for (uint32_t s = 0; s < info.subsets; ++s)
+        {
+            uint32_t mask = 0;
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                if (SubsetOf(info.subsets, partition, i) == s) mask |= 1u << i;
+            }
+
+            float ends[2][4];
+            RangeFit(tile, mask, channels, ends[0], ends[1]);
+            uint32_t values[2][4], pbits[2];
+            int colors[2][4];
+            uint8_t indices[16] = {};
+            QuantizeEndpoints(info, ends, values, pbits, colors);
+            uint32_t error = AssignIndices(tile, mask, colors, info.indexBits, indices);
+
+            for (uint32_t iteration = 0; iteration < iterations && error > 0; ++iteration)
+            {
+                float weight[16] = {};
+                for (uint32_t i = 0; i < 16; ++i) weight[i] = weights[indices[i]] / 64.f;
+                if (!LeastSquares(tile, mask, channels, weight, ends[0], ends[1])) break;
+
+                uint32_t nextValues[2][4], nextPBits[2];
+                int nextColors[2][4];
+                uint8_t nextIndices[16] = {};
+                QuantizeEndpoints(info, ends, nextValues, nextPBits, nextColors);
+                const uint32_t nextError = AssignIndices(tile, mask, nextColors, info.indexBits, nextIndices);
+                if (nextError >= error) break;
+
+                std::memcpy(values, nextValues, sizeof(values));
+                std::memcpy(pbits, nextPBits, sizeof(pbits));
+                std::memcpy(colors, nextColors, sizeof(colors));
+                std::memcpy(indices, nextIndices, sizeof(indices));
+                error = nextError;
+            }
+
+            // The anchor's index is stored without its top bit, so flip the
+            // subset when that bit is set
+            const uint32_t anchor = AnchorOf(info.subsets, partition, s);
+            const bool flip = (indices[anchor] >> (info.indexBits - 1)) != 0;
+            for (uint32_t e = 0; e < 2; ++e)
+            {
+                const uint32_t from = flip ? 1 - e : e;
+                std::memcpy(fit.values[s * 2 + e], values[from], sizeof(values[from]));
+                fit.pbits[s * 2 + e] = pbits[from];
+            }
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                if ((mask >> i) & 1) fit.indices[i] = (uint8_t)(flip ? largest - indices[i] : indices[i]);
+            }
+            fit.error += error;
+        }
+        return fit;
+    }
+
+    void PackBc7(const Bc7Fit& fit, uint32_t mode, uint32_t partition, uint8_t block[16])
+    {
+        const ModeInfo& info = modes[mode];
+        const uint32_t endpoints = info.subsets * 2;
+        BitWriter writer;
+        writer.Put(1u << mode, mode + 1);
+        writer.Put(partition, info.partitionBits);
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            for (uint32_t e = 0; e < endpoints; ++e) writer.Put(fit.values[e][c], info.colorBits);
+        }
+        for (uint32_t e = 0; e < endpoints; ++e) writer.Put(fit.values[e][3], info.alphaBits);
+        for (uint32_t e = 0; e < endpoints && info.endpointPBits; ++e) writer.Put(fit.pbits[e], 1);
+        for (uint32_t s = 0; s < info.subsets && info.sharedPBits; ++s) writer.Put(fit.pbits[s * 2], 1);
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            writer.Put(fit.indices[i], info.indexBits - (IsAnchor(info.subsets, partition, i) ? 1 : 0));
+        }
+        writer.Store(block);
+    }
+
+    // The count partitions among the first available with the least line
+    // error, best first
+    uint32_t RankPartitions(const uint8_t tile[64], uint32_t subsets, uint32_t available, uint32_t channels,
+        uint32_t count, uint32_t partitions[64])
+    {
+        Sums texels[16], all;
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            texels[i].Add(tile + i * 4, channels);
+            all.Add(texels[i], channels);
+        }
+
+        std::pair<float, uint32_t> ranked[64];
+        for (uint32_t p = 0; p < available; ++p)
+        {
+            // Subset 0 is whatever the others leave of the whole tile
+            Sums sums[3];
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                const uint32_t s = SubsetOf(subsets, p, i);
+                if (s) sums[s].Add(texels[i], channels);
+            }
+            sums[0] = all;
+            for (uint32_t s = 1; s < subsets; ++s)
+            {
+                sums[0].count -= sums[s].count;
+                for (uint32_t a = 0; a < channels; ++a)
+                {
+                    sums[0].sum[a] -= sums[s].sum[a];
+                    for (uint32_t b = a; b < channels; ++b) sums[0].products[a][b] -= sums[s].products[a][b];
+                }
+            }
+
+            float error = 0.f;
+            for (uint32_t s = 0; s < subsets; ++s) error += LineError(sums[s], channels);
+            ranked[p] = { error, p };
+        }
+        count = std::min(count, available);
+        std::partial_sort(ranked, ranked + count, ranked + available);
+        for (uint32_t k = 0; k < count; ++k) partitions[k] = ranked[k].second;
+        return count;
+    }
+
+    uint32_t BlockBytes(TextureFormat format)
+    {
+        return format == TextureFormat::BC1 ? 8 : 16;
+    }
+
+    // The 4x4 tile at block (bx, by), edge texels repeated past the sides
+    void LoadTile(const uint8_t* level, uint32_t width, uint32_t height, uint32_t bx, uint32_t by, uint8_t tile[64])
+    {
+        for (uint32_t y = 0; y < 4; ++y)
+        {
+            const uint32_t sy = std::min(by * 4 + y, height - 1);
+            for (uint32_t x = 0; x < 4; ++x)
+            {
+                const uint32_t sx = std::min(bx * 4 + x, width - 1);
+                std::memcpy(tile + (y * 4 + x) * 4, level + ((size_t)sy * width + sx) * 4, 4);
+            }
+        }
+    }
+
+    // Runs rows(y0, y1) over [0, blockRows), in bands on pool when it's
+    // worth it
+    template <typename Rows>
+    void ForBlockRows(WorkerPool* pool, uint32_t blockRows, uint32_t blocksPerRow, const Rows& rows)
+    {
+        const bool parallel = pool && pool->GetThreadCount() > 1 && blockRows > 1 && blockRows * blocksPerRow >= 64;
+        if (!parallel)
+        {
+            rows(0u, blockRows);
+            return;
+        }
+        // A few bands per thread to even out the tail
+        const uint32_t bands = std::min(blockRows, pool->GetThreadCount() * 4);
+        pool->Run(bands, [&](uint32_t band)
+        {
+            rows(blockRows * band / bands, blockRows * (band + 1) / bands);
+        });
+    }
+}
+
+void EncodeBC1Block(const uint8_t tile[64], uint8_t block[8], BlockQuality quality)
+{
+    StoreColor(EncodeColor(tile, quality, true), block);
+}
+
+void EncodeBC3Block(const uint8_t tile[64], uint8_t block[16], BlockQuality quality)
+{
+    StoreAlpha(EncodeAlpha(tile, quality), block);
+    StoreColor(EncodeColor(tile, quality, false), block + 8);
+}
+
+void EncodeBC7Block(const uint8_t tile[64], uint8_t block[16], BlockQuality quality)
+{
+    bool opaque = true;
+    for (uint32_t i = 0; i < 16; ++i) opaque = opaque && tile[i * 4 + 3] == 255;
+
+    // Mode 6 (one subset, RGBA, 4-bit indices) is the all-rounder; the
+    // partitioned modes help tiles with more than one color line
+    const uint32_t iterations = quality == BlockQuality::Best ? 4 : quality == BlockQuality::Normal ? 2 : 1;
+    Bc7Fit best = FitBc7(tile, 6, 0, iterations);
+    uint32_t bestMode = 6, bestPartition = 0;
+    auto consider = [&](uint32_t mode, uint32_t partition)
+    {
+        if (best.error == 0) return;
+        const Bc7Fit fit = FitBc7(tile, mode, partition, iterations);
+        if (fit.error < best.error)
+        {
+            best = fit;
+            bestMode = mode;
+            bestPartition = partition;
+        }
+    };
+
+    if (quality != BlockQuality::Fast && best.error > 0)
+    {
+        uint32_t partitions[64];
+        const uint32_t two = RankPartitions(tile, 2, 64, opaque ? 3 : 4, quality == BlockQuality::Best ? 8 : 2, partitions);
+        for (uint32_t k = 0; k < two; ++k)
+        {
+            if (opaque)
+            {
+                consider(1, partitions[k]);
+                consider(3, partitions[k]);
+            }
+            else
+            {
+                consider(7, partitions[k]);
+            }
+        }
+
+        if (opaque && quality == BlockQuality::Best)
+        {
+            const uint32_t three = RankPartitions(tile, 3, 64, 3, 4, partitions);
+            for (uint32_t k = 0; k < three; ++k) consider(2, partitions[k]);
+            // Mode 0 only reaches the first 16 partitions
+            const uint32_t first = RankPartitions(tile, 3, 16, 3, 2, partitions);
+            for (uint32_t k = 0; k < first; ++k) consider(0, partitions[k]);
+        }
+    }
+
+    PackBc7(best, bestMode, bestPartition, block);
+}
+
+void DecodeBC1Block(const uint8_t block[8], uint8_t tile[64])
+{
+    DecodeColor(block, false, tile);
+}
+
+void DecodeBC3Block(const uint8_t block[16], uint8_t tile[64])
+{
+    DecodeColor(block + 8, true, tile);
+    DecodeAlpha(block, tile);
+}
+
+void DecodeBC7Block(const uint8_t block[16], uint8_t tile[64])
+{
+    uint32_t mode = 0;
+    while (mode < 8 && !((block[0] >> mode) & 1)) ++mode;
+    if (mode == 8)
+    {
+        // Reserved mode: transparent black
+        std::memset(tile, 0, 64);
+        return;
+    }
+
+    const ModeInfo& info = modes[mode];
+    BitReader reader(block);
+    reader.Get(mode + 1);
+    const uint32_t partition = reader.Get(info.partitionBits);
+    const uint32_t rotation = reader.Get(info.rotationBits);
+    const uint32_t indexSelection = reader.Get(info.indexSelectionBits);
+
+    const uint32_t endpoints = info.subsets * 2;
+    uint32_t values[6][4] = {};
+    for (uint32_t c = 0; c < 3; ++c)
+    {
+        for (uint32_t e = 0; e < endpoints; ++e) values[e][c] = reader.Get(info.colorBits);
+    }
+    for (uint32_t e = 0; e < endpoints; ++e) values[e][3] = reader.Get(info.alphaBits);
+    uint32_t pbits[6] = {};
+    for (uint32_t e = 0; e < endpoints && info.endpointPBits; ++e) pbits[e] = reader.Get(1);
+    for (uint32_t s = 0; s < info.subsets && info.sharedPBits; ++s) pbits[s * 2] = pbits[s * 2 + 1] = reader.Get(1);
+
+    const bool hasPBit = info.endpointPBits || info.sharedPBits;
+    int colors[6][4];
+    for (uint32_t e = 0; e < endpoints; ++e)
+    {
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            const uint32_t bits = c < 3 ? info.colorBits : info.alphaBits;
+            if (bits == 0) colors[e][c] = 255;
+            else if (hasPBit) colors[e][c] = Unquantize(values[e][c] << 1 | pbits[e], bits + 1);
+            else colors[e][c] = Unquantize(values[e][c], bits);
+        }
+    }
+
+    uint32_t indices[16], indices2[16] = {};
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        indices[i] = reader.Get(info.indexBits - (IsAnchor(info.subsets, partition, i) ? 1 : 0));
+    }
+    for (uint32_t i = 0; i < 16 && info.index2Bits; ++i) indices2[i] = reader.Get(info.index2Bits - (i == 0 ? 1 : 0));
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        const uint32_t s = SubsetOf(info.subsets, partition, i);
+        const int* e0 = colors[s * 2];
+        const int* e1 = colors[s * 2 + 1];
+
+        // Modes 4 and 5 index color and alpha separately; mode 4's index
+        // selection bit swaps which set goes where
+        uint32_t colorIndex = indices[i], colorBits = info.indexBits;
+        uint32_t alphaIndex = indices[i], alphaBits = info.indexBits;
+        if (info.index2Bits)
+        {
+            if (indexSelection)
+            {
+                colorIndex = indices2[i];
+                colorBits = info.index2Bits;
+            }
+            else
+            {
+                alphaIndex = indices2[i];
+                alphaBits = info.index2Bits;
+            }
+        }
+
+        int texel[4];
+        for (uint32_t c = 0; c < 3; ++c) texel[c] = Interpolate(e0[c], e1[c], Weights(colorBits)[colorIndex]);
+        texel[3] = Interpolate(e0[3], e1[3], Weights(alphaBits)[alphaIndex]);
+        if (rotation) std::swap(texel[3], texel[rotation - 1]);
+        for (uint32_t c = 0; c < 4; ++c) tile[i * 4 + c] = (uint8_t)texel[c];
+    }
+}
+
+bool CompressImage(const Image& source, Image& out, const BlockEncodeSettings& settings)
+{
+    if (source.format != TextureFormat::RGBA8 || !IsBlockCompressed(settings.format)) return false;
+
+    Image result;
+    result.width = source.width;
+    result.height = source.height;
+    result.levels = source.levels;
+    result.format = settings.format;
+    result.pixels.resize(GetTextureBytes(result.format, result.width, result.height, result.levels));
+
+    const uint32_t blockBytes = BlockBytes(settings.format);
+    for (uint32_t level = 0; level < source.levels; ++level)
+    {
+        const uint8_t* src = source.GetLevel(level);
+        uint8_t* dst = result.GetLevel(level);
+        const uint32_t w = source.GetLevelWidth(level), h = source.GetLevelHeight(level);
+        const uint32_t blocksX = (w + 3) / 4, blocksY = (h + 3) / 4;
+
+        ForBlockRows(settings.pool, blocksY, blocksX, [&](uint32_t y0, uint32_t y1)
+        {
+            uint8_t tile[64];
+            for (uint32_t by = y0; by < y1; ++by)
+            {
+                for (uint32_t bx = 0; bx < blocksX; ++bx)
+                {
+                    LoadTile(src, w, h, bx, by, tile);
+                    uint8_t* block = dst + ((size_t)by * blocksX + bx) * blockBytes;
+                    switch (settings.format)
+                    {
+                    case TextureFormat::BC1: EncodeBC1Block(tile, block, settings.quality); break;
+                    case TextureFormat::BC3: EncodeBC3Block(tile, block, settings.quality); break;
+                    default: EncodeBC7Block(tile, block, settings.quality); break;
+                    }
+                }
+            }
+        });
+    }
+
+    out = std::move(result);
+    return true;
+}
+
+bool DecompressImage(const Image& source, Image& out)
+{
+    if (!IsBlockCompressed(source.format)) return false;
+
+    Image result;
+    result.width = source.width;
+    result.height = source.height;
+    result.levels = source.levels;
+    result.pixels.resize(GetTextureBytes(result.format, result.width, result.height, result.levels));
+
+    const uint32_t blockBytes = BlockBytes(source.format);
+    for (uint32_t level = 0; level < source.levels; ++level)
+    {
+        const uint8_t* src = source.GetLevel(level);
+        uint8_t* dst = result.GetLevel(level);
+        const uint32_t w = source.GetLevelWidth(level), h = source.GetLevelHeight(level);
+        const uint32_t blocksX = (w + 3) / 4, blocksY = (h + 3) / 4;
+
+        uint8_t tile[64];
+        for (uint32_t by = 0; by < blocksY; ++by)
+        {
+            for (uint32_t bx = 0; bx < blocksX; ++bx)
+            {
+                const uint8_t* block = src + ((size_t)by * blocksX + bx) * blockBytes;
+                switch (source.format)
+                {
+                case TextureFormat::BC1: DecodeBC1Block(block, tile); break;
+                case TextureFormat::BC3: DecodeBC3Block(block, tile); break;
+                default: DecodeBC7Block(block, tile); break;
+                }
+
+                const uint32_t cols = std::min(4u, w - bx * 4), rows = std::min(4u, h - by * 4);
+                for (uint32_t y = 0; y < rows; ++y)
+                {
+                    std::memcpy(dst + ((size_t)(by * 4 + y) * w + bx * 4) * 4, tile + y * 16, (size_t)cols * 4);
+                }
+            }
+        }
+    }
+
+    out = std::move(result);
+    return true;
+}
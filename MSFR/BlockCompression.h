@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+
+#include "RenderDevice.h"
+
+struct Image;
+class WorkerPool;
+
+// Portable BC1/BC3/BC7 block encoders and decoders. A tile is a 4x4 block
+// of RGBA8 texels, row by row (64 bytes).
+//
+// BC1 keeps one bit of alpha: tiles with texels under 128 use the three
+// color mode, where those texels decode to transparent black. BC3 adds an
+// interpolated alpha block. The BC7 encoder uses the modes with one to
+// three subsets and a single index set (0, 1, 2, 3, 6 and 7); the decoder
+// reads all eight.
+enum class BlockQuality
+{
+    Fast,       // principal axis endpoints and one refit; BC7 mode 6 only
+    Normal,     // a few refits; BC7 also tries the likeliest partitions
+    Best,       // more refits and an endpoint search; more BC7 partitions
+};
+
+struct BlockEncodeSettings
+{
+    TextureFormat format = TextureFormat::BC7;
+    BlockQuality quality = BlockQuality::Normal;
+    // Rows of blocks are split into bands run on pool; without one
+    // everything runs on the calling thread.
+    WorkerPool* pool = nullptr;
+};
+
+void EncodeBC1Block(const uint8_t tile[64], uint8_t block[8], BlockQuality quality);
+void EncodeBC3Block(const uint8_t tile[64], uint8_t block[16], BlockQuality quality);
+void EncodeBC7Block(const uint8_t tile[64], uint8_t block[16], BlockQuality quality);
+
+void DecodeBC1Block(const uint8_t block[8], uint8_t tile[64]);
+void DecodeBC3Block(const uint8_t block[16], uint8_t tile[64]);
+void DecodeBC7Block(const uint8_t block[16], uint8_t tile[64]);
+
+// Encodes every level of an RGBA8 image into settings.format. Levels whose
+// sides aren't multiples of 4 repeat their edge texels into the padding.
+// Returns false when source isn't RGBA8 or settings.format isn't a BC
+// format.
+bool CompressImage(const Image& source, Image& out, const BlockEncodeSettings& settings);
+// Every level back to RGBA8. Returns false when source isn't a BC format.
+bool DecompressImage(const Image& source, Image& out);
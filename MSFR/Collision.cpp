@@ -2,34 +2,15 @@
 
 #include "GameObject.h"
 #include "Engine.h"
-#include "DX11Services.h"
-
-#include <d3d11.h>
-#include <d3dcompiler.h>
-#include <wrl/client.h>
 
 #include <array>
 #include <vector>
 #include <cmath>
-#include <cstring>
 #include <stdexcept>
 #include <string>
 
-#pragma comment(lib, "d3dcompiler.lib")
-
 namespace
 {
-    using Microsoft::WRL::ComPtr;
-
-    template <typename T>
-    void ThrowIfFailed(HRESULT hr, const T& msg)
-    {
-        if (FAILED(hr))
-        {
-            throw std::runtime_error(msg);
-        }
-    }
-
     struct PerDrawCB
     {
         float m[16]; // float4x4
@@ -52,88 +33,31 @@ namespace
         return o;
     }
 
-    void CompileFromFile(const wchar_t* path, const char* entry, const char* target, ComPtr<ID3DBlob>& outBlob)
-    {
-        UINT flags = 0;
-#if defined(_DEBUG)
-        flags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#endif
-        ComPtr<ID3DBlob> err;
-
-        HRESULT hr = D3DCompileFromFile(
-            path,
-            nullptr,
-            D3D_COMPILE_STANDARD_FILE_INCLUDE,
-            entry,
-            target,
-            flags,
-            0,
-            outBlob.GetAddressOf(),
-            err.GetAddressOf());
-
-        if (FAILED(hr))
-        {
-            std::string msg = "D3DCompileFromFile failed: ";
-            if (err)
-            {
-                msg += (const char*)err->GetBufferPointer();
-            }
-            throw std::runtime_error(msg);
-        }
-    }
-
-    ComPtr<ID3D11Buffer> CreateImmutableVB(ID3D11Device* dev, const void* data, UINT bytes)
+    BufferHandle CreateImmutableVB(IRenderDevice& dev, const void* data, uint32_t bytes)
     {
-        D3D11_BUFFER_DESC bd{};
-        bd.ByteWidth = bytes;
-        bd.Usage = D3D11_USAGE_IMMUTABLE;
-        bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-
-        D3D11_SUBRESOURCE_DATA init{};
-        init.pSysMem = data;
-
-        ComPtr<ID3D11Buffer> b;
-        ThrowIfFailed(dev->CreateBuffer(&bd, &init, b.GetAddressOf()), "CreateBuffer(VB) failed.");
-        return b;
-    }
-
-    ComPtr<ID3D11Buffer> CreateImmutableIB(ID3D11Device* dev, const void* data, UINT bytes)
-    {
-        D3D11_BUFFER_DESC bd{};
-        bd.ByteWidth = bytes;
-        bd.Usage = D3D11_USAGE_IMMUTABLE;
-        bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-
-        D3D11_SUBRESOURCE_DATA init{};
-        init.pSysMem = data;
-
-        ComPtr<ID3D11Buffer> b;
-        ThrowIfFailed(dev->CreateBuffer(&bd, &init, b.GetAddressOf()), "CreateBuffer(IB) failed.");
-        return b;
+        return dev.CreateBuffer({ BufferType::Vertex, ResourceUsage::Immutable, bytes }, data);
     }
 
-    ComPtr<ID3D11Buffer> CreateDynamicCB(ID3D11Device* dev, UINT bytes)
+    BufferHandle CreateImmutableIB(IRenderDevice& dev, const void* data, uint32_t bytes)
     {
-        D3D11_BUFFER_DESC bd{};
-        bd.ByteWidth = bytes;
-        bd.Usage = D3D11_USAGE_DYNAMIC;
-        bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-
-        ComPtr<ID3D11Buffer> b;
-        ThrowIfFailed(dev->CreateBuffer(&bd, nullptr, b.GetAddressOf()), "CreateBuffer(CB) failed.");
-        return b;
+        return dev.CreateBuffer({ BufferType::Index, ResourceUsage::Immutable, bytes }, data);
     }
 
-    void UpdateDynamicCB(ID3D11DeviceContext* ctx, ID3D11Buffer* cb, const void* data, UINT bytes)
+    PipelineDesc MakeDebug2DPipelineDesc()
     {
-        D3D11_MAPPED_SUBRESOURCE ms{};
-        ThrowIfFailed(ctx->Map(cb, 0, D3D11_MAP_WRITE_DISCARD, 0, &ms), "Map(CB) failed.");
-        std::memcpy(ms.pData, data, bytes);
-        ctx->Unmap(cb, 0);
+        PipelineDesc desc;
+        desc.shaderPath = "assets/shaders/debug2d.hlsl";
+        desc.vsEntry = "VSMain";
+        desc.psEntry = "PSMain";
+        desc.layout =
+        {
+            { "POSITION", 0, VertexFormat::Float2, 0, 0 },
+            { "COLOR",    0, VertexFormat::Float3, 1, 0 },
+        };
+        desc.blend = BlendMode::Alpha;
+        desc.topology = PrimitiveTopology::LineStrip;
+        return desc;
     }
-
-    constexpr const wchar_t* kDebug2DShaderPath = L"assets/shaders/debug2d.hlsl";
 }
 
 
@@ -143,48 +67,35 @@ RectCollision::RectCollision(rect3 r, GameObject* obj)
     CreateGpuResources();
 }
 
+RectCollision::~RectCollision()
+{
+    device->Destroy(pipeline);
+    device->Destroy(vbPos);
+    device->Destroy(vbCol);
+    device->Destroy(ib);
+}
+
 void RectCollision::CreateGpuResources()
 {
-    ID3D11Device* dev = DX11Services::Device();
-    ID3D11DeviceContext* ctx = DX11Services::Context();
-    if (!dev || !ctx)
-        throw std::runtime_error("DX11Services not initialized. Call DX11Services::Init(...) before creating collisions.");
-
-    // shaders
-    ComPtr<ID3DBlob> vsBlob, psBlob;
-    CompileFromFile(kDebug2DShaderPath, "VSMain", "vs_5_0", vsBlob);
-    CompileFromFile(kDebug2DShaderPath, "PSMain", "ps_5_0", psBlob);
-
-    ThrowIfFailed(dev->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, vs.GetAddressOf()),
-        "CreateVertexShader failed.");
-    ThrowIfFailed(dev->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, ps.GetAddressOf()),
-        "CreatePixelShader failed.");
-
-    D3D11_INPUT_ELEMENT_DESC layout[] =
-    {
-        { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT,     0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "COLOR",    0, DXGI_FORMAT_R32G32B32_FLOAT,  1, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    };
-    ThrowIfFailed(dev->CreateInputLayout(layout, 2, vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), inputLayout.GetAddressOf()),
-        "CreateInputLayout failed.");
+    device = &Engine::GetRenderDevice();
+    IRenderDevice& dev = *device;
+
+    pipeline = dev.CreatePipeline(MakeDebug2DPipelineDesc());
 
     // geometry: line strip box
     constexpr std::array<vec2, 4> positions = { vec2{0.f,0.f}, vec2{1.f,0.f}, vec2{1.f,1.f}, vec2{0.f,1.f} };
     constexpr std::array<color3, 4> colors = { color3{0,0,0}, color3{0,0,0}, color3{0,0,0}, color3{0,0,0} };
     constexpr std::array<uint16_t, 5> indices = { 0, 1, 2, 3, 0 };
 
-    vbPos = CreateImmutableVB(dev, positions.data(), (UINT)(sizeof(vec2) * positions.size()));
-    vbCol = CreateImmutableVB(dev, colors.data(), (UINT)(sizeof(color3) * colors.size()));
-    ib = CreateImmutableIB(dev, indices.data(), (UINT)(sizeof(uint16_t) * indices.size()));
-    indexCount = (UINT)indices.size();
-
-    cbPerDraw = CreateDynamicCB(dev, (UINT)sizeof(PerDrawCB));
+    vbPos = CreateImmutableVB(dev, positions.data(), (uint32_t)(sizeof(vec2) * positions.size()));
+    vbCol = CreateImmutableVB(dev, colors.data(), (uint32_t)(sizeof(color3) * colors.size()));
+    ib = CreateImmutableIB(dev, indices.data(), (uint32_t)(sizeof(uint16_t) * indices.size()));
+    indexCount = (uint32_t)indices.size();
 }
 
 void RectCollision::Draw(mat3<float>)
 {
-    ID3D11DeviceContext* ctx = DX11Services::Context();
-    if (!ctx) return;
+    IRenderDevice& dev = *device;
 
     mat3<float> translation = mat3<float>::build_translation(
         GetWorldCoorRect().Left() - (1280.f - Engine::GetWindow().GetClientWidth()) / 2.f,
@@ -200,25 +111,17 @@ void RectCollision::Draw(mat3<float>)
 
     // update cbuffer
     const PerDrawCB cb = Mat3ToFloat4x4(model_to_ndc);
-    UpdateDynamicCB(ctx, cbPerDraw.Get(), &cb, (UINT)sizeof(cb));
+    const TransientAllocation cbRange = Engine::GetTransientAllocator().UploadConstants(&cb, (uint32_t)sizeof(cb));
+    if (!cbRange) return;
 
     // bind pipeline
-    ctx->IASetInputLayout(inputLayout.Get());
-    ctx->VSSetShader(vs.Get(), nullptr, 0);
-    ctx->PSSetShader(ps.Get(), nullptr, 0);
-
-    ID3D11Buffer* cbuffers[] = { cbPerDraw.Get() };
-    ctx->VSSetConstantBuffers(0, 1, cbuffers);
-
-    ID3D11Buffer* vbs[] = { vbPos.Get(), vbCol.Get() };
-    UINT strides[] = { (UINT)sizeof(vec2), (UINT)sizeof(color3) };
-    UINT offsets[] = { 0, 0 };
-    ctx->IASetVertexBuffers(0, 2, vbs, strides, offsets);
+    dev.SetPipeline(pipeline);
+    dev.SetConstantBuffer(0, cbRange.buffer, cbRange.offset, cbRange.size);
+    dev.SetVertexBuffer(0, vbPos, (uint32_t)sizeof(vec2), 0);
+    dev.SetVertexBuffer(1, vbCol, (uint32_t)sizeof(color3), 0);
+    dev.SetIndexBuffer(ib, IndexFormat::UInt16);
 
-    ctx->IASetIndexBuffer(ib.Get(), DXGI_FORMAT_R16_UINT, 0);
-    ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP);
-
-    ctx->DrawIndexed(indexCount, 0, 0);
+    dev.DrawIndexed(indexCount, 0, 0);
 }
 
 rect3 RectCollision::GetWorldCoorRect()
@@ -262,30 +165,19 @@ CircleCollision::CircleCollision(double r, GameObject* obj)
     CreateGpuResources();
 }
 
+CircleCollision::~CircleCollision()
+{
+    device->Destroy(pipeline);
+    device->Destroy(vbPos);
+    device->Destroy(vbCol);
+}
+
 void CircleCollision::CreateGpuResources()
 {
-    ID3D11Device* dev = DX11Services::Device();
-    ID3D11DeviceContext* ctx = DX11Services::Context();
-    if (!dev || !ctx)
-        throw std::runtime_error("DX11Services not initialized. Call DX11Services::Init(...) before creating collisions.");
-
-    // shaders
-    ComPtr<ID3DBlob> vsBlob, psBlob;
-    CompileFromFile(kDebug2DShaderPath, "VSMain", "vs_5_0", vsBlob);
-    CompileFromFile(kDebug2DShaderPath, "PSMain", "ps_5_0", psBlob);
-
-    ThrowIfFailed(dev->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, vs.GetAddressOf()),
-        "CreateVertexShader failed.");
-    ThrowIfFailed(dev->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, ps.GetAddressOf()),
-        "CreatePixelShader failed.");
-
-    D3D11_INPUT_ELEMENT_DESC layout[] =
-    {
-        { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT,     0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "COLOR",    0, DXGI_FORMAT_R32G32B32_FLOAT,  1, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    };
-    ThrowIfFailed(dev->CreateInputLayout(layout, 2, vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), inputLayout.GetAddressOf()),
-        "CreateInputLayout failed.");
+    device = &Engine::GetRenderDevice();
+    IRenderDevice& dev = *device;
+
+    pipeline = dev.CreatePipeline(MakeDebug2DPipelineDesc());
 
     // circle vertices (line strip)
     constexpr int slices = 30;
@@ -298,17 +190,14 @@ void CircleCollision::CreateGpuResources()
 
     std::vector<color3> col(slices + 1, color3{ 1, 0, 0 });
 
-    vbPos = CreateImmutableVB(dev, pos.data(), (UINT)(sizeof(vec2) * pos.size()));
-    vbCol = CreateImmutableVB(dev, col.data(), (UINT)(sizeof(color3) * col.size()));
-    vertexCount = (UINT)pos.size();
-
-    cbPerDraw = CreateDynamicCB(dev, (UINT)sizeof(PerDrawCB));
+    vbPos = CreateImmutableVB(dev, pos.data(), (uint32_t)(sizeof(vec2) * pos.size()));
+    vbCol = CreateImmutableVB(dev, col.data(), (uint32_t)(sizeof(color3) * col.size()));
+    vertexCount = (uint32_t)pos.size();
 }
 
 void CircleCollision::Draw(mat3<float> cameraMatrix)
 {
-    ID3D11DeviceContext* ctx = DX11Services::Context();
-    if (!ctx) return;
+    IRenderDevice& dev = *device;
 
     mat3<float> scale = mat3<float>::build_scale((float)(radius * 2.0));
     mat3<float> translation = mat3<float>::build_translation(cameraMatrix.column2.x, cameraMatrix.column2.y);
@@ -322,23 +211,24 @@ void CircleCollision::Draw(mat3<float> cameraMatrix)
     const mat3<float> model_to_ndc = extent * to_bottom_left * model_to_world;
 
     const PerDrawCB cb = Mat3ToFloat4x4(model_to_ndc);
-    UpdateDynamicCB(ctx, cbPerDraw.Get(), &cb, (UINT)sizeof(cb));
+    const TransientAllocation cbRange = Engine::GetTransientAllocator().UploadConstants(&cb, (uint32_t)sizeof(cb));
+    if (!cbRange) return;
 
     // bind pipeline
-    ctx->IASetInputLayout(inputLayout.Get());
-    ctx->VSSetShader(vs.Get(), nullptr, 0);
-    ctx->PSSetShader(ps.Get(), nullptr, 0);
-
-    ID3D11Buffer* cbuffers[] = { cbPerDraw.Get() };
-    ctx->VSSetConstantBuffers(0, 1, cbuffers);
+    dev.SetPipeline(pipeline);
+    dev.SetConstantBuffer(0, cbRange.buffer, cbRange.offset, cbRange.size);
+    dev.SetVertexBuffer(0, vbPos, (uint32_t)sizeof(vec2), 0);
+    dev.SetVertexBuffer(1, vbCol, (uint32_t)sizeof(color3), 0);
 
-    ID3D11Buffer* vbs[] = { vbPos.Get(), vbCol.Get() };
-    UINT strides[] = { (UINT)sizeof(vec2), (UINT)sizeof(color3) };
-    UINT offsets[] = { 0, 0 };
-    ctx->IASetVertexBuffers(0, 2, vbs, strides, offsets);
+    dev.Draw(vertexCount, 0);
+}
 
-    ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP);
-    ctx->Draw(vertexCount, 0);
+rect3 CircleCollision::GetDrawBounds()
+{
+    // Draw centers the circle on the object and doesn't scale it
+    const vec2& center = objectPtr->GetPosition();
+    const float r = static_cast<float>(radius);
+    return { vec3{ center.x - r, center.y - r, 1.0f }, vec3{ center.x + r, center.y + r, 1.0f } };
 }
 
 double CircleCollision::GetRadius()
@@ -5,9 +5,7 @@
 #include "mat3.h"
 #include "vec2.h"
 #include "color3.h"
-
-#include <d3d11.h>
-#include <wrl/client.h>
+#include "RenderDevice.h"
 
 class GameObject;
 
@@ -17,6 +15,9 @@ public:
     enum class CollideType { Rect_Collide, Circle_Collide };
 
     virtual void Draw(mat3<float> cameraMatrix) = 0;
+    // World-space area Draw covers, so culling doesn't drop a debug shape
+    // that reaches past the sprite
+    virtual rect3 GetDrawBounds() = 0;
     virtual CollideType GetCollideType() = 0;
     virtual bool DoesCollideWith(GameObject* objectB) = 0;
     virtual bool DoesCollideWith(vec2 point) = 0;
@@ -26,8 +27,10 @@ class RectCollision : public Collision
 {
 public:
     RectCollision(rect3 rect, GameObject* objectPtr);
+    ~RectCollision();
 
     void Draw(mat3<float> cameraMatrix) override;
+    rect3 GetDrawBounds() override { return GetWorldCoorRect(); }
     CollideType GetCollideType() override { return CollideType::Rect_Collide; }
 
     rect3 GetWorldCoorRect();
@@ -41,23 +44,23 @@ private:
     GameObject* objectPtr = nullptr;
     rect3 rect{};
 
-    Microsoft::WRL::ComPtr<ID3D11VertexShader> vs;
-    Microsoft::WRL::ComPtr<ID3D11PixelShader>  ps;
-    Microsoft::WRL::ComPtr<ID3D11InputLayout>  inputLayout;
-    Microsoft::WRL::ComPtr<ID3D11Buffer>       vbPos;
-    Microsoft::WRL::ComPtr<ID3D11Buffer>       vbCol;
-    Microsoft::WRL::ComPtr<ID3D11Buffer>       ib;
-    Microsoft::WRL::ComPtr<ID3D11Buffer>       cbPerDraw;
+    IRenderDevice* device = nullptr;
+    PipelineHandle pipeline;
+    BufferHandle   vbPos;
+    BufferHandle   vbCol;
+    BufferHandle   ib;
 
-    UINT indexCount = 0;
+    uint32_t indexCount = 0;
 };
 
 class CircleCollision : public Collision
 {
 public:
     CircleCollision(double radius, GameObject* objectPtr);
+    ~CircleCollision();
 
     void Draw(mat3<float> cameraMatrix) override;
+    rect3 GetDrawBounds() override;
     CollideType GetCollideType() override { return CollideType::Circle_Collide; }
 
     double GetRadius();
@@ -71,12 +74,10 @@ private:
     GameObject* objectPtr = nullptr;
     double radius = 0.0;
 
-    Microsoft::WRL::ComPtr<ID3D11VertexShader> vs;
-    Microsoft::WRL::ComPtr<ID3D11PixelShader>  ps;
-    Microsoft::WRL::ComPtr<ID3D11InputLayout>  inputLayout;
-    Microsoft::WRL::ComPtr<ID3D11Buffer>       vbPos;
-    Microsoft::WRL::ComPtr<ID3D11Buffer>       vbCol;
-    Microsoft::WRL::ComPtr<ID3D11Buffer>       cbPerDraw;
+    IRenderDevice* device = nullptr;
+    PipelineHandle pipeline;
+    BufferHandle   vbPos;
+    BufferHandle   vbCol;
 
-    UINT vertexCount = 0;
+    uint32_t vertexCount = 0;
 };
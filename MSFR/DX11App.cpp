@@ -5,6 +5,7 @@
 #include "IProgram.h"
 #include "DX11Services.h"
 #include "Engine.h"
+#include "RenderDeviceDX11.h"
 
 #define SDL_MAIN_HANDLED
 #include <SDL2/SDL.h>
@@ -13,6 +14,7 @@
 #include <d3d11.h>
 #include <dxgi.h>
 
+#include <filesystem>
 #include <stdexcept>
 #include <string>
 #include <algorithm>
@@ -61,9 +63,26 @@ DX11App::DX11App(const char* title, int desired_width, int desired_height)
     InitD3D11();
     DX11Services::Init(ptr_device, ptr_context, ptr_swapchain);
 
+    ptr_render_device = new RenderDeviceDX11(ptr_device, ptr_context);
+
     Engine::SetDX11(ptr_device, ptr_context, ptr_swapchain);
+    Engine::SetRenderDevice(ptr_render_device);
     Engine::SetViewportSize(viewport_width, viewport_height);
 
+    // Before the program loads anything: a pack in the working directory
+    // answers for the assets it holds (see Tools/AssetPacker.cpp)
+    const std::filesystem::path pack = "assets.pak";
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(pack, ec))
+    {
+        std::string error;
+        if (!Engine::GetAssets().Mount(pack, &error))
+        {
+            throw std::runtime_error("Failed to mount " + error);
+        }
+        Engine::GetLogger().LogEvent("Mounted " + pack.generic_string());
+    }
+
     ptr_program = create_program(viewport_width, viewport_height);
 
     if (ptr_program == nullptr)
@@ -81,6 +100,18 @@ DX11App::~DX11App()
         ptr_program = nullptr;
     }
 
+    // Device-owned resources go before the D3D11 device itself
+    Engine::GetSpriteDefinitions().Clear();
+    Engine::GetTextureManager().Unload();
+    Engine::SetRenderDevice(nullptr);
+
+    const ShaderCache::Stats& shaders = ptr_render_device->GetShaderCache().GetStats();
+    Engine::GetLogger().LogEvent("Shaders compiled: " + std::to_string(shaders.compiles) +
+        " DiskHits: " + std::to_string(shaders.diskHits) +
+        " MemoryHits: " + std::to_string(shaders.memoryHits));
+    delete ptr_render_device;
+    ptr_render_device = nullptr;
+
     // Release backbuffer resources before swapchain/device
     ReleaseBackBufferResources();
 
@@ -427,16 +458,36 @@ void DX11App::Update()
         return;
     }
 
-    // Bind + clear
-    ptr_context->OMSetRenderTargets(1, &ptr_rtv, ptr_dsv);
-
-    ptr_context->ClearRenderTargetView(ptr_rtv, clear_color);
-    ptr_context->ClearDepthStencilView(ptr_dsv, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+    // BeginFrame binds the back buffer
+    ptr_render_device->SetBackBuffer(ptr_rtv, ptr_dsv,
+        static_cast<uint32_t>(viewport_width), static_cast<uint32_t>(viewport_height));
+    ptr_render_device->BeginFrame();
+
+    // The back buffer is cleared here; the game states draw onto it during
+    // the program's Update, and what the program's Draw flushes last goes in
+    // the scene pass. Update may add passes through Engine::GetFrameGraph(),
+    // e.g. an overlay writing Find("BackBuffer")
+    FrameGraph& graph = Engine::GetFrameGraph();
+    graph.Reset();
+    TextureDesc backBufferDesc;
+    backBufferDesc.width = static_cast<uint32_t>(viewport_width);
+    backBufferDesc.height = static_cast<uint32_t>(viewport_height);
+    backBufferDesc.usage = ResourceUsage::RenderTarget;
+    FrameGraphResource backBuffer = graph.ImportBackBuffer(backBufferDesc, clear_color);
+    graph.AddPass("Scene",
+        [&backBuffer](FrameGraph::Builder& builder) { backBuffer = builder.Write(backBuffer); },
+        [this](IRenderDevice& device, const FrameGraph::Resources&)
+        {
+            device.SetRenderTarget({});
+            ptr_program->Draw();
+            //ptr_program->ImGuiDraw();
+        });
 
     // User program
     ptr_program->Update();
-    ptr_program->Draw();
-    //ptr_program->ImGuiDraw();
+    graph.Compile();
+    graph.Execute();
+    ptr_render_device->EndFrame();
 
     // Present
     // vsync=1 is nicer. If want uncapped, change first arg to 0.
@@ -13,6 +13,7 @@ struct ID3D11DeviceContext;
 struct IDXGISwapChain;
 struct ID3D11RenderTargetView;
 struct ID3D11DepthStencilView;
+class RenderDeviceDX11;
 
 class [[nodiscard]] DX11App
 {
@@ -63,6 +64,7 @@ private:
     util::owner<ID3D11Device*>           ptr_device = nullptr;
     util::owner<ID3D11DeviceContext*>    ptr_context = nullptr;
     util::owner<IDXGISwapChain*>         ptr_swapchain = nullptr;
+    util::owner<RenderDeviceDX11*>       ptr_render_device = nullptr;
 
     // Backbuffer-dependent
     util::owner<ID3D11RenderTargetView*> ptr_rtv = nullptr;
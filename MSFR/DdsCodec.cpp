@@ -0,0 +1,235 @@
+#include "DdsCodec.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    const uint32_t HeaderSize = 4 + 124;        // magic and DDS_HEADER
+    const uint32_t Dx10HeaderSize = 20;
+
+    // DDS_HEADER flags
+    const uint32_t FlagCaps = 0x1;
+    const uint32_t FlagHeight = 0x2;
+    const uint32_t FlagWidth = 0x4;
+    const uint32_t FlagPitch = 0x8;
+    const uint32_t FlagPixelFormat = 0x1000;
+    const uint32_t FlagMipMapCount = 0x20000;
+    const uint32_t FlagLinearSize = 0x80000;
+
+    // DDS_PIXELFORMAT flags
+    const uint32_t PixelAlpha = 0x1;
+    const uint32_t PixelFourCC = 0x4;
+    const uint32_t PixelRGB = 0x40;
+
+    const uint32_t CapsComplex = 0x8;
+    const uint32_t CapsTexture = 0x1000;
+    const uint32_t CapsMipMap = 0x400000;
+    const uint32_t Caps2CubeMap = 0x200;
+    const uint32_t Caps2Volume = 0x200000;
+
+    const uint32_t DimensionTexture2D = 3;
+    const uint32_t MiscTextureCube = 0x4;
+
+    // DXGI_FORMAT values, UNORM and TYPELESS
+    const uint32_t DxgiRGBA8Typeless = 27;
+    const uint32_t DxgiRGBA8 = 28;
+    const uint32_t DxgiBC1Typeless = 70;
+    const uint32_t DxgiBC1 = 71;
+    const uint32_t DxgiBC3Typeless = 76;
+    const uint32_t DxgiBC3 = 77;
+    const uint32_t DxgiBC7Typeless = 97;
+    const uint32_t DxgiBC7 = 98;
+
+    constexpr uint32_t FourCC(char a, char b, char c, char d)
+    {
+        return (uint32_t)(uint8_t)a | (uint32_t)(uint8_t)b << 8 | (uint32_t)(uint8_t)c << 16 | (uint32_t)(uint8_t)d << 24;
+    }
+
+    bool Fail(std::string* error, const char* message)
+    {
+        if (error) *error = message;
+        return false;
+    }
+
+    uint32_t ReadLE32(const uint8_t* p)
+    {
+        return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+    }
+
+    void WriteLE32(std::vector<uint8_t>& out, size_t offset, uint32_t value)
+    {
+        for (uint32_t i = 0; i < 4; ++i) out[offset + i] = (uint8_t)(value >> (i * 8));
+    }
+
+    bool FromDxgi(uint32_t dxgi, TextureFormat& format)
+    {
+        switch (dxgi)
+        {
+        case DxgiRGBA8Typeless: case DxgiRGBA8: format = TextureFormat::RGBA8; return true;
+        case DxgiBC1Typeless: case DxgiBC1: format = TextureFormat::BC1; return true;
+        case DxgiBC3Typeless: case DxgiBC3: format = TextureFormat::BC3; return true;
+        case DxgiBC7Typeless: case DxgiBC7: format = TextureFormat::BC7; return true;
+        }
+        return false;
+    }
+
+    uint32_t FullChainLevels(uint32_t width, uint32_t height)
+    {
+        uint32_t levels = 1;
+        for (uint32_t size = width > height ? width : height; size > 1; size >>= 1) ++levels;
+        return levels;
+    }
+
+    // Header fields and where the texels start
+    bool ParseHeader(const uint8_t* data, size_t size, DDSInfo& info, size_t& dataOffset, std::string* error)
+    {
+        if (!IsDDS(data, size)) return Fail(error, "not a DDS file");
+        if (size < HeaderSize) return Fail(error, "truncated header");
+
+        const uint8_t* header = data + 4;
+        if (ReadLE32(header) != 124 || ReadLE32(header + 72) != 32) return Fail(error, "bad header size");
+        const uint32_t flags = ReadLE32(header + 4);
+        info.height = ReadLE32(header + 8);
+        info.width = ReadLE32(header + 12);
+        const uint32_t depth = ReadLE32(header + 20);
+        const uint32_t mipMapCount = ReadLE32(header + 24);
+        const uint32_t pixelFlags = ReadLE32(header + 76);
+        const uint32_t fourCC = ReadLE32(header + 80);
+        const uint32_t bitCount = ReadLE32(header + 84);
+        const uint32_t caps2 = ReadLE32(header + 108);
+
+        if (info.width == 0 || info.height == 0 || info.width > 16384 || info.height > 16384) return Fail(error, "bad image size");
+        if ((caps2 & (Caps2CubeMap | Caps2Volume)) || depth > 1) return Fail(error, "only 2D textures are supported");
+
+        dataOffset = HeaderSize;
+        if ((pixelFlags & PixelFourCC) && fourCC == FourCC('D', 'X', '1', '0'))
+        {
+            if (size < HeaderSize + Dx10HeaderSize) return Fail(error, "truncated DX10 header");
+            const uint8_t* dx10 = data + HeaderSize;
+            if (!FromDxgi(ReadLE32(dx10), info.format)) return Fail(error, "unsupported DXGI format");
+            if (ReadLE32(dx10 + 4) != DimensionTexture2D || (ReadLE32(dx10 + 8) & MiscTextureCube) || ReadLE32(dx10 + 12) > 1)
+                return Fail(error, "only 2D textures are supported");
+            dataOffset += Dx10HeaderSize;
+        }
+        else if (pixelFlags & PixelFourCC)
+        {
+            if (fourCC == FourCC('D', 'X', 'T', '1')) info.format = TextureFormat::BC1;
+            else if (fourCC == FourCC('D', 'X', 'T', '5')) info.format = TextureFormat::BC3;
+            else return Fail(error, "unsupported FourCC");
+        }
+        else if ((pixelFlags & PixelRGB) && bitCount == 32 && ReadLE32(header + 88) == 0x000000FF &&
+            ReadLE32(header + 92) == 0x0000FF00 && ReadLE32(header + 96) == 0x00FF0000 &&
+            (!(pixelFlags & PixelAlpha) || ReadLE32(header + 100) == 0xFF000000))
+        {
+            info.format = TextureFormat::RGBA8;
+        }
+        else
+        {
+            return Fail(error, "unsupported pixel format");
+        }
+
+        info.levels = (flags & FlagMipMapCount) && mipMapCount ? mipMapCount : 1;
+        if (info.levels > FullChainLevels(info.width, info.height)) return Fail(error, "bad mip count");
+        if (IsBlockCompressed(info.format) && (info.width % 4 || info.height % 4))
+            return Fail(error, "block-compressed size is not a multiple of 4");
+        return true;
+    }
+}
+
+bool IsDDS(const uint8_t* data, size_t size)
+{
+    return size >= 4 && std::memcmp(data, "DDS ", 4) == 0;
+}
+
+bool ReadDDSInfo(const uint8_t* data, size_t size, DDSInfo& info, std::string* error)
+{
+    size_t dataOffset = 0;
+    return ParseHeader(data, size, info, dataOffset, error);
+}
+
+bool ReadDDSFileInfo(const std::filesystem::path& path, DDSInfo& info)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+    uint8_t head[HeaderSize + Dx10HeaderSize];
+    in.read(reinterpret_cast<char*>(head), (std::streamsize)sizeof(head));
+    return ReadDDSInfo(head, (size_t)in.gcount(), info);
+}
+
+bool DecodeDDS(const uint8_t* data, size_t size, Image& out, std::string* error)
+{
+    DDSInfo info;
+    size_t dataOffset = 0;
+    if (!ParseHeader(data, size, info, dataOffset, error)) return false;
+
+    const uint64_t bytes = GetTextureBytes(info.format, info.width, info.height, info.levels);
+    if (bytes > size - dataOffset) return Fail(error, "truncated texel data");
+
+    Image image;
+    image.width = info.width;
+    image.height = info.height;
+    image.levels = info.levels;
+    image.format = info.format;
+    image.pixels.assign(data + dataOffset, data + dataOffset + bytes);
+    out = std::move(image);
+    return true;
+}
+
+std::vector<uint8_t> EncodeDDS(const Image& image)
+{
+    const bool dx10 = image.format == TextureFormat::BC7;
+    const size_t dataOffset = HeaderSize + (dx10 ? Dx10HeaderSize : 0);
+    const uint64_t bytes = GetTextureBytes(image.format, image.width, image.height, image.levels);
+
+    std::vector<uint8_t> out(dataOffset, 0);
+    std::memcpy(out.data(), "DDS ", 4);
+    const size_t header = 4;
+    const bool compressed = IsBlockCompressed(image.format);
+    uint32_t flags = FlagCaps | FlagHeight | FlagWidth | FlagPixelFormat | (compressed ? FlagLinearSize : FlagPitch);
+    if (image.levels > 1) flags |= FlagMipMapCount;
+
+    WriteLE32(out, header, 124);
+    WriteLE32(out, header + 4, flags);
+    WriteLE32(out, header + 8, image.height);
+    WriteLE32(out, header + 12, image.width);
+    WriteLE32(out, header + 16, compressed ? GetRowPitch(image.format, image.width) * GetRowCount(image.format, image.height)
+        : GetRowPitch(image.format, image.width));
+    WriteLE32(out, header + 24, image.levels);
+
+    WriteLE32(out, header + 72, 32);
+    switch (image.format)
+    {
+    case TextureFormat::BC1:
+        WriteLE32(out, header + 76, PixelFourCC);
+        WriteLE32(out, header + 80, FourCC('D', 'X', 'T', '1'));
+        break;
+    case TextureFormat::BC3:
+        WriteLE32(out, header + 76, PixelFourCC);
+        WriteLE32(out, header + 80, FourCC('D', 'X', 'T', '5'));
+        break;
+    case TextureFormat::BC7:
+        WriteLE32(out, header + 76, PixelFourCC);
+        WriteLE32(out, header + 80, FourCC('D', 'X', '1', '0'));
+        break;
+    default:
+        WriteLE32(out, header + 76, PixelRGB | PixelAlpha);
+        WriteLE32(out, header + 84, 32);
+        WriteLE32(out, header + 88, 0x000000FF);
+        WriteLE32(out, header + 92, 0x0000FF00);
+        WriteLE32(out, header + 96, 0x00FF0000);
+        WriteLE32(out, header + 100, 0xFF000000);
+        break;
+    }
+    WriteLE32(out, header + 104, CapsTexture | (image.levels > 1 ? CapsComplex | CapsMipMap : 0));
+
+    if (dx10)
+    {
+        WriteLE32(out, HeaderSize, DxgiBC7);
+        WriteLE32(out, HeaderSize + 4, DimensionTexture2D);
+        WriteLE32(out, HeaderSize + 12, 1);
+    }
+
+    out.insert(out.end(), image.pixels.begin(), image.pixels.begin() + (ptrdiff_t)bytes);
+    return out;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "ImageCodec.h"
+
+// DDS container for cooked textures (see Tools/TextureCooker.cpp): one 2D
+// texture with its mip chain, RGBA8 or BC1/BC3/BC7. The levels are stored
+// back to back the way Image keeps them, so decoding is a header check and
+// one copy, and the data goes to CreateTexture as it is. BC1 and BC3 are
+// written with the DXT1/DXT5 FourCC, BC7 with the DX10 header and RGBA8 as
+// masked 32-bit RGB, like texconv does; the reader takes the DX10 forms of
+// all four as well. Cube maps, arrays, volumes, sRGB formats and BC levels
+// 0 that aren't multiples of 4 are rejected.
+bool DecodeDDS(const uint8_t* data, size_t size, Image& out, std::string* error = nullptr);
+
+std::vector<uint8_t> EncodeDDS(const Image& image);
+
+struct DDSInfo
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t levels = 1;
+    TextureFormat format = TextureFormat::RGBA8;
+};
+
+bool IsDDS(const uint8_t* data, size_t size);
+// Reads the header only.
+bool ReadDDSInfo(const uint8_t* data, size_t size, DDSInfo& info, std::string* error = nullptr);
+bool ReadDDSFileInfo(const std::filesystem::path& path, DDSInfo& info);
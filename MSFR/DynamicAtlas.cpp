@@ -0,0 +1,68 @@
+#include "DynamicAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    constexpr int Padding = 1;
+}
+
+DynamicAtlas::DynamicAtlas(int pageSize, uint32_t maxPages)
+    : allocator(pageSize, pageSize, maxPages, Padding)
+{
+}
+
+void DynamicAtlas::Init(IRenderDevice& device_)
+{
+    Shutdown();
+    device = &device_;
+}
+
+void DynamicAtlas::Shutdown()
+{
+    pages.clear();
+    allocator.Reset();
+    device = nullptr;
+}
+
+AtlasSlot DynamicAtlas::Insert(uint32_t w, uint32_t h, const void* rgba, uint32_t rowPitch)
+{
+    if (!device || !rgba) return {};
+
+    const AtlasSlot slot = allocator.Allocate((int)w, (int)h);
+    uint32_t page = 0;
+    AtlasRect rect;
+    if (!allocator.GetRect(slot, page, rect)) return {};
+
+    while (pages.size() <= page)
+    {
+        pages.push_back(std::make_unique<TextureDX11>(*device,
+            (uint32_t)allocator.GetPageWidth(), (uint32_t)allocator.GetPageHeight(), true));
+    }
+
+    // Upload with the padding cleared, so nothing left by an evicted slot
+    // bleeds in when sampling bilinearly at the edges
+    const uint32_t uploadW = std::min<uint32_t>(w + Padding, (uint32_t)(allocator.GetPageWidth() - rect.x));
+    const uint32_t uploadH = std::min<uint32_t>(h + Padding, (uint32_t)(allocator.GetPageHeight() - rect.y));
+    staging.assign((size_t)uploadW * uploadH * 4, 0);
+    for (uint32_t y = 0; y < h; ++y)
+    {
+        std::memcpy(&staging[(size_t)y * uploadW * 4], static_cast<const uint8_t*>(rgba) + (size_t)y * rowPitch, (size_t)w * 4);
+    }
+    pages[page]->Update((uint32_t)rect.x, (uint32_t)rect.y, uploadW, uploadH, staging.data(), uploadW * 4);
+    return slot;
+}
+
+bool DynamicAtlas::Get(AtlasSlot slot, AtlasView& view)
+{
+    uint32_t page = 0;
+    AtlasRect rect;
+    if (!allocator.Touch(slot) || !allocator.GetRect(slot, page, rect) || page >= pages.size()) return false;
+
+    view.page = pages[page].get();
+    view.texelPos = { (float)rect.x, (float)rect.y };
+    view.size = { (float)rect.width, (float)rect.height };
+    allocator.GetUVRect(rect, view.uvRect);
+    return true;
+}
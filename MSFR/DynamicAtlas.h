@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "vec2.h"
+#include "AtlasAllocator.h"
+#include "TextureDX11.h"
+
+// Where an atlas slot lives, in the forms the draw paths take:
+// TextureDX11::Draw(mat, texelPos, size) or SpriteDrawItem::uvRect + handle.
+struct AtlasView
+{
+    TextureDX11* page = nullptr;
+    vec2 texelPos{ 0, 0 };
+    vec2 size{ 0, 0 };
+    float uvRect[4] = { 0, 0, 1, 1 };
+};
+
+// Runtime atlas for images only known at runtime (generated icons, glyphs,
+// user content). AtlasAllocator does the packing and LRU bookkeeping; this
+// class owns the page textures and uploads pixels into them.
+// Callers keep the AtlasSlot and re-insert when Get reports it was evicted.
+class DynamicAtlas
+{
+public:
+    static constexpr int DefaultPageSize = 1024;
+    static constexpr uint32_t DefaultMaxPages = 4;
+
+    explicit DynamicAtlas(int pageSize = DefaultPageSize, uint32_t maxPages = DefaultMaxPages);
+
+    DynamicAtlas(const DynamicAtlas&) = delete;
+    DynamicAtlas& operator=(const DynamicAtlas&) = delete;
+
+    void Init(IRenderDevice& device);
+    void Shutdown();
+
+    void NextFrame() { allocator.NextFrame(); }
+
+    // Copies w x h RGBA8 texels in; returns an invalid slot if it cannot fit.
+    AtlasSlot Insert(uint32_t w, uint32_t h, const void* rgba, uint32_t rowPitch);
+    // Marks the slot used this frame and fills view. False once evicted.
+    bool Get(AtlasSlot slot, AtlasView& view);
+    void Remove(AtlasSlot slot) { allocator.Free(slot); }
+
+    const AtlasAllocator& GetAllocator() const { return allocator; }
+
+private:
+    IRenderDevice* device = nullptr;
+    AtlasAllocator allocator;
+    std::vector<std::unique_ptr<TextureDX11>> pages;
+    std::vector<uint8_t> staging;
+};
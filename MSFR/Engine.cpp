@@ -1,10 +1,45 @@
 #include "Engine.h"
+#include "RenderDevice.h"
+#include "GameObjectManager.h"
+#include "ParticleSystem.h"
+#include "TextureDX11.h"
+#include "TilemapFormat.h"
 
 #include <thread>
 #include <string>
+#include <stdexcept>
 
 Engine::Engine() = default;
 
+IRenderDevice& Engine::GetRenderDevice()
+{
+    if (Instance().renderDevice == nullptr)
+        throw std::runtime_error("Engine::GetRenderDevice: no render device set.");
+    return *Instance().renderDevice;
+}
+
+void Engine::SetRenderDevice(IRenderDevice* device)
+{
+    Engine& engine = Instance();
+    engine.spriteBatch.Shutdown();
+    engine.staticSpriteBatch.Shutdown();
+    engine.tilemap.Shutdown();
+    engine.frameGraph.Shutdown();
+    engine.transientAllocator.Shutdown();
+    engine.dynamicAtlas.Shutdown();
+    engine.renderDevice = device;
+    if (device)
+    {
+        engine.transientAllocator.Init(*device);
+        engine.spriteBatch.Init(*device, engine.transientAllocator);
+        engine.spriteBatch.SetWorkerPool(&engine.workerPool);
+        engine.staticSpriteBatch.Init(*device, engine.transientAllocator);
+        engine.tilemap.Init(*device, engine.transientAllocator);
+        engine.frameGraph.Init(*device);
+        engine.dynamicAtlas.Init(*device);
+    }
+}
+
 void Engine::InitCore()
 {
     logger.LogEvent("Engine InitCore");
@@ -33,7 +68,14 @@ void Engine::Shutdown()
 
     logger.LogEvent("Engine Shutdown");
 
+    textLayoutCache.Clear();
+    fonts.clear();
+    tilemap.Clear();
+    spriteDefinitions.Clear();
+    textureManager.Release(tilemapTexture);
+    tilemapTexture = nullptr;
     textureManager.Unload();
+    SetRenderDevice(nullptr);
 
     if (dxContext)
         dxContext->ClearState();
@@ -71,6 +113,69 @@ void Engine::Update()
     {
         const double avgFps = static_cast<double>(frameCount) / elapsed;
         logger.LogEvent("FPS: " + std::to_string(avgFps));
+        logger.LogEvent("Sprites: " + std::to_string(spriteBatch.GetFrameStats().sprites) +
+            " SpriteDraws: " + std::to_string(spriteBatch.GetFrameStats().drawCalls) +
+            " SortSaved: " + std::to_string(spriteBatch.GetFrameStats().stateChangesSaved));
+        if (staticSpriteBatch.Size() > 0)
+        {
+            const StaticSpriteBatch::DrawStats& stats = staticSpriteBatch.GetDrawStats();
+            logger.LogEvent("StaticChunks: " + std::to_string(stats.chunksDrawn) + "/" + std::to_string(stats.chunks) +
+                " StaticSprites: " + std::to_string(stats.sprites) +
+                " StaticDraws: " + std::to_string(stats.drawCalls) +
+                " Rebuilds: " + std::to_string(stats.rebuilds));
+        }
+        if (tilemap.GetWidth() > 0)
+        {
+            const Tilemap::DrawStats& stats = tilemap.GetDrawStats();
+            logger.LogEvent("TileChunks: " + std::to_string(stats.chunksDrawn) + "/" + std::to_string(stats.chunks) +
+                " Tiles: " + std::to_string(stats.tiles) +
+                " Resident: " + std::to_string(stats.resident) +
+                " Rebuilds: " + std::to_string(stats.rebuilds));
+        }
+        if (const GameObjectManager* objects = GetGSComponent<GameObjectManager>())
+        {
+            logger.LogEvent("Visible: " + std::to_string(objects->GetCullStats().visible) +
+                " Culled: " + std::to_string(objects->GetCullStats().culled));
+        }
+        if (const ParticleSystem* particles = GetGSComponent<ParticleSystem>())
+        {
+            logger.LogEvent("Particles: " + std::to_string(particles->GetStats().live) +
+                " Emitters: " + std::to_string(particles->GetStats().emitters) +
+                " ParticleDraws: " + std::to_string(particles->GetStats().drawCalls));
+        }
+        if (textureManager.GetStats().textures > 0)
+        {
+            const TextureManager::Stats& stats = textureManager.GetStats();
+            logger.LogEvent("Textures: " + std::to_string(stats.textures) +
+                " Referenced: " + std::to_string(stats.referenced) +
+                " Resident: " + std::to_string(stats.residentBytes) + " bytes" +
+                " HitRate: " + std::to_string(stats.GetHitRate()) +
+                " Evictions: " + std::to_string(stats.evictions));
+        }
+        if (textureManager.GetLoader().GetStats().requests > 0)
+        {
+            const TextureLoader::Stats& stats = textureManager.GetLoader().GetStats();
+            logger.LogEvent("TextureLoads: " + std::to_string(stats.inFlight) +
+                " Loaded: " + std::to_string(stats.decoded) +
+                " Coalesced: " + std::to_string(stats.coalesced) +
+                " Failed: " + std::to_string(stats.failed));
+        }
+        if (frameGraph.GetStats().passes > 0)
+        {
+            const FrameGraph::Stats& stats = frameGraph.GetStats();
+            logger.LogEvent("Passes: " + std::to_string(stats.passes - stats.culledPasses) + "/" + std::to_string(stats.passes) +
+                " RenderTargets: " + std::to_string(stats.physicalTextures) + "/" + std::to_string(stats.transientTextures) +
+                " TargetBytes: " + std::to_string(stats.physicalBytes));
+        }
+        if (renderDevice)
+        {
+            const RenderFrameStats& stats = renderDevice->GetFrameStats();
+            logger.LogEvent("Draws: " + std::to_string(stats.drawCalls) +
+                " StateChanges: " + std::to_string(stats.stateChanges) +
+                " Redundant: " + std::to_string(stats.redundantBinds) +
+                " Uploaded: " + std::to_string(stats.bytesUploaded) + " bytes" +
+                " Pipelines: " + std::to_string(renderDevice->GetPipelineStats().unique));
+        }
         frameCount = 0;
         fpsCalcTime = now;
     }
@@ -79,17 +184,66 @@ void Engine::Update()
         window.Update();
     }
 
+    textureManager.Update();
+    dynamicAtlas.NextFrame();
+    textLayoutCache.EndFrame();
+    spriteBatch.Begin((float)viewportWidth, (float)viewportHeight);
     UpdateGameObjects(dt);
 }
 
 void Engine::Draw()
 {
     // gameStateManager.Draw();
+    spriteBatch.Flush();
 }
 
 void Engine::AddSpriteFont(const std::filesystem::path& fileName)
 {
-    (void)fileName;
+    logger.LogEvent("Loading font " + fileName.generic_string());
+    fonts.push_back(std::make_unique<SpriteFont>(fileName));
+}
+
+void Engine::LoadTilemap(const std::filesystem::path& fileName)
+{
+    logger.LogEvent("Loading tilemap " + fileName.generic_string());
+
+    AssetBytes bytes;
+    if (assets.Read(fileName, bytes) == false)
+    {
+        throw std::runtime_error("Failed to load " + fileName.generic_string());
+    }
+    AssetStream inFile(bytes);
+
+    TilemapInfo info;
+    std::vector<std::string> errors;
+    const bool loaded = ReadTilemap(inFile, info, errors);
+    for (const std::string& error : errors)
+    {
+        logger.LogError(fileName.generic_string() + ": " + error);
+    }
+    if (loaded == false)
+    {
+        throw std::runtime_error("Failed to load " + fileName.generic_string());
+    }
+
+    // The tileset path is relative to the .tmap, like a font's page file.
+    // Loaded right away: chunks bake the handle, so no placeholder
+    const TextureDX11* texture = textureManager.Load(fileName.parent_path() / info.tileset, true);
+    textureManager.Release(tilemapTexture);
+    tilemapTexture = texture;
+    Tilemap::Tileset tileset;
+    tileset.texture = texture->GetHandle();
+    tileset.textureWidth = static_cast<uint32_t>(texture->GetSize().x);
+    tileset.textureHeight = static_cast<uint32_t>(texture->GetSize().y);
+    tilemap.Load(info, tileset);
+}
+
+SpriteFont& Engine::GetSpriteFont(int index)
+{
+    Engine& engine = Instance();
+    if (index < 0 || index >= static_cast<int>(engine.fonts.size()))
+        throw std::runtime_error("Engine::GetSpriteFont: no font " + std::to_string(index) + ".");
+    return *engine.fonts[index];
 }
 
 double Engine::ComputeDeltaSeconds()
@@ -1,16 +1,31 @@
 #pragma once
 #include <chrono>
 #include <filesystem>
+#include <memory>
+#include <vector>
 
 #include <wrl/client.h>
 #include <d3d11.h>
 #include <dxgi.h>
 
+#include "AssetPack.h"
 #include "GameStateManager.h"
 #include "Input.h"
 #include "Window.h"
 #include "Logger.h"
 #include "TextureManager.h"
+#include "SpriteBatch.h"
+#include "SpriteDefinition.h"
+#include "StaticSpriteBatch.h"
+#include "TransientAllocator.h"
+#include "DynamicAtlas.h"
+#include "WorkerPool.h"
+#include "BitmapFont.h"
+#include "SpriteFont.h"
+#include "Tilemap.h"
+#include "FrameGraph.h"
+
+class IRenderDevice;
 
 class Engine
 {
@@ -33,10 +48,25 @@ public:
     static Engine& Instance() { static Engine instance; return instance; }
 
     static Logger& GetLogger() { return Instance().logger; }
+    // Packs mounted at startup, then loose files; safe from decode threads
+    static AssetFileSystem& GetAssets() { return Instance().assets; }
     static Input& GetInput() { return Instance().input; }
     static Window& GetWindow() { return Instance().window; }
     static GameStateManager& GetGameStateManager() { return Instance().gameStateManager; }
     static TextureManager& GetTextureManager() { return Instance().textureManager; }
+    static SpriteBatch& GetSpriteBatch() { return Instance().spriteBatch; }
+    // Shared by every Sprite of the same file; see Sprite
+    static SpriteDefinitionCache& GetSpriteDefinitions() { return Instance().spriteDefinitions; }
+    static StaticSpriteBatch& GetStaticSpriteBatch() { return Instance().staticSpriteBatch; }
+    static Tilemap& GetTilemap() { return Instance().tilemap; }
+    // Rebuilt every frame by the app; the back buffer is imported as "BackBuffer"
+    static FrameGraph& GetFrameGraph() { return Instance().frameGraph; }
+    static TransientAllocator& GetTransientAllocator() { return Instance().transientAllocator; }
+    static DynamicAtlas& GetDynamicAtlas() { return Instance().dynamicAtlas; }
+    static WorkerPool& GetWorkerPool() { return Instance().workerPool; }
+    static TextLayoutCache& GetTextLayoutCache() { return Instance().textLayoutCache; }
+    // Fonts in AddSpriteFont order
+    static SpriteFont& GetSpriteFont(int index);
 
     template<typename T>
     static T* GetGSComponent() { return GetGameStateManager().GetGSComponent<T>(); }
@@ -53,6 +83,10 @@ public:
         Instance().dxSwapChain = swapChain;
     }
 
+    // Backend-agnostic rendering (D3D11 or null/recording)
+    static IRenderDevice& GetRenderDevice();
+    static void SetRenderDevice(IRenderDevice* device);
+
 
     void InitCore();
     void InitWindow(const char* windowName, int w, int h); // lgacy
@@ -64,6 +98,8 @@ public:
 
     bool IsGameFinished() const { return gameFinish; }
     void AddSpriteFont(const std::filesystem::path& fileName);
+    // Replaces the tile layer with a .tmap file, see TilemapFormat.h
+    void LoadTilemap(const std::filesystem::path& fileName);
 
 private:
     using Clock = std::chrono::steady_clock;
@@ -82,16 +118,31 @@ private:
     bool usesInternalWindow = false;
 
     Logger logger;
+    // Before everything that may hold views into a pack
+    AssetFileSystem assets;
     GameStateManager gameStateManager;
     Input input;
     Window window;
     TextureManager textureManager;
+    SpriteDefinitionCache spriteDefinitions;
+    WorkerPool workerPool;
+    TransientAllocator transientAllocator;
+    SpriteBatch spriteBatch;
+    StaticSpriteBatch staticSpriteBatch;
+    Tilemap tilemap;
+    const TextureDX11* tilemapTexture = nullptr;
+    FrameGraph frameGraph;
+    DynamicAtlas dynamicAtlas;
+    TextLayoutCache textLayoutCache;
+    std::vector<std::unique_ptr<SpriteFont>> fonts;
 
     // DX11 members
     Microsoft::WRL::ComPtr<ID3D11Device>        dxDevice;
     Microsoft::WRL::ComPtr<ID3D11DeviceContext> dxContext;
     Microsoft::WRL::ComPtr<IDXGISwapChain>      dxSwapChain;
 
+    IRenderDevice* renderDevice = nullptr;
+
     static constexpr double TargetFPS = 60.0;
     static constexpr int FPSIntervalSec = 5;
     int viewportWidth = 1280;
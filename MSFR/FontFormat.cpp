@@ -0,0 +1,144 @@
+#include "FontFormat.h"
+
+#include <cstdlib>
+#include <istream>
+#include <utility>
+
+namespace
+{
+    using Attributes = std::vector<std::pair<std::string, std::string>>;
+
+    // Splits "tag key=value key="quoted value" ..." into the tag and its pairs
+    std::string Tokenize(const std::string& line, Attributes& attributes)
+    {
+        attributes.clear();
+        size_t i = 0;
+        auto skipSpace = [&]() { while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) ++i; };
+
+        skipSpace();
+        const size_t tagStart = i;
+        while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r') ++i;
+        std::string tag = line.substr(tagStart, i - tagStart);
+
+        for (;;)
+        {
+            skipSpace();
+            if (i >= line.size()) break;
+            const size_t keyStart = i;
+            while (i < line.size() && line[i] != '=' && line[i] != ' ' && line[i] != '\t') ++i;
+            std::string key = line.substr(keyStart, i - keyStart);
+            std::string value;
+            if (i < line.size() && line[i] == '=')
+            {
+                ++i;
+                if (i < line.size() && line[i] == '"')
+                {
+                    const size_t end = line.find('"', i + 1);
+                    value = line.substr(i + 1, (end == std::string::npos ? line.size() : end) - i - 1);
+                    i = end == std::string::npos ? line.size() : end + 1;
+                }
+                else
+                {
+                    const size_t valueStart = i;
+                    while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r') ++i;
+                    value = line.substr(valueStart, i - valueStart);
+                }
+            }
+            attributes.emplace_back(std::move(key), std::move(value));
+        }
+        return tag;
+    }
+
+    int ToInt(const std::string& text)
+    {
+        return static_cast<int>(std::strtol(text.c_str(), nullptr, 10));
+    }
+}
+
+bool ParseFontInfo(std::istream& in, FontInfo& info, std::vector<std::string>& errors)
+{
+    info = {};
+
+    std::string line;
+    Attributes attributes;
+    while (std::getline(in, line))
+    {
+        const std::string tag = Tokenize(line, attributes);
+        if (tag.empty() || tag == "info" || tag == "chars" || tag == "kernings")
+        {
+            continue;
+        }
+        if (tag == "common")
+        {
+            for (const auto& [key, value] : attributes)
+            {
+                if (key == "lineHeight") info.lineHeight = ToInt(value);
+                else if (key == "base") info.base = ToInt(value);
+                else if (key == "scaleW") info.scaleW = ToInt(value);
+                else if (key == "scaleH") info.scaleH = ToInt(value);
+                else if (key == "pages" && ToInt(value) > 1) errors.push_back("Only the first of " + value + " font pages is used");
+            }
+        }
+        else if (tag == "page")
+        {
+            int id = 0;
+            std::string file;
+            for (const auto& [key, value] : attributes)
+            {
+                if (key == "id") id = ToInt(value);
+                else if (key == "file") file = value;
+            }
+            if (id == 0) info.texture = file;
+        }
+        else if (tag == "char")
+        {
+            FontGlyphInfo glyph;
+            int page = 0;
+            for (const auto& [key, value] : attributes)
+            {
+                if (key == "id") glyph.id = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+                else if (key == "x") glyph.x = ToInt(value);
+                else if (key == "y") glyph.y = ToInt(value);
+                else if (key == "width") glyph.width = ToInt(value);
+                else if (key == "height") glyph.height = ToInt(value);
+                else if (key == "xoffset") glyph.xOffset = ToInt(value);
+                else if (key == "yoffset") glyph.yOffset = ToInt(value);
+                else if (key == "xadvance") glyph.xAdvance = ToInt(value);
+                else if (key == "page") page = ToInt(value);
+            }
+            if (page != 0)
+            {
+                errors.push_back("Glyph " + std::to_string(glyph.id) + " is on page " + std::to_string(page) + ", skipped");
+                continue;
+            }
+            info.glyphs.push_back(glyph);
+        }
+        else if (tag == "kerning")
+        {
+            FontKerningInfo kerning;
+            for (const auto& [key, value] : attributes)
+            {
+                if (key == "first") kerning.first = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+                else if (key == "second") kerning.second = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+                else if (key == "amount") kerning.amount = ToInt(value);
+            }
+            info.kernings.push_back(kerning);
+        }
+        else
+        {
+            errors.push_back("Unknown fnt tag " + tag);
+        }
+    }
+
+    if (info.texture.empty())
+    {
+        errors.push_back("Missing font page file");
+        return false;
+    }
+    if (info.scaleW <= 0 || info.scaleH <= 0)
+    {
+        errors.push_back("Missing font sheet size");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// In-memory form of a bitmap font metrics file in the BMFont text format
+// (.fnt), as written by BMFont, Hiero and most glyph sheet tools:
+//   common lineHeight=32 base=26 scaleW=256 scaleH=256 pages=1
+//   page id=0 file="font.png"
+//   char id=65 x=2 y=2 width=18 height=22 xoffset=0 yoffset=4 xadvance=19 page=0
+//   kerning first=65 second=86 amount=-2
+// Glyph rects are texels with y down from the top of the sheet; yoffset is
+// from the top of the line to the top of the glyph. Only single page fonts
+// are supported: a glyph sprite binds one texture.
+struct FontGlyphInfo
+{
+    uint32_t id = 0;        // Unicode code point
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    int xOffset = 0;
+    int yOffset = 0;
+    int xAdvance = 0;
+};
+
+struct FontKerningInfo
+{
+    uint32_t first = 0;
+    uint32_t second = 0;
+    int amount = 0;
+};
+
+struct FontInfo
+{
+    std::string texture;    // as written, relative to the .fnt file
+    int lineHeight = 0;
+    int base = 0;           // top of the line to the baseline
+    int scaleW = 0;         // sheet size the glyph rects refer to
+    int scaleH = 0;
+    std::vector<FontGlyphInfo> glyphs;
+    std::vector<FontKerningInfo> kernings;
+};
+
+// Unknown tags and glyphs on other pages are reported through errors and
+// skipped. Fails without a page file or sheet size.
+bool ParseFontInfo(std::istream& in, FontInfo& info, std::vector<std::string>& errors);
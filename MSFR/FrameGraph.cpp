@@ -0,0 +1,414 @@
+#include "FrameGraph.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+
+namespace
+{
+    bool SameLayout(const TextureDesc& a, const TextureDesc& b) noexcept
+    {
+        return a.width == b.width && a.height == b.height && a.mipLevels == b.mipLevels && a.format == b.format;
+    }
+
+    uint64_t GetTextureBytes(const TextureDesc& desc) noexcept
+    {
+        uint64_t bytes = 0;
+        for (uint32_t mip = 0; mip < desc.mipLevels; ++mip)
+        {
+            const uint64_t w = std::max(desc.width >> mip, 1u);
+            const uint64_t h = std::max(desc.height >> mip, 1u);
+            bytes += w * h * 4;
+        }
+        return bytes;
+    }
+}
+
+FrameGraphResource FrameGraph::Builder::Create(const std::string& name, const TextureDesc& desc)
+{
+    ResourceInfo info;
+    info.name = name;
+    info.desc = desc;
+    info.desc.usage = ResourceUsage::RenderTarget;
+    graph.resources.push_back(std::move(info));
+
+    Node node;
+    node.resource = (uint32_t)graph.resources.size() - 1;
+    graph.nodes.push_back(node);
+    graph.latest.push_back((uint32_t)graph.nodes.size() - 1);
+    graph.compiled = false;
+    return FrameGraphResource{ (uint32_t)graph.nodes.size() };
+}
+
+FrameGraphResource FrameGraph::Builder::Read(FrameGraphResource resource)
+{
+    const uint32_t index = resource.id - 1;
+    const Node& node = graph.GetNode(resource);
+    const ResourceInfo& info = graph.resources[node.resource];
+    if (node.producer == Invalid && !info.imported)
+        throw std::runtime_error("FrameGraph: pass '" + graph.passes[pass].name + "' reads '" + info.name + "' before anything writes it.");
+
+    std::vector<uint32_t>& reads = graph.passes[pass].reads;
+    if (std::find(reads.begin(), reads.end(), index) == reads.end()) reads.push_back(index);
+    return resource;
+}
+
+FrameGraphResource FrameGraph::Builder::Write(FrameGraphResource resource)
+{
+    const uint32_t index = resource.id - 1;
+    const Node node = graph.GetNode(resource);
+    if (node.next != Invalid)
+        throw std::runtime_error("FrameGraph: pass '" + graph.passes[pass].name + "' writes an old version of '" + graph.resources[node.resource].name + "'.");
+
+    // The previous contents are kept, so whoever wrote them is a dependency
+    Pass& p = graph.passes[pass];
+    if (node.producer != Invalid && node.producer != pass && std::find(p.reads.begin(), p.reads.end(), index) == p.reads.end())
+        p.reads.push_back(index);
+
+    Node written;
+    written.resource = node.resource;
+    written.producer = pass;
+    graph.nodes.push_back(written);
+    const uint32_t writtenIndex = (uint32_t)graph.nodes.size() - 1;
+    graph.nodes[index].next = writtenIndex;
+    graph.latest[node.resource] = writtenIndex;
+    ++graph.resources[node.resource].versions;
+    p.writes.push_back(writtenIndex);
+    return FrameGraphResource{ writtenIndex + 1 };
+}
+
+void FrameGraph::Builder::SetSideEffect()
+{
+    graph.passes[pass].sideEffect = true;
+}
+
+TextureHandle FrameGraph::Resources::GetTexture(FrameGraphResource resource) const
+{
+    const ResourceInfo& info = graph.GetResourceInfo(resource);
+    if (info.imported) return info.texture;
+    return info.physical == Invalid ? TextureHandle{} : graph.physicalTextures[info.physical].texture;
+}
+
+const TextureDesc& FrameGraph::Resources::GetDesc(FrameGraphResource resource) const
+{
+    return graph.GetResourceInfo(resource).desc;
+}
+
+FrameGraph::FrameGraph(uint32_t maxIdleFrames_)
+    : maxIdleFrames(maxIdleFrames_)
+{
+}
+
+FrameGraph::~FrameGraph()
+{
+    Shutdown();
+}
+
+void FrameGraph::Init(IRenderDevice& device_)
+{
+    Shutdown();
+    device = &device_;
+}
+
+void FrameGraph::Shutdown()
+{
+    if (!device) return;
+
+    for (PooledTexture& pooled : pool) device->Destroy(pooled.texture);
+    pool.clear();
+    for (PhysicalTexture& physical : physicalTextures) physical.texture = {};
+    stats.pooledTextures = 0;
+    device = nullptr;
+}
+
+void FrameGraph::Reset()
+{
+    passes.clear();
+    resources.clear();
+    nodes.clear();
+    latest.clear();
+    order.clear();
+    physicalTextures.clear();
+    compiled = false;
+}
+
+FrameGraphResource FrameGraph::Import(const std::string& name, TextureHandle texture, const TextureDesc& desc)
+{
+    ResourceInfo info;
+    info.name = name;
+    info.desc = desc;
+    info.imported = true;
+    info.texture = texture;
+    resources.push_back(std::move(info));
+
+    Node node;
+    node.resource = (uint32_t)resources.size() - 1;
+    nodes.push_back(node);
+    latest.push_back((uint32_t)nodes.size() - 1);
+    compiled = false;
+    return FrameGraphResource{ (uint32_t)nodes.size() };
+}
+
+FrameGraphResource FrameGraph::ImportBackBuffer(const TextureDesc& desc, const float clearColor[4])
+{
+    if (device)
+    {
+        device->SetRenderTarget({});
+        device->ClearRenderTarget(clearColor);
+    }
+    return Import("BackBuffer", {}, desc);
+}
+
+uint32_t FrameGraph::AddPass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute)
+{
+    Pass pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+    passes.push_back(std::move(pass));
+    compiled = false;
+
+    const uint32_t index = (uint32_t)passes.size() - 1;
+    Builder builder(*this, index);
+    if (setup) setup(builder);
+    return index;
+}
+
+FrameGraphResource FrameGraph::Find(const std::string& name) const
+{
+    for (size_t i = 0; i < resources.size(); ++i)
+    {
+        if (resources[i].name == name) return FrameGraphResource{ latest[i] + 1 };
+    }
+    return {};
+}
+
+void FrameGraph::Compile()
+{
+    Cull();
+    Sort();
+    Alias();
+    compiled = true;
+}
+
+void FrameGraph::Execute()
+{
+    if (!compiled) Compile();
+    ++frame;
+
+    stats.texturesCreated = 0;
+    for (PooledTexture& pooled : pool) pooled.taken = false;
+    for (PhysicalTexture& physical : physicalTextures)
+    {
+        physical.texture = device ? Acquire(physical.desc) : TextureHandle{};
+    }
+    if (!device) return;
+
+    const Resources access(*this);
+    for (uint32_t pass : order)
+    {
+        if (passes[pass].execute) passes[pass].execute(*device, access);
+    }
+
+    // Textures the graph stopped asking for
+    auto idle = [this](const PooledTexture& pooled) { return frame - pooled.lastUsed > maxIdleFrames; };
+    for (PooledTexture& pooled : pool)
+    {
+        if (idle(pooled)) device->Destroy(pooled.texture);
+    }
+    pool.erase(std::remove_if(pool.begin(), pool.end(), idle), pool.end());
+    stats.pooledTextures = (uint32_t)pool.size();
+}
+
+const FrameGraph::ResourceInfo& FrameGraph::GetResourceInfo(FrameGraphResource resource) const
+{
+    return resources[GetNode(resource).resource];
+}
+
+const FrameGraph::Node& FrameGraph::GetNode(FrameGraphResource resource) const
+{
+    if (!resource || resource.id > nodes.size())
+        throw std::runtime_error("FrameGraph: unknown resource.");
+    return nodes[resource.id - 1];
+}
+
+void FrameGraph::Cull()
+{
+    // Reference counting from the roots' point of view: a pass stays while
+    // something still reads one of its outputs
+    std::vector<uint32_t> outputs(passes.size());
+    std::vector<bool> root(passes.size());
+    for (Node& node : nodes) node.readers = 0;
+    for (uint32_t p = 0; p < passes.size(); ++p)
+    {
+        Pass& pass = passes[p];
+        pass.culled = false;
+        outputs[p] = (uint32_t)pass.writes.size();
+        root[p] = pass.sideEffect || std::any_of(pass.writes.begin(), pass.writes.end(),
+            [this](uint32_t node) { return resources[nodes[node].resource].imported; });
+        for (uint32_t node : pass.reads) ++nodes[node].readers;
+    }
+
+    std::vector<uint32_t> unread;
+    auto cull = [&](uint32_t p)
+    {
+        passes[p].culled = true;
+        for (uint32_t node : passes[p].reads)
+        {
+            if (--nodes[node].readers == 0 && nodes[node].producer != Invalid) unread.push_back(node);
+        }
+    };
+
+    // Every unread node is queued exactly once: here if nothing ever read
+    // it, or by cull when its last reader goes. Queuing one twice would
+    // take two outputs off its producer and cull a pass still in use.
+    for (uint32_t n = 0; n < nodes.size(); ++n)
+    {
+        if (nodes[n].readers == 0 && nodes[n].producer != Invalid) unread.push_back(n);
+    }
+    for (uint32_t p = 0; p < passes.size(); ++p)
+    {
+        if (outputs[p] == 0 && !root[p]) cull(p);
+    }
+    while (!unread.empty())
+    {
+        const uint32_t producer = nodes[unread.back()].producer;
+        unread.pop_back();
+        if (root[producer] || passes[producer].culled) continue;
+        if (--outputs[producer] == 0) cull(producer);
+    }
+
+    stats.passes = (uint32_t)passes.size();
+    stats.culledPasses = (uint32_t)std::count_if(passes.begin(), passes.end(), [](const Pass& pass) { return pass.culled; });
+}
+
+void FrameGraph::Sort()
+{
+    // Kahn's algorithm, lowest declaration index first among the ready passes
+    std::vector<std::vector<uint32_t>> successors(passes.size());
+    std::vector<uint32_t> pending(passes.size());
+    auto addEdge = [&](uint32_t from, uint32_t to)
+    {
+        if (from == Invalid || to == Invalid || from == to || passes[from].culled || passes[to].culled) return;
+        successors[from].push_back(to);
+        ++pending[to];
+    };
+    for (uint32_t p = 0; p < passes.size(); ++p)
+    {
+        if (passes[p].culled) continue;
+        for (uint32_t node : passes[p].reads)
+        {
+            addEdge(nodes[node].producer, p);
+            // Read before the next version overwrites it
+            if (nodes[node].next != Invalid) addEdge(p, nodes[nodes[node].next].producer);
+        }
+    }
+
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> ready;
+    for (uint32_t p = 0; p < passes.size(); ++p)
+    {
+        if (!passes[p].culled && pending[p] == 0) ready.push(p);
+    }
+
+    order.clear();
+    while (!ready.empty())
+    {
+        const uint32_t p = ready.top();
+        ready.pop();
+        order.push_back(p);
+        for (uint32_t next : successors[p])
+        {
+            if (--pending[next] == 0) ready.push(next);
+        }
+    }
+
+    if (order.size() != passes.size() - stats.culledPasses)
+    {
+        std::string names;
+        for (uint32_t p = 0; p < passes.size(); ++p)
+        {
+            if (passes[p].culled || pending[p] == 0) continue;
+            names += (names.empty() ? "'" : ", '") + passes[p].name + "'";
+        }
+        throw std::runtime_error("FrameGraph: passes " + names + " depend on each other in a cycle.");
+    }
+}
+
+void FrameGraph::Alias()
+{
+    for (ResourceInfo& info : resources)
+    {
+        info.firstUse = info.lastUse = info.physical = Invalid;
+    }
+    for (uint32_t position = 0; position < order.size(); ++position)
+    {
+        const Pass& pass = passes[order[position]];
+        for (const std::vector<uint32_t>* used : { &pass.reads, &pass.writes })
+        {
+            for (uint32_t node : *used)
+            {
+                ResourceInfo& info = resources[nodes[node].resource];
+                info.firstUse = std::min(info.firstUse, position);
+                info.lastUse = info.lastUse == Invalid ? position : std::max(info.lastUse, position);
+            }
+        }
+    }
+
+    std::vector<uint32_t> transients;
+    for (uint32_t r = 0; r < resources.size(); ++r)
+    {
+        if (!resources[r].imported && resources[r].firstUse != Invalid) transients.push_back(r);
+    }
+    std::stable_sort(transients.begin(), transients.end(),
+        [this](uint32_t a, uint32_t b) { return resources[a].firstUse < resources[b].firstUse; });
+
+    // Greedy interval assignment: reuse the compatible texture that was freed
+    // last, so earlier-freed ones stay open for the others
+    physicalTextures.clear();
+    std::vector<uint32_t> busyUntil;
+    stats.transientTextures = (uint32_t)transients.size();
+    stats.transientBytes = 0;
+    stats.physicalBytes = 0;
+    for (uint32_t r : transients)
+    {
+        ResourceInfo& info = resources[r];
+        uint32_t best = Invalid;
+        for (uint32_t t = 0; t < physicalTextures.size(); ++t)
+        {
+            if (busyUntil[t] >= info.firstUse || !SameLayout(physicalTextures[t].desc, info.desc)) continue;
+            if (best == Invalid || busyUntil[t] > busyUntil[best]) best = t;
+        }
+        if (best == Invalid)
+        {
+            best = (uint32_t)physicalTextures.size();
+            physicalTextures.push_back({ info.desc, {}, {} });
+            busyUntil.push_back(0);
+            stats.physicalBytes += GetTextureBytes(info.desc);
+        }
+        info.physical = best;
+        physicalTextures[best].resources.push_back(r);
+        busyUntil[best] = info.lastUse;
+        stats.transientBytes += GetTextureBytes(info.desc);
+    }
+    stats.physicalTextures = (uint32_t)physicalTextures.size();
+}
+
+TextureHandle FrameGraph::Acquire(const TextureDesc& desc)
+{
+    for (PooledTexture& pooled : pool)
+    {
+        if (pooled.taken || !SameLayout(pooled.desc, desc)) continue;
+        pooled.taken = true;
+        pooled.lastUsed = frame;
+        return pooled.texture;
+    }
+
+    PooledTexture pooled;
+    pooled.desc = desc;
+    pooled.texture = device->CreateTexture(desc, nullptr);
+    pooled.lastUsed = frame;
+    pooled.taken = true;
+    pool.push_back(pooled);
+    ++stats.texturesCreated;
+    return pooled.texture;
+}
@@ -0,0 +1,197 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "RenderDevice.h"
+
+// A version of a frame graph texture. Every Write returns a new version, so
+// a handle pins down which contents a pass reads.
+struct FrameGraphResource
+{
+    uint32_t id = 0;
+    explicit operator bool() const noexcept { return id != 0; }
+};
+
+constexpr bool operator==(FrameGraphResource a, FrameGraphResource b) noexcept { return a.id == b.id; }
+constexpr bool operator!=(FrameGraphResource a, FrameGraphResource b) noexcept { return a.id != b.id; }
+
+// Per-frame description of the render passes. Each frame the passes are
+// declared again: a setup callback states which textures the pass creates,
+// reads and writes, and an execute callback records its draws. Compile then
+//  - culls passes whose results nothing reads (passes that write an imported
+//    texture, like the back buffer, or that are marked with SetSideEffect,
+//    are the roots),
+//  - orders the rest so every pass runs after the writers of what it reads
+//    and before anyone overwrites it, keeping declaration order otherwise,
+//  - computes each transient texture's lifetime in that order and assigns
+//    transient textures with equal descs and disjoint lifetimes to the same
+//    physical texture. D3D11 has no placed resources, so sharing memory
+//    means sharing the texture object.
+// Physical textures are pooled across frames and dropped after going unused
+// for a while. Everything Compile decides can be read back below, which is
+// how Tools/FrameGraphTest.cpp checks it against RenderDeviceNull.
+class FrameGraph
+{
+public:
+    static constexpr uint32_t Invalid = 0xFFFFFFFF;
+    static constexpr uint32_t DefaultMaxIdleFrames = 4;
+
+    class Builder
+    {
+    public:
+        // A transient render target, alive from its first write to its last
+        // use. Its contents are undefined until the first writer clears it.
+        FrameGraphResource Create(const std::string& name, const TextureDesc& desc);
+        FrameGraphResource Read(FrameGraphResource resource);
+        // Returns the version the pass produces. Writing keeps what was there,
+        // so the previous version's writer stays alive as well.
+        FrameGraphResource Write(FrameGraphResource resource);
+        // Never culled, e.g. for readbacks.
+        void SetSideEffect();
+
+    private:
+        friend class FrameGraph;
+        Builder(FrameGraph& graph_, uint32_t pass_) : graph(graph_), pass(pass_) {}
+
+        FrameGraph& graph;
+        uint32_t pass;
+    };
+
+    class Resources
+    {
+    public:
+        TextureHandle GetTexture(FrameGraphResource resource) const;
+        const TextureDesc& GetDesc(FrameGraphResource resource) const;
+
+    private:
+        friend class FrameGraph;
+        explicit Resources(const FrameGraph& graph_) : graph(graph_) {}
+
+        const FrameGraph& graph;
+    };
+
+    using SetupFunction = std::function<void(Builder&)>;
+    using ExecuteFunction = std::function<void(IRenderDevice&, const Resources&)>;
+
+    struct ResourceInfo
+    {
+        std::string name;
+        TextureDesc desc;
+        bool imported = false;
+        TextureHandle texture;          // imported textures only
+        uint32_t versions = 1;
+        // Positions in GetExecutionOrder(); Invalid when no live pass uses it
+        uint32_t firstUse = Invalid;
+        uint32_t lastUse = Invalid;
+        uint32_t physical = Invalid;    // index into GetPhysicalTextures()
+    };
+
+    struct PhysicalTexture
+    {
+        TextureDesc desc;
+        TextureHandle texture;          // set by Execute
+        std::vector<uint32_t> resources;    // in lifetime order
+    };
+
+    struct Stats
+    {
+        uint32_t passes = 0;
+        uint32_t culledPasses = 0;
+        uint32_t transientTextures = 0;     // used by live passes
+        uint32_t physicalTextures = 0;
+        uint64_t transientBytes = 0;        // without aliasing
+        uint64_t physicalBytes = 0;
+        uint32_t texturesCreated = 0;       // last Execute, pool misses
+        uint32_t pooledTextures = 0;        // alive in the pool
+    };
+
+    explicit FrameGraph(uint32_t maxIdleFrames = DefaultMaxIdleFrames);
+    ~FrameGraph();
+
+    FrameGraph(const FrameGraph&) = delete;
+    FrameGraph& operator=(const FrameGraph&) = delete;
+
+    void Init(IRenderDevice& device);
+    // Releases the pooled textures.
+    void Shutdown();
+
+    // Drops the passes and resources of the last frame; the pool stays.
+    void Reset();
+
+    // An empty handle stands for the back buffer, see SetRenderTarget.
+    FrameGraphResource Import(const std::string& name, TextureHandle texture, const TextureDesc& desc);
+    // Imports the back buffer as "BackBuffer", then binds and clears it on
+    // the device right away rather than in a pass: the game states draw
+    // during the program's Update, before Execute, and must land on top.
+    FrameGraphResource ImportBackBuffer(const TextureDesc& desc, const float clearColor[4]);
+    // Runs setup right away and returns the pass index.
+    uint32_t AddPass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute);
+    // Newest version of the named resource, or an empty handle.
+    FrameGraphResource Find(const std::string& name) const;
+
+    // Throws std::runtime_error when the passes depend on each other in a cycle.
+    void Compile();
+    // Compiles first if needed, then runs the live passes in order.
+    void Execute();
+
+    // Inspection, valid after Compile
+    uint32_t GetPassCount() const { return (uint32_t)passes.size(); }
+    const std::string& GetPassName(uint32_t pass) const { return passes[pass].name; }
+    bool IsCulled(uint32_t pass) const { return passes[pass].culled; }
+    const std::vector<uint32_t>& GetExecutionOrder() const { return order; }
+    const ResourceInfo& GetResourceInfo(FrameGraphResource resource) const;
+    uint32_t GetResourceCount() const { return (uint32_t)resources.size(); }
+    const ResourceInfo& GetResourceInfo(uint32_t index) const { return resources[index]; }
+    const std::vector<PhysicalTexture>& GetPhysicalTextures() const { return physicalTextures; }
+    const Stats& GetStats() const { return stats; }
+
+private:
+    struct Node
+    {
+        uint32_t resource = 0;
+        uint32_t producer = Invalid;    // pass that wrote this version
+        uint32_t next = Invalid;        // node of the following version
+        uint32_t readers = 0;           // live passes reading it, for culling
+    };
+
+    struct Pass
+    {
+        std::string name;
+        ExecuteFunction execute;
+        std::vector<uint32_t> reads;    // nodes, including the versions written over
+        std::vector<uint32_t> writes;   // nodes produced
+        bool sideEffect = false;
+        bool culled = false;
+    };
+
+    struct PooledTexture
+    {
+        TextureDesc desc;
+        TextureHandle texture;
+        uint64_t lastUsed = 0;
+        bool taken = false;
+    };
+
+    const Node& GetNode(FrameGraphResource resource) const;
+    void Cull();
+    void Sort();
+    void Alias();
+    TextureHandle Acquire(const TextureDesc& desc);
+
+    uint32_t maxIdleFrames;
+    IRenderDevice* device = nullptr;
+
+    std::vector<Pass> passes;
+    std::vector<ResourceInfo> resources;
+    std::vector<Node> nodes;
+    std::vector<uint32_t> latest;       // newest node per resource
+    bool compiled = false;
+
+    std::vector<uint32_t> order;
+    std::vector<PhysicalTexture> physicalTextures;
+    std::vector<PooledTexture> pool;
+    uint64_t frame = 0;
+    Stats stats;
+};
@@ -84,6 +84,22 @@ void GameObject::Draw(mat3<float> cameraMatrix)
     }
 }
 
+void GameObject::RecordDraw(const mat3<float>& cameraMatrix, SpriteDrawList& list)
+{
+    if (auto* spr = GetGOComponent<Sprite>())
+    {
+        spr->Record(cameraMatrix * GetMatrix(), list);
+    }
+}
+
+void GameObject::DrawImmediate(const mat3<float>& cameraMatrix)
+{
+    if (auto* col = GetGOComponent<Collision>())
+    {
+        col->Draw(cameraMatrix * GetMatrix());
+    }
+}
+
 // Transform getters
 const mat3<float>& GameObject::GetMatrix()
 {
@@ -123,6 +139,7 @@ void GameObject::SetPosition(vec2 newPosition)
 {
     position = newPosition;
     updateMatrix = true;
+    ++transformVersion;
 }
 
 bool GameObject::GetDestroyed()
@@ -151,6 +168,7 @@ void GameObject::UpdatePosition(vec2 adjustPosition)
     position.x += adjustPosition.x;
     position.y += adjustPosition.y;
     updateMatrix = true;
+    ++transformVersion;
 }
 
 void GameObject::SetVelocity(vec2 newVelocity)
@@ -168,18 +186,21 @@ void GameObject::SetScale(vec2 newScale)
 {
     scale = newScale;
     updateMatrix = true;
+    ++transformVersion;
 }
 
 void GameObject::SetRotation(double newRotationAmount)
 {
     rotation = newRotationAmount;
     updateMatrix = true;
+    ++transformVersion;
 }
 
 void GameObject::UpdateRotation(double newRotationAmount)
 {
     rotation += newRotationAmount;
     updateMatrix = true;
+    ++transformVersion;
 }
 
 // Collision
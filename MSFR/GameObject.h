@@ -6,6 +6,7 @@
 enum class GameObjectType;
 
 class Component;
+class SpriteDrawList;
 
 class GameObject
 {
@@ -18,8 +19,15 @@ public:
 
 	virtual void Update(double dt);
 	virtual void Draw(mat3<float> cameraMatrix);
+	// Draw in two parts for GameObjectManager's parallel recording: RecordDraw
+	// only fills list and may run on a worker thread, DrawImmediate issues the
+	// rest (debug shapes) on the render thread. Override both along with Draw.
+	virtual void RecordDraw(const mat3<float>& cameraMatrix, SpriteDrawList& list);
+	virtual void DrawImmediate(const mat3<float>& cameraMatrix);
 
 	const mat3<float>& GetMatrix();
+	// Bumped whenever position, rotation or scale change (culling bounds cache)
+	unsigned GetTransformVersion() const { return transformVersion; }
 	const vec2& GetPosition() const;
 	const vec2& GetVelocity() const;
 	const vec2& GetScale() const;
@@ -77,6 +85,7 @@ protected:
 private:
 	mat3<float> objectMatrix;
 	bool updateMatrix;
+	unsigned transformVersion = 0;
 
 	double rotation;
 	vec2 scale;
@@ -1,20 +1,63 @@
 #pragma once
 #include <list> //gameObjects
+#include <unordered_map> //cullEntries
+#include <utility> //pair
+#include <vector> //visible lists
 #include "Component.h" //Component inheritance
 #include "mat3.h"
+#include "SpatialGrid.h" //culling
+#include "SpriteBatch.h" //SpriteDrawList
 
 class GameObject;
 
 class GameObjectManager : public Component
 {
 public:
+	struct CullStats
+	{
+		unsigned visible = 0;
+		unsigned culled = 0;
+	};
+
 	~GameObjectManager();
 	void Add(GameObject* obj);
 	void Update(double dt) override;
+	// Large visible sets record their sprites on Engine's worker pool, one list
+	// per contiguous slice of the draw order, merged back in that order; the
+	// batch sees the same draws in the same order as the serial path.
 	void DrawAll(mat3<float>& cameraMatrix);
 	void CollideTest();
 	const std::list<GameObject*>& Objects();
 
+	// Sprite and collision shape bounds are cached and refreshed by DrawAll when
+	// the transform has changed. Call this when they change some other way
+	// (e.g. a new sprite).
+	void InvalidateBounds(GameObject* obj);
+	const CullStats& GetCullStats() const { return cullStats; }
+
 private:
+	struct CullEntry
+	{
+		unsigned order = 0; //Add order, which is also draw order
+		unsigned transformVersion = 0;
+		unsigned gridHandle = SpatialGrid::Invalid;
+		bool unbounded = false; //no sprite: always drawn
+		bool dirty = true;
+	};
+
+	void RefreshBounds(GameObject* obj, CullEntry& entry);
+	void RecordParallel(const mat3<float>& cameraMatrix);
+	void RemoveCullEntry(GameObject* obj);
+
 	std::list<GameObject*> gameObjects;
-};
\ No newline at end of file
+
+	SpatialGrid grid;
+	std::unordered_map<GameObject*, CullEntry> cullEntries;
+	std::vector<GameObject*> gridObjects; //grid handle -> object
+	std::vector<GameObject*> unbounded;
+	std::vector<unsigned> visibleHandles;
+	std::vector<std::pair<unsigned, GameObject*>> visible;
+	std::vector<SpriteDrawList> drawLists; //one per recording slice, reused
+	unsigned nextOrder = 0;
+	CullStats cullStats;
+};
@@ -1,7 +1,20 @@
 #include "GameObjectManager.h" //GameObjectManager
 #include "GameObject.h" //objects
 #include "Engine.h" //Getlogger
-#include "Collision.h" //CollideTest
+#include "Collision.h" //CollideTest, GetDrawBounds
+#include "Sprite.h" //GetLocalBounds
+
+#include <algorithm> //sort
+#include <cmath> //abs
+
+namespace
+{
+	// Fewer visible objects than this record serially; waking workers costs more
+	constexpr size_t MinParallelDraws = 1024;
+	constexpr size_t MinDrawsPerSlice = 256;
+	// Slices per thread, so uneven object costs still balance out
+	constexpr unsigned SlicesPerThread = 4;
+}
 
 GameObjectManager::~GameObjectManager()
 {
@@ -11,11 +24,19 @@ GameObjectManager::~GameObjectManager()
 		objects = nullptr;
 	}
 	gameObjects.clear();
+	cullEntries.clear();
+	gridObjects.clear();
+	unbounded.clear();
+	grid.Clear();
 }
 
 void GameObjectManager::Add(GameObject* obj)
 {
 	gameObjects.push_back(obj);
+
+	CullEntry entry;
+	entry.order = nextOrder++;
+	cullEntries[obj] = entry;
 }
 
 void GameObjectManager::Update(double dt)
@@ -33,16 +54,218 @@ void GameObjectManager::Update(double dt)
 	for (GameObject* destroyObject : DestroyList)
 	{
 		gameObjects.remove(destroyObject);
+		RemoveCullEntry(destroyObject);
 		delete destroyObject;
 	}
 }
 
 void GameObjectManager::DrawAll(mat3<float>& cameraMatrix)
 {
-	for (GameObject* objects : gameObjects)
+	// Checked here rather than in Update: collision resolution and state code
+	// move objects after Update, and stale bounds would pop at the screen edge
+	for (auto& [object, entry] : cullEntries)
+	{
+		if (entry.dirty || entry.transformVersion != object->GetTransformVersion())
+		{
+			RefreshBounds(object, entry);
+		}
+	}
+
+	// Camera view in world space: the screen rect through the inverse camera
+	const float a = cameraMatrix.column0.x, b = cameraMatrix.column0.y;
+	const float c = cameraMatrix.column1.x, d = cameraMatrix.column1.y;
+	const float tx = cameraMatrix.column2.x, ty = cameraMatrix.column2.y;
+	const float det = a * d - b * c;
+	const float screenW = static_cast<float>(Engine::GetViewportWidth());
+	const float screenH = static_cast<float>(Engine::GetViewportHeight());
+
+	Aabb view{ -1.0e30f, -1.0e30f, 1.0e30f, 1.0e30f };
+	if (std::abs(det) > 1.0e-12f)
+	{
+		const float corners[4][2] = { { 0, 0 }, { screenW, 0 }, { 0, screenH }, { screenW, screenH } };
+		view = { 1.0e30f, 1.0e30f, -1.0e30f, -1.0e30f };
+		for (const auto& corner : corners)
+		{
+			const float sx = corner[0] - tx;
+			const float sy = corner[1] - ty;
+			const float wx = (d * sx - c * sy) / det;
+			const float wy = (-b * sx + a * sy) / det;
+			view.minX = std::min(view.minX, wx);
+			view.minY = std::min(view.minY, wy);
+			view.maxX = std::max(view.maxX, wx);
+			view.maxY = std::max(view.maxY, wy);
+		}
+	}
+
+	// Tiles, then static scenery, go first so every object draws over them
+	const float worldToScreen[6] = { a, b, c, d, tx, ty };
+	Engine::GetTilemap().Draw(worldToScreen, view, screenW, screenH);
+	Engine::GetStaticSpriteBatch().Draw(worldToScreen, view, screenW, screenH);
+
+	visibleHandles.clear();
+	grid.Query(view, visibleHandles);
+
+	visible.clear();
+	for (unsigned handle : visibleHandles)
+	{
+		GameObject* object = gridObjects[handle];
+		visible.push_back({ cullEntries[object].order, object });
+	}
+	for (GameObject* object : unbounded)
+	{
+		visible.push_back({ cullEntries[object].order, object });
+	}
+	std::sort(visible.begin(), visible.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+	if (visible.size() >= MinParallelDraws && Engine::GetWorkerPool().GetThreadCount() > 1)
+	{
+		RecordParallel(cameraMatrix);
+	}
+	else
+	{
+		for (const auto& [order, objects] : visible)
+		{
+			objects->Draw(cameraMatrix);
+		}
+	}
+	Engine::GetSpriteBatch().Flush();
+
+	cullStats.visible = static_cast<unsigned>(visible.size());
+	cullStats.culled = static_cast<unsigned>(gameObjects.size() - visible.size());
+}
+
+void GameObjectManager::RecordParallel(const mat3<float>& cameraMatrix)
+{
+	WorkerPool& pool = Engine::GetWorkerPool();
+	const size_t count = visible.size();
+	const unsigned slices = static_cast<unsigned>(std::min<size_t>(
+		static_cast<size_t>(pool.GetThreadCount()) * SlicesPerThread, count / MinDrawsPerSlice));
+	if (drawLists.size() < slices)
+	{
+		drawLists.resize(slices);
+	}
+
+	pool.Run(slices, [&](uint32_t slice)
+	{
+		SpriteDrawList& list = drawLists[slice];
+		list.Clear();
+		const size_t begin = count * slice / slices;
+		const size_t end = count * (slice + 1) / slices;
+		for (size_t i = begin; i < end; ++i)
+		{
+			visible[i].second->RecordDraw(cameraMatrix, list);
+		}
+	});
+
+	SpriteBatch& batch = Engine::GetSpriteBatch();
+	for (unsigned slice = 0; slice < slices; ++slice)
+	{
+		for (const std::string& error : drawLists[slice].GetErrors())
+		{
+			Engine::GetLogger().LogError(error);
+		}
+		batch.Submit(drawLists[slice]);
+	}
+	// Device work stays on this thread; it lands before the batch flushes,
+	// just as it does on the serial path
+	for (const auto& [order, objects] : visible)
+	{
+		objects->DrawImmediate(cameraMatrix);
+	}
+}
+
+void GameObjectManager::InvalidateBounds(GameObject* obj)
+{
+	auto it = cullEntries.find(obj);
+	if (it != cullEntries.end())
+	{
+		it->second.dirty = true;
+	}
+}
+
+void GameObjectManager::RefreshBounds(GameObject* obj, CullEntry& entry)
+{
+	entry.dirty = false;
+	entry.transformVersion = obj->GetTransformVersion();
+
+	Sprite* sprite = obj->GetGOComponent<Sprite>();
+	if (sprite == nullptr)
+	{
+		if (entry.gridHandle != SpatialGrid::Invalid)
+		{
+			grid.Remove(entry.gridHandle);
+			gridObjects[entry.gridHandle] = nullptr;
+			entry.gridHandle = SpatialGrid::Invalid;
+		}
+		if (entry.unbounded == false)
+		{
+			unbounded.push_back(obj);
+			entry.unbounded = true;
+		}
+		return;
+	}
+	if (entry.unbounded == true)
+	{
+		unbounded.erase(std::find(unbounded.begin(), unbounded.end(), obj));
+		entry.unbounded = false;
+	}
+
+	vec2 lo, hi;
+	sprite->GetLocalBounds(lo, hi);
+	const mat3<float>& m = obj->GetMatrix();
+	const float corners[4][2] = { { lo.x, lo.y }, { hi.x, lo.y }, { lo.x, hi.y }, { hi.x, hi.y } };
+
+	Aabb bounds{ 1.0e30f, 1.0e30f, -1.0e30f, -1.0e30f };
+	for (const auto& corner : corners)
+	{
+		const float x = m.column0.x * corner[0] + m.column1.x * corner[1] + m.column2.x;
+		const float y = m.column0.y * corner[0] + m.column1.y * corner[1] + m.column2.y;
+		bounds.minX = std::min(bounds.minX, x);
+		bounds.minY = std::min(bounds.minY, y);
+		bounds.maxX = std::max(bounds.maxX, x);
+		bounds.maxY = std::max(bounds.maxY, y);
+	}
+	if (Collision* collision = obj->GetGOComponent<Collision>())
+	{
+		const rect3 shape = collision->GetDrawBounds();
+		bounds.minX = std::min(bounds.minX, shape.Left());
+		bounds.minY = std::min(bounds.minY, shape.Bottom());
+		bounds.maxX = std::max(bounds.maxX, shape.Right());
+		bounds.maxY = std::max(bounds.maxY, shape.Top());
+	}
+
+	if (entry.gridHandle == SpatialGrid::Invalid)
+	{
+		entry.gridHandle = grid.Insert(bounds);
+		if (gridObjects.size() <= entry.gridHandle)
+		{
+			gridObjects.resize(entry.gridHandle + 1, nullptr);
+		}
+		gridObjects[entry.gridHandle] = obj;
+	}
+	else
+	{
+		grid.Update(entry.gridHandle, bounds);
+	}
+}
+
+void GameObjectManager::RemoveCullEntry(GameObject* obj)
+{
+	auto it = cullEntries.find(obj);
+	if (it == cullEntries.end())
+	{
+		return;
+	}
+	if (it->second.gridHandle != SpatialGrid::Invalid)
+	{
+		grid.Remove(it->second.gridHandle);
+		gridObjects[it->second.gridHandle] = nullptr;
+	}
+	if (it->second.unbounded == true)
 	{
-		objects->Draw(cameraMatrix);
+		unbounded.erase(std::find(unbounded.begin(), unbounded.end(), obj));
 	}
+	cullEntries.erase(it);
 }
 
 void GameObjectManager::CollideTest()
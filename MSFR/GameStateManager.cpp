@@ -60,8 +60,11 @@ void GameStateManager::Update(double dt)
 
 	case State::UNLOAD:
 		Engine::GetLogger().LogEvent("Unload " + currGameState->GetName());
-		Engine::GetTextureManager().Unload();
 		currGameState->Unload();
+		// Its textures stay cached for the next state, within the budget, once
+		// the sprite definitions nothing uses now have given theirs back
+		Engine::GetSpriteDefinitions().Trim();
+		Engine::GetTextureManager().Trim();
 		if (nextGameState == nullptr)
 		{
 			state = State::SHUTDOWN;
@@ -16,7 +16,7 @@ public:
 	std::string GetName() { return currGameState->GetName(); };
 
 	template<typename T>
-	T* GetGSComponent() { return currGameState->GetGSComponent<T>(); }
+	T* GetGSComponent() { return currGameState != nullptr ? currGameState->GetGSComponent<T>() : nullptr; }
 
 private:
 	enum class State
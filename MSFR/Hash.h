@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// 64-bit FNV-1a. Stable across runs and platforms, so it may key on-disk data.
+constexpr uint64_t HashSeed = 0xCBF29CE484222325ull;
+
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = HashSeed) noexcept
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= p[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+// Strings are length-prefixed so consecutive fields cannot run into each other.
+inline uint64_t HashString(std::string_view s, uint64_t hash = HashSeed) noexcept
+{
+    const uint64_t length = s.size();
+    hash = HashBytes(&length, sizeof(length), hash);
+    return HashBytes(s.data(), s.size(), hash);
+}
+
+template <typename T>
+inline uint64_t HashValue(const T& value, uint64_t hash = HashSeed) noexcept
+{
+    return HashBytes(&value, sizeof(value), hash);
+}
@@ -0,0 +1,1044 @@
+#include "ImageCodec.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include "JpegCodec.h"
+
+#if (defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)) && !defined(MSFR_IMAGE_NO_SSE2)
+#define MSFR_IMAGE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // ---------------------------------------------------------------- inflate
+
+    constexpr uint16_t LengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    constexpr uint8_t LengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    constexpr uint16_t DistBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    constexpr uint8_t DistExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t* data_, size_t size_) : data(data_), size(size_) {}
+
+        // Returns false once the stream is exhausted; missing bits read as zero
+        bool Need(uint32_t n)
+        {
+            while (count < n)
+            {
+                if (pos >= size)
+                {
+                    if (++overrun > 8) return false;
+                    count += 8;
+                    continue;
+                }
+                bits |= (uint64_t)data[pos++] << count;
+                count += 8;
+            }
+            return true;
+        }
+        uint32_t Peek(uint32_t n) const { return (uint32_t)(bits & ((uint64_t(1) << n) - 1)); }
+        void Drop(uint32_t n) { bits >>= n; count -= n; }
+        uint32_t Read(uint32_t n)
+        {
+            if (n == 0) return 0;
+            Need(n);
+            const uint32_t v = Peek(n);
+            Drop(n);
+            return v;
+        }
+        void AlignToByte() { Drop(count & 7); }
+        bool Overrun() const { return overrun > 0 && count < overrun * 8u; }
+
+        const uint8_t* data;
+        size_t size;
+        size_t pos = 0;
+        uint64_t bits = 0;
+        uint32_t count = 0;
+        uint32_t overrun = 0;
+    };
+
+    // Canonical Huffman table with a direct lookup for codes up to FastBits
+    // and a per-length walk for the rest.
+    struct Huffman
+    {
+        static constexpr uint32_t FastBits = 10;
+
+        uint16_t fast[1 << FastBits];    // (symbol << 4) | length, 0 = slow path
+        uint16_t counts[16];
+        uint16_t symbols[320];
+
+        bool Build(const uint8_t* lengths, uint32_t n)
+        {
+            std::memset(counts, 0, sizeof(counts));
+            for (uint32_t i = 0; i < n; ++i) ++counts[lengths[i]];
+            counts[0] = 0;
+
+            int left = 1;
+            for (int len = 1; len < 16; ++len)
+            {
+                left <<= 1;
+                left -= counts[len];
+                if (left < 0) return false;
+            }
+
+            uint16_t offsets[16];
+            offsets[1] = 0;
+            for (int len = 1; len < 15; ++len) offsets[len + 1] = (uint16_t)(offsets[len] + counts[len]);
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                if (lengths[i]) symbols[offsets[lengths[i]]++] = (uint16_t)i;
+            }
+
+            std::memset(fast, 0, sizeof(fast));
+            uint32_t code = 0;
+            uint32_t index = 0;
+            for (uint32_t len = 1; len <= FastBits; ++len)
+            {
+                for (uint32_t k = 0; k < counts[len]; ++k, ++code, ++index)
+                {
+                    // Codes are stored MSB-first; the bit reader is LSB-first
+                    uint32_t reversed = 0;
+                    for (uint32_t b = 0; b < len; ++b) reversed |= ((code >> b) & 1) << (len - 1 - b);
+                    for (uint32_t fill = reversed; fill < (1u << FastBits); fill += 1u << len)
+                    {
+                        fast[fill] = (uint16_t)((symbols[index] << 4) | len);
+                    }
+                }
+                code <<= 1;
+            }
+            return true;
+        }
+
+        int Decode(BitReader& br) const
+        {
+            if (!br.Need(15)) return -1;
+            const uint16_t entry = fast[br.Peek(FastBits)];
+            if (entry)
+            {
+                br.Drop(entry & 15);
+                return entry >> 4;
+            }
+
+            // Slow path, one bit at a time (puff-style)
+            int code = 0, first = 0, index = 0;
+            for (int len = 1; len < 16; ++len)
+            {
+                code |= (int)br.Read(1);
+                const int count = counts[len];
+                if (code - count < first) return symbols[index + (code - first)];
+                index += count;
+                first += count;
+                first <<= 1;
+                code <<= 1;
+            }
+            return -1;
+        }
+    };
+
+    bool InflateBlock(BitReader& br, std::vector<uint8_t>& out, const Huffman& lit, const Huffman& dist)
+    {
+        for (;;)
+        {
+            const int sym = lit.Decode(br);
+            if (sym < 0 || br.Overrun()) return false;
+            if (sym < 256)
+            {
+                out.push_back((uint8_t)sym);
+                continue;
+            }
+            if (sym == 256) return true;
+
+            const int li = sym - 257;
+            if (li >= 29) return false;
+            const uint32_t length = LengthBase[li] + br.Read(LengthExtra[li]);
+
+            const int di = dist.Decode(br);
+            if (di < 0 || di >= 30) return false;
+            const uint32_t distance = DistBase[di] + br.Read(DistExtra[di]);
+            if (distance > out.size()) return false;
+
+            const size_t from = out.size() - distance;
+            out.resize(out.size() + length);
+            uint8_t* dst = out.data() + out.size() - length;
+            const uint8_t* src = out.data() + from;
+            if (distance >= length)
+            {
+                std::memcpy(dst, src, length);
+            }
+            else
+            {
+                for (uint32_t i = 0; i < length; ++i) dst[i] = src[i];
+            }
+        }
+    }
+
+    bool InflateRaw(BitReader& br, std::vector<uint8_t>& out)
+    {
+        bool last = false;
+        while (!last)
+        {
+            last = br.Read(1) != 0;
+            const uint32_t type = br.Read(2);
+
+            if (type == 0)
+            {
+                br.AlignToByte();
+                const uint32_t len = br.Read(16);
+                const uint32_t nlen = br.Read(16);
+                if ((len ^ 0xFFFF) != nlen) return false;
+
+                // Drain whole bytes still held in the bit buffer first
+                uint32_t remaining = len;
+                while (remaining && br.count >= 8)
+                {
+                    out.push_back((uint8_t)br.Read(8));
+                    --remaining;
+                }
+                if (br.pos + remaining > br.size) return false;
+                out.insert(out.end(), br.data + br.pos, br.data + br.pos + remaining);
+                br.pos += remaining;
+            }
+            else if (type == 1)
+            {
+                static const struct Fixed
+                {
+                    Huffman lit, dist;
+                    Fixed()
+                    {
+                        uint8_t lengths[288];
+                        std::memset(lengths, 8, 144);
+                        std::memset(lengths + 144, 9, 112);
+                        std::memset(lengths + 256, 7, 24);
+                        std::memset(lengths + 280, 8, 8);
+                        lit.Build(lengths, 288);
+                        std::memset(lengths, 5, 30);
+                        dist.Build(lengths, 30);
+                    }
+                } fixed;
+                if (!InflateBlock(br, out, fixed.lit, fixed.dist)) return false;
+            }
+            else if (type == 2)
+            {
+                const uint32_t hlit = br.Read(5) + 257;
+                const uint32_t hdist = br.Read(5) + 1;
+                const uint32_t hclen = br.Read(4) + 4;
+                if (hlit > 286 || hdist > 30) return false;
+
+                static constexpr uint8_t Order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+                uint8_t codeLengths[19] = {};
+                for (uint32_t i = 0; i < hclen; ++i) codeLengths[Order[i]] = (uint8_t)br.Read(3);
+
+                Huffman lengthCode;
+                if (!lengthCode.Build(codeLengths, 19)) return false;
+
+                uint8_t lengths[286 + 30] = {};
+                uint32_t n = 0;
+                while (n < hlit + hdist)
+                {
+                    const int sym = lengthCode.Decode(br);
+                    if (sym < 0) return false;
+                    if (sym < 16)
+                    {
+                        lengths[n++] = (uint8_t)sym;
+                        continue;
+                    }
+                    uint8_t value = 0;
+                    uint32_t repeat = 0;
+                    if (sym == 16)
+                    {
+                        if (n == 0) return false;
+                        value = lengths[n - 1];
+                        repeat = 3 + br.Read(2);
+                    }
+                    else if (sym == 17) repeat = 3 + br.Read(3);
+                    else repeat = 11 + br.Read(7);
+                    if (n + repeat > hlit + hdist) return false;
+                    while (repeat--) lengths[n++] = value;
+                }
+                if (lengths[256] == 0) return false;
+
+                Huffman lit, dist;
+                if (!lit.Build(lengths, hlit) || !dist.Build(lengths + hlit, hdist)) return false;
+                if (!InflateBlock(br, out, lit, dist)) return false;
+            }
+            else
+            {
+                return false;
+            }
+            if (br.Overrun()) return false;
+        }
+        return true;
+    }
+
+    // ---------------------------------------------------------------- deflate
+
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::vector<uint8_t>& out_) : out(out_) {}
+
+        void Write(uint32_t value, uint32_t n)
+        {
+            bits |= (uint64_t)value << count;
+            count += n;
+            while (count >= 8)
+            {
+                out.push_back((uint8_t)bits);
+                bits >>= 8;
+                count -= 8;
+            }
+        }
+        // Huffman codes go out MSB-first
+        void WriteCode(uint32_t code, uint32_t n)
+        {
+            uint32_t reversed = 0;
+            for (uint32_t b = 0; b < n; ++b) reversed |= ((code >> b) & 1) << (n - 1 - b);
+            Write(reversed, n);
+        }
+        void Flush()
+        {
+            if (count) out.push_back((uint8_t)bits);
+            bits = 0;
+            count = 0;
+        }
+
+    private:
+        std::vector<uint8_t>& out;
+        uint64_t bits = 0;
+        uint32_t count = 0;
+    };
+
+    void WriteFixedLiteral(BitWriter& bw, uint32_t sym)
+    {
+        if (sym < 144) bw.WriteCode(0x30 + sym, 8);
+        else if (sym < 256) bw.WriteCode(0x190 + sym - 144, 9);
+        else if (sym < 280) bw.WriteCode(sym - 256, 7);
+        else bw.WriteCode(0xC0 + sym - 280, 8);
+    }
+
+    void WriteFixedMatch(BitWriter& bw, uint32_t length, uint32_t distance)
+    {
+        int li = 28;
+        while (LengthBase[li] > length) --li;
+        WriteFixedLiteral(bw, 257 + li);
+        bw.Write(length - LengthBase[li], LengthExtra[li]);
+
+        int di = 29;
+        while (DistBase[di] > distance) --di;
+        bw.WriteCode(di, 5);
+        bw.Write(distance - DistBase[di], DistExtra[di]);
+    }
+
+    void DeflateFixed(const uint8_t* data, size_t size, std::vector<uint8_t>& out)
+    {
+        constexpr uint32_t HashBits = 15;
+        constexpr uint32_t Window = 32768;
+        constexpr uint32_t MaxChain = 16;
+
+        std::vector<int32_t> head(1u << HashBits, -1);
+        std::vector<int32_t> prev(Window, -1);
+        auto hash = [&](size_t i) { return ((data[i] << 10) ^ (data[i + 1] << 5) ^ data[i + 2]) & ((1u << HashBits) - 1); };
+
+        BitWriter bw(out);
+        bw.Write(1, 1);     // final block
+        bw.Write(1, 2);     // fixed Huffman
+
+        size_t i = 0;
+        while (i < size)
+        {
+            uint32_t bestLen = 0, bestDist = 0;
+            if (i + 3 <= size)
+            {
+                const uint32_t h = hash(i);
+                int32_t candidate = head[h];
+                for (uint32_t chain = 0; candidate >= 0 && chain < MaxChain; ++chain)
+                {
+                    const size_t dist = i - (size_t)candidate;
+                    if (dist > Window - 1) break;
+                    const size_t maxLen = std::min<size_t>(258, size - i);
+                    uint32_t len = 0;
+                    while (len < maxLen && data[candidate + len] == data[i + len]) ++len;
+                    if (len > bestLen)
+                    {
+                        bestLen = len;
+                        bestDist = (uint32_t)dist;
+                        if (len == maxLen) break;
+                    }
+                    candidate = prev[candidate & (Window - 1)];
+                }
+            }
+
+            const size_t step = bestLen >= 3 ? bestLen : 1;
+            if (bestLen >= 3) WriteFixedMatch(bw, bestLen, bestDist);
+            else WriteFixedLiteral(bw, data[i]);
+
+            for (size_t k = 0; k < step; ++k, ++i)
+            {
+                if (i + 3 <= size)
+                {
+                    const uint32_t h = hash(i);
+                    prev[i & (Window - 1)] = head[h];
+                    head[h] = (int32_t)i;
+                }
+            }
+        }
+        WriteFixedLiteral(bw, 256);
+        bw.Flush();
+    }
+
+    void DeflateStored(const uint8_t* data, size_t size, std::vector<uint8_t>& out)
+    {
+        size_t pos = 0;
+        do
+        {
+            const uint32_t len = (uint32_t)std::min<size_t>(65535, size - pos);
+            out.push_back(pos + len == size ? 1 : 0);
+            out.push_back((uint8_t)len);
+            out.push_back((uint8_t)(len >> 8));
+            out.push_back((uint8_t)~len);
+            out.push_back((uint8_t)(~len >> 8));
+            out.insert(out.end(), data + pos, data + pos + len);
+            pos += len;
+        } while (pos < size);
+    }
+
+    uint32_t Adler32(const uint8_t* data, size_t size)
+    {
+        uint32_t a = 1, b = 0;
+        while (size)
+        {
+            const size_t n = std::min<size_t>(size, 5552);
+            for (size_t i = 0; i < n; ++i)
+            {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+            data += n;
+            size -= n;
+        }
+        return (b << 16) | a;
+    }
+
+    uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+    {
+        static const struct Table
+        {
+            uint32_t v[256];
+            Table()
+            {
+                for (uint32_t n = 0; n < 256; ++n)
+                {
+                    uint32_t c = n;
+                    for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                    v[n] = c;
+                }
+            }
+        } table;
+
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i) crc = table.v[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    // ---------------------------------------------------------------- PNG
+
+    constexpr uint8_t PngSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+    uint32_t ReadBE32(const uint8_t* p)
+    {
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+    }
+
+    void WriteBE32(std::vector<uint8_t>& out, uint32_t v)
+    {
+        out.push_back((uint8_t)(v >> 24));
+        out.push_back((uint8_t)(v >> 16));
+        out.push_back((uint8_t)(v >> 8));
+        out.push_back((uint8_t)v);
+    }
+
+    bool Fail(std::string* error, const char* message)
+    {
+        if (error) *error = message;
+        return false;
+    }
+
+    uint8_t Paeth(int a, int b, int c)
+    {
+        const int p = a + b - c;
+        const int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+        if (pa <= pb && pa <= pc) return (uint8_t)a;
+        return (uint8_t)(pb <= pc ? b : c);
+    }
+
+    // Unfiltering runs one pixel at a time for Sub, Avg and Paeth, since each
+    // byte depends on the reconstructed one to its left; SSE2 handles a whole
+    // 3- or 4-byte pixel per step and Up sixteen bytes per step.
+#if MSFR_IMAGE_SSE2
+    __m128i LoadPixel(const uint8_t* p)
+    {
+        int32_t v;
+        std::memcpy(&v, p, 4);
+        return _mm_cvtsi32_si128(v);
+    }
+
+    void StorePixel(uint8_t* p, __m128i v, uint32_t bpp)
+    {
+        const int32_t bits = _mm_cvtsi128_si32(v);
+        std::memcpy(p, &bits, bpp);
+    }
+
+    __m128i Select(__m128i mask, __m128i a, __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+
+    __m128i Abs16(__m128i v)
+    {
+        return _mm_max_epi16(v, _mm_sub_epi16(_mm_setzero_si128(), v));
+    }
+#endif
+
+    // The SIMD loops load four bytes per pixel, so they stop one pixel early
+    // for bpp 3 and leave the rest to the scalar tails
+    void UnfilterSub(const uint8_t* src, uint8_t* dst, size_t stride, uint32_t bpp)
+    {
+        size_t i = 0;
+#if MSFR_IMAGE_SSE2
+        if (bpp == 3 || bpp == 4)
+        {
+            __m128i left = _mm_setzero_si128();
+            for (; i + 4 <= stride; i += bpp)
+            {
+                left = _mm_add_epi8(LoadPixel(src + i), left);
+                StorePixel(dst + i, left, bpp);
+            }
+        }
+#endif
+        for (; i < stride; ++i) dst[i] = uint8_t(src[i] + (i >= bpp ? dst[i - bpp] : 0));
+    }
+
+    void UnfilterUp(const uint8_t* src, uint8_t* dst, const uint8_t* prior, size_t stride)
+    {
+        size_t i = 0;
+#if MSFR_IMAGE_SSE2
+        for (; i + 16 <= stride; i += 16)
+        {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i up = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prior + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi8(x, up));
+        }
+#endif
+        for (; i < stride; ++i) dst[i] = uint8_t(src[i] + prior[i]);
+    }
+
+    void UnfilterAvg(const uint8_t* src, uint8_t* dst, const uint8_t* prior, size_t stride, uint32_t bpp)
+    {
+        size_t i = 0;
+#if MSFR_IMAGE_SSE2
+        if (prior && (bpp == 3 || bpp == 4))
+        {
+            // pavgb rounds up; the spec rounds down
+            const __m128i one = _mm_set1_epi8(1);
+            __m128i left = _mm_setzero_si128();
+            for (; i + 4 <= stride; i += bpp)
+            {
+                const __m128i up = LoadPixel(prior + i);
+                const __m128i avg = _mm_sub_epi8(_mm_avg_epu8(left, up), _mm_and_si128(_mm_xor_si128(left, up), one));
+                left = _mm_add_epi8(LoadPixel(src + i), avg);
+                StorePixel(dst + i, left, bpp);
+            }
+        }
+#endif
+        for (; i < stride; ++i)
+        {
+            const int left = i >= bpp ? dst[i - bpp] : 0;
+            const int up = prior ? prior[i] : 0;
+            dst[i] = uint8_t(src[i] + ((left + up) >> 1));
+        }
+    }
+
+    void UnfilterPaeth(const uint8_t* src, uint8_t* dst, const uint8_t* prior, size_t stride, uint32_t bpp)
+    {
+        size_t i = 0;
+#if MSFR_IMAGE_SSE2
+        if (bpp == 3 || bpp == 4)
+        {
+            // Predictor distances in 16-bit lanes; ties prefer left, then up
+            const __m128i zero = _mm_setzero_si128();
+            __m128i a = zero, c = zero;
+            for (; i + 4 <= stride; i += bpp)
+            {
+                const __m128i b = _mm_unpacklo_epi8(LoadPixel(prior + i), zero);
+                const __m128i pa = _mm_sub_epi16(b, c);
+                const __m128i pb = _mm_sub_epi16(a, c);
+                const __m128i pc = Abs16(_mm_add_epi16(pa, pb));
+                const __m128i absA = Abs16(pa), absB = Abs16(pb);
+                const __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(absA, absB));
+                const __m128i nearest = Select(_mm_cmpeq_epi16(smallest, absA), a,
+                    Select(_mm_cmpeq_epi16(smallest, absB), b, c));
+                const __m128i x = _mm_add_epi8(LoadPixel(src + i), _mm_packus_epi16(nearest, nearest));
+                StorePixel(dst + i, x, bpp);
+                a = _mm_unpacklo_epi8(x, zero);
+                c = b;
+            }
+        }
+#endif
+        for (; i < stride; ++i)
+        {
+            const int left = i >= bpp ? dst[i - bpp] : 0;
+            const int upLeft = i >= bpp ? prior[i - bpp] : 0;
+            dst[i] = uint8_t(src[i] + Paeth(left, prior[i], upLeft));
+        }
+    }
+
+    // Reverses one scanline's filter from src into dst, which may be the same
+    // memory; prior is the previous reconstructed scanline, null for the first
+    bool UnfilterRow(uint8_t filter, const uint8_t* src, uint8_t* dst, const uint8_t* prior, size_t stride, uint32_t bpp)
+    {
+        if (!prior)
+        {
+            // Above the image is all zero: Up is None and Paeth is Sub
+            if (filter == 2) filter = 0;
+            else if (filter == 4) filter = 1;
+        }
+        switch (filter)
+        {
+        case 0:
+            if (dst != src) std::memcpy(dst, src, stride);
+            return true;
+        case 1:
+            UnfilterSub(src, dst, stride, bpp);
+            return true;
+        case 2:
+            UnfilterUp(src, dst, prior, stride);
+            return true;
+        case 3:
+            UnfilterAvg(src, dst, prior, stride, bpp);
+            return true;
+        case 4:
+            UnfilterPaeth(src, dst, prior, stride, bpp);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool Unfilter(uint8_t* rows, uint32_t height, size_t stride, uint32_t bpp)
+    {
+        const uint8_t* prior = nullptr;
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            uint8_t* line = rows + y * (stride + 1);
+            if (!UnfilterRow(line[0], line + 1, line + 1, prior, stride, bpp)) return false;
+            prior = line + 1;
+        }
+        return true;
+    }
+
+    struct PngHeader
+    {
+        uint32_t width = 0, height = 0;
+        uint8_t depth = 0, colorType = 0, interlace = 0;
+        uint32_t channels = 0;
+        uint8_t palette[256][4] = {};
+        uint32_t paletteSize = 0;
+        bool hasColorKey = false;
+        uint16_t colorKey[3] = {};
+    };
+
+    uint32_t SampleAt(const uint8_t* row, uint32_t index, uint32_t depth)
+    {
+        switch (depth)
+        {
+        case 1: return (row[index >> 3] >> (7 - (index & 7))) & 1;
+        case 2: return (row[index >> 2] >> (6 - 2 * (index & 3))) & 3;
+        case 4: return (row[index >> 1] >> (4 - 4 * (index & 1))) & 15;
+        case 8: return row[index];
+        default: return (uint32_t(row[index * 2]) << 8) | row[index * 2 + 1];
+        }
+    }
+
+    // Writes one unfiltered scanline into RGBA8 pixels [x0, x0 + dx * n)
+    void ExpandRow(const PngHeader& h, const uint8_t* src, uint32_t n, uint8_t* dst, uint32_t dx)
+    {
+        if (h.depth == 8 && h.colorType == 6)
+        {
+            for (uint32_t x = 0; x < n; ++x, src += 4, dst += dx * 4) std::memcpy(dst, src, 4);
+            return;
+        }
+        if (h.depth == 8 && h.colorType == 2 && !h.hasColorKey)
+        {
+            for (uint32_t x = 0; x < n; ++x, src += 3, dst += dx * 4)
+            {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+                dst[3] = 255;
+            }
+            return;
+        }
+
+        const uint32_t maxValue = (1u << h.depth) - 1;
+        auto to8 = [&](uint32_t v) -> uint8_t
+        {
+            if (h.depth == 8) return (uint8_t)v;
+            if (h.depth == 16) return (uint8_t)(v >> 8);
+            return (uint8_t)(v * 255 / maxValue);
+        };
+
+        for (uint32_t x = 0; x < n; ++x, dst += dx * 4)
+        {
+            const uint32_t base = x * h.channels;
+            switch (h.colorType)
+            {
+            case 0:
+            {
+                const uint32_t g = SampleAt(src, base, h.depth);
+                dst[0] = dst[1] = dst[2] = to8(g);
+                dst[3] = (h.hasColorKey && g == h.colorKey[0]) ? 0 : 255;
+                break;
+            }
+            case 2:
+            {
+                const uint32_t r = SampleAt(src, base, h.depth);
+                const uint32_t g = SampleAt(src, base + 1, h.depth);
+                const uint32_t b = SampleAt(src, base + 2, h.depth);
+                dst[0] = to8(r);
+                dst[1] = to8(g);
+                dst[2] = to8(b);
+                dst[3] = (h.hasColorKey && r == h.colorKey[0] && g == h.colorKey[1] && b == h.colorKey[2]) ? 0 : 255;
+                break;
+            }
+            case 3:
+            {
+                const uint32_t i = SampleAt(src, base, h.depth);
+                std::memcpy(dst, h.palette[i < 256 ? i : 0], 4);
+                break;
+            }
+            case 4:
+                dst[0] = dst[1] = dst[2] = to8(SampleAt(src, base, h.depth));
+                dst[3] = to8(SampleAt(src, base + 1, h.depth));
+                break;
+            default:
+                for (uint32_t c = 0; c < 4; ++c) dst[c] = to8(SampleAt(src, base + c, h.depth));
+                break;
+            }
+        }
+    }
+}
+
+bool ZlibInflate(const uint8_t* data, size_t size, std::vector<uint8_t>& out, size_t sizeHint)
+{
+    if (size < 2) return false;
+    const uint8_t cmf = data[0], flg = data[1];
+    if ((cmf & 15) != 8 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20)) return false;
+
+    out.clear();
+    out.reserve(sizeHint);
+    BitReader br(data + 2, size - 2);
+    return InflateRaw(br, out);
+}
+
+std::vector<uint8_t> ZlibDeflate(const uint8_t* data, size_t size, bool compress)
+{
+    std::vector<uint8_t> out;
+    out.reserve(compress ? size / 2 + 64 : size + size / 65535 * 5 + 16);
+    out.push_back(0x78);
+    out.push_back(0x01);
+    if (compress && size > 0) DeflateFixed(data, size, out);
+    else DeflateStored(data, size, out);
+    WriteBE32(out, Adler32(data, size));
+    return out;
+}
+
+bool ReadPNGSize(const uint8_t* data, size_t size, uint32_t& width, uint32_t& height)
+{
+    if (size < 33 || std::memcmp(data, PngSignature, 8) != 0 || std::memcmp(data + 12, "IHDR", 4) != 0) return false;
+    width = ReadBE32(data + 16);
+    height = ReadBE32(data + 20);
+    return true;
+}
+
+bool DecodePNG(const uint8_t* data, size_t size, Image& out, std::string* error)
+{
+    if (size < 8 || std::memcmp(data, PngSignature, 8) != 0) return Fail(error, "not a PNG file");
+
+    PngHeader h;
+    // A single IDAT chunk is inflated where it is; several are joined first
+    const uint8_t* idatData = nullptr;
+    size_t idatSize = 0;
+    std::vector<uint8_t> idat;
+    bool sawHeader = false;
+
+    size_t pos = 8;
+    while (pos + 12 <= size)
+    {
+        const uint32_t length = ReadBE32(data + pos);
+        const uint8_t* type = data + pos + 4;
+        const uint8_t* body = data + pos + 8;
+        if (length > size - pos - 12) return Fail(error, "truncated chunk");
+
+        if (std::memcmp(type, "IHDR", 4) == 0)
+        {
+            if (length != 13) return Fail(error, "bad IHDR");
+            h.width = ReadBE32(body);
+            h.height = ReadBE32(body + 4);
+            h.depth = body[8];
+            h.colorType = body[9];
+            h.interlace = body[12];
+            if (body[10] != 0 || body[11] != 0 || h.interlace > 1) return Fail(error, "unsupported PNG method");
+            static constexpr uint32_t Channels[7] = { 1, 0, 3, 1, 2, 0, 4 };
+            if (h.colorType > 6 || Channels[h.colorType] == 0) return Fail(error, "bad color type");
+            h.channels = Channels[h.colorType];
+            const bool depthOk = h.depth == 8 || h.depth == 16
+                || ((h.colorType == 0 || h.colorType == 3) && (h.depth == 1 || h.depth == 2 || h.depth == 4));
+            if (!depthOk || (h.colorType == 3 && h.depth == 16)) return Fail(error, "bad bit depth");
+            if (h.width == 0 || h.height == 0 || h.width > (1u << 24) || h.height > (1u << 24)) return Fail(error, "bad image size");
+            sawHeader = true;
+        }
+        else if (std::memcmp(type, "PLTE", 4) == 0)
+        {
+            h.paletteSize = std::min<uint32_t>(length / 3, 256);
+            for (uint32_t i = 0; i < h.paletteSize; ++i)
+            {
+                h.palette[i][0] = body[i * 3];
+                h.palette[i][1] = body[i * 3 + 1];
+                h.palette[i][2] = body[i * 3 + 2];
+                h.palette[i][3] = 255;
+            }
+        }
+        else if (std::memcmp(type, "tRNS", 4) == 0)
+        {
+            if (h.colorType == 3)
+            {
+                for (uint32_t i = 0; i < length && i < 256; ++i) h.palette[i][3] = body[i];
+            }
+            else if (h.colorType == 0 && length >= 2)
+            {
+                h.hasColorKey = true;
+                h.colorKey[0] = (uint16_t)((body[0] << 8) | body[1]);
+            }
+            else if (h.colorType == 2 && length >= 6)
+            {
+                h.hasColorKey = true;
+                for (int c = 0; c < 3; ++c) h.colorKey[c] = (uint16_t)((body[c * 2] << 8) | body[c * 2 + 1]);
+            }
+        }
+        else if (std::memcmp(type, "IDAT", 4) == 0)
+        {
+            if (!idatData)
+            {
+                idatData = body;
+                idatSize = length;
+            }
+            else
+            {
+                if (idat.empty()) idat.assign(idatData, idatData + idatSize);
+                idat.insert(idat.end(), body, body + length);
+                idatData = idat.data();
+                idatSize = idat.size();
+            }
+        }
+        else if (std::memcmp(type, "IEND", 4) == 0)
+        {
+            break;
+        }
+        pos += 12 + (size_t)length;
+    }
+
+    if (!sawHeader) return Fail(error, "missing IHDR");
+    if (h.colorType == 3 && h.paletteSize == 0) return Fail(error, "missing PLTE");
+
+    const uint32_t bitsPerPixel = h.channels * h.depth;
+    const uint32_t bpp = std::max(1u, bitsPerPixel / 8);
+    auto strideOf = [&](uint32_t w) { return ((size_t)w * bitsPerPixel + 7) / 8; };
+
+    // Adam7 pass origins and steps; a single full pass when not interlaced
+    static constexpr uint32_t Adam7[7][4] = {
+        { 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 }, { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 } };
+    static constexpr uint32_t NoInterlace[1][4] = { { 0, 0, 1, 1 } };
+    const uint32_t (*passes)[4] = h.interlace ? Adam7 : NoInterlace;
+    const uint32_t passCount = h.interlace ? 7 : 1;
+
+    size_t expected = 0;
+    for (uint32_t p = 0; p < passCount; ++p)
+    {
+        const uint32_t pw = (h.width - passes[p][0] + passes[p][2] - 1) / passes[p][2];
+        const uint32_t ph = (h.height - passes[p][1] + passes[p][3] - 1) / passes[p][3];
+        if (h.width > passes[p][0] && h.height > passes[p][1]) expected += (strideOf(pw) + 1) * ph;
+    }
+
+    std::vector<uint8_t> raw;
+    if (!ZlibInflate(idatData, idatSize, raw, expected)) return Fail(error, "corrupt image data");
+    if (raw.size() < expected) return Fail(error, "image data too short");
+
+    out = Image(h.width, h.height);
+
+    // Plain RGBA8 is unfiltered straight into the image, each row using the
+    // row above it in the image as its prior
+    if (!h.interlace && h.depth == 8 && h.colorType == 6)
+    {
+        const size_t stride = strideOf(h.width);
+        for (uint32_t y = 0; y < h.height; ++y)
+        {
+            const uint8_t* line = raw.data() + y * (stride + 1);
+            if (!UnfilterRow(line[0], line + 1, out.Row(y), y ? out.Row(y - 1) : nullptr, stride, 4)) return Fail(error, "bad scanline filter");
+        }
+        return true;
+    }
+
+    size_t offset = 0;
+    for (uint32_t p = 0; p < passCount; ++p)
+    {
+        const uint32_t x0 = passes[p][0], y0 = passes[p][1], dx = passes[p][2], dy = passes[p][3];
+        if (h.width <= x0 || h.height <= y0) continue;
+        const uint32_t pw = (h.width - x0 + dx - 1) / dx;
+        const uint32_t ph = (h.height - y0 + dy - 1) / dy;
+        const size_t stride = strideOf(pw);
+
+        uint8_t* rows = raw.data() + offset;
+        if (!Unfilter(rows, ph, stride, bpp)) return Fail(error, "bad scanline filter");
+        for (uint32_t y = 0; y < ph; ++y)
+        {
+            ExpandRow(h, rows + y * (stride + 1) + 1, pw, out.Row(y0 + y * dy) + (size_t)x0 * 4, dx);
+        }
+        offset += (stride + 1) * ph;
+    }
+    return true;
+}
+
+std::vector<uint8_t> EncodePNG(const Image& image, bool compress)
+{
+    const size_t stride = (size_t)image.width * 4;
+    std::vector<uint8_t> filtered((stride + 1) * image.height);
+    std::vector<uint8_t> candidate(stride);
+
+    for (uint32_t y = 0; y < image.height; ++y)
+    {
+        const uint8_t* cur = image.Row(y);
+        const uint8_t* prior = y ? image.Row(y - 1) : nullptr;
+        uint8_t* dst = filtered.data() + y * (stride + 1);
+
+        // Pick the filter with the smallest sum of absolute residuals
+        uint64_t bestScore = UINT64_MAX;
+        for (uint8_t f = 0; f < 5; ++f)
+        {
+            if (f == 3) continue;
+            uint64_t score = 0;
+            for (size_t i = 0; i < stride; ++i)
+            {
+                const int left = i >= 4 ? cur[i - 4] : 0;
+                const int up = prior ? prior[i] : 0;
+                const int upLeft = (prior && i >= 4) ? prior[i - 4] : 0;
+                uint8_t v = cur[i];
+                if (f == 1) v = uint8_t(v - left);
+                else if (f == 2) v = uint8_t(v - up);
+                else if (f == 4) v = uint8_t(v - Paeth(left, up, upLeft));
+                candidate[i] = v;
+                score += v < 128 ? v : 256 - v;
+            }
+            if (score < bestScore)
+            {
+                bestScore = score;
+                dst[0] = f;
+                std::memcpy(dst + 1, candidate.data(), stride);
+            }
+        }
+    }
+
+    std::vector<uint8_t> out(PngSignature, PngSignature + 8);
+    auto writeChunk = [&](const char* type, const uint8_t* body, size_t length)
+    {
+        WriteBE32(out, (uint32_t)length);
+        const size_t start = out.size();
+        out.insert(out.end(), type, type + 4);
+        if (length) out.insert(out.end(), body, body + length);
+        WriteBE32(out, Crc32(out.data() + start, length + 4));
+    };
+
+    uint8_t ihdr[13] = {};
+    ihdr[0] = (uint8_t)(image.width >> 24); ihdr[1] = (uint8_t)(image.width >> 16);
+    ihdr[2] = (uint8_t)(image.width >> 8);  ihdr[3] = (uint8_t)image.width;
+    ihdr[4] = (uint8_t)(image.height >> 24); ihdr[5] = (uint8_t)(image.height >> 16);
+    ihdr[6] = (uint8_t)(image.height >> 8);  ihdr[7] = (uint8_t)image.height;
+    ihdr[8] = 8;    // bit depth
+    ihdr[9] = 6;    // RGBA
+    writeChunk("IHDR", ihdr, sizeof(ihdr));
+
+    const std::vector<uint8_t> z = ZlibDeflate(filtered.data(), filtered.size(), compress);
+    writeChunk("IDAT", z.data(), z.size());
+    writeChunk("IEND", nullptr, 0);
+    return out;
+}
+
+bool LoadFile(const std::filesystem::path& path, std::vector<uint8_t>& bytes)
+{
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) return false;
+    const std::streamsize size = in.tellg();
+    if (size < 0) return false;
+    bytes.resize((size_t)size);
+    in.seekg(0);
+    return size == 0 || (bool)in.read(reinterpret_cast<char*>(bytes.data()), size);
+}
+
+bool SaveFile(const std::filesystem::path& path, const std::vector<uint8_t>& bytes)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+    out.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize)bytes.size());
+    return (bool)out;
+}
+
+bool LoadPNG(const std::filesystem::path& path, Image& out, std::string* error)
+{
+    std::vector<uint8_t> bytes;
+    if (!LoadFile(path, bytes)) return Fail(error, "cannot read file");
+    return DecodePNG(bytes.data(), bytes.size(), out, error);
+}
+
+bool SavePNG(const std::filesystem::path& path, const Image& image)
+{
+    return SaveFile(path, EncodePNG(image));
+}
+
+bool DecodeImage(const uint8_t* data, size_t size, Image& out, std::string* error)
+{
+    if (size >= 8 && std::memcmp(data, PngSignature, 8) == 0) return DecodePNG(data, size, out, error);
+    if (size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF) return DecodeJPEG(data, size, out, error);
+    return Fail(error, "unsupported image format");
+}
+
+bool ReadImageSize(const uint8_t* data, size_t size, uint32_t& width, uint32_t& height)
+{
+    return ReadPNGSize(data, size, width, height) || ReadJPEGSize(data, size, width, height);
+}
+
+bool LoadImageFile(const std::filesystem::path& path, Image& out, std::string* error)
+{
+    std::vector<uint8_t> bytes;
+    if (!LoadFile(path, bytes)) return Fail(error, "cannot read file");
+    return DecodeImage(bytes.data(), bytes.size(), out, error);
+}
+
+bool ReadImageFileSize(const std::filesystem::path& path, uint32_t& width, uint32_t& height)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+    std::vector<uint8_t> head(64 * 1024);
+    in.read(reinterpret_cast<char*>(head.data()), (std::streamsize)head.size());
+    return ReadImageSize(head.data(), (size_t)in.gcount(), width, height);
+}
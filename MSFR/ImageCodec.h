@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "RenderDevice.h"
+
+// Decoded image, tightly packed RGBA8 with the first row at the top. pixels
+// may carry a mip chain after the image itself (see MipGenerator.h): levels
+// back to back, each tightly packed; Row addresses level 0. Cooked textures
+// (see DdsCodec.h) keep their block-compressed format, where Row means
+// nothing and levels are rows of blocks.
+struct Image
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t levels = 1;
+    TextureFormat format = TextureFormat::RGBA8;
+    std::vector<uint8_t> pixels;
+
+    Image() = default;
+    Image(uint32_t width_, uint32_t height_) : width(width_), height(height_), pixels((size_t)width_ * height_ * 4, 0) {}
+
+    uint8_t* Row(uint32_t y) { return pixels.data() + (size_t)y * width * 4; }
+    const uint8_t* Row(uint32_t y) const { return pixels.data() + (size_t)y * width * 4; }
+
+    uint32_t GetLevelWidth(uint32_t level) const { return (width >> level) ? (width >> level) : 1; }
+    uint32_t GetLevelHeight(uint32_t level) const { return (height >> level) ? (height >> level) : 1; }
+    size_t GetLevelOffset(uint32_t level) const
+    {
+        size_t offset = 0;
+        for (uint32_t i = 0; i < level; ++i) offset += (size_t)GetRowPitch(format, GetLevelWidth(i)) * GetRowCount(format, GetLevelHeight(i));
+        return offset;
+    }
+    uint8_t* GetLevel(uint32_t level) { return pixels.data() + GetLevelOffset(level); }
+    const uint8_t* GetLevel(uint32_t level) const { return pixels.data() + GetLevelOffset(level); }
+};
+
+// Portable PNG codec (no platform imaging API). Decodes every standard color
+// type and bit depth, with or without Adam7 interlacing; 16-bit channels are
+// reduced to 8. Returns false and fills error on malformed input.
+bool DecodePNG(const uint8_t* data, size_t size, Image& out, std::string* error = nullptr);
+
+// Reads only the IHDR chunk.
+bool ReadPNGSize(const uint8_t* data, size_t size, uint32_t& width, uint32_t& height);
+
+// Encodes RGBA8 as PNG. Rows are filtered per-row with the cheapest of
+// None/Sub/Up/Paeth and written as stored deflate blocks unless compress is
+// set, in which case a fixed-Huffman LZ77 pass is used.
+std::vector<uint8_t> EncodePNG(const Image& image, bool compress = true);
+
+bool LoadFile(const std::filesystem::path& path, std::vector<uint8_t>& bytes);
+bool SaveFile(const std::filesystem::path& path, const std::vector<uint8_t>& bytes);
+
+bool LoadPNG(const std::filesystem::path& path, Image& out, std::string* error = nullptr);
+bool SavePNG(const std::filesystem::path& path, const Image& image);
+
+// Picks the codec from the signature: PNG or baseline JPEG (see JpegCodec.h).
+// Anything else fails with "unsupported image format".
+bool DecodeImage(const uint8_t* data, size_t size, Image& out, std::string* error = nullptr);
+bool ReadImageSize(const uint8_t* data, size_t size, uint32_t& width, uint32_t& height);
+
+bool LoadImageFile(const std::filesystem::path& path, Image& out, std::string* error = nullptr);
+// Reads just the start of the file, which holds the size for PNG and
+// almost always for JPEG (unless the metadata before the frame is huge).
+bool ReadImageFileSize(const std::filesystem::path& path, uint32_t& width, uint32_t& height);
+
+// zlib stream (RFC 1950/1951) helpers, shared with other decoders
+bool ZlibInflate(const uint8_t* data, size_t size, std::vector<uint8_t>& out, size_t sizeHint = 0);
+std::vector<uint8_t> ZlibDeflate(const uint8_t* data, size_t size, bool compress = true);
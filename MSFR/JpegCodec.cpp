@@ -0,0 +1,826 @@
+#include "JpegCodec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if (defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)) && !defined(MSFR_IMAGE_NO_SSE2)
+#define MSFR_IMAGE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // Zigzag position -> row-major coefficient index
+    constexpr uint8_t ZigZag[64] = {
+        0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+        12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+        35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+        58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63 };
+
+    bool Fail(std::string* error, const char* message)
+    {
+        if (error) *error = message;
+        return false;
+    }
+
+    uint32_t ReadBE16(const uint8_t* p)
+    {
+        return (uint32_t(p[0]) << 8) | p[1];
+    }
+
+    uint8_t Clamp255(int v)
+    {
+        return (uint8_t)(v < 0 ? 0 : v > 255 ? 255 : v);
+    }
+
+    // ---------------------------------------------------------------- entropy
+
+    // MSB-first reader over entropy-coded data. Stuffed 0xFF00 pairs read as
+    // 0xFF; at a marker or the end of data it keeps returning zero bits, so a
+    // truncated file decodes to grey rather than failing.
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t* pos_, const uint8_t* end_) : pos(pos_), end(end_) {}
+
+        void Fill()
+        {
+            while (count <= 24)
+            {
+                uint32_t byte = 0;
+                if (!atMarker && pos < end)
+                {
+                    byte = *pos;
+                    if (byte != 0xFF) ++pos;
+                    else if (pos + 1 < end && pos[1] == 0) pos += 2;
+                    else
+                    {
+                        atMarker = true;
+                        byte = 0;
+                    }
+                }
+                bits |= byte << (24 - count);
+                count += 8;
+            }
+        }
+
+        // n is 1..16
+        uint32_t Read(uint32_t n)
+        {
+            if (count < n) Fill();
+            const uint32_t v = bits >> (32 - n);
+            bits <<= n;
+            count -= n;
+            return v;
+        }
+
+        // Drops the bits left in this interval and steps over the next RSTn
+        void Restart()
+        {
+            bits = 0;
+            count = 0;
+            atMarker = false;
+            while (pos + 1 < end)
+            {
+                if (pos[0] == 0xFF && pos[1] >= 0xD0 && pos[1] <= 0xD7)
+                {
+                    pos += 2;
+                    return;
+                }
+                if (pos[0] == 0xFF && pos[1] != 0 && pos[1] != 0xFF) return;
+                ++pos;
+            }
+        }
+
+        const uint8_t* pos;
+        const uint8_t* end;
+        uint32_t bits = 0;      // left-aligned
+        uint32_t count = 0;
+        bool atMarker = false;
+    };
+
+    int Extend(uint32_t v, uint32_t n)
+    {
+        return v < (1u << (n - 1)) ? (int)v - (1 << n) + 1 : (int)v;
+    }
+
+    // Canonical Huffman table with a direct lookup for codes up to FastBits
+    // and per-length bounds for the rest.
+    struct Huffman
+    {
+        static constexpr uint32_t FastBits = 9;
+
+        uint8_t fast[1 << FastBits];    // index into values, 255 = longer code
+        uint8_t sizes[257];
+        uint8_t values[256];
+        uint32_t maxCode[18];           // exclusive bound per length, left-aligned to 16 bits
+        int32_t delta[17];              // value index minus code, per length
+        uint32_t symbolCount = 0;
+        bool defined = false;
+
+        bool Build(const uint8_t counts[16], const uint8_t* symbols)
+        {
+            uint32_t k = 0;
+            for (uint32_t len = 1; len <= 16; ++len)
+            {
+                for (uint32_t i = 0; i < counts[len - 1]; ++i)
+                {
+                    if (k >= 256) return false;
+                    sizes[k++] = (uint8_t)len;
+                }
+            }
+            sizes[k] = 0;
+            symbolCount = k;
+            std::memcpy(values, symbols, k);
+
+            uint16_t codes[256];
+            uint32_t code = 0;
+            k = 0;
+            for (uint32_t len = 1; len <= 16; ++len)
+            {
+                delta[len] = (int32_t)k - (int32_t)code;
+                while (sizes[k] == len) codes[k++] = (uint16_t)code++;
+                if (code > (1u << len)) return false;
+                maxCode[len] = code << (16 - len);
+                code <<= 1;
+            }
+            maxCode[17] = 0xFFFFFFFF;
+
+            std::memset(fast, 255, sizeof(fast));
+            for (uint32_t i = 0; i < symbolCount; ++i)
+            {
+                if (sizes[i] > FastBits) continue;
+                const uint32_t first = (uint32_t)codes[i] << (FastBits - sizes[i]);
+                const uint32_t span = 1u << (FastBits - sizes[i]);
+                for (uint32_t j = 0; j < span; ++j) fast[first + j] = (uint8_t)i;
+            }
+            defined = true;
+            return true;
+        }
+
+        int Decode(BitReader& br) const
+        {
+            if (br.count < 16) br.Fill();
+            const uint32_t index = fast[br.bits >> (32 - FastBits)];
+            if (index != 255)
+            {
+                const uint32_t len = sizes[index];
+                br.bits <<= len;
+                br.count -= len;
+                return values[index];
+            }
+
+            const uint32_t top = br.bits >> 16;
+            uint32_t len = FastBits + 1;
+            while (top >= maxCode[len]) ++len;
+            if (len > 16) return -1;
+            const int32_t at = (int32_t)(br.bits >> (32 - len)) + delta[len];
+            if (at < 0 || at >= (int32_t)symbolCount) return -1;
+            br.bits <<= len;
+            br.count -= len;
+            return values[at];
+        }
+    };
+
+    // ---------------------------------------------------------------- IDCT
+
+    // Integer "islow" IDCT with 12-bit fixed-point constants: columns keep two
+    // extra bits of precision, rows take them off together with the +128
+    // level shift, and both versions below round and clamp identically.
+    constexpr int Fix(double x) { return (int)(x * 4096 + 0.5); }
+
+    constexpr int ColumnBias = 1 << 9;
+    constexpr int ColumnShift = 10;
+    constexpr int RowBias = (1 << 16) + (128 << 17);
+    constexpr int RowShift = 17;
+
+    template <typename T>
+    void Idct8(const T* in, size_t step, int bias, int shift, int out[8])
+    {
+        const int s0 = in[0], s1 = in[step], s2 = in[step * 2], s3 = in[step * 3];
+        const int s4 = in[step * 4], s5 = in[step * 5], s6 = in[step * 6], s7 = in[step * 7];
+
+        // Even part
+        const int p1 = (s2 + s6) * Fix(0.5411961);
+        const int t2 = p1 + s6 * Fix(-1.847759065);
+        const int t3 = p1 + s2 * Fix(0.765366865);
+        const int t0 = (s0 + s4) * 4096;
+        const int t1 = (s0 - s4) * 4096;
+        const int x0 = t0 + t3 + bias, x3 = t0 - t3 + bias;
+        const int x1 = t1 + t2 + bias, x2 = t1 - t2 + bias;
+
+        // Odd part
+        const int p5 = (s7 + s3 + s5 + s1) * Fix(1.175875602);
+        const int q1 = p5 + (s7 + s1) * Fix(-0.899976223);
+        const int q2 = p5 + (s5 + s3) * Fix(-2.562915447);
+        const int q3 = (s7 + s3) * Fix(-1.961570560);
+        const int q4 = (s5 + s1) * Fix(-0.390180644);
+        const int o0 = s7 * Fix(0.298631336) + q1 + q3;
+        const int o1 = s5 * Fix(2.053119869) + q2 + q4;
+        const int o2 = s3 * Fix(3.072711026) + q2 + q3;
+        const int o3 = s1 * Fix(1.501321110) + q1 + q4;
+
+        out[0] = (x0 + o3) >> shift;
+        out[7] = (x0 - o3) >> shift;
+        out[1] = (x1 + o2) >> shift;
+        out[6] = (x1 - o2) >> shift;
+        out[2] = (x2 + o1) >> shift;
+        out[5] = (x2 - o1) >> shift;
+        out[3] = (x3 + o0) >> shift;
+        out[4] = (x3 - o0) >> shift;
+    }
+
+#if MSFR_IMAGE_SSE2
+    // Eight 32-bit lanes
+    struct Wide
+    {
+        __m128i lo, hi;
+    };
+
+    Wide Add(const Wide& a, const Wide& b) { return { _mm_add_epi32(a.lo, b.lo), _mm_add_epi32(a.hi, b.hi) }; }
+    Wide Sub(const Wide& a, const Wide& b) { return { _mm_sub_epi32(a.lo, b.lo), _mm_sub_epi32(a.hi, b.hi) }; }
+
+    // a * 4096, widened
+    Wide Widen(__m128i a)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        return { _mm_srai_epi32(_mm_unpacklo_epi16(zero, a), 4), _mm_srai_epi32(_mm_unpackhi_epi16(zero, a), 4) };
+    }
+
+    // Lane-wise a * k.x + b * k.y for two constant pairs; k is (x, y) repeated
+    void Rotate(__m128i a, __m128i b, __m128i k0, __m128i k1, Wide& out0, Wide& out1)
+    {
+        const __m128i lo = _mm_unpacklo_epi16(a, b);
+        const __m128i hi = _mm_unpackhi_epi16(a, b);
+        out0 = { _mm_madd_epi16(lo, k0), _mm_madd_epi16(hi, k0) };
+        out1 = { _mm_madd_epi16(lo, k1), _mm_madd_epi16(hi, k1) };
+    }
+
+    __m128i Pair(int x, int y)
+    {
+        return _mm_setr_epi16((short)x, (short)y, (short)x, (short)y, (short)x, (short)y, (short)x, (short)y);
+    }
+
+    void Butterfly(const Wide& a, const Wide& b, __m128i bias, __m128i shift, __m128i& out0, __m128i& out1)
+    {
+        const Wide biased = { _mm_add_epi32(a.lo, bias), _mm_add_epi32(a.hi, bias) };
+        const Wide sum = Add(biased, b), dif = Sub(biased, b);
+        out0 = _mm_packs_epi32(_mm_sra_epi32(sum.lo, shift), _mm_sra_epi32(sum.hi, shift));
+        out1 = _mm_packs_epi32(_mm_sra_epi32(dif.lo, shift), _mm_sra_epi32(dif.hi, shift));
+    }
+
+    void Interleave16(__m128i& a, __m128i& b)
+    {
+        const __m128i t = a;
+        a = _mm_unpacklo_epi16(a, b);
+        b = _mm_unpackhi_epi16(t, b);
+    }
+
+    void Interleave8(__m128i& a, __m128i& b)
+    {
+        const __m128i t = a;
+        a = _mm_unpacklo_epi8(a, b);
+        b = _mm_unpackhi_epi8(t, b);
+    }
+
+    // Idct8 on all eight lanes at once; the multiplies are regrouped so each
+    // madd pairs two inputs with two summed constants
+    void IdctPass(__m128i r[8], __m128i bias, __m128i shift)
+    {
+        static const __m128i Rot0a = Pair(Fix(0.5411961), Fix(0.5411961) + Fix(-1.847759065));
+        static const __m128i Rot0b = Pair(Fix(0.5411961) + Fix(0.765366865), Fix(0.5411961));
+        static const __m128i Rot1a = Pair(Fix(1.175875602) + Fix(-0.899976223), Fix(1.175875602));
+        static const __m128i Rot1b = Pair(Fix(1.175875602), Fix(1.175875602) + Fix(-2.562915447));
+        static const __m128i Rot2a = Pair(Fix(-1.961570560) + Fix(0.298631336), Fix(-1.961570560));
+        static const __m128i Rot2b = Pair(Fix(-1.961570560), Fix(-1.961570560) + Fix(3.072711026));
+        static const __m128i Rot3a = Pair(Fix(-0.390180644) + Fix(2.053119869), Fix(-0.390180644));
+        static const __m128i Rot3b = Pair(Fix(-0.390180644), Fix(-0.390180644) + Fix(1.501321110));
+
+        Wide t2, t3;
+        Rotate(r[2], r[6], Rot0a, Rot0b, t2, t3);
+        const Wide t0 = Widen(_mm_add_epi16(r[0], r[4]));
+        const Wide t1 = Widen(_mm_sub_epi16(r[0], r[4]));
+        const Wide x0 = Add(t0, t3), x3 = Sub(t0, t3);
+        const Wide x1 = Add(t1, t2), x2 = Sub(t1, t2);
+
+        Wide y0, y1, y2, y3, y4, y5;
+        Rotate(r[7], r[3], Rot2a, Rot2b, y0, y2);
+        Rotate(r[5], r[1], Rot3a, Rot3b, y1, y3);
+        Rotate(_mm_add_epi16(r[1], r[7]), _mm_add_epi16(r[3], r[5]), Rot1a, Rot1b, y4, y5);
+        const Wide o0 = Add(y0, y4), o1 = Add(y1, y5), o2 = Add(y2, y5), o3 = Add(y3, y4);
+
+        Butterfly(x0, o3, bias, shift, r[0], r[7]);
+        Butterfly(x1, o2, bias, shift, r[1], r[6]);
+        Butterfly(x2, o1, bias, shift, r[2], r[5]);
+        Butterfly(x3, o0, bias, shift, r[3], r[4]);
+    }
+
+    void Transpose16(__m128i r[8])
+    {
+        Interleave16(r[0], r[4]); Interleave16(r[1], r[5]); Interleave16(r[2], r[6]); Interleave16(r[3], r[7]);
+        Interleave16(r[0], r[2]); Interleave16(r[1], r[3]); Interleave16(r[4], r[6]); Interleave16(r[5], r[7]);
+        Interleave16(r[0], r[1]); Interleave16(r[2], r[3]); Interleave16(r[4], r[5]); Interleave16(r[6], r[7]);
+    }
+#endif
+
+    // Dequantized row-major coefficients to an 8x8 block of samples
+    void InverseDCT(const int16_t coef[64], uint8_t* out, size_t stride)
+    {
+#if MSFR_IMAGE_SSE2
+        __m128i r[8];
+        for (int i = 0; i < 8; ++i) r[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coef + i * 8));
+
+        IdctPass(r, _mm_set1_epi32(ColumnBias), _mm_cvtsi32_si128(ColumnShift));
+        Transpose16(r);
+        IdctPass(r, _mm_set1_epi32(RowBias), _mm_cvtsi32_si128(RowShift));
+
+        // Saturate to bytes and transpose back
+        __m128i p0 = _mm_packus_epi16(r[0], r[1]);
+        __m128i p1 = _mm_packus_epi16(r[2], r[3]);
+        __m128i p2 = _mm_packus_epi16(r[4], r[5]);
+        __m128i p3 = _mm_packus_epi16(r[6], r[7]);
+        Interleave8(p0, p2); Interleave8(p1, p3);
+        Interleave8(p0, p1); Interleave8(p2, p3);
+        Interleave8(p0, p2); Interleave8(p1, p3);
+
+        const __m128i rows[4] = { p0, p2, p1, p3 };
+        for (int i = 0; i < 4; ++i, out += stride * 2)
+        {
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out), rows[i]);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + stride), _mm_shuffle_epi32(rows[i], 0x4E));
+        }
+#else
+        int columns[64];
+        int values[8];
+        for (int x = 0; x < 8; ++x)
+        {
+            Idct8(coef + x, 8, ColumnBias, ColumnShift, values);
+            for (int y = 0; y < 8; ++y) columns[y * 8 + x] = values[y];
+        }
+        for (int y = 0; y < 8; ++y, out += stride)
+        {
+            Idct8(columns + y * 8, 1, RowBias, RowShift, values);
+            for (int x = 0; x < 8; ++x) out[x] = Clamp255(values[x]);
+        }
+#endif
+    }
+
+    // What InverseDCT gives for a block without AC coefficients, which is
+    // common in flat areas
+    void FillBlock(int dc, uint8_t* out, size_t stride)
+    {
+        const uint8_t value = Clamp255(((dc + 4) >> 3) + 128);
+        for (int y = 0; y < 8; ++y, out += stride) std::memset(out, value, 8);
+    }
+
+    // ---------------------------------------------------------------- color
+
+    // JFIF YCbCr -> RGB in 12-bit fixed point, shaped around pmulhw so the
+    // scalar tail matches the vector lanes exactly
+    constexpr int CrToR = Fix(1.402);
+    constexpr int CbToG = -Fix(0.34414);
+    constexpr int CrToG = -Fix(0.71414);
+    constexpr int CbToB = Fix(1.772);
+
+    void YCbCrToRGBA(const uint8_t* y, const uint8_t* cb, const uint8_t* cr, uint8_t* dst, uint32_t n)
+    {
+        uint32_t i = 0;
+#if MSFR_IMAGE_SSE2
+        const __m128i signFlip = _mm_set1_epi8(-0x80);
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i alpha = _mm_set1_epi16(255);
+        const __m128i crToR = _mm_set1_epi16((short)CrToR);
+        const __m128i cbToG = _mm_set1_epi16((short)CbToG);
+        const __m128i crToG = _mm_set1_epi16((short)CrToG);
+        const __m128i cbToB = _mm_set1_epi16((short)CbToB);
+        for (; i + 8 <= n; i += 8, dst += 32)
+        {
+            const __m128i y8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + i));
+            const __m128i cb8 = _mm_xor_si128(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cb + i)), signFlip);
+            const __m128i cr8 = _mm_xor_si128(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cr + i)), signFlip);
+
+            // y * 16 + 8, and the chroma offsets from 128 scaled by 256
+            const __m128i yw = _mm_srli_epi16(_mm_unpacklo_epi8(signFlip, y8), 4);
+            const __m128i cbw = _mm_unpacklo_epi8(zero, cb8);
+            const __m128i crw = _mm_unpacklo_epi8(zero, cr8);
+
+            const __m128i r = _mm_srai_epi16(_mm_add_epi16(yw, _mm_mulhi_epi16(crw, crToR)), 4);
+            const __m128i g = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(yw, _mm_mulhi_epi16(cbw, cbToG)), _mm_mulhi_epi16(crw, crToG)), 4);
+            const __m128i b = _mm_srai_epi16(_mm_add_epi16(yw, _mm_mulhi_epi16(cbw, cbToB)), 4);
+
+            const __m128i rb = _mm_packus_epi16(r, b);
+            const __m128i ga = _mm_packus_epi16(g, alpha);
+            const __m128i rg = _mm_unpacklo_epi8(rb, ga);
+            const __m128i ba = _mm_unpackhi_epi8(rb, ga);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi16(rg, ba));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), _mm_unpackhi_epi16(rg, ba));
+        }
+#endif
+        for (; i < n; ++i, dst += 4)
+        {
+            const int yw = (y[i] << 4) + 8;
+            const int cbw = (cb[i] - 128) * 256;
+            const int crw = (cr[i] - 128) * 256;
+            dst[0] = Clamp255((yw + ((crw * CrToR) >> 16)) >> 4);
+            dst[1] = Clamp255((yw + ((cbw * CbToG) >> 16) + ((crw * CrToG) >> 16)) >> 4);
+            dst[2] = Clamp255((yw + ((cbw * CbToB) >> 16)) >> 4);
+            dst[3] = 255;
+        }
+    }
+
+    void GreyToRGBA(const uint8_t* y, uint8_t* dst, uint32_t n)
+    {
+        uint32_t i = 0;
+#if MSFR_IMAGE_SSE2
+        const __m128i alpha = _mm_set1_epi8(-1);
+        for (; i + 16 <= n; i += 16, dst += 64)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i));
+            const __m128i vv = _mm_unpacklo_epi8(v, v), vvHi = _mm_unpackhi_epi8(v, v);
+            const __m128i va = _mm_unpacklo_epi8(v, alpha), vaHi = _mm_unpackhi_epi8(v, alpha);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi16(vv, va));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), _mm_unpackhi_epi16(vv, va));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 32), _mm_unpacklo_epi16(vvHi, vaHi));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 48), _mm_unpackhi_epi16(vvHi, vaHi));
+        }
+#endif
+        for (; i < n; ++i, dst += 4)
+        {
+            dst[0] = dst[1] = dst[2] = y[i];
+            dst[3] = 255;
+        }
+    }
+
+    void RGBToRGBA(const uint8_t* r, const uint8_t* g, const uint8_t* b, uint8_t* dst, uint32_t n)
+    {
+        for (uint32_t i = 0; i < n; ++i, dst += 4)
+        {
+            dst[0] = r[i];
+            dst[1] = g[i];
+            dst[2] = b[i];
+            dst[3] = 255;
+        }
+    }
+
+    // Widens a subsampled row by pixel replication; dst holds n samples
+    void UpsampleRow(const uint8_t* src, uint8_t* dst, uint32_t n, uint32_t factor, uint32_t maxFactor)
+    {
+        uint32_t x = 0;
+#if MSFR_IMAGE_SSE2
+        if (maxFactor == factor * 2)
+        {
+            for (; x + 32 <= n; x += 32)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x / 2));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_unpacklo_epi8(v, v));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x + 16), _mm_unpackhi_epi8(v, v));
+            }
+        }
+#endif
+        for (; x < n; ++x) dst[x] = src[x * factor / maxFactor];
+    }
+
+    // ---------------------------------------------------------------- decoder
+
+    struct Component
+    {
+        uint8_t id = 0;
+        uint32_t h = 1, v = 1;          // sampling factors
+        uint32_t quant = 0;
+        uint32_t dcTable = 0, acTable = 0;
+        int dcPred = 0;
+
+        // One MCU row of samples
+        std::vector<uint8_t> strip;
+        size_t stride = 0;
+        std::vector<uint8_t> upsampled;  // one output row, when h < maxH
+    };
+
+    class Decoder
+    {
+    public:
+        bool Decode(const uint8_t* data, size_t size, Image& out, std::string* error);
+
+    private:
+        bool ReadQuantTables(const uint8_t* body, size_t length, std::string* error);
+        bool ReadHuffmanTables(const uint8_t* body, size_t length, std::string* error);
+        bool ReadFrame(const uint8_t* body, size_t length, std::string* error);
+        bool DecodeScan(const uint8_t* body, size_t length, const uint8_t* entropy, const uint8_t* end, Image& out, std::string* error);
+        bool DecodeBlock(BitReader& br, Component& c, int16_t coef[64], bool& dcOnly);
+        void EmitRows(uint32_t mcuRow, Image& out);
+
+        uint16_t quant[4][64] = {};     // zigzag order
+        bool quantDefined[4] = {};
+        Huffman dc[4], ac[4];
+
+        uint32_t width = 0, height = 0;
+        std::vector<Component> components;
+        uint32_t maxH = 1, maxV = 1;
+        uint32_t mcusX = 0, mcusY = 0;
+        uint32_t restartInterval = 0;
+        int adobeTransform = -1;
+        bool sawJfif = false;
+    };
+
+    bool Decoder::Decode(const uint8_t* data, size_t size, Image& out, std::string* error)
+    {
+        if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) return Fail(error, "not a JPEG file");
+
+        size_t pos = 2;
+        for (;;)
+        {
+            if (pos >= size) return Fail(error, "missing scan");
+            if (data[pos] != 0xFF) return Fail(error, "bad marker");
+            while (pos < size && data[pos] == 0xFF) ++pos;
+            if (pos >= size) return Fail(error, "missing scan");
+            const uint8_t marker = data[pos++];
+
+            if (marker == 0xD8 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) continue;
+            if (marker == 0xD9) return Fail(error, "missing scan");
+            if (pos + 2 > size) return Fail(error, "truncated segment");
+            const size_t length = ReadBE16(data + pos);
+            if (length < 2 || pos + length > size) return Fail(error, "truncated segment");
+            const uint8_t* body = data + pos + 2;
+            const size_t bodyLength = length - 2;
+
+            switch (marker)
+            {
+            case 0xDB:
+                if (!ReadQuantTables(body, bodyLength, error)) return false;
+                break;
+            case 0xC4:
+                if (!ReadHuffmanTables(body, bodyLength, error)) return false;
+                break;
+            case 0xC0:
+            case 0xC1:
+                if (!ReadFrame(body, bodyLength, error)) return false;
+                break;
+            case 0xC2: case 0xC3: case 0xC5: case 0xC6: case 0xC7:
+            case 0xC9: case 0xCA: case 0xCB: case 0xCD: case 0xCE: case 0xCF: case 0xCC:
+                return Fail(error, "progressive, lossless or arithmetic-coded JPEG not supported");
+            case 0xDD:
+                if (bodyLength < 2) return Fail(error, "bad DRI");
+                restartInterval = ReadBE16(body);
+                break;
+            case 0xE0:
+                if (bodyLength >= 5 && std::memcmp(body, "JFIF", 5) == 0) sawJfif = true;
+                break;
+            case 0xEE:
+                if (bodyLength >= 12 && std::memcmp(body, "Adobe", 5) == 0) adobeTransform = body[11];
+                break;
+            case 0xDA:
+                return DecodeScan(body, bodyLength, data + pos + length, data + size, out, error);
+            default:
+                break;
+            }
+            pos += length;
+        }
+    }
+
+    bool Decoder::ReadQuantTables(const uint8_t* body, size_t length, std::string* error)
+    {
+        size_t pos = 0;
+        while (pos < length)
+        {
+            const uint32_t precision = body[pos] >> 4, id = body[pos] & 15;
+            ++pos;
+            if (precision > 1 || id > 3) return Fail(error, "bad DQT");
+            const size_t bytes = precision ? 128 : 64;
+            if (pos + bytes > length) return Fail(error, "bad DQT");
+            for (uint32_t k = 0; k < 64; ++k)
+            {
+                quant[id][k] = (uint16_t)(precision ? ReadBE16(body + pos + k * 2) : body[pos + k]);
+            }
+            quantDefined[id] = true;
+            pos += bytes;
+        }
+        return true;
+    }
+
+    bool Decoder::ReadHuffmanTables(const uint8_t* body, size_t length, std::string* error)
+    {
+        size_t pos = 0;
+        while (pos < length)
+        {
+            if (pos + 17 > length) return Fail(error, "bad DHT");
+            const uint32_t tableClass = body[pos] >> 4, id = body[pos] & 15;
+            if (tableClass > 1 || id > 3) return Fail(error, "bad DHT");
+            const uint8_t* counts = body + pos + 1;
+            size_t total = 0;
+            for (int i = 0; i < 16; ++i) total += counts[i];
+            pos += 17;
+            if (total > 256 || pos + total > length) return Fail(error, "bad DHT");
+
+            Huffman& table = tableClass ? ac[id] : dc[id];
+            if (!table.Build(counts, body + pos)) return Fail(error, "bad Huffman table");
+            pos += total;
+        }
+        return true;
+    }
+
+    bool Decoder::ReadFrame(const uint8_t* body, size_t length, std::string* error)
+    {
+        if (!components.empty()) return Fail(error, "more than one frame");
+        if (length < 6) return Fail(error, "bad SOF");
+        if (body[0] != 8) return Fail(error, "only 8-bit JPEG is supported");
+        height = ReadBE16(body + 1);
+        width = ReadBE16(body + 3);
+        const uint32_t count = body[5];
+        if (width == 0 || height == 0) return Fail(error, "bad image size");
+        if (count == 4) return Fail(error, "CMYK JPEG not supported");
+        if (count != 1 && count != 3) return Fail(error, "bad component count");
+        if (length < 6 + count * 3) return Fail(error, "bad SOF");
+
+        components.resize(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            Component& c = components[i];
+            const uint8_t* p = body + 6 + i * 3;
+            c.id = p[0];
+            c.h = p[1] >> 4;
+            c.v = p[1] & 15;
+            c.quant = p[2];
+            if (c.h < 1 || c.h > 4 || c.v < 1 || c.v > 4 || c.quant > 3) return Fail(error, "bad SOF");
+        }
+        // A lone component is coded block by block whatever its factors say
+        if (count == 1) components[0].h = components[0].v = 1;
+
+        for (const Component& c : components)
+        {
+            maxH = std::max(maxH, c.h);
+            maxV = std::max(maxV, c.v);
+        }
+        mcusX = (width + maxH * 8 - 1) / (maxH * 8);
+        mcusY = (height + maxV * 8 - 1) / (maxV * 8);
+        return true;
+    }
+
+    bool Decoder::DecodeBlock(BitReader& br, Component& c, int16_t coef[64], bool& dcOnly)
+    {
+        dcOnly = true;
+        std::memset(coef, 0, 64 * sizeof(int16_t));
+        const uint16_t* q = quant[c.quant];
+
+        const int t = dc[c.dcTable].Decode(br);
+        if (t < 0 || t > 11) return false;
+        if (t) c.dcPred += Extend(br.Read((uint32_t)t), (uint32_t)t);
+        coef[0] = (int16_t)(c.dcPred * q[0]);
+
+        const Huffman& table = ac[c.acTable];
+        for (uint32_t k = 1; k < 64;)
+        {
+            const int rs = table.Decode(br);
+            if (rs < 0) return false;
+            const uint32_t run = (uint32_t)rs >> 4, bits = (uint32_t)rs & 15;
+            if (bits == 0)
+            {
+                if (run != 15) break;   // end of block
+                k += 16;
+                continue;
+            }
+            k += run;
+            if (k > 63) return false;
+            coef[ZigZag[k]] = (int16_t)(Extend(br.Read(bits), bits) * q[k]);
+            dcOnly = false;
+            ++k;
+        }
+        return true;
+    }
+
+    bool Decoder::DecodeScan(const uint8_t* body, size_t length, const uint8_t* entropy, const uint8_t* end, Image& out, std::string* error)
+    {
+        if (components.empty()) return Fail(error, "scan before frame");
+        if (length < 1) return Fail(error, "bad SOS");
+        const uint32_t count = body[0];
+        if (length < 4 + count * 2) return Fail(error, "bad SOS");
+        // Baseline files may also code each component in its own scan; that
+        // needs whole-image planes, so it is left to the fallback decoder
+        if (count != components.size()) return Fail(error, "multi-scan JPEG not supported");
+
+        std::vector<Component*> order;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const uint8_t* p = body + 1 + i * 2;
+            auto it = std::find_if(components.begin(), components.end(), [p](const Component& c) { return c.id == p[0]; });
+            if (it == components.end() || std::find(order.begin(), order.end(), &*it) != order.end()) return Fail(error, "bad SOS");
+            it->dcTable = p[1] >> 4;
+            it->acTable = p[1] & 15;
+            if (it->dcTable > 3 || it->acTable > 3 || !dc[it->dcTable].defined || !ac[it->acTable].defined)
+            {
+                return Fail(error, "missing Huffman table");
+            }
+            if (!quantDefined[it->quant]) return Fail(error, "missing quantization table");
+            order.push_back(&*it);
+        }
+        const uint8_t* spectral = body + 1 + count * 2;
+        if (spectral[0] != 0 || spectral[1] != 63 || spectral[2] != 0) return Fail(error, "bad SOS");
+
+        const size_t paddedWidth = (size_t)mcusX * maxH * 8;
+        for (Component& c : components)
+        {
+            c.stride = (size_t)mcusX * c.h * 8;
+            c.strip.assign(c.stride * c.v * 8, 0);
+            // Room for the vector upsampler to run one block past the end
+            if (c.h != maxH) c.upsampled.assign(paddedWidth + 32, 0);
+        }
+
+        out = Image(width, height);
+        BitReader br(entropy, end);
+        alignas(16) int16_t coef[64];
+        uint32_t todo = restartInterval;
+        for (uint32_t my = 0; my < mcusY; ++my)
+        {
+            for (uint32_t mx = 0; mx < mcusX; ++mx)
+            {
+                for (Component* c : order)
+                {
+                    for (uint32_t by = 0; by < c->v; ++by)
+                    {
+                        for (uint32_t bx = 0; bx < c->h; ++bx)
+                        {
+                            bool dcOnly = false;
+                            if (!DecodeBlock(br, *c, coef, dcOnly)) return Fail(error, "corrupt image data");
+                            uint8_t* dst = c->strip.data() + by * 8 * c->stride + ((size_t)mx * c->h + bx) * 8;
+                            if (dcOnly) FillBlock(coef[0], dst, c->stride);
+                            else InverseDCT(coef, dst, c->stride);
+                        }
+                    }
+                }
+
+                if (restartInterval && --todo == 0 && (my + 1 < mcusY || mx + 1 < mcusX))
+                {
+                    br.Restart();
+                    for (Component& c : components) c.dcPred = 0;
+                    todo = restartInterval;
+                }
+            }
+            EmitRows(my, out);
+        }
+        return true;
+    }
+
+    void Decoder::EmitRows(uint32_t mcuRow, Image& out)
+    {
+        const uint32_t y0 = mcuRow * maxV * 8;
+        const uint32_t y1 = std::min(height, y0 + maxV * 8);
+        const bool rgb = components.size() == 3
+            && ((adobeTransform == 0 && !sawJfif)
+                || (components[0].id == 'R' && components[1].id == 'G' && components[2].id == 'B'));
+
+        const uint8_t* rows[3] = {};
+        for (uint32_t y = y0; y < y1; ++y)
+        {
+            const uint32_t local = y - y0;
+            for (size_t i = 0; i < components.size(); ++i)
+            {
+                Component& c = components[i];
+                const uint8_t* src = c.strip.data() + (size_t)(local * c.v / maxV) * c.stride;
+                if (c.h == maxH) rows[i] = src;
+                else
+                {
+                    UpsampleRow(src, c.upsampled.data(), width, c.h, maxH);
+                    rows[i] = c.upsampled.data();
+                }
+            }
+
+            uint8_t* dst = out.Row(y);
+            if (components.size() == 1) GreyToRGBA(rows[0], dst, width);
+            else if (rgb) RGBToRGBA(rows[0], rows[1], rows[2], dst, width);
+            else YCbCrToRGBA(rows[0], rows[1], rows[2], dst, width);
+        }
+    }
+}
+
+bool DecodeJPEG(const uint8_t* data, size_t size, Image& out, std::string* error)
+{
+    Decoder decoder;
+    return decoder.Decode(data, size, out, error);
+}
+
+bool ReadJPEGSize(const uint8_t* data, size_t size, uint32_t& width, uint32_t& height)
+{
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) return false;
+    size_t pos = 2;
+    while (pos + 4 <= size)
+    {
+        if (data[pos] != 0xFF) return false;
+        while (pos < size && data[pos] == 0xFF) ++pos;
+        if (pos + 3 > size) return false;
+        const uint8_t marker = data[pos++];
+        if (marker == 0xD8 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) continue;
+        if (marker == 0xD9 || marker == 0xDA) return false;
+
+        const size_t length = ReadBE16(data + pos);
+        const bool frame = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+        if (frame)
+        {
+            if (length < 7 || pos + 7 > size) return false;
+            height = ReadBE16(data + pos + 3);
+            width = ReadBE16(data + pos + 5);
+            return true;
+        }
+        pos += length;
+    }
+    return false;
+}
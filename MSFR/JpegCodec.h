@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ImageCodec.h"
+
+// Portable baseline JPEG decoder (no platform imaging API). Handles 8-bit
+// sequential Huffman files with one (grey) or three (YCbCr, or RGB when the
+// Adobe/JFIF markers say so) components, any sampling factors and restart
+// intervals. Progressive, arithmetic-coded, 12-bit, lossless and CMYK files
+// are rejected with an error so the caller can fall back to another decoder.
+//
+// Decoding goes one MCU row at a time: the blocks of a row are inverse
+// transformed into small per-component strips, and the strips are upsampled
+// (pixel replication) and color converted straight into the output image.
+// The IDCT, the upsampling and the color conversion use SSE2 when the target
+// has it, with scalar code producing the same results otherwise.
+bool DecodeJPEG(const uint8_t* data, size_t size, Image& out, std::string* error = nullptr);
+
+// Walks the markers up to the frame header.
+bool ReadJPEGSize(const uint8_t* data, size_t size, uint32_t& width, uint32_t& height);
@@ -0,0 +1,373 @@
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "ImageCodec.h"
+#include "WorkerPool.h"
+
+#if (defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)) && !defined(MSFR_IMAGE_NO_SSE2)
+#define MSFR_IMAGE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    constexpr uint32_t EncodeSize = 4096;
+    constexpr float KaiserWidth = 3.f;
+    constexpr float KaiserAlpha = 4.f;
+
+    // 8-bit to linear [0, 1] and back, through a 12-bit index; [1] is the
+    // identity mapping for gammaCorrect = false
+    struct Tables
+    {
+        float decode[2][256];
+        uint8_t encode[2][EncodeSize];
+
+        Tables()
+        {
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                const double v = i / 255.0;
+                decode[0][i] = (float)(v <= 0.04045 ? v / 12.92 : std::pow((v + 0.055) / 1.055, 2.4));
+                decode[1][i] = (float)v;
+            }
+            for (uint32_t i = 0; i < EncodeSize; ++i)
+            {
+                const double v = i / (double)(EncodeSize - 1);
+                const double s = v <= 0.0031308 ? v * 12.92 : 1.055 * std::pow(v, 1 / 2.4) - 0.055;
+                encode[0][i] = (uint8_t)std::lround(s * 255.0);
+                encode[1][i] = (uint8_t)std::lround(v * 255.0);
+            }
+        }
+    };
+
+    const Tables& GetTables()
+    {
+        static const Tables tables;
+        return tables;
+    }
+
+    // One RGBA texel in linear, alpha-premultiplied floats. Decode and Encode
+    // convert from and to 8-bit straight alpha through the tables; Encode
+    // clamps, since the Kaiser lobes can overshoot.
+#if MSFR_IMAGE_SSE2
+    using Texel = __m128;
+
+    Texel Load(const float* p) { return _mm_load_ps(p); }
+    void Store(float* p, Texel t) { _mm_store_ps(p, t); }
+    Texel Mul(Texel t, float w) { return _mm_mul_ps(t, _mm_set1_ps(w)); }
+    Texel MulAdd(Texel acc, Texel t, float w) { return _mm_add_ps(acc, _mm_mul_ps(t, _mm_set1_ps(w))); }
+
+    Texel Decode(const uint8_t* p, const float* decode)
+    {
+        return _mm_mul_ps(_mm_setr_ps(decode[p[0]], decode[p[1]], decode[p[2]], 1.f), _mm_set1_ps(p[3] * (1.f / 255.f)));
+    }
+
+    void Encode(Texel t, const uint8_t* encode, uint8_t* d)
+    {
+        const __m128 one = _mm_set1_ps(1.f);
+        const __m128 alpha = _mm_shuffle_ps(t, t, _MM_SHUFFLE(3, 3, 3, 3));
+        const __m128 inv = _mm_and_ps(_mm_cmpgt_ps(alpha, _mm_set1_ps(1e-6f)), _mm_div_ps(one, alpha));
+        // Color by 1 / alpha, alpha by 1
+        const __m128 colorLanes = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+        const __m128 scale = _mm_or_ps(_mm_and_ps(colorLanes, inv), _mm_andnot_ps(colorLanes, one));
+        const __m128 v = _mm_min_ps(_mm_max_ps(_mm_mul_ps(t, scale), _mm_setzero_ps()), one);
+        const __m128 range = _mm_setr_ps(EncodeSize - 1.f, EncodeSize - 1.f, EncodeSize - 1.f, 255.f);
+        alignas(16) int32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, range), _mm_set1_ps(0.5f))));
+        d[0] = encode[lanes[0]];
+        d[1] = encode[lanes[1]];
+        d[2] = encode[lanes[2]];
+        d[3] = (uint8_t)lanes[3];
+    }
+#else
+    struct Texel
+    {
+        float v[4];
+    };
+
+    Texel Load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+    void Store(float* p, Texel t) { std::memcpy(p, t.v, sizeof(t.v)); }
+    Texel Mul(Texel t, float w)
+    {
+        for (int c = 0; c < 4; ++c) t.v[c] *= w;
+        return t;
+    }
+    Texel MulAdd(Texel acc, Texel t, float w)
+    {
+        for (int c = 0; c < 4; ++c) acc.v[c] += t.v[c] * w;
+        return acc;
+    }
+
+    Texel Decode(const uint8_t* p, const float* decode)
+    {
+        const float a = p[3] * (1.f / 255.f);
+        return { { decode[p[0]] * a, decode[p[1]] * a, decode[p[2]] * a, a } };
+    }
+
+    void Encode(Texel t, const uint8_t* encode, uint8_t* d)
+    {
+        const float inv = t.v[3] > 1e-6f ? 1.f / t.v[3] : 0.f;
+        for (int c = 0; c < 3; ++c)
+        {
+            const float v = std::clamp(t.v[c] * inv, 0.f, 1.f);
+            d[c] = encode[(uint32_t)(v * (EncodeSize - 1) + 0.5f)];
+        }
+        d[3] = (uint8_t)(std::clamp(t.v[3], 0.f, 1.f) * 255.f + 0.5f);
+    }
+#endif
+
+    // Aligned storage for Load and Store
+    struct alignas(16) TexelSlot
+    {
+        float v[4];
+    };
+
+    // Per destination texel along one axis: a run of source texels and weights
+    struct Axis
+    {
+        std::vector<uint32_t> first;    // into taps, one past the end at [size]
+        std::vector<uint32_t> index;
+        std::vector<float> weight;
+        uint32_t maxTaps = 0;
+    };
+
+    double Sinc(double x)
+    {
+        if (std::abs(x) < 1e-6) return 1.0;
+        const double px = 3.14159265358979323846 * x;
+        return std::sin(px) / px;
+    }
+
+    // Zeroth-order modified Bessel function, power series
+    double BesselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 32; ++k)
+        {
+            term *= (x / (2 * k)) * (x / (2 * k));
+            sum += term;
+            if (term < sum * 1e-12) break;
+        }
+        return sum;
+    }
+
+    Axis BuildAxis(uint32_t src, uint32_t dst, MipFilter filter)
+    {
+        Axis axis;
+        const double scale = (double)src / dst;
+        std::vector<double> weights;
+        for (uint32_t i = 0; i < dst; ++i)
+        {
+            axis.first.push_back((uint32_t)axis.index.size());
+            weights.clear();
+            std::vector<uint32_t> indices;
+
+            if (filter == MipFilter::Box)
+            {
+                const double lo = i * scale, hi = (i + 1) * scale;
+                for (uint32_t s = (uint32_t)lo; s < src && s < hi; ++s)
+                {
+                    const double w = std::min(hi, s + 1.0) - std::max(lo, (double)s);
+                    if (w <= 1e-9) continue;
+                    indices.push_back(s);
+                    weights.push_back(w);
+                }
+            }
+            else
+            {
+                // In destination texel units, centered on texel i
+                const double center = (i + 0.5) * scale;
+                const double radius = KaiserWidth * scale;
+                const int64_t s0 = (int64_t)std::floor(center - radius), s1 = (int64_t)std::ceil(center + radius);
+                for (int64_t s = s0; s <= s1; ++s)
+                {
+                    const double t = (s + 0.5 - center) / scale;
+                    const double r = t / KaiserWidth;
+                    if (std::abs(r) >= 1.0) continue;
+                    const double window = BesselI0(KaiserAlpha * std::sqrt(1.0 - r * r)) / BesselI0(KaiserAlpha);
+                    const double w = Sinc(t) * window;
+                    if (std::abs(w) < 1e-6) continue;
+                    indices.push_back((uint32_t)std::clamp<int64_t>(s, 0, (int64_t)src - 1));
+                    weights.push_back(w);
+                }
+            }
+
+            double sum = 0.0;
+            for (double w : weights) sum += w;
+            for (size_t k = 0; k < indices.size(); ++k)
+            {
+                axis.index.push_back(indices[k]);
+                axis.weight.push_back((float)(weights[k] / sum));
+            }
+            axis.maxTaps = std::max(axis.maxTaps, (uint32_t)indices.size());
+        }
+        axis.first.push_back((uint32_t)axis.index.size());
+        return axis;
+    }
+
+    struct Level
+    {
+        const uint8_t* pixels;
+        uint32_t width, height;
+    };
+
+    // Filters destination rows [y0, y1): source rows are decoded to linear
+    // once into a ring, accumulated vertically, then filtered horizontally
+    void FilterRows(const Level& src, uint8_t* dst, uint32_t dstWidth, const Axis& ax, const Axis& ay,
+        uint32_t y0, uint32_t y1, bool gammaCorrect)
+    {
+        const Tables& tables = GetTables();
+        const float* decode = tables.decode[gammaCorrect ? 0 : 1];
+        const uint8_t* encode = tables.encode[gammaCorrect ? 0 : 1];
+
+        const size_t rowFloats = (size_t)src.width * 4;
+        const uint32_t ringSize = ay.maxTaps;
+        std::vector<TexelSlot> ringStorage((size_t)ringSize * src.width);
+        std::vector<TexelSlot> accStorage(src.width);
+        float* ring = reinterpret_cast<float*>(ringStorage.data());
+        float* acc = reinterpret_cast<float*>(accStorage.data());
+        std::vector<uint32_t> ringRow(ringSize, UINT32_MAX);
+
+        auto sourceRow = [&](uint32_t sy) -> const float*
+        {
+            const uint32_t slot = sy % ringSize;
+            float* row = ring + slot * rowFloats;
+            if (ringRow[slot] == sy) return row;
+            ringRow[slot] = sy;
+
+            const uint8_t* p = src.pixels + (size_t)sy * src.width * 4;
+            for (uint32_t x = 0; x < src.width; ++x, p += 4) Store(row + x * 4, Decode(p, decode));
+            return row;
+        };
+
+        for (uint32_t y = y0; y < y1; ++y)
+        {
+            for (uint32_t k = ay.first[y]; k < ay.first[y + 1]; ++k)
+            {
+                const float* row = sourceRow(ay.index[k]);
+                const float w = ay.weight[k];
+                if (k == ay.first[y])
+                {
+                    for (uint32_t x = 0; x < src.width; ++x) Store(acc + x * 4, Mul(Load(row + x * 4), w));
+                    continue;
+                }
+                for (uint32_t x = 0; x < src.width; ++x)
+                {
+                    Store(acc + x * 4, MulAdd(Load(acc + x * 4), Load(row + x * 4), w));
+                }
+            }
+
+            uint8_t* d = dst + (size_t)y * dstWidth * 4;
+            for (uint32_t x = 0; x < dstWidth; ++x, d += 4)
+            {
+                uint32_t k = ax.first[x];
+                Texel sum = Mul(Load(acc + ax.index[k] * 4), ax.weight[k]);
+                for (++k; k < ax.first[x + 1]; ++k) sum = MulAdd(sum, Load(acc + ax.index[k] * 4), ax.weight[k]);
+                Encode(sum, encode, d);
+            }
+        }
+    }
+
+    // Share of texels whose alpha is above the cutoff
+    uint64_t CountAbove(const uint64_t histogram[256], uint32_t threshold)
+    {
+        uint64_t n = 0;
+        for (uint32_t i = threshold + 1; i < 256; ++i) n += histogram[i];
+        return n;
+    }
+
+    void AlphaHistogram(const uint8_t* pixels, size_t count, uint64_t histogram[256])
+    {
+        std::fill(histogram, histogram + 256, 0);
+        for (size_t i = 0; i < count; ++i) ++histogram[pixels[i * 4 + 3]];
+    }
+
+    // Scales alpha so as close to target texels as possible pass the cutoff
+    void PreserveCoverage(uint8_t* pixels, size_t count, float cutoff, double target)
+    {
+        uint64_t histogram[256];
+        AlphaHistogram(pixels, count, histogram);
+
+        const double wanted = target * count;
+        const uint32_t cut = (uint32_t)std::clamp(cutoff * 255.f, 0.f, 254.f);
+        uint32_t best = cut;
+        double bestError = 1e300;
+        for (uint32_t k = 0; k < 255; ++k)
+        {
+            const double error = std::abs((double)CountAbove(histogram, k) - wanted);
+            // Ties keep the threshold nearest the cutoff, i.e. the mildest scale
+            if (error < bestError || (error == bestError && std::abs((int)k - (int)cut) < std::abs((int)best - (int)cut)))
+            {
+                best = k;
+                bestError = error;
+            }
+        }
+        if (best == cut) return;
+
+        // Alpha best + 1 lands just above the cutoff, alpha best just below
+        const float scale = cutoff * 255.f / (best + 0.5f);
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint8_t& a = pixels[i * 4 + 3];
+            a = (uint8_t)std::min(255.f, a * scale + 0.5f);
+        }
+    }
+}
+
+uint32_t GetMipLevelCount(uint32_t width, uint32_t height, uint32_t maxLevels)
+{
+    uint32_t levels = 1;
+    for (uint32_t size = std::max(width, height); size > 1; size >>= 1) ++levels;
+    return maxLevels ? std::min(levels, maxLevels) : levels;
+}
+
+void GenerateMips(Image& image, const MipSettings& settings)
+{
+    if (image.width == 0 || image.height == 0 || image.format != TextureFormat::RGBA8) return;
+    image.levels = GetMipLevelCount(image.width, image.height, settings.maxLevels);
+    image.pixels.resize(GetTextureBytes(image.format, image.width, image.height, image.levels));
+
+    // Only cutouts with something cut out get their coverage kept
+    const size_t baseTexels = (size_t)image.width * image.height;
+    bool cutout = false;
+    double coverage = 0.0;
+    if (settings.alphaCutoff > 0.f)
+    {
+        uint64_t histogram[256];
+        AlphaHistogram(image.pixels.data(), baseTexels, histogram);
+        cutout = histogram[0] > 0 && histogram[0] + histogram[255] == baseTexels;
+        coverage = (double)CountAbove(histogram, (uint32_t)(settings.alphaCutoff * 255.f)) / baseTexels;
+    }
+
+    for (uint32_t level = 1; level < image.levels; ++level)
+    {
+        const Level src = { image.GetLevel(level - 1), image.GetLevelWidth(level - 1), image.GetLevelHeight(level - 1) };
+        uint8_t* dst = image.GetLevel(level);
+        const uint32_t w = image.GetLevelWidth(level), h = image.GetLevelHeight(level);
+        const Axis ax = BuildAxis(src.width, w, settings.filter);
+        const Axis ay = BuildAxis(src.height, h, settings.filter);
+
+        const bool parallel = settings.pool && settings.pool->GetThreadCount() > 1 && (uint64_t)w * h >= settings.minParallelTexels;
+        if (parallel)
+        {
+            // A few bands per thread to even out the tail
+            const uint32_t bands = std::min(h, settings.pool->GetThreadCount() * 4);
+            settings.pool->Run(bands, [&](uint32_t band)
+            {
+                const uint32_t y0 = (uint32_t)((uint64_t)h * band / bands);
+                const uint32_t y1 = (uint32_t)((uint64_t)h * (band + 1) / bands);
+                FilterRows(src, dst, w, ax, ay, y0, y1, settings.gammaCorrect);
+            });
+        }
+        else
+        {
+            FilterRows(src, dst, w, ax, ay, 0, h, settings.gammaCorrect);
+        }
+
+        if (cutout) PreserveCoverage(dst, (size_t)w * h, settings.alphaCutoff, coverage);
+    }
+}
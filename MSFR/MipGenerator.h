@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+
+struct Image;
+class WorkerPool;
+
+enum class MipFilter { Box, Kaiser };
+
+struct MipSettings
+{
+    // Box averages the texels each level texel covers (with fractional
+    // weights for odd sizes); Kaiser is a windowed sinc three texels wide,
+    // sharper at the cost of slight ringing.
+    MipFilter filter = MipFilter::Box;
+    // Color is treated as sRGB and filtered in linear light; alpha is always
+    // linear. Off filters the stored values as they are.
+    bool gammaCorrect = true;
+    // Cutout images (every alpha 0 or 255) get each level's alpha scaled so
+    // the share of texels above this stays what it is in level 0, so they
+    // don't thin out with distance. Blended images are left alone. 0 = off.
+    float alphaCutoff = 0.5f;
+    // 0: down to 1x1. 1 generates nothing.
+    uint32_t maxLevels = 0;
+    // Levels with at least minParallelTexels texels are split into row bands
+    // run on pool; without one everything runs on the calling thread.
+    WorkerPool* pool = nullptr;
+    uint32_t minParallelTexels = 256 * 256;
+};
+
+uint32_t GetMipLevelCount(uint32_t width, uint32_t height, uint32_t maxLevels = 0);
+
+// Appends the mip chain to image.pixels after level 0 (replacing any levels
+// already there) and sets image.levels, so the whole chain is one buffer and
+// goes to the device in a single CreateTexture call. Each level is filtered
+// from the one above it with alpha-weighted color, so transparent texels
+// don't bleed their color into the edges. Block-compressed images are left
+// as they are.
+void GenerateMips(Image& image, const MipSettings& settings = {});
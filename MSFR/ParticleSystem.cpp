@@ -0,0 +1,387 @@
+#include "ParticleSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "TransientAllocator.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#define MSFR_PARTICLES_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    constexpr uint32_t SimdWidth = 4;
+    constexpr float UnitQuad[8] = { 0, 0, 1, 0, 1, 1, 0, 1 };
+    constexpr uint16_t QuadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+
+    uint32_t Padded(uint32_t count)
+    {
+        return (count + SimdWidth - 1) / SimdWidth * SimdWidth;
+    }
+
+    template <typename Key, typename Fn>
+    void BakeCurve(std::vector<Key> keys, uint32_t size, const Fn& write)
+    {
+        std::stable_sort(keys.begin(), keys.end(), [](const Key& a, const Key& b) { return a.time < b.time; });
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            const float t = (float)i / (float)(size - 1);
+            size_t next = 0;
+            while (next < keys.size() && keys[next].time < t) ++next;
+            if (next == 0) write(i, keys.front(), keys.front(), 0.f);
+            else if (next == keys.size()) write(i, keys.back(), keys.back(), 0.f);
+            else
+            {
+                const Key& a = keys[next - 1];
+                const Key& b = keys[next];
+                const float span = b.time - a.time;
+                write(i, a, b, span > 0.f ? (t - a.time) / span : 1.f);
+            }
+        }
+    }
+}
+
+ParticleSystem::ParticleSystem(uint32_t seed)
+    : rng(seed ? seed : 1u)
+{
+}
+
+ParticleSystem::~ParticleSystem()
+{
+    Shutdown();
+}
+
+void ParticleSystem::Init(IRenderDevice& device_, TransientAllocator& transient_)
+{
+    Shutdown();
+    device = &device_;
+    transient = &transient_;
+
+    pipeline = device->CreatePipeline(MakeInstancedSpritePipelineDesc());
+    cornerBuffer = device->CreateBuffer({ BufferType::Vertex, ResourceUsage::Immutable, sizeof(UnitQuad) }, UnitQuad);
+    indexBuffer = device->CreateBuffer({ BufferType::Index, ResourceUsage::Immutable, sizeof(QuadIndices) }, QuadIndices);
+}
+
+void ParticleSystem::Shutdown()
+{
+    if (!device) return;
+
+    device->Destroy(pipeline);
+    device->Destroy(cornerBuffer);
+    device->Destroy(indexBuffer);
+
+    pipeline = {};
+    cornerBuffer = {};
+    indexBuffer = {};
+    device = nullptr;
+    transient = nullptr;
+}
+
+uint32_t ParticleSystem::AddEmitter(const ParticleEmitterDesc& desc)
+{
+    uint32_t id = 0;
+    while (id < emitters.size() && emitters[id].live) ++id;
+    if (id == emitters.size()) emitters.emplace_back();
+
+    Emitter& emitter = emitters[id];
+    emitter = Emitter{};
+    emitter.desc = desc;
+    emitter.live = true;
+    for (int i = 0; i < 4; ++i) emitter.uvRect[i] = PackUNorm16(desc.uvRect[i]);
+
+    const size_t capacity = Padded(desc.maxParticles);
+    for (std::vector<float>* pool : { &emitter.posX, &emitter.posY, &emitter.velX, &emitter.velY,
+        &emitter.age, &emitter.invLifetime, &emitter.baseSize, &emitter.size })
+    {
+        pool->assign(capacity, 0.f);
+    }
+    emitter.color.assign(capacity, 0);
+
+    if (desc.sizeOverLife.empty())
+    {
+        std::fill(std::begin(emitter.sizeCurve), std::end(emitter.sizeCurve), 1.f);
+    }
+    else
+    {
+        BakeCurve(desc.sizeOverLife, CurveSize, [&](uint32_t i, const ParticleKey& a, const ParticleKey& b, float f)
+        {
+            emitter.sizeCurve[i] = a.value + (b.value - a.value) * f;
+        });
+    }
+    if (desc.colorOverLife.empty())
+    {
+        std::fill(std::begin(emitter.colorCurve), std::end(emitter.colorCurve), 0xFFFFFFFFu);
+    }
+    else
+    {
+        BakeCurve(desc.colorOverLife, CurveSize, [&](uint32_t i, const ParticleColorKey& a, const ParticleColorKey& b, float f)
+        {
+            emitter.colorCurve[i] = PackColor(a.r + (b.r - a.r) * f, a.g + (b.g - a.g) * f,
+                a.b + (b.b - a.b) * f, a.a + (b.a - a.a) * f);
+        });
+    }
+    return id;
+}
+
+void ParticleSystem::RemoveEmitter(uint32_t id)
+{
+    if (id >= emitters.size()) return;
+    emitters[id] = Emitter{};
+}
+
+void ParticleSystem::SetPosition(uint32_t id, float x, float y)
+{
+    if (id >= emitters.size() || !emitters[id].live) return;
+    emitters[id].x = x;
+    emitters[id].y = y;
+}
+
+void ParticleSystem::SetRate(uint32_t id, float rate)
+{
+    if (id >= emitters.size() || !emitters[id].live) return;
+    emitters[id].desc.rate = std::max(rate, 0.f);
+}
+
+void ParticleSystem::Burst(uint32_t id, uint32_t count)
+{
+    if (id >= emitters.size() || !emitters[id].live) return;
+    Emit(emitters[id], count);
+}
+
+void ParticleSystem::Clear(uint32_t id)
+{
+    if (id >= emitters.size()) return;
+    emitters[id].count = 0;
+    emitters[id].pending = 0.f;
+}
+
+uint32_t ParticleSystem::GetLiveCount(uint32_t id) const
+{
+    return id < emitters.size() ? emitters[id].count : 0;
+}
+
+void ParticleSystem::Update(double dt)
+{
+    const float step = (float)dt;
+    stats.emitters = 0;
+    stats.live = 0;
+    stats.emitted = 0;
+    stats.killed = 0;
+
+    for (Emitter& emitter : emitters)
+    {
+        if (!emitter.live) continue;
+        ++stats.emitters;
+
+        Simulate(emitter, step);
+        stats.killed += Compact(emitter);
+
+        emitter.pending += emitter.desc.rate * step;
+        const uint32_t due = (uint32_t)emitter.pending;
+        emitter.pending -= (float)due;
+        Emit(emitter, due);
+        stats.live += emitter.count;
+    }
+}
+
+void ParticleSystem::Draw(const float worldToScreen[6], float screenWidth, float screenHeight)
+{
+    stats.drawCalls = 0;
+    if (!device) return;
+
+    bool bound = false;
+    for (const Emitter& emitter : emitters)
+    {
+        if (!emitter.live || emitter.count == 0 || !emitter.desc.texture) continue;
+
+        // Quads centred on the particle; nothing but this loop touches all of them
+        instances.resize(emitter.count);
+        for (uint32_t i = 0; i < emitter.count; ++i)
+        {
+            SpriteInstance& out = instances[i];
+            const float s = emitter.size[i];
+            out.transform[0] = s;
+            out.transform[1] = 0.f;
+            out.transform[2] = 0.f;
+            out.transform[3] = s;
+            out.transform[4] = emitter.posX[i] - 0.5f * s;
+            out.transform[5] = emitter.posY[i] - 0.5f * s;
+            std::copy_n(emitter.uvRect, 4, out.uvRect);
+            out.color = emitter.color[i];
+        }
+        const TransientAllocation stream = transient->UploadVertices(instances.data(),
+            (uint32_t)(instances.size() * sizeof(SpriteInstance)));
+        if (!stream) continue;
+
+        if (!bound)
+        {
+            float projection[16];
+            MakeSpriteProjection(worldToScreen, screenWidth, screenHeight, projection);
+            const TransientAllocation cbRange = transient->UploadConstants(projection, sizeof(projection));
+            if (!cbRange) return;
+            device->SetPipeline(pipeline);
+            device->SetConstantBuffer(0, cbRange.buffer, cbRange.offset, cbRange.size);
+            device->SetIndexBuffer(indexBuffer, IndexFormat::UInt16);
+            device->SetVertexBuffer(0, cornerBuffer, sizeof(float) * 2, 0);
+            bound = true;
+        }
+        device->SetTexture(0, emitter.desc.texture);
+        device->SetVertexBuffer(1, stream.buffer, sizeof(SpriteInstance), stream.offset);
+        device->DrawIndexedInstanced(6, emitter.count, 0, 0, 0);
+        ++stats.drawCalls;
+    }
+}
+
+void ParticleSystem::Emit(Emitter& emitter, uint32_t count)
+{
+    const ParticleEmitterDesc& desc = emitter.desc;
+    count = std::min(count, desc.maxParticles - emitter.count);
+    if (count == 0) return;
+
+    // Every pool is written in its own pass over the new slots
+    const uint32_t begin = emitter.count;
+    const uint32_t end = begin + count;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const float lifetime = desc.lifetimeMin + (desc.lifetimeMax - desc.lifetimeMin) * NextRandom();
+        emitter.invLifetime[i] = 1.f / std::max(lifetime, 1.0e-4f);
+        emitter.age[i] = 0.f;
+    }
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const float angle = NextRandom() * 6.2831853f;
+        const float radius = desc.spawnRadius * std::sqrt(NextRandom());
+        emitter.posX[i] = emitter.x + radius * std::cos(angle);
+        emitter.posY[i] = emitter.y + radius * std::sin(angle);
+    }
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const float angle = desc.direction + (NextRandom() * 2.f - 1.f) * desc.spread;
+        const float speed = desc.speedMin + (desc.speedMax - desc.speedMin) * NextRandom();
+        emitter.velX[i] = speed * std::cos(angle);
+        emitter.velY[i] = speed * std::sin(angle);
+    }
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        emitter.baseSize[i] = desc.sizeMin + (desc.sizeMax - desc.sizeMin) * NextRandom();
+        emitter.size[i] = emitter.baseSize[i] * emitter.sizeCurve[0];
+        emitter.color[i] = emitter.colorCurve[0];
+    }
+    emitter.count = end;
+    stats.emitted += count;
+}
+
+void ParticleSystem::Simulate(Emitter& emitter, float dt)
+{
+    const float drag = std::exp(-emitter.desc.drag * dt);
+    const float gx = emitter.desc.gravityX * dt;
+    const float gy = emitter.desc.gravityY * dt;
+    const float curveScale = (float)(CurveSize - 1);
+
+    float* posX = emitter.posX.data();
+    float* posY = emitter.posY.data();
+    float* velX = emitter.velX.data();
+    float* velY = emitter.velY.data();
+    float* age = emitter.age.data();
+    const float* invLifetime = emitter.invLifetime.data();
+    const float* baseSize = emitter.baseSize.data();
+    float* size = emitter.size.data();
+    uint32_t* color = emitter.color.data();
+    const float* sizeCurve = emitter.sizeCurve;
+    const uint32_t* colorCurve = emitter.colorCurve;
+
+    // The pools are padded, so the last block may run over dead slots
+    const uint32_t count = Padded(emitter.count);
+#if MSFR_PARTICLES_SSE2
+    const __m128 vdt = _mm_set1_ps(dt);
+    const __m128 vdrag = _mm_set1_ps(drag);
+    const __m128 vgx = _mm_set1_ps(gx);
+    const __m128 vgy = _mm_set1_ps(gy);
+    const __m128 vone = _mm_set1_ps(1.f);
+    const __m128 vscale = _mm_set1_ps(curveScale);
+    alignas(16) int32_t lanes[4];
+    for (uint32_t i = 0; i < count; i += SimdWidth)
+    {
+        const __m128 a = _mm_add_ps(_mm_loadu_ps(age + i), _mm_mul_ps(vdt, _mm_loadu_ps(invLifetime + i)));
+        _mm_storeu_ps(age + i, a);
+
+        // Semi-implicit Euler: velocity first, then position with the new velocity
+        const __m128 vx = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(velX + i), vdrag), vgx);
+        const __m128 vy = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(velY + i), vdrag), vgy);
+        _mm_storeu_ps(velX + i, vx);
+        _mm_storeu_ps(velY + i, vy);
+        _mm_storeu_ps(posX + i, _mm_add_ps(_mm_loadu_ps(posX + i), _mm_mul_ps(vx, vdt)));
+        _mm_storeu_ps(posY + i, _mm_add_ps(_mm_loadu_ps(posY + i), _mm_mul_ps(vy, vdt)));
+
+        // Curve lookups: the index math is vector, the table reads are not
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(a, vone), vscale)));
+        const __m128 curve = _mm_setr_ps(sizeCurve[lanes[0]], sizeCurve[lanes[1]], sizeCurve[lanes[2]], sizeCurve[lanes[3]]);
+        _mm_storeu_ps(size + i, _mm_mul_ps(_mm_loadu_ps(baseSize + i), curve));
+        color[i] = colorCurve[lanes[0]];
+        color[i + 1] = colorCurve[lanes[1]];
+        color[i + 2] = colorCurve[lanes[2]];
+        color[i + 3] = colorCurve[lanes[3]];
+    }
+#else
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        age[i] += dt * invLifetime[i];
+        velX[i] = velX[i] * drag + gx;
+        velY[i] = velY[i] * drag + gy;
+        posX[i] += velX[i] * dt;
+        posY[i] += velY[i] * dt;
+        const int32_t lane = (int32_t)(std::min(age[i], 1.f) * curveScale);
+        size[i] = baseSize[i] * sizeCurve[lane];
+        color[i] = colorCurve[lane];
+    }
+#endif
+}
+
+uint32_t ParticleSystem::Compact(Emitter& emitter)
+{
+    float* age = emitter.age.data();
+    uint32_t n = emitter.count;
+    uint32_t i = 0;
+    while (i < n)
+    {
+#if MSFR_PARTICLES_SSE2
+        // Whole blocks of live particles are skipped four at a time
+        if (i + SimdWidth <= n && _mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(age + i), _mm_set1_ps(1.f))) == 0)
+        {
+            i += SimdWidth;
+            continue;
+        }
+#endif
+        if (age[i] < 1.f)
+        {
+            ++i;
+            continue;
+        }
+
+        // Dead: the last live particle takes its slot (order is not kept)
+        --n;
+        emitter.posX[i] = emitter.posX[n];
+        emitter.posY[i] = emitter.posY[n];
+        emitter.velX[i] = emitter.velX[n];
+        emitter.velY[i] = emitter.velY[n];
+        age[i] = age[n];
+        emitter.invLifetime[i] = emitter.invLifetime[n];
+        emitter.baseSize[i] = emitter.baseSize[n];
+        emitter.size[i] = emitter.size[n];
+        emitter.color[i] = emitter.color[n];
+    }
+    const uint32_t killed = emitter.count - n;
+    emitter.count = n;
+    return killed;
+}
+
+float ParticleSystem::NextRandom()
+{
+    // xorshift32: cheap, and the same sequence on every platform for a seed
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (float)(rng >> 8) * (1.f / 16777216.f);
+}
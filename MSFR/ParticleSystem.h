@@ -0,0 +1,133 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Component.h"
+#include "RenderDevice.h"
+#include "SpriteBatch.h"
+
+// Value over a particle's normalized age (0 at birth, 1 at death), linear
+// between keys. Without keys the value is 1.
+struct ParticleKey
+{
+    float time;
+    float value;
+};
+
+struct ParticleColorKey
+{
+    float time;
+    float r, g, b, a;
+};
+
+struct ParticleEmitterDesc
+{
+    TextureHandle texture;
+    float uvRect[4] = { 0, 0, 1, 1 };   // as in SpriteDrawItem
+
+    uint32_t maxParticles = 10000;
+    float rate = 0.f;                   // particles per second, see also Burst
+    float lifetimeMin = 1.f;            // seconds
+    float lifetimeMax = 1.f;
+
+    float spawnRadius = 0.f;            // world units around the emitter
+    float direction = 1.5707963f;       // radians, 0 along +x
+    float spread = 3.1415927f;          // half angle around direction
+    float speedMin = 0.f;               // world units per second
+    float speedMax = 0.f;
+
+    float gravityX = 0.f;               // world units per second squared
+    float gravityY = 0.f;
+    float drag = 0.f;                   // velocity lost per second, as a rate
+
+    float sizeMin = 8.f;                // world units, picked per particle
+    float sizeMax = 8.f;
+    std::vector<ParticleKey> sizeOverLife;          // multiplies the size
+    std::vector<ParticleColorKey> colorOverLife;
+};
+
+// Particles without GameObjects. Every emitter keeps its particles as
+// structure-of-arrays pools that the update runs over with SIMD (gravity,
+// drag, integration and the size/color-over-life curves, baked to tables).
+// Dead particles are swap-compacted so the live ones stay packed at the
+// front, and each emitter draws all its particles with one instanced draw,
+// streamed through the transient vertex ring. Add it to a game state and
+// call Draw after the sprites, so particles end up on top.
+class ParticleSystem : public Component
+{
+public:
+    static constexpr uint32_t Invalid = 0xFFFFFFFF;
+
+    struct Stats
+    {
+        uint32_t emitters = 0;
+        uint32_t live = 0;
+        uint32_t emitted = 0;       // last Update
+        uint32_t killed = 0;        // last Update
+        uint32_t drawCalls = 0;     // last Draw
+    };
+
+    explicit ParticleSystem(uint32_t seed = 0x2545F491u);
+    ~ParticleSystem();
+
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+    void Init(IRenderDevice& device, TransientAllocator& transient);
+    void Shutdown();
+
+    // Returns an emitter id for the calls below.
+    uint32_t AddEmitter(const ParticleEmitterDesc& desc);
+    void RemoveEmitter(uint32_t emitter);
+    void SetPosition(uint32_t emitter, float x, float y);
+    void SetRate(uint32_t emitter, float rate);
+    // Emits count particles at once (capped by maxParticles).
+    void Burst(uint32_t emitter, uint32_t count);
+    void Clear(uint32_t emitter);
+    uint32_t GetLiveCount(uint32_t emitter) const;
+
+    void Update(double dt) override;
+    // worldToScreen uses SpriteDrawItem's column-major 2x3 layout.
+    void Draw(const float worldToScreen[6], float screenWidth, float screenHeight);
+
+    const Stats& GetStats() const { return stats; }
+
+private:
+    static constexpr uint32_t CurveSize = 256;
+
+    struct Emitter
+    {
+        ParticleEmitterDesc desc;
+        bool live = false;
+        float x = 0.f;
+        float y = 0.f;
+        float pending = 0.f;    // fractional particles owed by the rate
+        uint16_t uvRect[4] = {};
+
+        // Pools, padded to a multiple of the SIMD width
+        uint32_t count = 0;
+        std::vector<float> posX, posY, velX, velY;
+        std::vector<float> age, invLifetime;    // age is normalized
+        std::vector<float> baseSize, size;
+        std::vector<uint32_t> color;
+
+        float sizeCurve[CurveSize];
+        uint32_t colorCurve[CurveSize];
+    };
+
+    void Emit(Emitter& emitter, uint32_t count);
+    void Simulate(Emitter& emitter, float dt);
+    uint32_t Compact(Emitter& emitter);
+    float NextRandom();   // [0, 1)
+
+    IRenderDevice* device = nullptr;
+    TransientAllocator* transient = nullptr;
+    PipelineHandle pipeline;
+    BufferHandle cornerBuffer;
+    BufferHandle indexBuffer;
+
+    std::vector<Emitter> emitters;
+    std::vector<SpriteInstance> instances;
+    uint32_t rng;
+    Stats stats;
+};
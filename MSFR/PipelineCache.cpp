@@ -0,0 +1,80 @@
+#include "PipelineCache.h"
+
+#include "Hash.h"
+
+uint64_t HashPipelineDesc(const PipelineDesc& desc) noexcept
+{
+    uint64_t h = HashString(desc.shaderPath);
+    h = HashString(desc.vsEntry, h);
+    h = HashString(desc.psEntry, h);
+    for (const VertexElement& e : desc.layout)
+    {
+        h = HashString(e.semantic, h);
+        h = HashValue(e.semanticIndex, h);
+        h = HashValue(e.format, h);
+        h = HashValue(e.slot, h);
+        h = HashValue(e.offset, h);
+        h = HashValue(e.instanceStepRate, h);
+    }
+    h = HashValue(desc.blend, h);
+    h = HashValue(desc.topology, h);
+    return HashValue(desc.sampler, h);
+}
+
+bool operator==(const VertexElement& a, const VertexElement& b) noexcept
+{
+    return a.semantic == b.semantic && a.semanticIndex == b.semanticIndex && a.format == b.format
+        && a.slot == b.slot && a.offset == b.offset && a.instanceStepRate == b.instanceStepRate;
+}
+
+bool operator==(const PipelineDesc& a, const PipelineDesc& b) noexcept
+{
+    return a.shaderPath == b.shaderPath && a.vsEntry == b.vsEntry && a.psEntry == b.psEntry
+        && a.layout == b.layout && a.blend == b.blend && a.topology == b.topology && a.sampler == b.sampler;
+}
+
+uint32_t PipelineCache::Acquire(const PipelineDesc& desc)
+{
+    ++stats.requests;
+    const uint64_t hash = HashPipelineDesc(desc);
+    auto range = byHash.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        Entry& entry = entries.at(it->second);
+        if (entry.desc == desc)
+        {
+            ++entry.refs;
+            ++stats.shared;
+            return it->second;
+        }
+    }
+    return 0;
+}
+
+void PipelineCache::Insert(const PipelineDesc& desc, uint32_t id)
+{
+    const uint64_t hash = HashPipelineDesc(desc);
+    entries[id] = { desc, hash, 1 };
+    byHash.emplace(hash, id);
+    ++stats.unique;
+}
+
+bool PipelineCache::Release(uint32_t id)
+{
+    auto it = entries.find(id);
+    if (it == entries.end()) return true;
+    if (--it->second.refs > 0) return false;
+
+    auto range = byHash.equal_range(it->second.hash);
+    for (auto h = range.first; h != range.second; ++h)
+    {
+        if (h->second == id)
+        {
+            byHash.erase(h);
+            break;
+        }
+    }
+    entries.erase(it);
+    --stats.unique;
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+
+#include "RenderDevice.h"
+
+uint64_t HashPipelineDesc(const PipelineDesc& desc) noexcept;
+bool operator==(const VertexElement& a, const VertexElement& b) noexcept;
+bool operator==(const PipelineDesc& a, const PipelineDesc& b) noexcept;
+
+// Deduplicates pipeline states inside a backend. CreatePipeline asks Acquire
+// first and only builds API objects on a miss; every handle handed out holds
+// one reference and Destroy releases it, so the shared object lives until its
+// last user is gone. Pipelines are immutable once created.
+class PipelineCache
+{
+public:
+    // Id of a live identical pipeline with a reference added, or 0.
+    uint32_t Acquire(const PipelineDesc& desc);
+    // Registers a freshly built pipeline with one reference.
+    void Insert(const PipelineDesc& desc, uint32_t id);
+    // True when the backend should free the object now (last reference gone or unknown id).
+    bool Release(uint32_t id);
+
+    const PipelineStats& GetStats() const { return stats; }
+
+private:
+    struct Entry
+    {
+        PipelineDesc desc;
+        uint64_t hash = 0;
+        uint32_t refs = 0;
+    };
+
+    std::unordered_map<uint32_t, Entry> entries;
+    std::unordered_multimap<uint64_t, uint32_t> byHash;
+    PipelineStats stats;
+};
@@ -0,0 +1,303 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Thin, API-agnostic render device. Resources are referred to by small handles
+// owned by the device; the D3D11 backend and the null (recording) backend both
+// implement this interface so the CPU side of rendering can run headless.
+
+struct BufferHandle
+{
+    uint32_t id = 0;
+    explicit operator bool() const noexcept { return id != 0; }
+};
+
+struct TextureHandle
+{
+    uint32_t id = 0;
+    explicit operator bool() const noexcept { return id != 0; }
+};
+
+struct PipelineHandle
+{
+    uint32_t id = 0;
+    explicit operator bool() const noexcept { return id != 0; }
+};
+
+constexpr bool operator==(BufferHandle a, BufferHandle b) noexcept { return a.id == b.id; }
+constexpr bool operator!=(BufferHandle a, BufferHandle b) noexcept { return a.id != b.id; }
+constexpr bool operator==(TextureHandle a, TextureHandle b) noexcept { return a.id == b.id; }
+constexpr bool operator!=(TextureHandle a, TextureHandle b) noexcept { return a.id != b.id; }
+constexpr bool operator==(PipelineHandle a, PipelineHandle b) noexcept { return a.id == b.id; }
+constexpr bool operator!=(PipelineHandle a, PipelineHandle b) noexcept { return a.id != b.id; }
+
+enum class BufferType { Vertex, Index, Constant };
+
+// Constant buffer ranges bound with an offset start on this boundary.
+constexpr uint32_t ConstantBufferAlignment = 256;
+// RenderTarget applies to textures only: written by draws (SetRenderTarget),
+// sampled like any other texture, never initialized or updated from the CPU.
+enum class ResourceUsage { Immutable, Dynamic, RenderTarget };
+
+struct BufferDesc
+{
+    BufferType type = BufferType::Vertex;
+    ResourceUsage usage = ResourceUsage::Immutable;
+    uint32_t byteWidth = 0;
+};
+
+// BC formats store 4x4 texel blocks, 8 bytes each for BC1 and 16 for BC3
+// and BC7. Their level 0 must be a multiple of 4 on each side, and they
+// can't be dynamic or render targets.
+enum class TextureFormat { RGBA8, BC1, BC3, BC7 };
+
+inline bool IsBlockCompressed(TextureFormat format) noexcept { return format != TextureFormat::RGBA8; }
+
+// Bytes per row of texels, or per row of blocks for BC formats.
+inline uint32_t GetRowPitch(TextureFormat format, uint32_t width) noexcept
+{
+    switch (format)
+    {
+    case TextureFormat::BC1: return ((width + 3) / 4) * 8;
+    case TextureFormat::BC3:
+    case TextureFormat::BC7: return ((width + 3) / 4) * 16;
+    default: return width * 4;
+    }
+}
+
+// Rows as GetRowPitch counts them.
+inline uint32_t GetRowCount(TextureFormat format, uint32_t height) noexcept
+{
+    return IsBlockCompressed(format) ? (height + 3) / 4 : height;
+}
+
+// Mip chain with levels back to back, as TextureDX11 and DdsCodec store it.
+inline uint64_t GetTextureBytes(TextureFormat format, uint32_t width, uint32_t height, uint32_t levels) noexcept
+{
+    uint64_t bytes = 0;
+    for (uint32_t mip = 0; mip < levels; ++mip)
+    {
+        const uint32_t w = (width >> mip) ? (width >> mip) : 1;
+        const uint32_t h = (height >> mip) ? (height >> mip) : 1;
+        bytes += uint64_t(GetRowPitch(format, w)) * GetRowCount(format, h);
+    }
+    return bytes;
+}
+
+// Dynamic textures may be created without initial data and patched with
+// UpdateTexture; immutable ones need every mip up front.
+struct TextureDesc
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mipLevels = 1;
+    TextureFormat format = TextureFormat::RGBA8;
+    ResourceUsage usage = ResourceUsage::Immutable;
+};
+
+struct TextureRegion
+{
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+// One entry per mip level.
+struct SubresourceData
+{
+    const void* pixels = nullptr;
+    uint32_t rowPitch = 0;
+    uint32_t slicePitch = 0;
+};
+
+inline uint64_t GetUploadBytes(const TextureDesc& desc, const SubresourceData* mips) noexcept
+{
+    uint64_t bytes = 0;
+    for (uint32_t mip = 0; mips && mip < desc.mipLevels; ++mip)
+    {
+        const uint32_t h = (desc.height >> mip) ? (desc.height >> mip) : 1;
+        bytes += mips[mip].slicePitch ? mips[mip].slicePitch : uint64_t(mips[mip].rowPitch) * GetRowCount(desc.format, h);
+    }
+    return bytes;
+}
+
+enum class VertexFormat { Float2, Float3, Float4, UNorm8x4, UNorm16x4 };
+
+struct VertexElement
+{
+    std::string semantic;
+    uint32_t semanticIndex = 0;
+    VertexFormat format = VertexFormat::Float2;
+    uint32_t slot = 0;
+    uint32_t offset = 0;
+    uint32_t instanceStepRate = 0;  // 0: per vertex, n: advances every n instances
+};
+
+enum class BlendMode { Opaque, Alpha };
+enum class PrimitiveTopology { TriangleList, LineStrip };
+enum class SamplerFilter { Linear, Point };
+enum class IndexFormat { UInt16, UInt32 };
+
+struct PipelineDesc
+{
+    std::string shaderPath;
+    std::string vsEntry = "VSMain";
+    std::string psEntry = "PSMain";
+    std::vector<VertexElement> layout;
+
+    BlendMode blend = BlendMode::Alpha;
+    PrimitiveTopology topology = PrimitiveTopology::TriangleList;
+    SamplerFilter sampler = SamplerFilter::Linear;
+};
+
+struct RenderFrameStats
+{
+    uint32_t drawCalls = 0;
+    uint32_t stateChanges = 0;    // binds that actually changed device state
+    uint32_t redundantBinds = 0;  // binds skipped because the state was already set
+    uint64_t bytesUploaded = 0;   // buffer updates + resource creation payloads
+};
+
+struct PipelineStats
+{
+    uint32_t unique = 0;      // live pipeline state objects
+    uint32_t requests = 0;    // CreatePipeline calls
+    uint32_t shared = 0;      // requests served by an existing identical pipeline
+};
+
+// Tracks the currently bound state so backends skip redundant binds and count
+// the ones that reach the API.
+class RenderStateTracker
+{
+public:
+    static constexpr uint32_t MaxSlots = 8;
+
+    void Reset() noexcept { *this = RenderStateTracker{}; }
+
+    bool Pipeline(PipelineHandle p) noexcept { return Track(pipeline, p); }
+    bool IndexBuffer(BufferHandle b) noexcept { return Track(indexBuffer, b); }
+    bool ConstantBuffer(uint32_t slot, BufferHandle b, uint32_t offset = 0) noexcept
+    {
+        if (slot >= MaxSlots) return Count(true);
+        const bool changed = constantBuffers[slot] != b || constantOffsets[slot] != offset;
+        constantBuffers[slot] = b;
+        constantOffsets[slot] = offset;
+        return Count(changed);
+    }
+    bool Texture(uint32_t slot, TextureHandle t) noexcept { return slot < MaxSlots ? Track(textures[slot], t) : Count(true); }
+    bool RenderTarget(TextureHandle t) noexcept { return Track(renderTarget, t); }
+    // Forgets the slots t is bound to, so the next SetTexture rebinds them;
+    // returns them as a bit mask. Used when t becomes the render target.
+    uint32_t UnbindTexture(TextureHandle t) noexcept
+    {
+        uint32_t mask = 0;
+        for (uint32_t slot = 0; t && slot < MaxSlots; ++slot)
+        {
+            if (textures[slot] != t) continue;
+            textures[slot] = {};
+            mask |= 1u << slot;
+        }
+        return mask;
+    }
+    bool VertexBuffer(uint32_t slot, BufferHandle b, uint32_t stride, uint32_t offset) noexcept
+    {
+        if (slot >= MaxSlots) return Count(true);
+        VertexStream& vs = vertexBuffers[slot];
+        const bool changed = vs.buffer != b || vs.stride != stride || vs.offset != offset;
+        vs = { b, stride, offset };
+        return Count(changed);
+    }
+
+    RenderFrameStats stats;
+
+private:
+    template <typename H>
+    bool Track(H& bound, H next) noexcept
+    {
+        const bool changed = bound != next;
+        bound = next;
+        return Count(changed);
+    }
+
+    bool Count(bool changed) noexcept
+    {
+        if (changed) ++stats.stateChanges;
+        else ++stats.redundantBinds;
+        return changed;
+    }
+
+    struct VertexStream
+    {
+        BufferHandle buffer;
+        uint32_t stride = 0;
+        uint32_t offset = 0;
+    };
+
+    PipelineHandle pipeline;
+    BufferHandle indexBuffer;
+    BufferHandle constantBuffers[MaxSlots];
+    uint32_t constantOffsets[MaxSlots] = {};
+    TextureHandle textures[MaxSlots];
+    VertexStream vertexBuffers[MaxSlots];
+    TextureHandle renderTarget;     // empty: the back buffer
+};
+
+class IRenderDevice
+{
+public:
+    virtual ~IRenderDevice() = default;
+
+    // Resources
+    virtual BufferHandle CreateBuffer(const BufferDesc& desc, const void* initialData) = 0;
+    virtual TextureHandle CreateTexture(const TextureDesc& desc, const SubresourceData* mips) = 0;
+    // Identical descs share one pipeline object; each returned handle must
+    // still be destroyed once.
+    virtual PipelineHandle CreatePipeline(const PipelineDesc& desc) = 0;
+
+    virtual void Destroy(BufferHandle buffer) = 0;
+    virtual void Destroy(TextureHandle texture) = 0;
+    virtual void Destroy(PipelineHandle pipeline) = 0;
+
+    // Replaces the whole contents of a dynamic buffer (WRITE_DISCARD semantics).
+    virtual void UpdateBuffer(BufferHandle buffer, const void* data, uint32_t bytes) = 0;
+    // Writes a range of a dynamic buffer without discarding the rest
+    // (NO_OVERWRITE semantics): the caller guarantees the GPU is done with it.
+    virtual void WriteBuffer(BufferHandle buffer, uint32_t offset, const void* data, uint32_t bytes) = 0;
+    // Writes a rectangle of mip 0 of a dynamic texture; rowPitch is in bytes.
+    virtual void UpdateTexture(TextureHandle texture, const TextureRegion& region, const void* pixels, uint32_t rowPitch) = 0;
+
+    // Frame
+    virtual void BeginFrame() = 0;
+    virtual void EndFrame() = 0;
+    // Fences: frames are numbered from 1 by BeginFrame. GetCompletedFrame is
+    // the newest frame whose GPU work has finished, so anything it used may
+    // be overwritten.
+    virtual uint64_t GetCurrentFrame() const = 0;
+    virtual uint64_t GetCompletedFrame() = 0;
+
+    // State
+    virtual void SetPipeline(PipelineHandle pipeline) = 0;
+    virtual void SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset) = 0;
+    virtual void SetIndexBuffer(BufferHandle buffer, IndexFormat format) = 0;
+    // bytes == 0 binds the whole buffer; otherwise offset is a multiple of
+    // ConstantBufferAlignment.
+    virtual void SetConstantBuffer(uint32_t slot, BufferHandle buffer, uint32_t offset = 0, uint32_t bytes = 0) = 0;
+    virtual void SetTexture(uint32_t slot, TextureHandle texture) = 0;
+    // Directs draws into a RenderTarget texture; an empty handle selects the
+    // back buffer, which BeginFrame binds. The viewport covers the target.
+    virtual void SetRenderTarget(TextureHandle target) = 0;
+    // Clears the bound render target (and the back buffer's depth) to RGBA.
+    virtual void ClearRenderTarget(const float color[4]) = 0;
+
+    // Draw submission
+    virtual void Draw(uint32_t vertexCount, uint32_t startVertex) = 0;
+    virtual void DrawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex) = 0;
+    virtual void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount,
+        uint32_t startIndex, int32_t baseVertex, uint32_t startInstance) = 0;
+
+    // Stats of the last completed frame (BeginFrame..EndFrame).
+    virtual const RenderFrameStats& GetFrameStats() const = 0;
+    virtual const PipelineStats& GetPipelineStats() const = 0;
+};
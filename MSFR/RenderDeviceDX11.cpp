@@ -0,0 +1,567 @@
+#include "RenderDeviceDX11.h"
+
+#include <d3dcompiler.h>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#pragma comment(lib, "d3dcompiler.lib")
+
+namespace
+{
+    using Microsoft::WRL::ComPtr;
+
+    template <typename T>
+    void ThrowIfFailed(HRESULT hr, const T& msg)
+    {
+        if (FAILED(hr)) throw std::runtime_error(msg);
+    }
+
+    class ShaderCompilerDX11 final : public IShaderCompiler
+    {
+    public:
+        std::string GetVersionTag() const override
+        {
+            return "d3dcompiler_" + std::to_string(D3D_COMPILER_VERSION) + "/" + std::to_string(GetFlags());
+        }
+
+        bool Compile(const ShaderCompileRequest& request, ShaderBytecode& out, std::string& error) override
+        {
+            std::vector<D3D_SHADER_MACRO> macros;
+            for (const ShaderDefine& d : request.defines) macros.push_back({ d.name.c_str(), d.value.c_str() });
+            macros.push_back({ nullptr, nullptr });
+
+            ComPtr<ID3DBlob> blob;
+            ComPtr<ID3DBlob> err;
+            HRESULT hr = D3DCompileFromFile(
+                request.sourcePath.wstring().c_str(), macros.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE,
+                request.entry.c_str(), request.target.c_str(), GetFlags(), 0,
+                blob.GetAddressOf(), err.GetAddressOf());
+
+            if (FAILED(hr))
+            {
+                error = "D3DCompileFromFile failed: ";
+                if (err) error += (const char*)err->GetBufferPointer();
+                return false;
+            }
+            const uint8_t* code = (const uint8_t*)blob->GetBufferPointer();
+            out.assign(code, code + blob->GetBufferSize());
+            return true;
+        }
+
+    private:
+        static UINT GetFlags()
+        {
+            UINT flags = 0;
+#if defined(_DEBUG)
+            flags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+            return flags;
+        }
+    };
+
+    UINT ToBindFlags(BufferType type)
+    {
+        switch (type)
+        {
+        case BufferType::Vertex:   return D3D11_BIND_VERTEX_BUFFER;
+        case BufferType::Index:    return D3D11_BIND_INDEX_BUFFER;
+        case BufferType::Constant: return D3D11_BIND_CONSTANT_BUFFER;
+        }
+        return 0;
+    }
+
+    DXGI_FORMAT ToDXGI(VertexFormat format)
+    {
+        switch (format)
+        {
+        case VertexFormat::Float2:   return DXGI_FORMAT_R32G32_FLOAT;
+        case VertexFormat::Float3:   return DXGI_FORMAT_R32G32B32_FLOAT;
+        case VertexFormat::Float4:   return DXGI_FORMAT_R32G32B32A32_FLOAT;
+        case VertexFormat::UNorm8x4: return DXGI_FORMAT_R8G8B8A8_UNORM;
+        case VertexFormat::UNorm16x4: return DXGI_FORMAT_R16G16B16A16_UNORM;
+        }
+        return DXGI_FORMAT_UNKNOWN;
+    }
+
+    DXGI_FORMAT ToDXGI(TextureFormat format)
+    {
+        switch (format)
+        {
+        case TextureFormat::RGBA8: return DXGI_FORMAT_R8G8B8A8_UNORM;
+        case TextureFormat::BC1: return DXGI_FORMAT_BC1_UNORM;
+        case TextureFormat::BC3: return DXGI_FORMAT_BC3_UNORM;
+        case TextureFormat::BC7: return DXGI_FORMAT_BC7_UNORM;
+        }
+        return DXGI_FORMAT_UNKNOWN;
+    }
+}
+
+RenderDeviceDX11::RenderDeviceDX11(ID3D11Device* device_, ID3D11DeviceContext* context_,
+    const std::filesystem::path& shaderCacheDir)
+    : device(device_), context(context_)
+{
+    if (!device || !context)
+        throw std::runtime_error("RenderDeviceDX11: device/context is null.");
+
+    shaderCompiler = std::make_unique<ShaderCompilerDX11>();
+    shaderCache = std::make_unique<ShaderCache>(*shaderCompiler, shaderCacheDir);
+
+    // Binding constant buffer ranges needs the 11.1 context and driver support
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+    if (SUCCEEDED(context->QueryInterface(IID_PPV_ARGS(context1.GetAddressOf())))
+        && SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options)))
+        && (!options.ConstantBufferOffsetting || !options.MapNoOverwriteOnDynamicConstantBuffer))
+    {
+        context1.Reset();
+    }
+
+    D3D11_QUERY_DESC qd{ D3D11_QUERY_EVENT, 0 };
+    for (ComPtr<ID3D11Query>& query : frameQueries)
+    {
+        ThrowIfFailed(device->CreateQuery(&qd, query.GetAddressOf()), "CreateQuery failed.");
+    }
+}
+
+RenderDeviceDX11::~RenderDeviceDX11() = default;
+
+BufferHandle RenderDeviceDX11::CreateBuffer(const BufferDesc& desc, const void* initialData)
+{
+    D3D11_BUFFER_DESC bd{};
+    bd.ByteWidth = desc.byteWidth;
+    bd.BindFlags = ToBindFlags(desc.type);
+    if (desc.usage == ResourceUsage::Dynamic)
+    {
+        bd.Usage = D3D11_USAGE_DYNAMIC;
+        bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    }
+    else
+    {
+        bd.Usage = D3D11_USAGE_IMMUTABLE;
+    }
+
+    D3D11_SUBRESOURCE_DATA init{};
+    init.pSysMem = initialData;
+
+    Buffer buffer;
+    buffer.desc = desc;
+    ThrowIfFailed(device->CreateBuffer(&bd, initialData ? &init : nullptr, buffer.buffer.GetAddressOf()),
+        "CreateBuffer failed.");
+    if (!context1 && desc.type == BufferType::Constant && desc.usage == ResourceUsage::Dynamic)
+    {
+        buffer.shadow.resize(desc.byteWidth);
+    }
+
+    if (initialData) state.stats.bytesUploaded += desc.byteWidth;
+
+    const uint32_t id = nextId++;
+    buffers.emplace(id, std::move(buffer));
+    return BufferHandle{ id };
+}
+
+TextureHandle RenderDeviceDX11::CreateTexture(const TextureDesc& desc, const SubresourceData* mips)
+{
+    if (IsBlockCompressed(desc.format) && desc.usage != ResourceUsage::Immutable)
+        throw std::runtime_error("CreateTexture: block-compressed texture must be immutable.");
+
+    D3D11_TEXTURE2D_DESC td{};
+    td.Width = desc.width;
+    td.Height = desc.height;
+    td.MipLevels = desc.mipLevels;
+    td.ArraySize = 1;
+    td.Format = ToDXGI(desc.format);
+    td.SampleDesc.Count = 1;
+    // Dynamic textures are patched with UpdateSubresource, which needs DEFAULT
+    td.Usage = desc.usage == ResourceUsage::Immutable ? D3D11_USAGE_IMMUTABLE : D3D11_USAGE_DEFAULT;
+    td.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    if (desc.usage == ResourceUsage::RenderTarget)
+    {
+        if (mips) throw std::runtime_error("CreateTexture: render target with initial data.");
+        td.BindFlags |= D3D11_BIND_RENDER_TARGET;
+    }
+
+    std::vector<D3D11_SUBRESOURCE_DATA> init(mips ? desc.mipLevels : 0);
+    for (uint32_t mip = 0; mips && mip < desc.mipLevels; ++mip)
+    {
+        init[mip].pSysMem = mips[mip].pixels;
+        init[mip].SysMemPitch = mips[mip].rowPitch;
+        init[mip].SysMemSlicePitch = mips[mip].slicePitch;
+    }
+
+    Texture tex;
+    ThrowIfFailed(device->CreateTexture2D(&td, init.empty() ? nullptr : init.data(), tex.texture.GetAddressOf()),
+        "CreateTexture2D failed.");
+    ThrowIfFailed(device->CreateShaderResourceView(tex.texture.Get(), nullptr, tex.srv.GetAddressOf()),
+        "CreateShaderResourceView failed.");
+    if (desc.usage == ResourceUsage::RenderTarget)
+    {
+        ThrowIfFailed(device->CreateRenderTargetView(tex.texture.Get(), nullptr, tex.rtv.GetAddressOf()),
+            "CreateRenderTargetView failed.");
+    }
+    tex.width = desc.width;
+    tex.height = desc.height;
+
+    state.stats.bytesUploaded += GetUploadBytes(desc, mips);
+
+    const uint32_t id = nextId++;
+    textures.emplace(id, std::move(tex));
+    return TextureHandle{ id };
+}
+
+PipelineHandle RenderDeviceDX11::CreatePipeline(const PipelineDesc& desc)
+{
+    if (const uint32_t shared = pipelineCache.Acquire(desc)) return PipelineHandle{ shared };
+
+    const auto vsCode = GetShader(desc.shaderPath, desc.vsEntry, "vs_5_0");
+    const auto psCode = GetShader(desc.shaderPath, desc.psEntry, "ps_5_0");
+
+    Pipeline p;
+    ThrowIfFailed(device->CreateVertexShader(vsCode->data(), vsCode->size(), nullptr, p.vs.GetAddressOf()),
+        "CreateVertexShader failed.");
+    ThrowIfFailed(device->CreatePixelShader(psCode->data(), psCode->size(), nullptr, p.ps.GetAddressOf()),
+        "CreatePixelShader failed.");
+
+    std::vector<D3D11_INPUT_ELEMENT_DESC> layout;
+    layout.reserve(desc.layout.size());
+    for (const VertexElement& e : desc.layout)
+    {
+        layout.push_back({ e.semantic.c_str(), e.semanticIndex, ToDXGI(e.format), e.slot, e.offset,
+            e.instanceStepRate ? D3D11_INPUT_PER_INSTANCE_DATA : D3D11_INPUT_PER_VERTEX_DATA, e.instanceStepRate });
+    }
+    ThrowIfFailed(device->CreateInputLayout(layout.data(), (UINT)layout.size(),
+        vsCode->data(), vsCode->size(), p.inputLayout.GetAddressOf()),
+        "CreateInputLayout failed.");
+
+    D3D11_BLEND_DESC bd{};
+    bd.RenderTarget[0].BlendEnable = desc.blend == BlendMode::Alpha ? TRUE : FALSE;
+    bd.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
+    bd.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+    bd.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+    bd.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+    bd.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_INV_SRC_ALPHA;
+    bd.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
+    bd.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+    ThrowIfFailed(device->CreateBlendState(&bd, p.blendState.GetAddressOf()),
+        "CreateBlendState failed.");
+
+    D3D11_RASTERIZER_DESC rd{};
+    rd.FillMode = D3D11_FILL_SOLID;
+    rd.CullMode = D3D11_CULL_NONE;
+    rd.ScissorEnable = FALSE;
+    rd.DepthClipEnable = TRUE;
+    ThrowIfFailed(device->CreateRasterizerState(&rd, p.rasterState.GetAddressOf()),
+        "CreateRasterizerState failed.");
+
+    D3D11_SAMPLER_DESC samp{};
+    samp.Filter = desc.sampler == SamplerFilter::Point ? D3D11_FILTER_MIN_MAG_MIP_POINT : D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    samp.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samp.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samp.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samp.MaxLOD = D3D11_FLOAT32_MAX;
+    ThrowIfFailed(device->CreateSamplerState(&samp, p.sampler.GetAddressOf()),
+        "CreateSamplerState failed.");
+
+    p.topology = desc.topology == PrimitiveTopology::LineStrip
+        ? D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP
+        : D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+
+    const uint32_t id = nextId++;
+    pipelines.emplace(id, std::move(p));
+    pipelineCache.Insert(desc, id);
+    return PipelineHandle{ id };
+}
+
+void RenderDeviceDX11::Destroy(BufferHandle buffer)
+{
+    buffers.erase(buffer.id);
+}
+
+void RenderDeviceDX11::Destroy(TextureHandle texture)
+{
+    textures.erase(texture.id);
+}
+
+void RenderDeviceDX11::Destroy(PipelineHandle pipeline)
+{
+    if (pipelineCache.Release(pipeline.id)) pipelines.erase(pipeline.id);
+}
+
+void RenderDeviceDX11::UpdateBuffer(BufferHandle buffer, const void* data, uint32_t bytes)
+{
+    auto it = buffers.find(buffer.id);
+    if (it == buffers.end()) return;
+    Buffer& b = it->second;
+
+    D3D11_MAPPED_SUBRESOURCE ms{};
+    ThrowIfFailed(context->Map(b.buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms), "Map(buffer) failed.");
+    std::memcpy(ms.pData, data, bytes);
+    context->Unmap(b.buffer.Get(), 0);
+    if (!b.shadow.empty()) std::memcpy(b.shadow.data(), data, bytes);
+
+    state.stats.bytesUploaded += bytes;
+}
+
+void RenderDeviceDX11::WriteBuffer(BufferHandle buffer, uint32_t offset, const void* data, uint32_t bytes)
+{
+    auto it = buffers.find(buffer.id);
+    if (it == buffers.end()) return;
+    Buffer& b = it->second;
+    if (b.desc.usage != ResourceUsage::Dynamic || offset > b.desc.byteWidth || bytes > b.desc.byteWidth - offset)
+        throw std::runtime_error("WriteBuffer: buffer is not dynamic or range out of bounds.");
+
+    if (!b.shadow.empty())
+    {
+        std::memcpy(b.shadow.data() + offset, data, bytes);
+        return;
+    }
+
+    D3D11_MAPPED_SUBRESOURCE ms{};
+    ThrowIfFailed(context->Map(b.buffer.Get(), 0, D3D11_MAP_WRITE_NO_OVERWRITE, 0, &ms), "Map(buffer) failed.");
+    std::memcpy((uint8_t*)ms.pData + offset, data, bytes);
+    context->Unmap(b.buffer.Get(), 0);
+
+    state.stats.bytesUploaded += bytes;
+}
+
+void RenderDeviceDX11::UpdateTexture(TextureHandle texture, const TextureRegion& region, const void* pixels, uint32_t rowPitch)
+{
+    auto it = textures.find(texture.id);
+    if (it == textures.end()) return;
+
+    const D3D11_BOX box{ region.x, region.y, 0, region.x + region.width, region.y + region.height, 1 };
+    context->UpdateSubresource(it->second.texture.Get(), 0, &box, pixels, rowPitch, 0);
+
+    state.stats.bytesUploaded += uint64_t(region.width) * region.height * 4;
+}
+
+void RenderDeviceDX11::BeginFrame()
+{
+    // Anything may have touched the context since the last frame (resize, ClearState).
+    state.Reset();
+    BindRenderTarget({});
+    ++frame;
+}
+
+void RenderDeviceDX11::EndFrame()
+{
+    lastFrameStats = state.stats;
+
+    // The query slot still belongs to an older frame when the GPU is
+    // MaxFramesInFlight behind; wait for that one first
+    const uint32_t slot = (uint32_t)(frame % MaxFramesInFlight);
+    ID3D11Query* query = frameQueries[slot].Get();
+    if (queryFrames[slot] > completedFrame)
+    {
+        while (context->GetData(query, nullptr, 0, 0) == S_FALSE) std::this_thread::yield();
+        completedFrame = queryFrames[slot];
+    }
+    context->End(query);
+    queryFrames[slot] = frame;
+}
+
+uint64_t RenderDeviceDX11::GetCompletedFrame()
+{
+    while (completedFrame < frame)
+    {
+        const uint64_t next = completedFrame + 1;
+        const uint32_t slot = (uint32_t)(next % MaxFramesInFlight);
+        if (queryFrames[slot] != next) break;   // not ended yet
+        if (context->GetData(frameQueries[slot].Get(), nullptr, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK) break;
+        completedFrame = next;
+    }
+    return completedFrame;
+}
+
+void RenderDeviceDX11::SetPipeline(PipelineHandle pipeline)
+{
+    if (!state.Pipeline(pipeline)) return;
+
+    auto it = pipelines.find(pipeline.id);
+    if (it == pipelines.end()) return;
+    const Pipeline& p = it->second;
+
+    context->IASetInputLayout(p.inputLayout.Get());
+    context->IASetPrimitiveTopology(p.topology);
+    context->VSSetShader(p.vs.Get(), nullptr, 0);
+    context->PSSetShader(p.ps.Get(), nullptr, 0);
+
+    ID3D11SamplerState* samps[] = { p.sampler.Get() };
+    context->PSSetSamplers(0, 1, samps);
+
+    float blendFactor[4] = { 0,0,0,0 };
+    context->OMSetBlendState(p.blendState.Get(), blendFactor, 0xFFFFFFFF);
+    context->RSSetState(p.rasterState.Get());
+}
+
+void RenderDeviceDX11::SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset)
+{
+    if (!state.VertexBuffer(slot, buffer, stride, offset)) return;
+
+    ID3D11Buffer* vb = GetBuffer(buffer);
+    UINT s = stride;
+    UINT o = offset;
+    context->IASetVertexBuffers(slot, 1, &vb, &s, &o);
+}
+
+void RenderDeviceDX11::SetIndexBuffer(BufferHandle buffer, IndexFormat format)
+{
+    if (!state.IndexBuffer(buffer)) return;
+
+    context->IASetIndexBuffer(GetBuffer(buffer),
+        format == IndexFormat::UInt32 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT, 0);
+}
+
+void RenderDeviceDX11::SetConstantBuffer(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t bytes)
+{
+    if (!state.ConstantBuffer(slot, buffer, offset)) return;
+
+    auto it = buffers.find(buffer.id);
+    ID3D11Buffer* cbs[] = { it == buffers.end() ? nullptr : it->second.buffer.Get() };
+    if (bytes == 0 || !cbs[0])
+    {
+        context->VSSetConstantBuffers(slot, 1, cbs);
+        context->PSSetConstantBuffers(slot, 1, cbs);
+        return;
+    }
+
+    if (context1)
+    {
+        // Offsets and sizes are in 16-byte constants, sizes a multiple of 16 of them
+        const UINT first = offset / 16;
+        const UINT count = (bytes + ConstantBufferAlignment - 1) / ConstantBufferAlignment * 16;
+        context1->VSSetConstantBuffers1(slot, 1, cbs, &first, &count);
+        context1->PSSetConstantBuffers1(slot, 1, cbs, &first, &count);
+        return;
+    }
+
+    const Buffer& b = it->second;
+    if (b.shadow.empty() || offset > b.shadow.size() || bytes > b.shadow.size() - offset) return;
+    ID3D11Buffer* range = GetRangeBuffer(slot, bytes);
+    D3D11_MAPPED_SUBRESOURCE ms{};
+    ThrowIfFailed(context->Map(range, 0, D3D11_MAP_WRITE_DISCARD, 0, &ms), "Map(buffer) failed.");
+    std::memcpy(ms.pData, b.shadow.data() + offset, bytes);
+    context->Unmap(range, 0);
+    state.stats.bytesUploaded += bytes;
+
+    cbs[0] = range;
+    context->VSSetConstantBuffers(slot, 1, cbs);
+    context->PSSetConstantBuffers(slot, 1, cbs);
+}
+
+void RenderDeviceDX11::SetTexture(uint32_t slot, TextureHandle texture)
+{
+    if (!state.Texture(slot, texture)) return;
+
+    auto it = textures.find(texture.id);
+    ID3D11ShaderResourceView* srvs[] = { it == textures.end() ? nullptr : it->second.srv.Get() };
+    context->PSSetShaderResources(slot, 1, srvs);
+}
+
+void RenderDeviceDX11::SetRenderTarget(TextureHandle target)
+{
+    if (!state.RenderTarget(target)) return;
+
+    // A texture can't be sampled and rendered to at once; D3D would unbind it anyway
+    const uint32_t stale = state.UnbindTexture(target);
+    for (uint32_t slot = 0; slot < RenderStateTracker::MaxSlots; ++slot)
+    {
+        if (!(stale & 1u << slot)) continue;
+        ID3D11ShaderResourceView* none[] = { nullptr };
+        context->PSSetShaderResources(slot, 1, none);
+    }
+    BindRenderTarget(target);
+}
+
+void RenderDeviceDX11::ClearRenderTarget(const float color[4])
+{
+    if (!renderTarget)
+    {
+        if (backBufferRTV) context->ClearRenderTargetView(backBufferRTV, color);
+        if (backBufferDSV) context->ClearDepthStencilView(backBufferDSV, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+        return;
+    }
+    auto it = textures.find(renderTarget.id);
+    if (it != textures.end() && it->second.rtv) context->ClearRenderTargetView(it->second.rtv.Get(), color);
+}
+
+void RenderDeviceDX11::SetBackBuffer(ID3D11RenderTargetView* rtv, ID3D11DepthStencilView* dsv, uint32_t width, uint32_t height)
+{
+    backBufferRTV = rtv;
+    backBufferDSV = dsv;
+    backBufferWidth = width;
+    backBufferHeight = height;
+}
+
+void RenderDeviceDX11::BindRenderTarget(TextureHandle target)
+{
+    renderTarget = target;
+    ID3D11RenderTargetView* rtvs[] = { backBufferRTV };
+    ID3D11DepthStencilView* dsv = backBufferDSV;
+    uint32_t width = backBufferWidth, height = backBufferHeight;
+    if (target)
+    {
+        auto it = textures.find(target.id);
+        rtvs[0] = it == textures.end() ? nullptr : it->second.rtv.Get();
+        dsv = nullptr;
+        width = it == textures.end() ? 0 : it->second.width;
+        height = it == textures.end() ? 0 : it->second.height;
+    }
+    if (!rtvs[0]) return;
+
+    context->OMSetRenderTargets(1, rtvs, dsv);
+    const D3D11_VIEWPORT vp{ 0.0f, 0.0f, (float)width, (float)height, 0.0f, 1.0f };
+    context->RSSetViewports(1, &vp);
+}
+
+void RenderDeviceDX11::Draw(uint32_t vertexCount, uint32_t startVertex)
+{
+    ++state.stats.drawCalls;
+    context->Draw(vertexCount, startVertex);
+}
+
+void RenderDeviceDX11::DrawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex)
+{
+    ++state.stats.drawCalls;
+    context->DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+void RenderDeviceDX11::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount,
+    uint32_t startIndex, int32_t baseVertex, uint32_t startInstance)
+{
+    ++state.stats.drawCalls;
+    context->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+std::shared_ptr<const ShaderBytecode> RenderDeviceDX11::GetShader(const std::string& path, const std::string& entry, const char* target)
+{
+    std::string error;
+    auto code = shaderCache->Get({ path, entry, target, {} }, &error);
+    if (!code) throw std::runtime_error(error);
+    return code;
+}
+
+ID3D11Buffer* RenderDeviceDX11::GetBuffer(BufferHandle buffer) const
+{
+    auto it = buffers.find(buffer.id);
+    return it == buffers.end() ? nullptr : it->second.buffer.Get();
+}
+
+ID3D11Buffer* RenderDeviceDX11::GetRangeBuffer(uint32_t slot, uint32_t bytes)
+{
+    if (slot >= RenderStateTracker::MaxSlots)
+        throw std::runtime_error("SetConstantBuffer: slot out of range.");
+    const uint32_t size = (bytes + 15) / 16 * 16;
+    if (rangeBufferSizes[slot] >= size) return rangeBuffers[slot].Get();
+
+    D3D11_BUFFER_DESC bd{};
+    bd.ByteWidth = size;
+    bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    bd.Usage = D3D11_USAGE_DYNAMIC;
+    bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    rangeBuffers[slot].Reset();
+    ThrowIfFailed(device->CreateBuffer(&bd, nullptr, rangeBuffers[slot].GetAddressOf()), "CreateBuffer failed.");
+    rangeBufferSizes[slot] = size;
+    return rangeBuffers[slot].Get();
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <wrl/client.h>
+#include <d3d11_1.h>
+
+#include "PipelineCache.h"
+#include "RenderDevice.h"
+#include "ShaderCache.h"
+
+class RenderDeviceDX11 final : public IRenderDevice
+{
+public:
+    // Compiled shaders are cached in shaderCacheDir; empty keeps them in memory only.
+    RenderDeviceDX11(ID3D11Device* device, ID3D11DeviceContext* context,
+        const std::filesystem::path& shaderCacheDir = "shadercache");
+    ~RenderDeviceDX11() override;
+
+    RenderDeviceDX11(const RenderDeviceDX11&) = delete;
+    RenderDeviceDX11& operator=(const RenderDeviceDX11&) = delete;
+
+    BufferHandle CreateBuffer(const BufferDesc& desc, const void* initialData) override;
+    TextureHandle CreateTexture(const TextureDesc& desc, const SubresourceData* mips) override;
+    PipelineHandle CreatePipeline(const PipelineDesc& desc) override;
+
+    void Destroy(BufferHandle buffer) override;
+    void Destroy(TextureHandle texture) override;
+    void Destroy(PipelineHandle pipeline) override;
+
+    void UpdateBuffer(BufferHandle buffer, const void* data, uint32_t bytes) override;
+    void WriteBuffer(BufferHandle buffer, uint32_t offset, const void* data, uint32_t bytes) override;
+    void UpdateTexture(TextureHandle texture, const TextureRegion& region, const void* pixels, uint32_t rowPitch) override;
+
+    void BeginFrame() override;
+    void EndFrame() override;
+    uint64_t GetCurrentFrame() const override { return frame; }
+    uint64_t GetCompletedFrame() override;
+
+    void SetPipeline(PipelineHandle pipeline) override;
+    void SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset) override;
+    void SetIndexBuffer(BufferHandle buffer, IndexFormat format) override;
+    void SetConstantBuffer(uint32_t slot, BufferHandle buffer, uint32_t offset = 0, uint32_t bytes = 0) override;
+    void SetTexture(uint32_t slot, TextureHandle texture) override;
+    void SetRenderTarget(TextureHandle target) override;
+    void ClearRenderTarget(const float color[4]) override;
+
+    void Draw(uint32_t vertexCount, uint32_t startVertex) override;
+    void DrawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex) override;
+    void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount,
+        uint32_t startIndex, int32_t baseVertex, uint32_t startInstance) override;
+
+    const RenderFrameStats& GetFrameStats() const override { return lastFrameStats; }
+    const PipelineStats& GetPipelineStats() const override { return pipelineCache.GetStats(); }
+
+    const ShaderCache& GetShaderCache() const { return *shaderCache; }
+
+    // Views of the swap chain's back buffer, owned by the caller; they are
+    // bound by BeginFrame and by SetRenderTarget with an empty handle. Set
+    // again after every resize.
+    void SetBackBuffer(ID3D11RenderTargetView* rtv, ID3D11DepthStencilView* dsv, uint32_t width, uint32_t height);
+
+private:
+    // EndFrame stalls rather than run further ahead of the GPU than this
+    static constexpr uint32_t MaxFramesInFlight = 3;
+
+    struct Buffer
+    {
+        Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+        BufferDesc desc;
+        // Dynamic constant buffers without 11.1 offset binding: WriteBuffer
+        // lands here and bound ranges are copied into a per-slot buffer
+        std::vector<uint8_t> shadow;
+    };
+
+    struct Texture
+    {
+        Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+        Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+        Microsoft::WRL::ComPtr<ID3D11RenderTargetView> rtv;   // RenderTarget usage only
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    struct Pipeline
+    {
+        Microsoft::WRL::ComPtr<ID3D11VertexShader> vs;
+        Microsoft::WRL::ComPtr<ID3D11PixelShader> ps;
+        Microsoft::WRL::ComPtr<ID3D11InputLayout> inputLayout;
+        Microsoft::WRL::ComPtr<ID3D11BlendState> blendState;
+        Microsoft::WRL::ComPtr<ID3D11RasterizerState> rasterState;
+        Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler;
+        D3D11_PRIMITIVE_TOPOLOGY topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+    };
+
+    std::shared_ptr<const ShaderBytecode> GetShader(const std::string& path, const std::string& entry, const char* target);
+    ID3D11Buffer* GetBuffer(BufferHandle buffer) const;
+    ID3D11Buffer* GetRangeBuffer(uint32_t slot, uint32_t bytes);
+    void BindRenderTarget(TextureHandle target);
+
+    ID3D11Device* device = nullptr;
+    ID3D11DeviceContext* context = nullptr;
+    Microsoft::WRL::ComPtr<ID3D11DeviceContext1> context1;   // null when 11.1 offsets are unavailable
+
+    std::unique_ptr<IShaderCompiler> shaderCompiler;
+    std::unique_ptr<ShaderCache> shaderCache;
+
+    uint32_t nextId = 1;
+    std::unordered_map<uint32_t, Buffer> buffers;
+    std::unordered_map<uint32_t, Texture> textures;
+    std::unordered_map<uint32_t, Pipeline> pipelines;
+    PipelineCache pipelineCache;
+
+    Microsoft::WRL::ComPtr<ID3D11Buffer> rangeBuffers[RenderStateTracker::MaxSlots];
+    uint32_t rangeBufferSizes[RenderStateTracker::MaxSlots] = {};
+
+    Microsoft::WRL::ComPtr<ID3D11Query> frameQueries[MaxFramesInFlight];
+    uint64_t queryFrames[MaxFramesInFlight] = {};
+    uint64_t frame = 0;
+    uint64_t completedFrame = 0;
+
+    ID3D11RenderTargetView* backBufferRTV = nullptr;
+    ID3D11DepthStencilView* backBufferDSV = nullptr;
+    uint32_t backBufferWidth = 0;
+    uint32_t backBufferHeight = 0;
+    TextureHandle renderTarget;
+
+    RenderStateTracker state;
+    RenderFrameStats lastFrameStats;
+};
@@ -0,0 +1,223 @@
+#include "RenderDeviceNull.h"
+
+#include <cstring>
+#include <stdexcept>
+
+BufferHandle RenderDeviceNull::CreateBuffer(const BufferDesc& desc, const void* initialData)
+{
+    if (desc.byteWidth == 0)
+        throw std::runtime_error("RenderDeviceNull::CreateBuffer: zero-sized buffer.");
+
+    Buffer buffer{ desc, std::vector<uint8_t>(desc.byteWidth) };
+    if (initialData)
+    {
+        std::memcpy(buffer.data.data(), initialData, desc.byteWidth);
+        state.stats.bytesUploaded += desc.byteWidth;
+    }
+
+    const uint32_t id = nextId++;
+    buffers.emplace(id, std::move(buffer));
+    return BufferHandle{ id };
+}
+
+TextureHandle RenderDeviceNull::CreateTexture(const TextureDesc& desc, const SubresourceData* mips)
+{
+    if (desc.width == 0 || desc.height == 0)
+        throw std::runtime_error("RenderDeviceNull::CreateTexture: zero-sized texture.");
+    if (desc.usage == ResourceUsage::Immutable && !mips)
+        throw std::runtime_error("RenderDeviceNull::CreateTexture: immutable texture without data.");
+    if (desc.usage == ResourceUsage::RenderTarget && mips)
+        throw std::runtime_error("RenderDeviceNull::CreateTexture: render target with initial data.");
+
+    state.stats.bytesUploaded += GetUploadBytes(desc, mips);
+
+    const uint32_t id = nextId++;
+    textures.emplace(id, desc);
+    return TextureHandle{ id };
+}
+
+PipelineHandle RenderDeviceNull::CreatePipeline(const PipelineDesc& desc)
+{
+    if (const uint32_t shared = pipelineCache.Acquire(desc)) return PipelineHandle{ shared };
+
+    const uint32_t id = nextId++;
+    pipelines.emplace(id, desc);
+    pipelineCache.Insert(desc, id);
+    return PipelineHandle{ id };
+}
+
+void RenderDeviceNull::Destroy(BufferHandle buffer)
+{
+    buffers.erase(buffer.id);
+}
+
+void RenderDeviceNull::Destroy(TextureHandle texture)
+{
+    textures.erase(texture.id);
+}
+
+void RenderDeviceNull::Destroy(PipelineHandle pipeline)
+{
+    if (pipelineCache.Release(pipeline.id)) pipelines.erase(pipeline.id);
+}
+
+void RenderDeviceNull::UpdateBuffer(BufferHandle buffer, const void* data, uint32_t bytes)
+{
+    auto it = buffers.find(buffer.id);
+    if (it == buffers.end())
+        throw std::runtime_error("RenderDeviceNull::UpdateBuffer: unknown buffer.");
+    if (it->second.desc.usage != ResourceUsage::Dynamic || bytes > it->second.desc.byteWidth)
+        throw std::runtime_error("RenderDeviceNull::UpdateBuffer: buffer is not dynamic or too small.");
+
+    std::memcpy(it->second.data.data(), data, bytes);
+    state.stats.bytesUploaded += bytes;
+    Record({ CommandType::UpdateBuffer, 0, buffer.id, bytes });
+}
+
+void RenderDeviceNull::WriteBuffer(BufferHandle buffer, uint32_t offset, const void* data, uint32_t bytes)
+{
+    auto it = buffers.find(buffer.id);
+    if (it == buffers.end())
+        throw std::runtime_error("RenderDeviceNull::WriteBuffer: unknown buffer.");
+    if (it->second.desc.usage != ResourceUsage::Dynamic || offset > it->second.desc.byteWidth
+        || bytes > it->second.desc.byteWidth - offset)
+        throw std::runtime_error("RenderDeviceNull::WriteBuffer: buffer is not dynamic or range out of bounds.");
+
+    std::memcpy(it->second.data.data() + offset, data, bytes);
+    state.stats.bytesUploaded += bytes;
+    Record({ CommandType::WriteBuffer, 0, buffer.id, bytes, offset });
+}
+
+void RenderDeviceNull::UpdateTexture(TextureHandle texture, const TextureRegion& region, const void* pixels, uint32_t rowPitch)
+{
+    auto it = textures.find(texture.id);
+    if (it == textures.end())
+        throw std::runtime_error("RenderDeviceNull::UpdateTexture: unknown texture.");
+    const TextureDesc& desc = it->second;
+    if (desc.usage != ResourceUsage::Dynamic
+        || region.x + region.width > desc.width || region.y + region.height > desc.height)
+        throw std::runtime_error("RenderDeviceNull::UpdateTexture: texture is not dynamic or region out of bounds.");
+    if (!pixels || rowPitch < region.width * 4)
+        throw std::runtime_error("RenderDeviceNull::UpdateTexture: bad source data.");
+
+    const uint32_t bytes = region.width * region.height * 4;
+    state.stats.bytesUploaded += bytes;
+    Record({ CommandType::UpdateTexture, 0, texture.id, bytes });
+}
+
+void RenderDeviceNull::BeginFrame()
+{
+    ++frame;
+    state.Reset();
+    renderTarget = {};
+    commands.clear();
+}
+
+void RenderDeviceNull::EndFrame()
+{
+    lastFrameStats = state.stats;
+    lastFrameCommands.swap(commands);
+    completedFrame = frame;
+}
+
+void RenderDeviceNull::SetPipeline(PipelineHandle pipeline)
+{
+    if (state.Pipeline(pipeline))
+        Record({ CommandType::SetPipeline, 0, pipeline.id });
+}
+
+void RenderDeviceNull::SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset)
+{
+    if (state.VertexBuffer(slot, buffer, stride, offset))
+        Record({ CommandType::SetVertexBuffer, slot, buffer.id, stride, offset });
+}
+
+void RenderDeviceNull::SetIndexBuffer(BufferHandle buffer, IndexFormat format)
+{
+    if (state.IndexBuffer(buffer))
+        Record({ CommandType::SetIndexBuffer, 0, buffer.id, format == IndexFormat::UInt32 ? 4u : 2u });
+}
+
+void RenderDeviceNull::SetConstantBuffer(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t bytes)
+{
+    if (bytes == 0 ? offset != 0 : offset % ConstantBufferAlignment != 0)
+        throw std::runtime_error("RenderDeviceNull::SetConstantBuffer: misaligned range.");
+    if (bytes != 0)
+    {
+        auto it = buffers.find(buffer.id);
+        if (it == buffers.end() || offset > it->second.desc.byteWidth || bytes > it->second.desc.byteWidth - offset)
+            throw std::runtime_error("RenderDeviceNull::SetConstantBuffer: range out of bounds.");
+    }
+
+    if (state.ConstantBuffer(slot, buffer, offset))
+        Record({ CommandType::SetConstantBuffer, slot, buffer.id, bytes, offset });
+}
+
+void RenderDeviceNull::SetTexture(uint32_t slot, TextureHandle texture)
+{
+    if (state.Texture(slot, texture))
+        Record({ CommandType::SetTexture, slot, texture.id });
+}
+
+void RenderDeviceNull::SetRenderTarget(TextureHandle target)
+{
+    if (target)
+    {
+        auto it = textures.find(target.id);
+        if (it == textures.end() || it->second.usage != ResourceUsage::RenderTarget)
+            throw std::runtime_error("RenderDeviceNull::SetRenderTarget: not a render target texture.");
+    }
+
+    state.UnbindTexture(target);
+    renderTarget = target;
+    if (state.RenderTarget(target))
+        Record({ CommandType::SetRenderTarget, 0, target.id });
+}
+
+void RenderDeviceNull::ClearRenderTarget(const float color[4])
+{
+    (void)color;
+    Record({ CommandType::ClearRenderTarget, 0, renderTarget.id });
+}
+
+void RenderDeviceNull::Draw(uint32_t vertexCount, uint32_t startVertex)
+{
+    ++state.stats.drawCalls;
+    Record({ CommandType::Draw, 0, renderTarget.id, vertexCount, startVertex });
+}
+
+void RenderDeviceNull::DrawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex)
+{
+    ++state.stats.drawCalls;
+    Record({ CommandType::DrawIndexed, 0, renderTarget.id, indexCount, startIndex, baseVertex });
+}
+
+void RenderDeviceNull::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount,
+    uint32_t startIndex, int32_t baseVertex, uint32_t startInstance)
+{
+    ++state.stats.drawCalls;
+    Record({ CommandType::DrawIndexedInstanced, 0, renderTarget.id, indexCount, startIndex, baseVertex, instanceCount, startInstance });
+}
+
+const std::vector<uint8_t>* RenderDeviceNull::GetBufferData(BufferHandle buffer) const
+{
+    auto it = buffers.find(buffer.id);
+    return it == buffers.end() ? nullptr : &it->second.data;
+}
+
+const PipelineDesc* RenderDeviceNull::GetPipelineDesc(PipelineHandle pipeline) const
+{
+    auto it = pipelines.find(pipeline.id);
+    return it == pipelines.end() ? nullptr : &it->second;
+}
+
+const TextureDesc* RenderDeviceNull::GetTextureDesc(TextureHandle texture) const
+{
+    auto it = textures.find(texture.id);
+    return it == textures.end() ? nullptr : &it->second;
+}
+
+void RenderDeviceNull::Record(const Command& command)
+{
+    commands.push_back(command);
+}
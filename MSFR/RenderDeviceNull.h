@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "PipelineCache.h"
+#include "RenderDevice.h"
+
+// Headless backend. Resources are plain CPU copies and every call is recorded
+// into an in-memory command stream, so draw submission can be profiled and
+// regression-tested without a GPU.
+class RenderDeviceNull final : public IRenderDevice
+{
+public:
+    enum class CommandType
+    {
+        UpdateBuffer,
+        WriteBuffer,
+        UpdateTexture,
+        SetPipeline,
+        SetVertexBuffer,
+        SetIndexBuffer,
+        SetConstantBuffer,
+        SetTexture,
+        SetRenderTarget,
+        ClearRenderTarget,
+        Draw,
+        DrawIndexed,
+        DrawIndexedInstanced,
+    };
+
+    struct Command
+    {
+        CommandType type;
+        uint32_t slot = 0;     // binding slot, when applicable
+        uint32_t handle = 0;   // resource handle id, when applicable; draws: the render target
+        uint32_t count = 0;    // vertex/index count, upload or range size
+        uint32_t start = 0;    // start vertex/index, stride or offset
+        int32_t base = 0;      // base vertex
+        uint32_t instanceCount = 0;
+        uint32_t startInstance = 0;
+    };
+
+    BufferHandle CreateBuffer(const BufferDesc& desc, const void* initialData) override;
+    TextureHandle CreateTexture(const TextureDesc& desc, const SubresourceData* mips) override;
+    PipelineHandle CreatePipeline(const PipelineDesc& desc) override;
+
+    void Destroy(BufferHandle buffer) override;
+    void Destroy(TextureHandle texture) override;
+    void Destroy(PipelineHandle pipeline) override;
+
+    void UpdateBuffer(BufferHandle buffer, const void* data, uint32_t bytes) override;
+    void WriteBuffer(BufferHandle buffer, uint32_t offset, const void* data, uint32_t bytes) override;
+    void UpdateTexture(TextureHandle texture, const TextureRegion& region, const void* pixels, uint32_t rowPitch) override;
+
+    void BeginFrame() override;
+    void EndFrame() override;
+    // Nothing runs asynchronously: a frame is complete once it has ended.
+    uint64_t GetCurrentFrame() const override { return frame; }
+    uint64_t GetCompletedFrame() override { return completedFrame; }
+
+    void SetPipeline(PipelineHandle pipeline) override;
+    void SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset) override;
+    void SetIndexBuffer(BufferHandle buffer, IndexFormat format) override;
+    void SetConstantBuffer(uint32_t slot, BufferHandle buffer, uint32_t offset = 0, uint32_t bytes = 0) override;
+    void SetTexture(uint32_t slot, TextureHandle texture) override;
+    void SetRenderTarget(TextureHandle target) override;
+    void ClearRenderTarget(const float color[4]) override;
+
+    void Draw(uint32_t vertexCount, uint32_t startVertex) override;
+    void DrawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex) override;
+    void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount,
+        uint32_t startIndex, int32_t baseVertex, uint32_t startInstance) override;
+
+    const RenderFrameStats& GetFrameStats() const override { return lastFrameStats; }
+    const PipelineStats& GetPipelineStats() const override { return pipelineCache.GetStats(); }
+
+    // Inspection
+    const std::vector<Command>& GetCommands() const { return lastFrameCommands; }
+    const std::vector<uint8_t>* GetBufferData(BufferHandle buffer) const;
+    const PipelineDesc* GetPipelineDesc(PipelineHandle pipeline) const;
+    const TextureDesc* GetTextureDesc(TextureHandle texture) const;
+    size_t GetLiveResourceCount() const { return buffers.size() + textures.size() + pipelines.size(); }
+
+private:
+    struct Buffer
+    {
+        BufferDesc desc;
+        std::vector<uint8_t> data;
+    };
+
+    void Record(const Command& command);
+
+    uint32_t nextId = 1;
+    std::unordered_map<uint32_t, Buffer> buffers;
+    std::unordered_map<uint32_t, TextureDesc> textures;
+    std::unordered_map<uint32_t, PipelineDesc> pipelines;
+    PipelineCache pipelineCache;
+
+    uint64_t frame = 0;
+    uint64_t completedFrame = 0;
+
+    RenderStateTracker state;
+    TextureHandle renderTarget;
+    RenderFrameStats lastFrameStats;
+    std::vector<Command> commands;
+    std::vector<Command> lastFrameCommands;
+};
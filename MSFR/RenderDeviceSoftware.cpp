@@ -0,0 +1,419 @@
+#include "RenderDeviceSoftware.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "BlockCompression.h"
+#include "ImageCodec.h"
+
+namespace
+{
+    // a after b, both in SpriteDrawItem::transform layout
+    void Compose(const float a[6], const float b[6], float out[6])
+    {
+        const float r[6] =
+        {
+            a[0] * b[0] + a[2] * b[1],
+            a[1] * b[0] + a[3] * b[1],
+            a[0] * b[2] + a[2] * b[3],
+            a[1] * b[2] + a[3] * b[3],
+            a[0] * b[4] + a[2] * b[5] + a[4],
+            a[1] * b[4] + a[3] * b[5] + a[5],
+        };
+        std::memcpy(out, r, sizeof(r));
+    }
+
+    const VertexElement* FindElement(const PipelineDesc& desc, const char* semantic, VertexFormat format)
+    {
+        for (const VertexElement& e : desc.layout)
+        {
+            if (e.semantic == semantic && e.semanticIndex == 0 && e.format == format && e.slot == 0 && e.instanceStepRate == 0)
+                return &e;
+        }
+        return nullptr;
+    }
+}
+
+RenderDeviceSoftware::RenderDeviceSoftware(int width, int height, unsigned threadCount)
+    : rasterizer(threadCount)
+{
+    rasterizer.Resize(width, height);
+}
+
+BufferHandle RenderDeviceSoftware::CreateBuffer(const BufferDesc& desc, const void* initialData)
+{
+    if (desc.byteWidth == 0)
+        throw std::runtime_error("RenderDeviceSoftware::CreateBuffer: zero-sized buffer.");
+
+    Buffer buffer{ desc, std::vector<uint8_t>(desc.byteWidth) };
+    if (initialData)
+    {
+        std::memcpy(buffer.data.data(), initialData, desc.byteWidth);
+        state.stats.bytesUploaded += desc.byteWidth;
+    }
+
+    const uint32_t id = nextId++;
+    buffers.emplace(id, std::move(buffer));
+    return BufferHandle{ id };
+}
+
+TextureHandle RenderDeviceSoftware::CreateTexture(const TextureDesc& desc, const SubresourceData* mips)
+{
+    if (desc.width == 0 || desc.height == 0)
+        throw std::runtime_error("RenderDeviceSoftware::CreateTexture: zero-sized texture.");
+    if (desc.usage == ResourceUsage::Immutable && !mips)
+        throw std::runtime_error("RenderDeviceSoftware::CreateTexture: immutable texture without data.");
+    if (desc.usage == ResourceUsage::RenderTarget && mips)
+        throw std::runtime_error("RenderDeviceSoftware::CreateTexture: render target with initial data.");
+    if (IsBlockCompressed(desc.format) && desc.usage != ResourceUsage::Immutable)
+        throw std::runtime_error("RenderDeviceSoftware::CreateTexture: block-compressed texture must be immutable.");
+
+    state.stats.bytesUploaded += GetUploadBytes(desc, mips);
+
+    Texture texture;
+    texture.desc = desc;
+    texture.pixels.assign((size_t)desc.width * desc.height, 0);
+    if (mips && mips[0].pixels && IsBlockCompressed(desc.format))
+    {
+        // The rasterizer samples RGBA8, so keep the top level decoded
+        Image blocks;
+        blocks.width = desc.width;
+        blocks.height = desc.height;
+        blocks.format = desc.format;
+        const uint32_t pitch = GetRowPitch(desc.format, desc.width);
+        blocks.pixels.resize((size_t)pitch * GetRowCount(desc.format, desc.height));
+        for (uint32_t row = 0; row < GetRowCount(desc.format, desc.height); ++row)
+        {
+            std::memcpy(&blocks.pixels[(size_t)row * pitch], (const uint8_t*)mips[0].pixels + (size_t)row * mips[0].rowPitch, pitch);
+        }
+        Image decoded;
+        DecompressImage(blocks, decoded);
+        std::memcpy(texture.pixels.data(), decoded.pixels.data(), decoded.pixels.size());
+    }
+    else if (mips && mips[0].pixels)
+    {
+        for (uint32_t y = 0; y < desc.height; ++y)
+        {
+            std::memcpy(&texture.pixels[(size_t)y * desc.width],
+                (const uint8_t*)mips[0].pixels + (size_t)y * mips[0].rowPitch, (size_t)desc.width * 4);
+        }
+    }
+    texture.view = { (int)desc.width, (int)desc.height, texture.pixels.data() };
+
+    const uint32_t id = nextId++;
+    textures.emplace(id, std::move(texture));
+    return TextureHandle{ id };
+}
+
+PipelineHandle RenderDeviceSoftware::CreatePipeline(const PipelineDesc& desc)
+{
+    if (const uint32_t shared = pipelineCache.Acquire(desc)) return PipelineHandle{ shared };
+
+    Pipeline p;
+    for (const VertexElement& e : desc.layout)
+    {
+        if (e.instanceStepRate != 0 && e.semantic == "TRANSFORM") p.kind = PipelineKind::SpriteInstances;
+    }
+    if (p.kind == PipelineKind::Unsupported)
+    {
+        const VertexElement* position = FindElement(desc, "POSITION", VertexFormat::Float2);
+        const VertexElement* texcoord = FindElement(desc, "TEXCOORD", VertexFormat::Float2);
+        const VertexElement* color = FindElement(desc, "COLOR", VertexFormat::UNorm8x4);
+        if (position && texcoord && color)
+        {
+            p.kind = PipelineKind::SpriteVertices;
+            p.position = position->offset;
+            p.texcoord = texcoord->offset;
+            p.color = color->offset;
+        }
+    }
+
+    const uint32_t id = nextId++;
+    pipelines.emplace(id, p);
+    pipelineCache.Insert(desc, id);
+    return PipelineHandle{ id };
+}
+
+void RenderDeviceSoftware::Destroy(BufferHandle buffer)
+{
+    buffers.erase(buffer.id);
+}
+
+void RenderDeviceSoftware::Destroy(TextureHandle texture_)
+{
+    // Pending quads still read the pixels
+    if (textures.count(texture_.id)) rasterizer.Render();
+    textures.erase(texture_.id);
+}
+
+void RenderDeviceSoftware::Destroy(PipelineHandle pipeline_)
+{
+    if (pipelineCache.Release(pipeline_.id)) pipelines.erase(pipeline_.id);
+}
+
+void RenderDeviceSoftware::UpdateBuffer(BufferHandle buffer, const void* data, uint32_t bytes)
+{
+    auto it = buffers.find(buffer.id);
+    if (it == buffers.end())
+        throw std::runtime_error("RenderDeviceSoftware::UpdateBuffer: unknown buffer.");
+    if (it->second.desc.usage != ResourceUsage::Dynamic || bytes > it->second.desc.byteWidth)
+        throw std::runtime_error("RenderDeviceSoftware::UpdateBuffer: buffer is not dynamic or too small.");
+
+    std::memcpy(it->second.data.data(), data, bytes);
+    state.stats.bytesUploaded += bytes;
+}
+
+void RenderDeviceSoftware::WriteBuffer(BufferHandle buffer, uint32_t offset, const void* data, uint32_t bytes)
+{
+    auto it = buffers.find(buffer.id);
+    if (it == buffers.end())
+        throw std::runtime_error("RenderDeviceSoftware::WriteBuffer: unknown buffer.");
+    if (it->second.desc.usage != ResourceUsage::Dynamic || offset > it->second.desc.byteWidth
+        || bytes > it->second.desc.byteWidth - offset)
+        throw std::runtime_error("RenderDeviceSoftware::WriteBuffer: buffer is not dynamic or range out of bounds.");
+
+    std::memcpy(it->second.data.data() + offset, data, bytes);
+    state.stats.bytesUploaded += bytes;
+}
+
+void RenderDeviceSoftware::UpdateTexture(TextureHandle texture_, const TextureRegion& region, const void* pixels, uint32_t rowPitch)
+{
+    auto it = textures.find(texture_.id);
+    if (it == textures.end())
+        throw std::runtime_error("RenderDeviceSoftware::UpdateTexture: unknown texture.");
+    Texture& t = it->second;
+    if (t.desc.usage != ResourceUsage::Dynamic
+        || region.x + region.width > t.desc.width || region.y + region.height > t.desc.height)
+        throw std::runtime_error("RenderDeviceSoftware::UpdateTexture: texture is not dynamic or region out of bounds.");
+    if (!pixels || rowPitch < region.width * 4)
+        throw std::runtime_error("RenderDeviceSoftware::UpdateTexture: bad source data.");
+
+    // Draws recorded before the update must see the old contents
+    rasterizer.Render();
+    for (uint32_t y = 0; y < region.height; ++y)
+    {
+        std::memcpy(&t.pixels[(size_t)(region.y + y) * t.desc.width + region.x],
+            (const uint8_t*)pixels + (size_t)y * rowPitch, (size_t)region.width * 4);
+    }
+    state.stats.bytesUploaded += (uint64_t)region.width * region.height * 4;
+}
+
+void RenderDeviceSoftware::BeginFrame()
+{
+    ++frame;
+    state.Reset();
+    renderTarget = {};
+    rasterizer.Clear(clearColor);
+}
+
+void RenderDeviceSoftware::EndFrame()
+{
+    rasterizer.Render();
+    lastFrameStats = state.stats;
+    completedFrame = frame;
+}
+
+void RenderDeviceSoftware::SetPipeline(PipelineHandle pipeline_)
+{
+    state.Pipeline(pipeline_);
+    pipeline = pipeline_;
+}
+
+void RenderDeviceSoftware::SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset)
+{
+    state.VertexBuffer(slot, buffer, stride, offset);
+    if (slot < 2) streams[slot] = { buffer, stride, offset };
+}
+
+void RenderDeviceSoftware::SetIndexBuffer(BufferHandle buffer, IndexFormat format)
+{
+    state.IndexBuffer(buffer);
+    indexBuffer = buffer;
+    indexFormat = format;
+}
+
+void RenderDeviceSoftware::SetConstantBuffer(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t bytes)
+{
+    (void)bytes;
+    state.ConstantBuffer(slot, buffer, offset);
+    if (slot == 0)
+    {
+        projection = buffer;
+        projectionOffset = offset;
+    }
+}
+
+void RenderDeviceSoftware::SetTexture(uint32_t slot, TextureHandle texture_)
+{
+    state.Texture(slot, texture_);
+    if (slot == 0) texture = texture_;
+}
+
+void RenderDeviceSoftware::SetRenderTarget(TextureHandle target)
+{
+    state.UnbindTexture(target);
+    state.RenderTarget(target);
+    renderTarget = target;
+}
+
+void RenderDeviceSoftware::ClearRenderTarget(const float color[4])
+{
+    uint32_t packed = 0;
+    for (int c = 0; c < 4; ++c)
+    {
+        const float v = std::min(std::max(color[c], 0.f), 1.f);
+        packed |= (uint32_t)(v * 255.f + 0.5f) << (c * 8);
+    }
+
+    if (!renderTarget)
+    {
+        rasterizer.Clear(packed);
+        return;
+    }
+    auto it = textures.find(renderTarget.id);
+    if (it != textures.end()) std::fill(it->second.pixels.begin(), it->second.pixels.end(), packed);
+}
+
+void RenderDeviceSoftware::Draw(uint32_t vertexCount, uint32_t startVertex)
+{
+    (void)vertexCount;
+    (void)startVertex;
+    ++state.stats.drawCalls;
+    ++skippedDraws;
+}
+
+void RenderDeviceSoftware::DrawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex)
+{
+    ++state.stats.drawCalls;
+
+    auto p = pipelines.find(pipeline.id);
+    const Buffer* vb = FindBuffer(streams[0].buffer);
+    const Buffer* ib = FindBuffer(indexBuffer);
+    const Texture* tex = BoundTexture();
+    if (p == pipelines.end() || p->second.kind != PipelineKind::SpriteVertices || !vb || !ib || !tex || renderTarget)
+    {
+        ++skippedDraws;
+        return;
+    }
+
+    const Pipeline& layout = p->second;
+    const uint32_t indexSize = indexFormat == IndexFormat::UInt32 ? 4 : 2;
+    auto readIndex = [&](uint32_t i) -> uint32_t
+    {
+        if (indexSize == 4)
+        {
+            uint32_t v;
+            std::memcpy(&v, &ib->data[(size_t)i * 4], 4);
+            return v;
+        }
+        uint16_t v;
+        std::memcpy(&v, &ib->data[(size_t)i * 2], 2);
+        return v;
+    };
+
+    // Quads as two triangles in SpriteBatch's pattern: 0 1 2, 0 2 3
+    float view[6];
+    GetViewTransform(view);
+    const uint32_t stride = streams[0].stride;
+    const size_t needed = std::max({ layout.position + 8, layout.texcoord + 8, layout.color + 4 });
+    for (uint32_t q = 0; q + 6 <= indexCount; q += 6)
+    {
+        if ((size_t)(startIndex + q + 6) * indexSize > ib->data.size()) break;
+
+        const uint32_t corners[3] = { readIndex(startIndex + q), readIndex(startIndex + q + 1), readIndex(startIndex + q + 5) };
+        float pos[3][2], uv[3][2];
+        uint32_t color = 0;
+        bool valid = true;
+        for (int c = 0; c < 3 && valid; ++c)
+        {
+            const size_t at = streams[0].offset + (size_t)((int64_t)corners[c] + baseVertex) * stride;
+            valid = at + needed <= vb->data.size();
+            if (!valid) break;
+            std::memcpy(pos[c], &vb->data[at + layout.position], 8);
+            std::memcpy(uv[c], &vb->data[at + layout.texcoord], 8);
+            if (c == 0) std::memcpy(&color, &vb->data[at + layout.color], 4);
+        }
+        if (!valid) break;
+
+        SoftwareQuad quad;
+        const float transform[6] = { pos[1][0] - pos[0][0], pos[1][1] - pos[0][1], pos[2][0] - pos[0][0], pos[2][1] - pos[0][1], pos[0][0], pos[0][1] };
+        const float uvTransform[6] = { uv[1][0] - uv[0][0], uv[1][1] - uv[0][1], uv[2][0] - uv[0][0], uv[2][1] - uv[0][1], uv[0][0], uv[0][1] };
+        std::memcpy(quad.transform, transform, sizeof(transform));
+        std::memcpy(quad.uvTransform, uvTransform, sizeof(uvTransform));
+        quad.color = color;
+        quad.texture = &tex->view;
+        SubmitQuad(quad, view);
+    }
+}
+
+void RenderDeviceSoftware::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount,
+    uint32_t startIndex, int32_t baseVertex, uint32_t startInstance)
+{
+    (void)indexCount;
+    (void)startIndex;
+    (void)baseVertex;
+    ++state.stats.drawCalls;
+
+    auto p = pipelines.find(pipeline.id);
+    const Buffer* instances = FindBuffer(streams[1].buffer);
+    const Texture* tex = BoundTexture();
+    if (p == pipelines.end() || p->second.kind != PipelineKind::SpriteInstances || !instances || !tex
+        || streams[1].stride < sizeof(SpriteInstance) || renderTarget)
+    {
+        ++skippedDraws;
+        return;
+    }
+
+    float view[6];
+    GetViewTransform(view);
+    for (uint32_t i = startInstance; i < startInstance + instanceCount; ++i)
+    {
+        const size_t at = streams[1].offset + (size_t)i * streams[1].stride;
+        if (at + sizeof(SpriteInstance) > instances->data.size()) break;
+
+        SpriteInstance instance;
+        std::memcpy(&instance, &instances->data[at], sizeof(instance));
+        SubmitQuad(MakeSoftwareQuad(instance, tex->view), view);
+    }
+}
+
+const RenderDeviceSoftware::Buffer* RenderDeviceSoftware::FindBuffer(BufferHandle buffer) const
+{
+    auto it = buffers.find(buffer.id);
+    return it == buffers.end() ? nullptr : &it->second;
+}
+
+const RenderDeviceSoftware::Texture* RenderDeviceSoftware::BoundTexture() const
+{
+    auto it = textures.find(texture.id);
+    return it == textures.end() ? nullptr : &it->second;
+}
+
+void RenderDeviceSoftware::GetViewTransform(float out[6]) const
+{
+    // NDC to framebuffer pixels, origin bottom-left
+    const float halfW = (float)rasterizer.GetWidth() * 0.5f;
+    const float halfH = (float)rasterizer.GetHeight() * 0.5f;
+    const float viewport[6] = { halfW, 0, 0, halfH, halfW, halfH };
+
+    const Buffer* cb = FindBuffer(projection);
+    if (!cb || cb->data.size() < projectionOffset + sizeof(float) * 16)
+    {
+        const float identity[6] = { 1, 0, 0, 1, 0, 0 };
+        std::memcpy(out, identity, sizeof(identity));
+        return;
+    }
+
+    // Column-major float4x4, 2D part only
+    float m[16];
+    std::memcpy(m, cb->data.data() + projectionOffset, sizeof(m));
+    const float projection2D[6] = { m[0], m[1], m[4], m[5], m[12], m[13] };
+    Compose(viewport, projection2D, out);
+}
+
+void RenderDeviceSoftware::SubmitQuad(SoftwareQuad quad, const float view[6])
+{
+    Compose(view, quad.transform, quad.transform);
+    rasterizer.Submit(quad);
+}
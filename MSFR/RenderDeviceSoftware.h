@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "PipelineCache.h"
+#include "RenderDevice.h"
+#include "SoftwareRasterizer.h"
+
+struct Image;
+
+// GPU-less backend that actually draws. Resources are CPU copies; draws made
+// with the sprite pipelines (SpriteBatch's vertex and instanced layouts) are
+// rasterized by SoftwareRasterizer into an RGBA8 framebuffer. Constant buffer
+// 0, when bound, is read as the 2D screen-to-NDC matrix like the shaders do.
+// Draws with any other layout, or into a RenderTarget texture, are counted
+// but not rendered; clearing such a texture does fill it.
+class RenderDeviceSoftware final : public IRenderDevice
+{
+public:
+    RenderDeviceSoftware(int width, int height, unsigned threadCount = 0);
+
+    BufferHandle CreateBuffer(const BufferDesc& desc, const void* initialData) override;
+    TextureHandle CreateTexture(const TextureDesc& desc, const SubresourceData* mips) override;
+    PipelineHandle CreatePipeline(const PipelineDesc& desc) override;
+
+    void Destroy(BufferHandle buffer) override;
+    void Destroy(TextureHandle texture) override;
+    void Destroy(PipelineHandle pipeline) override;
+
+    void UpdateBuffer(BufferHandle buffer, const void* data, uint32_t bytes) override;
+    void WriteBuffer(BufferHandle buffer, uint32_t offset, const void* data, uint32_t bytes) override;
+    void UpdateTexture(TextureHandle texture, const TextureRegion& region, const void* pixels, uint32_t rowPitch) override;
+
+    // Clears to the clear color; EndFrame finishes rasterizing.
+    void BeginFrame() override;
+    void EndFrame() override;
+    uint64_t GetCurrentFrame() const override { return frame; }
+    uint64_t GetCompletedFrame() override { return completedFrame; }
+
+    void SetPipeline(PipelineHandle pipeline) override;
+    void SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset) override;
+    void SetIndexBuffer(BufferHandle buffer, IndexFormat format) override;
+    void SetConstantBuffer(uint32_t slot, BufferHandle buffer, uint32_t offset = 0, uint32_t bytes = 0) override;
+    void SetTexture(uint32_t slot, TextureHandle texture) override;
+    void SetRenderTarget(TextureHandle target) override;
+    void ClearRenderTarget(const float color[4]) override;
+
+    void Draw(uint32_t vertexCount, uint32_t startVertex) override;
+    void DrawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex) override;
+    void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount,
+        uint32_t startIndex, int32_t baseVertex, uint32_t startInstance) override;
+
+    const RenderFrameStats& GetFrameStats() const override { return lastFrameStats; }
+    const PipelineStats& GetPipelineStats() const override { return pipelineCache.GetStats(); }
+
+    void SetClearColor(uint32_t rgba) { clearColor = rgba; }
+    SoftwareRasterizer& GetRasterizer() { return rasterizer; }
+    void ReadPixels(Image& out) const { rasterizer.ReadPixels(out); }
+    uint32_t GetSkippedDraws() const { return skippedDraws; }
+
+private:
+    enum class PipelineKind { Unsupported, SpriteVertices, SpriteInstances };
+
+    struct Buffer
+    {
+        BufferDesc desc;
+        std::vector<uint8_t> data;
+    };
+
+    struct Texture
+    {
+        TextureDesc desc;
+        std::vector<uint32_t> pixels;   // mip 0 only
+        SoftwareTexture view;
+    };
+
+    struct Pipeline
+    {
+        PipelineKind kind = PipelineKind::Unsupported;
+        uint32_t position = 0;      // SpriteVertices attribute offsets
+        uint32_t texcoord = 0;
+        uint32_t color = 0;
+    };
+
+    struct Stream
+    {
+        BufferHandle buffer;
+        uint32_t stride = 0;
+        uint32_t offset = 0;
+    };
+
+    const Buffer* FindBuffer(BufferHandle buffer) const;
+    const Texture* BoundTexture() const;
+    // Framebuffer pixels from the vertex shader's input space
+    void GetViewTransform(float out[6]) const;
+    void SubmitQuad(SoftwareQuad quad, const float view[6]);
+
+    SoftwareRasterizer rasterizer;
+    uint32_t clearColor = 0xFF000000;
+
+    uint32_t nextId = 1;
+    std::unordered_map<uint32_t, Buffer> buffers;
+    std::unordered_map<uint32_t, Texture> textures;
+    std::unordered_map<uint32_t, Pipeline> pipelines;
+    PipelineCache pipelineCache;
+
+    PipelineHandle pipeline;
+    Stream streams[2];
+    BufferHandle indexBuffer;
+    IndexFormat indexFormat = IndexFormat::UInt32;
+    BufferHandle projection;
+    uint32_t projectionOffset = 0;
+    TextureHandle texture;
+    TextureHandle renderTarget;
+
+    // Draws read their buffers when recorded, so a frame is complete once it has ended
+    uint64_t frame = 0;
+    uint64_t completedFrame = 0;
+
+    RenderStateTracker state;
+    RenderFrameStats lastFrameStats;
+    uint32_t skippedDraws = 0;
+};
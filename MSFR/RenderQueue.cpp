@@ -0,0 +1,79 @@
+#include "RenderQueue.h"
+
+#include <cstring>
+#include <utility>
+
+void RenderQueue::Clear()
+{
+    entries.clear();
+    stats = {};
+}
+
+void RenderQueue::Sort()
+{
+    stats.commands = (uint32_t)entries.size();
+    stats.stateChangesUnsorted = CountStateChanges(entries);
+
+    const size_t count = entries.size();
+    if (count > 1)
+    {
+        // All 8 byte histograms in one pass
+        uint32_t histogram[8][256];
+        std::memset(histogram, 0, sizeof(histogram));
+        for (const Entry& e : entries)
+        {
+            for (int pass = 0; pass < 8; ++pass)
+            {
+                ++histogram[pass][(e.key >> (pass * 8)) & 0xFF];
+            }
+        }
+
+        scratch.resize(count);
+        Entry* src = entries.data();
+        Entry* dst = scratch.data();
+
+        for (int pass = 0; pass < 8; ++pass)
+        {
+            uint32_t* h = histogram[pass];
+            const uint32_t shift = pass * 8;
+
+            // Every key has the same byte here: nothing to reorder
+            if (h[(src[0].key >> shift) & 0xFF] == count) continue;
+
+            uint32_t offset = 0;
+            for (int b = 0; b < 256; ++b)
+            {
+                const uint32_t n = h[b];
+                h[b] = offset;
+                offset += n;
+            }
+            for (size_t i = 0; i < count; ++i)
+            {
+                dst[h[(src[i].key >> shift) & 0xFF]++] = src[i];
+            }
+            std::swap(src, dst);
+        }
+
+        if (src != entries.data())
+        {
+            entries.swap(scratch);
+        }
+    }
+
+    stats.stateChangesSorted = CountStateChanges(entries);
+}
+
+uint32_t RenderQueue::CountStateChanges(const std::vector<Entry>& list)
+{
+    uint32_t changes = 0;
+    uint32_t shader = 0xFFFFFFFF;
+    uint32_t texture = 0xFFFFFFFF;
+    for (const Entry& e : list)
+    {
+        const uint32_t s = RenderKey::GetShader(e.state);
+        const uint32_t t = RenderKey::GetTexture(e.state);
+        if (s != shader) { ++changes; shader = s; }
+        if (t != texture) { ++changes; texture = t; }
+    }
+    return changes;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Packed 64-bit draw sort key.
+//   opaque      : layer(8) | 0 | shader(11) | texture(20) | depth(24)
+//   translucent : layer(8) | 1 | depth(24)  | 0(31)
+// Layer always wins. Opaque draws group by state first. Translucent keys
+// carry no state, so draws of equal layer and depth keep submission order
+// and overlapping alpha-blended sprites still composite in painter order.
+struct RenderKey
+{
+    static constexpr uint32_t LayerBits = 8;
+    static constexpr uint32_t ShaderBits = 11;
+    static constexpr uint32_t TextureBits = 20;
+    static constexpr uint32_t DepthBits = 24;
+
+    static constexpr uint64_t Mask(uint32_t bits) noexcept { return (uint64_t(1) << bits) - 1; }
+
+    // shader(11) | texture(20), i.e. everything a bind would change
+    static constexpr uint32_t MakeState(uint32_t shader, uint32_t texture) noexcept
+    {
+        return uint32_t(((shader & Mask(ShaderBits)) << TextureBits) | (texture & Mask(TextureBits)));
+    }
+
+    static constexpr uint64_t Make(uint32_t layer, bool translucent, uint32_t shader, uint32_t texture, uint32_t depth) noexcept
+    {
+        const uint64_t head = (uint64_t(layer & Mask(LayerBits)) << 1 | (translucent ? 1 : 0)) << 55;
+        return translucent
+            ? head | (uint64_t(depth & Mask(DepthBits)) << 31)
+            : head | (uint64_t(MakeState(shader, texture)) << 24) | (depth & Mask(DepthBits));
+    }
+
+    static constexpr uint32_t GetLayer(uint64_t key) noexcept { return uint32_t(key >> 56); }
+    static constexpr bool IsTranslucent(uint64_t key) noexcept { return (key >> 55) & 1; }
+    static constexpr uint32_t GetDepth(uint64_t key) noexcept
+    {
+        return uint32_t(IsTranslucent(key) ? (key >> 31) & Mask(DepthBits) : key & Mask(DepthBits));
+    }
+
+    static constexpr uint32_t GetShader(uint32_t state) noexcept { return state >> TextureBits; }
+    static constexpr uint32_t GetTexture(uint32_t state) noexcept { return state & uint32_t(Mask(TextureBits)); }
+};
+
+// Per-frame list of (key, payload index) pairs, sorted once with a stable
+// LSD radix sort so equal keys keep submission order.
+class RenderQueue
+{
+public:
+    struct Entry
+    {
+        uint64_t key;
+        uint32_t index;
+        uint32_t state;     // RenderKey::MakeState, for the stats; fills the padding
+    };
+
+    struct Stats
+    {
+        uint32_t commands = 0;
+        uint32_t stateChangesUnsorted = 0;
+        uint32_t stateChangesSorted = 0;
+
+        // Negative when sorting adds state changes: translucent keys order
+        // by layer and depth only, so interleaved depths can split a state run
+        int32_t Saved() const { return static_cast<int32_t>(stateChangesUnsorted) - static_cast<int32_t>(stateChangesSorted); }
+    };
+
+    void Clear();
+    void Push(uint64_t key, uint32_t index, uint32_t state) { entries.push_back({ key, index, state }); }
+    void Sort();
+
+    bool Empty() const { return entries.empty(); }
+    size_t Size() const { return entries.size(); }
+    const std::vector<Entry>& GetEntries() const { return entries; }
+    const Stats& GetStats() const { return stats; }
+
+    static uint32_t CountStateChanges(const std::vector<Entry>& list);
+
+private:
+    std::vector<Entry> entries;
+    std::vector<Entry> scratch;
+    Stats stats;
+};
@@ -0,0 +1,71 @@
+#include "RingAllocator.h"
+
+#include <algorithm>
+
+RingAllocator::RingAllocator(uint64_t capacity_)
+{
+    Reset(capacity_);
+}
+
+void RingAllocator::Reset(uint64_t capacity_)
+{
+    capacity = capacity_;
+    head = 0;
+    openBytes = 0;
+    frames.clear();
+    stats.used = 0;
+    stats.framesInFlight = 0;
+}
+
+uint64_t RingAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0 || size == 0 || size > capacity)
+    {
+        ++stats.failedAllocations;
+        return Invalid;
+    }
+
+    // Free space is the single run from head up to the oldest live byte,
+    // possibly wrapping; used counts everything else
+    if (stats.used == 0) head = 0;
+
+    uint64_t offset = (head + alignment - 1) & ~(alignment - 1);
+    uint64_t taken = offset - head + size;
+    if (offset > capacity - size)
+    {
+        offset = 0;
+        taken = capacity - head + size;
+    }
+    if (taken > capacity - stats.used)
+    {
+        ++stats.failedAllocations;
+        return Invalid;
+    }
+
+    head = offset + size;
+    openBytes += taken;
+    stats.used += taken;
+    stats.peakUsed = std::max(stats.peakUsed, stats.used);
+    ++stats.allocations;
+    return offset;
+}
+
+void RingAllocator::EndFrame(uint64_t fence)
+{
+    if (openBytes == 0) return;
+
+    if (!frames.empty() && frames.back().fence == fence) frames.back().bytes += openBytes;
+    else frames.push_back({ fence, openBytes });
+    openBytes = 0;
+    stats.framesInFlight = (uint32_t)frames.size();
+}
+
+void RingAllocator::Retire(uint64_t completedFence)
+{
+    while (!frames.empty() && frames.front().fence <= completedFence)
+    {
+        stats.used -= frames.front().bytes;
+        frames.pop_front();
+    }
+    stats.framesInFlight = (uint32_t)frames.size();
+}
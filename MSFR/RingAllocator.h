@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+
+// Frame-based ring of byte offsets for transient data. Each frame's
+// allocations are closed under a fence value; their space comes back once
+// Retire is told that fence has completed, oldest frame first. Allocations
+// never straddle the end: the tail of the ring is skipped instead. Pure
+// bookkeeping: no buffers, no GPU.
+class RingAllocator
+{
+public:
+    static constexpr uint64_t Invalid = ~uint64_t(0);
+
+    struct Stats
+    {
+        uint64_t used = 0;          // bytes held by open and in-flight frames, padding included
+        uint64_t peakUsed = 0;
+        uint32_t allocations = 0;
+        uint32_t failedAllocations = 0;
+        uint32_t framesInFlight = 0;
+    };
+
+    explicit RingAllocator(uint64_t capacity = 0);
+
+    // Forgets every allocation, in flight or not.
+    void Reset(uint64_t capacity);
+
+    // Offset of size bytes aligned to alignment (a power of two), or Invalid
+    // when the free space left by in-flight frames is too small.
+    uint64_t Allocate(uint64_t size, uint64_t alignment = 1);
+
+    // Closes the allocations made since the last call under fence. Fences
+    // must not decrease.
+    void EndFrame(uint64_t fence);
+    // Reclaims closed frames whose fence is <= completedFence.
+    void Retire(uint64_t completedFence);
+
+    uint64_t GetCapacity() const { return capacity; }
+    const Stats& GetStats() const { return stats; }
+
+private:
+    struct Frame
+    {
+        uint64_t fence;
+        uint64_t bytes;
+    };
+
+    uint64_t capacity = 0;
+    uint64_t head = 0;          // next free byte
+    uint64_t openBytes = 0;     // taken since the last EndFrame
+    std::deque<Frame> frames;
+    Stats stats;
+};
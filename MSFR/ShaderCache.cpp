@@ -0,0 +1,243 @@
+#include "ShaderCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+
+#include "Hash.h"
+#include "ImageCodec.h"
+
+namespace
+{
+    constexpr char DiskMagic[4] = { 'M', 'S', 'S', 'C' };
+    constexpr uint32_t DiskVersion = 1;
+
+    struct DiskHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+        uint64_t size;
+        uint64_t checksum;      // of the bytecode
+    };
+
+    // Names from #include "x" / #include <x>. Commented-out directives are
+    // picked up too, which only costs an extra file hash.
+    std::vector<std::string> ScanIncludes(const std::vector<uint8_t>& text)
+    {
+        std::vector<std::string> includes;
+        const char* p = (const char*)text.data();
+        const char* end = p + text.size();
+        while (p < end)
+        {
+            const char* lineEnd = std::find(p, end, '\n');
+            const char* c = p;
+            while (c < lineEnd && (*c == ' ' || *c == '\t')) ++c;
+            if (c < lineEnd && *c == '#')
+            {
+                ++c;
+                while (c < lineEnd && (*c == ' ' || *c == '\t')) ++c;
+                if (lineEnd - c > 7 && std::strncmp(c, "include", 7) == 0)
+                {
+                    c += 7;
+                    while (c < lineEnd && (*c == ' ' || *c == '\t')) ++c;
+                    if (c < lineEnd && (*c == '"' || *c == '<'))
+                    {
+                        const char close = *c == '"' ? '"' : '>';
+                        const char* nameEnd = std::find(c + 1, lineEnd, close);
+                        if (nameEnd < lineEnd) includes.emplace_back(c + 1, nameEnd);
+                    }
+                }
+            }
+            p = lineEnd + (lineEnd < end ? 1 : 0);
+        }
+        return includes;
+    }
+}
+
+ShaderCache::ShaderCache(IShaderCompiler& compiler_, std::filesystem::path directory_)
+    : compiler(compiler_), directory(std::move(directory_))
+{
+    if (!directory.empty())
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        if (ec) directory.clear();
+    }
+}
+
+std::shared_ptr<const ShaderBytecode> ShaderCache::Get(const ShaderCompileRequest& request, std::string* error)
+{
+    uint64_t key;
+    if (!ComputeKey(request, key, error))
+    {
+        ++stats.failures;
+        return nullptr;
+    }
+
+    auto it = compiled.find(key);
+    if (it != compiled.end())
+    {
+        ++stats.memoryHits;
+        return it->second;
+    }
+
+    if (std::shared_ptr<const ShaderBytecode> bytecode = ReadDisk(key))
+    {
+        ++stats.diskHits;
+        compiled.emplace(key, bytecode);
+        return bytecode;
+    }
+
+    auto bytecode = std::make_shared<ShaderBytecode>();
+    std::string compileError;
+    ++stats.compiles;
+    if (!compiler.Compile(request, *bytecode, compileError))
+    {
+        ++stats.failures;
+        if (error) *error = compileError;
+        return nullptr;
+    }
+
+    WriteDisk(key, *bytecode);
+    compiled.emplace(key, bytecode);
+    return bytecode;
+}
+
+bool ShaderCache::ComputeKey(const ShaderCompileRequest& request, uint64_t& key, std::string* error)
+{
+    uint64_t hash = HashString(compiler.GetVersionTag());
+    hash = HashString(request.entry, hash);
+    hash = HashString(request.target, hash);
+    for (const ShaderDefine& d : request.defines)
+    {
+        hash = HashString(d.name, hash);
+        hash = HashString(d.value, hash);
+    }
+
+    std::vector<std::filesystem::path> visited;
+    if (!HashSourceTree(request.sourcePath, hash, visited, error)) return false;
+
+    key = hash;
+    return true;
+}
+
+void ShaderCache::ClearMemory()
+{
+    compiled.clear();
+    sources.clear();
+}
+
+const ShaderCache::SourceFile* ShaderCache::LoadSource(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    const auto writeTime = std::filesystem::last_write_time(path, ec);
+    if (ec) return nullptr;
+    const uintmax_t size = std::filesystem::file_size(path, ec);
+    if (ec) return nullptr;
+
+    SourceFile& file = sources[path.generic_string()];
+    if (file.hash != 0 && file.writeTime == writeTime && file.size == size) return &file;
+
+    std::vector<uint8_t> text;
+    if (!LoadFile(path, text))
+    {
+        sources.erase(path.generic_string());
+        return nullptr;
+    }
+    file.writeTime = writeTime;
+    file.size = size;
+    file.hash = HashBytes(text.data(), text.size());
+    file.includes = ScanIncludes(text);
+    return &file;
+}
+
+bool ShaderCache::HashSourceTree(const std::filesystem::path& path, uint64_t& hash,
+    std::vector<std::filesystem::path>& visited, std::string* error)
+{
+    const std::filesystem::path normal = path.lexically_normal();
+    if (std::find(visited.begin(), visited.end(), normal) != visited.end())
+    {
+        hash = HashString("<visited>", hash);
+        return true;
+    }
+    visited.push_back(normal);
+
+    const SourceFile* file = LoadSource(normal);
+    if (!file)
+    {
+        if (error) *error = "Cannot read shader source: " + normal.string();
+        return false;
+    }
+    hash = HashValue(file->hash, hash);
+
+    for (const std::string& name : file->includes)
+    {
+        hash = HashString(name, hash);
+        const std::filesystem::path included = normal.parent_path() / name;
+        // Unresolvable includes are left to the compiler to report
+        std::error_code ec;
+        if (!std::filesystem::exists(included, ec)) continue;
+        if (!HashSourceTree(included, hash, visited, error)) return false;
+    }
+    return true;
+}
+
+std::filesystem::path ShaderCache::GetCachePath(uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.cso", (unsigned long long)key);
+    return directory / name;
+}
+
+std::shared_ptr<const ShaderBytecode> ShaderCache::ReadDisk(uint64_t key)
+{
+    if (directory.empty()) return nullptr;
+
+    std::vector<uint8_t> bytes;
+    if (!LoadFile(GetCachePath(key), bytes)) return nullptr;
+
+    DiskHeader header;
+    bool valid = bytes.size() >= sizeof(header);
+    if (valid)
+    {
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        valid = std::memcmp(header.magic, DiskMagic, sizeof(DiskMagic)) == 0
+            && header.version == DiskVersion
+            && header.key == key
+            && header.size == bytes.size() - sizeof(header)
+            && header.checksum == HashBytes(bytes.data() + sizeof(header), (size_t)header.size);
+    }
+    if (!valid)
+    {
+        ++stats.diskRejects;
+        return nullptr;
+    }
+    return std::make_shared<const ShaderBytecode>(bytes.begin() + sizeof(header), bytes.end());
+}
+
+void ShaderCache::WriteDisk(uint64_t key, const ShaderBytecode& bytecode)
+{
+    if (directory.empty()) return;
+
+    DiskHeader header{};
+    std::memcpy(header.magic, DiskMagic, sizeof(DiskMagic));
+    header.version = DiskVersion;
+    header.key = key;
+    header.size = bytecode.size();
+    header.checksum = HashBytes(bytecode.data(), bytecode.size());
+
+    std::vector<uint8_t> bytes(sizeof(header) + bytecode.size());
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    if (!bytecode.empty()) std::memcpy(bytes.data() + sizeof(header), bytecode.data(), bytecode.size());
+
+    // Write then rename, so a crash never leaves a torn file under the real name
+    const std::filesystem::path target = GetCachePath(key);
+    std::filesystem::path temp = target;
+    temp += ".tmp";
+    if (!SaveFile(temp, bytes)) return;
+    std::error_code ec;
+    std::filesystem::rename(temp, target, ec);
+    if (ec) std::filesystem::remove(temp, ec);
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ShaderDefine
+{
+    std::string name;
+    std::string value;
+};
+
+struct ShaderCompileRequest
+{
+    std::filesystem::path sourcePath;
+    std::string entry;
+    std::string target;     // e.g. "vs_5_0"
+    std::vector<ShaderDefine> defines;
+};
+
+using ShaderBytecode = std::vector<uint8_t>;
+
+// Backend compiler; ShaderCache only calls it on a miss.
+class IShaderCompiler
+{
+public:
+    virtual ~IShaderCompiler() = default;
+
+    // Compiler identity and flags. Part of every cache key, so changing it
+    // invalidates everything compiled before.
+    virtual std::string GetVersionTag() const = 0;
+    virtual bool Compile(const ShaderCompileRequest& request, ShaderBytecode& out, std::string& error) = 0;
+};
+
+// Compiled shader cache keyed by a 64-bit hash of the compiler tag, entry
+// point, target, defines and the contents of the source and every file it
+// #includes (resolved relative to the including file). Hits are served from
+// memory, then from <directory>/<key>.cso, and only then compiled; fresh
+// compiles are written back. Source hashes are remembered per file until its
+// size or write time changes. An empty directory keeps the cache in memory.
+class ShaderCache
+{
+public:
+    struct Stats
+    {
+        uint32_t memoryHits = 0;
+        uint32_t diskHits = 0;
+        uint32_t compiles = 0;
+        uint32_t failures = 0;        // missing sources and compile errors
+        uint32_t diskRejects = 0;     // cache files that failed validation
+    };
+
+    explicit ShaderCache(IShaderCompiler& compiler, std::filesystem::path directory = {});
+
+    // Null on failure, with the reason in error.
+    std::shared_ptr<const ShaderBytecode> Get(const ShaderCompileRequest& request, std::string* error = nullptr);
+
+    bool ComputeKey(const ShaderCompileRequest& request, uint64_t& key, std::string* error = nullptr);
+
+    // Forgets compiled bytecode and source hashes; the disk cache stays.
+    void ClearMemory();
+
+    const std::filesystem::path& GetDirectory() const { return directory; }
+    const Stats& GetStats() const { return stats; }
+
+private:
+    struct SourceFile
+    {
+        std::filesystem::file_time_type writeTime;
+        uintmax_t size = 0;
+        uint64_t hash = 0;
+        std::vector<std::string> includes;   // as written in the directive
+    };
+
+    const SourceFile* LoadSource(const std::filesystem::path& path);
+    bool HashSourceTree(const std::filesystem::path& path, uint64_t& hash,
+        std::vector<std::filesystem::path>& visited, std::string* error);
+
+    std::filesystem::path GetCachePath(uint64_t key) const;
+    std::shared_ptr<const ShaderBytecode> ReadDisk(uint64_t key);
+    void WriteDisk(uint64_t key, const ShaderBytecode& bytecode);
+
+    IShaderCompiler& compiler;
+    std::filesystem::path directory;
+
+    std::unordered_map<uint64_t, std::shared_ptr<const ShaderBytecode>> compiled;
+    std::unordered_map<std::string, SourceFile> sources;
+    Stats stats;
+};
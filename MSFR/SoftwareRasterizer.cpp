@@ -0,0 +1,498 @@
+#include "SoftwareRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ImageCodec.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#define MSFR_RASTER_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define MSFR_RASTER_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // (x + 128 + ((x + 128) >> 8)) >> 8 == round(x / 255) for x <= 255 * 255
+    inline uint32_t Div255(uint32_t x)
+    {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    }
+
+    struct SpanParams
+    {
+        float tu, tv;     // texel coordinates of the first pixel
+        float du, dv;     // per pixel step
+        uint32_t tint;
+    };
+
+    // Reference path; the SIMD paths below use the same fixed-point math
+    void BlendSpanScalar(uint32_t* dst, int count, const SpanParams& p, const SoftwareTexture& tex)
+    {
+        const float maxU = (float)(tex.width - 1);
+        const float maxV = (float)(tex.height - 1);
+        for (int i = 0; i < count; ++i)
+        {
+            const float u = std::min(std::max(p.tu + p.du * (float)i, 0.f), maxU);
+            const float v = std::min(std::max(p.tv + p.dv * (float)i, 0.f), maxV);
+            const int x0 = (int)u;
+            const int y0 = (int)v;
+            const uint32_t fx = (uint32_t)((u - (float)x0) * 256.f);
+            const uint32_t fy = (uint32_t)((v - (float)y0) * 256.f);
+            const int x1 = x0 + (x0 < tex.width - 1 ? 1 : 0);
+            const int y1 = y0 + (y0 < tex.height - 1 ? 1 : 0);
+
+            const uint32_t t00 = tex.pixels[(size_t)y0 * tex.width + x0];
+            const uint32_t t01 = tex.pixels[(size_t)y0 * tex.width + x1];
+            const uint32_t t10 = tex.pixels[(size_t)y1 * tex.width + x0];
+            const uint32_t t11 = tex.pixels[(size_t)y1 * tex.width + x1];
+
+            uint32_t s[4];
+            for (int c = 0; c < 4; ++c)
+            {
+                const int shift = c * 8;
+                const uint32_t top = (((t00 >> shift) & 0xFF) * (256 - fx) + ((t01 >> shift) & 0xFF) * fx) >> 8;
+                const uint32_t bottom = (((t10 >> shift) & 0xFF) * (256 - fx) + ((t11 >> shift) & 0xFF) * fx) >> 8;
+                const uint32_t texel = (top * (256 - fy) + bottom * fy) >> 8;
+                s[c] = Div255(texel * ((p.tint >> shift) & 0xFF));
+            }
+
+            const uint32_t d = dst[i];
+            const uint32_t inv = 255 - s[3];
+            uint32_t out = 0;
+            for (int c = 0; c < 4; ++c)
+            {
+                const uint32_t srcFactor = c == 3 ? 255 : s[3];
+                out |= Div255(s[c] * srcFactor + ((d >> (c * 8)) & 0xFF) * inv) << (c * 8);
+            }
+            dst[i] = out;
+        }
+    }
+
+#if MSFR_RASTER_SSE2
+    // 16-bit lanes, two RGBA pixels per register
+    inline __m128i Lerp16(__m128i a, __m128i b, __m128i w)
+    {
+        const __m128i k256 = _mm_set1_epi16(256);
+        return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(a, _mm_sub_epi16(k256, w)), _mm_mullo_epi16(b, w)), 8);
+    }
+
+    inline __m128i Div255x8(__m128i x)
+    {
+        x = _mm_add_epi16(x, _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    }
+
+    inline __m128i Shade2(__m128i t00, __m128i t01, __m128i t10, __m128i t11,
+        __m128i wx, __m128i wy, __m128i tint, __m128i dst)
+    {
+        __m128i s = Lerp16(Lerp16(t00, t01, wx), Lerp16(t10, t11, wx), wy);
+        s = Div255x8(_mm_mullo_epi16(s, tint));
+
+        const __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xFF), 0xFF);
+        const __m128i rgbMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+        const __m128i alphaOne = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+        const __m128i srcFactor = _mm_or_si128(_mm_and_si128(alpha, rgbMask), alphaOne);
+        const __m128i dstFactor = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+        return Div255x8(_mm_add_epi16(_mm_mullo_epi16(s, srcFactor), _mm_mullo_epi16(dst, dstFactor)));
+    }
+
+    // Per-pixel weights widened to all four channels of each pixel
+    inline void SplitWeights(__m128i w32, __m128i& lo, __m128i& hi)
+    {
+        const __m128i w16 = _mm_packs_epi32(w32, w32);
+        const __m128i pairs = _mm_unpacklo_epi16(w16, w16);
+        lo = _mm_unpacklo_epi32(pairs, pairs);
+        hi = _mm_unpackhi_epi32(pairs, pairs);
+    }
+
+    int BlendSpanSSE2(uint32_t* dst, int count, const SpanParams& p, const SoftwareTexture& tex)
+    {
+        const __m128 maxU = _mm_set1_ps((float)(tex.width - 1));
+        const __m128 maxV = _mm_set1_ps((float)(tex.height - 1));
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 k256 = _mm_set1_ps(256.f);
+        const __m128 lane = _mm_set_ps(3.f, 2.f, 1.f, 0.f);
+        const __m128i lastX = _mm_set1_epi32(tex.width - 1);
+        const __m128i lastY = _mm_set1_epi32(tex.height - 1);
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128i zero16 = _mm_setzero_si128();
+        const __m128i tint = _mm_unpacklo_epi8(_mm_set1_epi32((int)p.tint), zero16);
+        const uint32_t* texels = tex.pixels;
+        const size_t pitch = (size_t)tex.width;
+
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 index = _mm_add_ps(_mm_set1_ps((float)i), lane);
+            const __m128 u = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_set1_ps(p.tu), _mm_mul_ps(_mm_set1_ps(p.du), index)), zero), maxU);
+            const __m128 v = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_set1_ps(p.tv), _mm_mul_ps(_mm_set1_ps(p.dv), index)), zero), maxV);
+            const __m128i x0 = _mm_cvttps_epi32(u);
+            const __m128i y0 = _mm_cvttps_epi32(v);
+            const __m128i fx = _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(u, _mm_cvtepi32_ps(x0)), k256));
+            const __m128i fy = _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(v, _mm_cvtepi32_ps(y0)), k256));
+            const __m128i x1 = _mm_add_epi32(x0, _mm_and_si128(_mm_cmplt_epi32(x0, lastX), one));
+            const __m128i y1 = _mm_add_epi32(y0, _mm_and_si128(_mm_cmplt_epi32(y0, lastY), one));
+
+            alignas(16) int32_t ix0[4], ix1[4], iy0[4], iy1[4];
+            _mm_store_si128((__m128i*)ix0, x0);
+            _mm_store_si128((__m128i*)ix1, x1);
+            _mm_store_si128((__m128i*)iy0, y0);
+            _mm_store_si128((__m128i*)iy1, y1);
+
+            alignas(16) uint32_t g00[4], g01[4], g10[4], g11[4];
+            for (int k = 0; k < 4; ++k)
+            {
+                const uint32_t* row0 = texels + (size_t)iy0[k] * pitch;
+                const uint32_t* row1 = texels + (size_t)iy1[k] * pitch;
+                g00[k] = row0[ix0[k]];
+                g01[k] = row0[ix1[k]];
+                g10[k] = row1[ix0[k]];
+                g11[k] = row1[ix1[k]];
+            }
+            const __m128i t00 = _mm_load_si128((const __m128i*)g00);
+            const __m128i t01 = _mm_load_si128((const __m128i*)g01);
+            const __m128i t10 = _mm_load_si128((const __m128i*)g10);
+            const __m128i t11 = _mm_load_si128((const __m128i*)g11);
+            const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+
+            __m128i wxLo, wxHi, wyLo, wyHi;
+            SplitWeights(fx, wxLo, wxHi);
+            SplitWeights(fy, wyLo, wyHi);
+
+            const __m128i lo = Shade2(_mm_unpacklo_epi8(t00, zero16), _mm_unpacklo_epi8(t01, zero16),
+                _mm_unpacklo_epi8(t10, zero16), _mm_unpacklo_epi8(t11, zero16), wxLo, wyLo, tint, _mm_unpacklo_epi8(d, zero16));
+            const __m128i hi = Shade2(_mm_unpackhi_epi8(t00, zero16), _mm_unpackhi_epi8(t01, zero16),
+                _mm_unpackhi_epi8(t10, zero16), _mm_unpackhi_epi8(t11, zero16), wxHi, wyHi, tint, _mm_unpackhi_epi8(d, zero16));
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+        }
+        return i;
+    }
+#endif
+
+#if MSFR_RASTER_AVX2
+    inline __m256i Lerp16(__m256i a, __m256i b, __m256i w)
+    {
+        const __m256i k256 = _mm256_set1_epi16(256);
+        return _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(a, _mm256_sub_epi16(k256, w)), _mm256_mullo_epi16(b, w)), 8);
+    }
+
+    inline __m256i Div255x16(__m256i x)
+    {
+        x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+        return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+    }
+
+    inline __m256i Shade4(__m256i t00, __m256i t01, __m256i t10, __m256i t11,
+        __m256i wx, __m256i wy, __m256i tint, __m256i dst)
+    {
+        __m256i s = Lerp16(Lerp16(t00, t01, wx), Lerp16(t10, t11, wx), wy);
+        s = Div255x16(_mm256_mullo_epi16(s, tint));
+
+        const __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xFF), 0xFF);
+        const __m256i rgbMask = _mm256_set1_epi64x(0x0000FFFFFFFFFFFFll);
+        const __m256i alphaOne = _mm256_set1_epi64x(0x00FF000000000000ll);
+        const __m256i srcFactor = _mm256_or_si256(_mm256_and_si256(alpha, rgbMask), alphaOne);
+        const __m256i dstFactor = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+        return Div255x16(_mm256_add_epi16(_mm256_mullo_epi16(s, srcFactor), _mm256_mullo_epi16(dst, dstFactor)));
+    }
+
+    inline void SplitWeights(__m256i w32, __m256i& lo, __m256i& hi)
+    {
+        const __m256i w16 = _mm256_packs_epi32(w32, w32);
+        const __m256i pairs = _mm256_unpacklo_epi16(w16, w16);
+        lo = _mm256_unpacklo_epi32(pairs, pairs);
+        hi = _mm256_unpackhi_epi32(pairs, pairs);
+    }
+
+    int BlendSpanAVX2(uint32_t* dst, int count, const SpanParams& p, const SoftwareTexture& tex)
+    {
+        const __m256 maxU = _mm256_set1_ps((float)(tex.width - 1));
+        const __m256 maxV = _mm256_set1_ps((float)(tex.height - 1));
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 k256 = _mm256_set1_ps(256.f);
+        const __m256 lane = _mm256_set_ps(7.f, 6.f, 5.f, 4.f, 3.f, 2.f, 1.f, 0.f);
+        const __m256i lastX = _mm256_set1_epi32(tex.width - 1);
+        const __m256i lastY = _mm256_set1_epi32(tex.height - 1);
+        const __m256i pitch = _mm256_set1_epi32(tex.width);
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i zero16 = _mm256_setzero_si256();
+        const __m256i tint = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)p.tint), zero16);
+        const int* texels = (const int*)tex.pixels;
+
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256 index = _mm256_add_ps(_mm256_set1_ps((float)i), lane);
+            const __m256 u = _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(_mm256_set1_ps(p.tu), _mm256_mul_ps(_mm256_set1_ps(p.du), index)), zero), maxU);
+            const __m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(_mm256_set1_ps(p.tv), _mm256_mul_ps(_mm256_set1_ps(p.dv), index)), zero), maxV);
+            const __m256i x0 = _mm256_cvttps_epi32(u);
+            const __m256i y0 = _mm256_cvttps_epi32(v);
+            const __m256i fx = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_sub_ps(u, _mm256_cvtepi32_ps(x0)), k256));
+            const __m256i fy = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_sub_ps(v, _mm256_cvtepi32_ps(y0)), k256));
+            const __m256i dx = _mm256_and_si256(_mm256_cmpgt_epi32(lastX, x0), one);
+            const __m256i dy = _mm256_and_si256(_mm256_cmpgt_epi32(lastY, y0), pitch);
+
+            // 32-bit texel offsets: textures are limited to 16384x16384
+            const __m256i i00 = _mm256_add_epi32(_mm256_mullo_epi32(y0, pitch), x0);
+            const __m256i i01 = _mm256_add_epi32(i00, dx);
+            const __m256i i10 = _mm256_add_epi32(i00, dy);
+            const __m256i i11 = _mm256_add_epi32(i10, dx);
+            const __m256i t00 = _mm256_i32gather_epi32(texels, i00, 4);
+            const __m256i t01 = _mm256_i32gather_epi32(texels, i01, 4);
+            const __m256i t10 = _mm256_i32gather_epi32(texels, i10, 4);
+            const __m256i t11 = _mm256_i32gather_epi32(texels, i11, 4);
+            const __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+
+            __m256i wxLo, wxHi, wyLo, wyHi;
+            SplitWeights(fx, wxLo, wxHi);
+            SplitWeights(fy, wyLo, wyHi);
+
+            const __m256i lo = Shade4(_mm256_unpacklo_epi8(t00, zero16), _mm256_unpacklo_epi8(t01, zero16),
+                _mm256_unpacklo_epi8(t10, zero16), _mm256_unpacklo_epi8(t11, zero16), wxLo, wyLo, tint, _mm256_unpacklo_epi8(d, zero16));
+            const __m256i hi = Shade4(_mm256_unpackhi_epi8(t00, zero16), _mm256_unpackhi_epi8(t01, zero16),
+                _mm256_unpackhi_epi8(t10, zero16), _mm256_unpackhi_epi8(t11, zero16), wxHi, wyHi, tint, _mm256_unpackhi_epi8(d, zero16));
+            _mm256_storeu_si256((__m256i*)(dst + i), _mm256_packus_epi16(lo, hi));
+        }
+        return i;
+    }
+#endif
+
+    void BlendSpan(uint32_t* dst, int count, SpanParams p, const SoftwareTexture& tex)
+    {
+        int done = 0;
+#if MSFR_RASTER_AVX2
+        done = BlendSpanAVX2(dst, count, p, tex);
+#endif
+#if MSFR_RASTER_SSE2
+        if (count - done >= 4)
+        {
+            p.tu += p.du * (float)done;
+            p.tv += p.dv * (float)done;
+            const int n = BlendSpanSSE2(dst + done, count - done, p, tex);
+            done += n;
+            p.tu += p.du * (float)n;
+            p.tv += p.dv * (float)n;
+        }
+        else
+#endif
+        {
+            p.tu += p.du * (float)done;
+            p.tv += p.dv * (float)done;
+        }
+        if (done < count) BlendSpanScalar(dst + done, count - done, p, tex);
+    }
+
+    // Columns x with lo <= a * x + k <= hi, as [first, last)
+    void ClipSlab(float a, float k, int& first, int& last)
+    {
+        if (std::fabs(a) < 1e-12f)
+        {
+            if (k < 0.f || k > 1.f) last = first;
+            return;
+        }
+        float lo = -k / a;
+        float hi = (1.f - k) / a;
+        if (lo > hi) std::swap(lo, hi);
+        lo = std::min(std::max(lo, (float)first), (float)last);
+        hi = std::min(std::max(hi, (float)first), (float)last);
+        first = std::max(first, (int)std::ceil(lo));
+        last = std::min(last, (int)std::ceil(hi));
+    }
+}
+
+SoftwareQuad MakeSoftwareQuad(const SpriteDrawItem& item, const SoftwareTexture& texture) noexcept
+{
+    SoftwareQuad q;
+    std::copy(item.transform, item.transform + 6, q.transform);
+    const float u0 = item.uvRect[0], v0 = item.uvRect[1];
+    const float u1 = item.uvRect[2], v1 = item.uvRect[3];
+    if (item.flags & SpriteDrawItem::UVRotated)
+    {
+        // Same corner mapping as ExpandSpriteQuad
+        const float uv[6] = { 0, v1 - v0, u1 - u0, 0, u0, v0 };
+        std::copy(uv, uv + 6, q.uvTransform);
+    }
+    else
+    {
+        const float uv[6] = { u1 - u0, 0, 0, v0 - v1, u0, v1 };
+        std::copy(uv, uv + 6, q.uvTransform);
+    }
+    q.color = item.color;
+    q.texture = &texture;
+    return q;
+}
+
+SoftwareQuad MakeSoftwareQuad(const SpriteInstance& instance, const SoftwareTexture& texture) noexcept
+{
+    SoftwareQuad q;
+    std::copy(instance.transform, instance.transform + 6, q.transform);
+    const float u0 = instance.uvRect[0] / 65535.f, v0 = instance.uvRect[1] / 65535.f;
+    const float u1 = instance.uvRect[2] / 65535.f, v1 = instance.uvRect[3] / 65535.f;
+    const float uv[6] = { u1 - u0, 0, 0, v0 - v1, u0, v1 };
+    std::copy(uv, uv + 6, q.uvTransform);
+    q.color = instance.color;
+    q.texture = &texture;
+    return q;
+}
+
+SoftwareRasterizer::SoftwareRasterizer(unsigned threadCount)
+    : pool(threadCount)
+{
+}
+
+void SoftwareRasterizer::Resize(int width_, int height_)
+{
+    width = std::max(width_, 0);
+    height = std::max(height_, 0);
+    tilesX = (width + TileSize - 1) / TileSize;
+    tilesY = (height + TileSize - 1) / TileSize;
+    pixels.assign((size_t)width * height, 0);
+    bins.assign((size_t)tilesX * tilesY, {});
+    tilePixels.assign(bins.size(), 0);
+    quads.clear();
+    stats = {};
+}
+
+void SoftwareRasterizer::Clear(uint32_t color)
+{
+    quads.clear();
+    std::fill(pixels.begin(), pixels.end(), color);
+}
+
+void SoftwareRasterizer::Submit(const SoftwareQuad& quad)
+{
+    const SoftwareTexture* tex = quad.texture;
+    if (!tex || !tex->pixels || tex->width <= 0 || tex->height <= 0 || width == 0 || height == 0) return;
+
+    const float* t = quad.transform;
+    const float det = t[0] * t[3] - t[2] * t[1];
+    if (std::fabs(det) < 1e-12f) return;
+
+    // Bounds in framebuffer columns/rows (row 0 at the top)
+    const float xs[4] = { t[4], t[4] + t[0], t[4] + t[0] + t[2], t[4] + t[2] };
+    const float ys[4] = { t[5], t[5] + t[1], t[5] + t[1] + t[3], t[5] + t[3] };
+    const float minPx = std::min(std::min(xs[0], xs[1]), std::min(xs[2], xs[3]));
+    const float maxPx = std::max(std::max(xs[0], xs[1]), std::max(xs[2], xs[3]));
+    const float minPy = std::min(std::min(ys[0], ys[1]), std::min(ys[2], ys[3]));
+    const float maxPy = std::max(std::max(ys[0], ys[1]), std::max(ys[2], ys[3]));
+    if (maxPx <= 0.f || minPx >= (float)width || maxPy <= 0.f || minPy >= (float)height) return;
+
+    Setup s;
+    s.minX = std::max(0, (int)std::floor(minPx));
+    s.maxX = std::min(width - 1, (int)std::ceil(maxPx));
+    s.minY = std::max(0, (int)std::floor((float)height - maxPy));
+    s.maxY = std::min(height - 1, (int)std::ceil((float)height - minPy));
+
+    // Inverse transform, re-expressed over integer column/row indices:
+    // px = x + 0.5, py = height - row - 0.5
+    const float i00 = t[3] / det, i01 = -t[2] / det;
+    const float i10 = -t[1] / det, i11 = t[0] / det;
+    const float ox = 0.5f - t[4];
+    const float oy = (float)height - 0.5f - t[5];
+    s.cx[0] = i00;
+    s.cx[1] = -i01;
+    s.cx[2] = i00 * ox + i01 * oy;
+    s.cy[0] = i10;
+    s.cy[1] = -i11;
+    s.cy[2] = i10 * ox + i11 * oy;
+
+    const float* uv = quad.uvTransform;
+    const float w = (float)tex->width;
+    const float h = (float)tex->height;
+    for (int k = 0; k < 3; ++k)
+    {
+        s.tu[k] = (uv[0] * s.cx[k] + uv[2] * s.cy[k] + (k == 2 ? uv[4] : 0.f)) * w - (k == 2 ? 0.5f : 0.f);
+        s.tv[k] = (uv[1] * s.cx[k] + uv[3] * s.cy[k] + (k == 2 ? uv[5] : 0.f)) * h - (k == 2 ? 0.5f : 0.f);
+    }
+    s.color = quad.color;
+    s.texture = *tex;
+
+    quads.push_back(s);
+}
+
+void SoftwareRasterizer::Render()
+{
+    if (quads.empty()) return;
+
+    for (std::vector<uint32_t>& bin : bins) bin.clear();
+    for (uint32_t i = 0; i < quads.size(); ++i)
+    {
+        const Setup& s = quads[i];
+        for (int ty = s.minY / TileSize; ty <= s.maxY / TileSize; ++ty)
+        {
+            for (int tx = s.minX / TileSize; tx <= s.maxX / TileSize; ++tx)
+            {
+                bins[(size_t)ty * tilesX + tx].push_back(i);
+                ++stats.binEntries;
+            }
+        }
+    }
+    std::fill(tilePixels.begin(), tilePixels.end(), 0);
+
+    pool.Run((uint32_t)bins.size(), [this](uint32_t tile)
+    {
+        if (!bins[tile].empty()) RasterizeTile(tile);
+    });
+
+    for (uint64_t n : tilePixels) stats.pixels += n;
+    stats.quads += (uint32_t)quads.size();
+    quads.clear();
+}
+
+void SoftwareRasterizer::ReadPixels(Image& out) const
+{
+    out = Image((uint32_t)width, (uint32_t)height);
+    for (size_t i = 0; i < pixels.size(); ++i)
+    {
+        const uint32_t p = pixels[i];
+        uint8_t* d = &out.pixels[i * 4];
+        d[0] = (uint8_t)p;
+        d[1] = (uint8_t)(p >> 8);
+        d[2] = (uint8_t)(p >> 16);
+        d[3] = (uint8_t)(p >> 24);
+    }
+}
+
+void SoftwareRasterizer::RasterizeTile(uint32_t tile)
+{
+    const int x0 = (int)(tile % tilesX) * TileSize;
+    const int y0 = (int)(tile / tilesX) * TileSize;
+    const int x1 = std::min(x0 + TileSize, width);
+    const int y1 = std::min(y0 + TileSize, height);
+
+    for (uint32_t index : bins[tile])
+    {
+        const Setup& s = quads[index];
+        RasterizeQuad(s, std::max(x0, s.minX), std::max(y0, s.minY),
+            std::min(x1, s.maxX + 1), std::min(y1, s.maxY + 1));
+    }
+}
+
+void SoftwareRasterizer::RasterizeQuad(const Setup& s, int x0, int y0, int x1, int y1)
+{
+    uint64_t shaded = 0;
+    for (int row = y0; row < y1; ++row)
+    {
+        const float r = (float)row;
+        int first = x0;
+        int last = x1;
+        ClipSlab(s.cx[0], s.cx[1] * r + s.cx[2], first, last);
+        ClipSlab(s.cy[0], s.cy[1] * r + s.cy[2], first, last);
+        if (first >= last) continue;
+
+        SpanParams p;
+        p.du = s.tu[0];
+        p.dv = s.tv[0];
+        p.tu = s.tu[0] * (float)first + s.tu[1] * r + s.tu[2];
+        p.tv = s.tv[0] * (float)first + s.tv[1] * r + s.tv[2];
+        p.tint = s.color;
+        BlendSpan(&pixels[(size_t)row * width + first], last - first, p, s.texture);
+        shaded += (uint64_t)(last - first);
+    }
+    tilePixels[(size_t)(y0 / TileSize) * tilesX + x0 / TileSize] += shaded;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "SpriteBatch.h"
+#include "WorkerPool.h"
+
+struct Image;
+
+// RGBA8 texels, R in the low byte, first row at the top (v = 0).
+struct SoftwareTexture
+{
+    int width = 0;
+    int height = 0;
+    const uint32_t* pixels = nullptr;
+};
+
+// A textured parallelogram. Both transforms map the unit quad (0..1), the
+// first to framebuffer pixels (origin bottom-left, like SpriteDrawItem), the
+// second to texture UVs:
+//   u = uv[0] * x + uv[2] * y + uv[4]
+//   v = uv[1] * x + uv[3] * y + uv[5]
+struct SoftwareQuad
+{
+    float transform[6] = { 1, 0, 0, 1, 0, 0 };
+    float uvTransform[6] = { 1, 0, 0, -1, 0, 1 };
+    uint32_t color = 0xFFFFFFFF;
+    const SoftwareTexture* texture = nullptr;
+};
+
+SoftwareQuad MakeSoftwareQuad(const SpriteDrawItem& item, const SoftwareTexture& texture) noexcept;
+SoftwareQuad MakeSoftwareQuad(const SpriteInstance& instance, const SoftwareTexture& texture) noexcept;
+
+// CPU sprite renderer. Quads are bilinear-sampled (clamped), tinted and
+// alpha-blended like the sprite pipelines (color: src-alpha / inv-src-alpha,
+// alpha: one / inv-src-alpha) into an RGBA8 framebuffer. Submitted quads are
+// binned into 64x64 tiles and the tiles are rasterized in parallel, each one
+// in submission order. Spans are blended 8 pixels at a time with AVX2, 4 with
+// SSE2, scalar elsewhere; all paths use the same fixed-point math.
+class SoftwareRasterizer
+{
+public:
+    static constexpr int TileSize = 64;
+
+    struct Stats
+    {
+        uint32_t quads = 0;        // rendered since the last Resize/ResetStats
+        uint32_t binEntries = 0;   // quad/tile pairs
+        uint64_t pixels = 0;       // blended pixels
+    };
+
+    // 0 threads: one per hardware core. The calling thread always helps.
+    explicit SoftwareRasterizer(unsigned threadCount = 0);
+
+    SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+    SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+    void Resize(int width, int height);
+    // Drops anything pending; it would be overwritten anyway.
+    void Clear(uint32_t color);
+
+    // Textures must stay alive and unchanged until the next Render.
+    void Submit(const SoftwareQuad& quad);
+    bool HasPending() const { return !quads.empty(); }
+    void Render();
+
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    const uint32_t* GetPixels() const { return pixels.data(); }
+    void ReadPixels(Image& out) const;
+
+    unsigned GetThreadCount() const { return pool.GetThreadCount(); }
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = {}; }
+
+private:
+    struct Setup
+    {
+        float cx[3];    // unit quad coordinates from pixel centres: a * px + b * py + c
+        float cy[3];
+        float tu[3];    // texel coordinates from pixel centres
+        float tv[3];
+        int minX, minY, maxX, maxY;    // framebuffer rows, inclusive
+        uint32_t color;
+        SoftwareTexture texture;
+    };
+
+    void RasterizeTile(uint32_t tile);
+    void RasterizeQuad(const Setup& quad, int x0, int y0, int x1, int y1);
+
+    int width = 0;
+    int height = 0;
+    int tilesX = 0;
+    int tilesY = 0;
+    std::vector<uint32_t> pixels;
+
+    std::vector<Setup> quads;
+    std::vector<std::vector<uint32_t>> bins;
+    std::vector<uint64_t> tilePixels;
+    Stats stats;
+
+    WorkerPool pool;
+};
@@ -0,0 +1,183 @@
+#include "SpatialGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Keeps cell indices well inside int range for far-away or bogus bounds
+    constexpr float CellLimit = 1.0e8f;
+
+    int ToCell(float v, float invCellSize)
+    {
+        const float c = std::floor(v * invCellSize);
+        if (!(c > -CellLimit)) return (int)-CellLimit;
+        if (!(c < CellLimit)) return (int)CellLimit;
+        return (int)c;
+    }
+
+    void EraseValue(std::vector<uint32_t>& list, uint32_t value)
+    {
+        auto it = std::find(list.begin(), list.end(), value);
+        if (it != list.end())
+        {
+            *it = list.back();
+            list.pop_back();
+        }
+    }
+}
+
+SpatialGrid::SpatialGrid(float cellSize_)
+    : cellSize(cellSize_ > 0.f ? cellSize_ : 256.f)
+    , invCellSize(1.f / cellSize)
+{
+}
+
+uint32_t SpatialGrid::Insert(const Aabb& bounds)
+{
+    uint32_t handle;
+    if (!freeHandles.empty())
+    {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+    else
+    {
+        handle = (uint32_t)items.size();
+        items.emplace_back();
+    }
+
+    Item& item = items[handle];
+    item.bounds = bounds;
+    item.range = RangeOf(bounds);
+    item.live = true;
+    Link(handle);
+    ++liveCount;
+    return handle;
+}
+
+void SpatialGrid::Update(uint32_t handle, const Aabb& bounds)
+{
+    if (handle >= items.size() || !items[handle].live) return;
+
+    Item& item = items[handle];
+    item.bounds = bounds;
+    const CellRange range = RangeOf(bounds);
+    if (range == item.range) return;
+
+    Unlink(handle);
+    item.range = range;
+    Link(handle);
+}
+
+void SpatialGrid::Remove(uint32_t handle)
+{
+    if (handle >= items.size() || !items[handle].live) return;
+
+    Unlink(handle);
+    items[handle].live = false;
+    freeHandles.push_back(handle);
+    --liveCount;
+}
+
+void SpatialGrid::Clear()
+{
+    items.clear();
+    freeHandles.clear();
+    cells.clear();
+    large.clear();
+    liveCount = 0;
+}
+
+void SpatialGrid::Query(const Aabb& area, std::vector<uint32_t>& out)
+{
+    // Stamps dedupe items that sit in several cells
+    if (++stamp == 0)
+    {
+        for (Item& item : items) item.stamp = 0;
+        stamp = 1;
+    }
+
+    auto visit = [&](uint32_t handle)
+    {
+        Item& item = items[handle];
+        if (item.stamp == stamp) return;
+        item.stamp = stamp;
+        if (item.bounds.Intersects(area)) out.push_back(handle);
+    };
+
+    const CellRange range = RangeOf(area);
+    const int64_t rangeCells = (int64_t)(range.x1 - range.x0 + 1) * (range.y1 - range.y0 + 1);
+    if (rangeCells > (int64_t)cells.size())
+    {
+        // Area covers more cells than exist: walk the occupied ones instead
+        for (auto& [key, list] : cells)
+        {
+            const int cx = (int)(int32_t)(key >> 32);
+            const int cy = (int)(int32_t)(uint32_t)key;
+            if (cx < range.x0 || cx > range.x1 || cy < range.y0 || cy > range.y1) continue;
+            for (uint32_t handle : list) visit(handle);
+        }
+    }
+    else
+    {
+        for (int cy = range.y0; cy <= range.y1; ++cy)
+        {
+            for (int cx = range.x0; cx <= range.x1; ++cx)
+            {
+                auto it = cells.find(CellKey(cx, cy));
+                if (it == cells.end()) continue;
+                for (uint32_t handle : it->second) visit(handle);
+            }
+        }
+    }
+
+    for (uint32_t handle : large) visit(handle);
+}
+
+SpatialGrid::CellRange SpatialGrid::RangeOf(const Aabb& bounds) const
+{
+    CellRange range;
+    range.x0 = ToCell(bounds.minX, invCellSize);
+    range.y0 = ToCell(bounds.minY, invCellSize);
+    range.x1 = std::max(range.x0, ToCell(bounds.maxX, invCellSize));
+    range.y1 = std::max(range.y0, ToCell(bounds.maxY, invCellSize));
+    return range;
+}
+
+void SpatialGrid::Link(uint32_t handle)
+{
+    const CellRange& r = items[handle].range;
+    if (r.IsLarge())
+    {
+        large.push_back(handle);
+        return;
+    }
+    for (int cy = r.y0; cy <= r.y1; ++cy)
+    {
+        for (int cx = r.x0; cx <= r.x1; ++cx)
+        {
+            cells[CellKey(cx, cy)].push_back(handle);
+        }
+    }
+}
+
+void SpatialGrid::Unlink(uint32_t handle)
+{
+    const CellRange& r = items[handle].range;
+    if (r.IsLarge())
+    {
+        EraseValue(large, handle);
+        return;
+    }
+    for (int cy = r.y0; cy <= r.y1; ++cy)
+    {
+        for (int cx = r.x0; cx <= r.x1; ++cx)
+        {
+            auto it = cells.find(CellKey(cx, cy));
+            if (it == cells.end()) continue;
+            EraseValue(it->second, handle);
+            if (it->second.empty()) cells.erase(it);
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+struct Aabb
+{
+    float minX = 0.f;
+    float minY = 0.f;
+    float maxX = 0.f;
+    float maxY = 0.f;
+
+    bool Intersects(const Aabb& o) const noexcept
+    {
+        return minX <= o.maxX && o.minX <= maxX && minY <= o.maxY && o.minY <= maxY;
+    }
+};
+
+// Uniform grid over world space, stored sparsely (only occupied cells exist),
+// so unbounded scrolling levels cost nothing for empty space. Items spanning
+// more than MaxCellsPerItem cells are kept aside and tested individually.
+class SpatialGrid
+{
+public:
+    static constexpr uint32_t Invalid = 0xFFFFFFFF;
+    static constexpr int MaxCellsPerItem = 64;
+
+    explicit SpatialGrid(float cellSize = 256.f);
+
+    uint32_t Insert(const Aabb& bounds);
+    // Re-bins only when the covered cell range changes.
+    void Update(uint32_t handle, const Aabb& bounds);
+    void Remove(uint32_t handle);
+    void Clear();
+
+    // Appends handles whose bounds intersect area, each once, in no
+    // particular order.
+    void Query(const Aabb& area, std::vector<uint32_t>& out);
+
+    size_t Size() const { return liveCount; }
+    size_t GetCellCount() const { return cells.size(); }
+
+private:
+    struct CellRange
+    {
+        int x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+
+        bool operator==(const CellRange& o) const noexcept { return x0 == o.x0 && y0 == o.y0 && x1 == o.x1 && y1 == o.y1; }
+        bool IsLarge() const noexcept { return (int64_t)(x1 - x0 + 1) * (y1 - y0 + 1) > MaxCellsPerItem; }
+    };
+
+    struct Item
+    {
+        Aabb bounds;
+        CellRange range;
+        uint32_t stamp = 0;
+        bool live = false;
+    };
+
+    static uint64_t CellKey(int x, int y) noexcept
+    {
+        return (uint64_t)(uint32_t)x << 32 | (uint32_t)y;
+    }
+
+    CellRange RangeOf(const Aabb& bounds) const;
+    void Link(uint32_t handle);
+    void Unlink(uint32_t handle);
+
+    float cellSize;
+    float invCellSize;
+
+    std::vector<Item> items;
+    std::vector<uint32_t> freeHandles;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+    std::vector<uint32_t> large;
+    uint32_t stamp = 0;
+    size_t liveCount = 0;
+};
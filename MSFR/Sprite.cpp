@@ -1,195 +1,192 @@
 
 #include "Sprite.h" //Sprite
-#include "Engine.h" //GetLogger
-#include "TextureDX11.h" //texturePtr
+#include "Engine.h" //GetLogger, GetSpriteDefinitions
+#include "TextureDX11.h" //GetSize
 #include "Rect.h"
-#include "Animation.h" //animations
 #include "Collision.h" //Collision
+#include "SpriteBatch.h" //SpriteDrawItem
+#include "SpriteDefinition.h" //SpriteDefinition
+
+namespace
+{
+	template <typename T>
+	void AddCollision(GameObject* object, SpriteCollisionInfo::Type type, const T (&values)[4])
+	{
+		if (object == nullptr)
+		{
+			Engine::GetLogger().LogError("Trying to add collision to a nullobject");
+		}
+		else if (type == SpriteCollisionInfo::Type::Rect)
+		{
+			rect3 rect;
+			rect.point1.x = static_cast<float>(values[0]);
+			rect.point1.y = static_cast<float>(values[1]);
+			rect.point2.x = static_cast<float>(values[2]);
+			rect.point2.y = static_cast<float>(values[3]);
+			object->AddGOComponent(new RectCollision(rect, object));
+		}
+		else
+		{
+			object->AddGOComponent(new CircleCollision(values[0], object));
+		}
+	}
+}
 
 Sprite::Sprite(const std::filesystem::path& spriteInfoFile, GameObject* object)
 {
 	Load(spriteInfoFile, object);
 }
 
-Sprite::~Sprite()
+Sprite::Sprite(std::shared_ptr<const SpriteDefinition> definition_, GameObject* object)
 {
-	for (Animation* anim : animations)
-	{
-		delete anim;
-	}
-	animations.clear();
+	Load(std::move(definition_), object);
 }
 
 void Sprite::Load(const std::filesystem::path& spriteInfoFile, GameObject* object)
 {
-	hotSpotList.clear();
-	frameTexel.clear();
-	animations.clear();
+	Load(Engine::GetSpriteDefinitions().Load(spriteInfoFile), object);
+}
 
-	if (spriteInfoFile.extension() != ".spt")
+void Sprite::Load(std::shared_ptr<const SpriteDefinition> definition_, GameObject* object)
+{
+	definition = std::move(definition_);
+	for (const SpriteCollisionInfo& collision : definition->GetCollisions())
 	{
-		throw std::runtime_error("Bad Filetype.  " + spriteInfoFile.generic_string() + " not a sprite info file (.spt)");
+		AddCollision(object, collision.type, collision.values);
 	}
-	std::ifstream inFile(spriteInfoFile);
+	PlayAnimation(0);
+}
 
-	if (inFile.is_open() == false)
+void Sprite::Draw(mat3<float> displayMatrix)
+{
+	SpriteDrawItem item;
+	if (BuildDrawItem(displayMatrix, item))
 	{
-		throw std::runtime_error("Failed to load " + spriteInfoFile.generic_string());
+		Engine::GetSpriteBatch().Draw(item, layer, depth);
 	}
+}
 
-	std::string text;
-	inFile >> text;
-	texturePtr = Engine::GetTextureManager().Load(
-		Engine::GetDXDevice(),
-		Engine::GetDXContext(),
-		text,
-		true);
-	frameSize = texturePtr->GetSize();
-
-	inFile >> text;
-	while (inFile.eof() == false)
-	{
-		if (text == "FrameSize")
-		{
-			inFile >> frameSize.x;
-			inFile >> frameSize.y;
-		}
-		else if (text == "NumFrames")
-		{
-			int numFrames;
-			inFile >> numFrames;
-			for (int i = 0; i < numFrames; i++)
-			{
-				frameTexel.push_back({ frameSize.x * i, 0 });
-			}
-		}
-		else if (text == "Frame")
-		{
-			int frameLocationX, frameLocationY;
-			inFile >> frameLocationX;
-			inFile >> frameLocationY;
-			frameTexel.push_back({ static_cast<float>(frameLocationX), static_cast<float>(frameLocationY) });
-		}
-		else if (text == "HotSpot")
-		{
-			int hotSpotX, hotSpotY;
-			inFile >> hotSpotX;
-			inFile >> hotSpotY;
-			hotSpotList.push_back({ static_cast<float>(hotSpotX), static_cast<float>(hotSpotY) });
-		}
-		else if (text == "Anim")
-		{
-			inFile >> text;
-			animations.push_back(new Animation{ text });
-		}
-		else if (text == "CollisionRect")
-		{
-			rect3 rect;
-			inFile >> rect.point1.x >> rect.point1.y >> rect.point2.x >> rect.point2.y;
-			if (object == nullptr)
-			{
-				Engine::GetLogger().LogError("Trying to add collision to a nullobject");
-			}
-			else
-			{
-				object->AddGOComponent(new RectCollision(rect, object));
-			}
-		}
-		else if (text == "CollisionCircle")
-		{
-			double radius;
-			inFile >> radius;
-			if (object == nullptr)
-			{
-				Engine::GetLogger().LogError("Trying to add collision to a nullobject");
-			}
-			else
-			{
-				object->AddGOComponent(new CircleCollision(radius, object));
-			}
-		}
-		else
-		{
-			Engine::GetLogger().LogError("Unknown spt command " + text);
-		}
-		inFile >> text;
-	}
-	if (frameTexel.empty() == true)
+void Sprite::Record(const mat3<float>& displayMatrix, SpriteDrawList& list)
+{
+	SpriteDrawItem item;
+	std::string error;
+	if (BuildDrawItem(displayMatrix, item, &error))
 	{
-		frameTexel.push_back({ 0,0 });
+		list.Draw(item, layer, depth);
 	}
-
-	if (animations.empty())
+	if (error.empty() == false)
 	{
-		animations.push_back(new Animation{});
-		PlayAnimation(0);
+		list.AddError(std::move(error));
 	}
 }
 
-void Sprite::Draw(mat3<float> displayMatrix)
+bool Sprite::BuildDrawItem(const mat3<float>& displayMatrix, SpriteDrawItem& item, std::string* error)
 {
-	if (!texturePtr) return;
+	if (!definition) return false;
 
-	texturePtr->Draw(
-		Engine::GetDXContext(),
-		displayMatrix * mat3<float>::build_translation(-GetHotSpot(0).x, -GetHotSpot(0).y),
-		GetFrameTexel(animations[currAnim]->GetDisplayFrame()),
-		GetFrameSize());
+	const vec2 frameSize = definition->GetFrameSize();
+	const vec2* hotSpotPtr = definition->GetHotSpot(0);
+	if (hotSpotPtr == nullptr)
+	{
+		Report("Cannot find a hotspot of current index!", error);
+	}
+	const vec2 hotSpot = hotSpotPtr == nullptr ? vec2{ 0,0 } : *hotSpotPtr;
+	const mat3<float> quadToScreen = displayMatrix
+		* mat3<float>::build_translation(-hotSpot.x, -hotSpot.y)
+		* mat3<float>::build_scale(frameSize.x, frameSize.y);
+
+	item.transform[0] = quadToScreen.column0.x;
+	item.transform[1] = quadToScreen.column0.y;
+	item.transform[2] = quadToScreen.column1.x;
+	item.transform[3] = quadToScreen.column1.y;
+	item.transform[4] = quadToScreen.column2.x;
+	item.transform[5] = quadToScreen.column2.y;
+
+	const int frameNum = animation.GetDisplayFrame();
+	const SpriteDefinition::Frame* frame = definition->GetFrame(frameNum);
+	const bool rotated = frame != nullptr && frame->rotated;
+	const vec2 texel = GetFrameTexel(frameNum, error);
+	const vec2 texelSize = rotated ? vec2{ frameSize.y, frameSize.x } : frameSize;
+	const vec2 textureSize = definition->GetTexture()->GetSize();
+	item.uvRect[0] = texel.x / textureSize.x;
+	item.uvRect[1] = texel.y / textureSize.y;
+	item.uvRect[2] = (texel.x + texelSize.x) / textureSize.x;
+	item.uvRect[3] = (texel.y + texelSize.y) / textureSize.y;
+	item.flags = rotated ? SpriteDrawItem::UVRotated : 0;
+
+	item.texture = definition->GetTexture()->GetHandle();
+	return true;
 }
 
 vec2 Sprite::GetHotSpot(int index)
 {
-	if (index < 0 || hotSpotList.size() <= index)
+	const vec2* hotSpot = definition->GetHotSpot(index);
+	if (hotSpot == nullptr)
 	{
 		Engine::GetLogger().LogError("Cannot find a hotspot of current index!");
 		return vec2{ 0,0 };
 	}
-	return hotSpotList[index];
+	return *hotSpot;
 }
 
 vec2 Sprite::GetFrameSize() const
 {
-	return frameSize;
+	return definition->GetFrameSize();
 }
 
-void Sprite::PlayAnimation(int anim)
+vec2 Sprite::GetFrameTexel(int frameNum, std::string* error) const
 {
-	if (anim < 0 || animations.size() <= anim)
+	const SpriteDefinition::Frame* frame = definition->GetFrame(frameNum);
+	if (frame == nullptr)
 	{
-		Engine::GetLogger().LogError(std::to_string(anim) + " is out of index!");
-		currAnim = 0;
+		Report(std::to_string(frameNum) + " is out of index!", error);
+		return vec2{ 0,0 };
+	}
+	return frame->texel;
+}
+
+void Sprite::Report(std::string message, std::string* error)
+{
+	if (error == nullptr)
+	{
+		Engine::GetLogger().LogError(message);
 	}
-	else
+	else if (error->empty())
 	{
-		currAnim = anim;
-		animations[currAnim]->ResetAnimation();
+		*error = std::move(message);
 	}
 }
 
+void Sprite::GetLocalBounds(vec2& min, vec2& max) const
+{
+	const vec2* hotSpot = definition->GetHotSpot(0);
+	const vec2 frameSize = definition->GetFrameSize();
+	min = hotSpot == nullptr ? vec2{ 0, 0 } : vec2{ -hotSpot->x, -hotSpot->y };
+	max = { min.x + frameSize.x, min.y + frameSize.y };
+}
+
+void Sprite::PlayAnimation(int anim)
+{
+	if (anim < 0 || definition->GetAnimationCount() <= anim)
+	{
+		Engine::GetLogger().LogError(std::to_string(anim) + " is out of index!");
+		anim = 0;
+	}
+	currAnim = anim;
+	animation = Animation{ definition->GetCommands(currAnim), definition->GetCommandCount(currAnim) };
+}
+
 void Sprite::Update(double dt)
 {
-	animations[currAnim]->Update(dt);
+	animation.Update(dt);
 }
 
 bool Sprite::IsAnimationDone()
 {
-	return animations[currAnim]->IsAnimationDone();
+	return animation.IsAnimationDone();
 }
 
 int Sprite::GetCurrentAnim() const
 {
 	return currAnim;
-}
-
-vec2 Sprite::GetFrameTexel(int frameNum) const
-{
-	if (frameNum < 0 || frameTexel.size() <= frameNum)
-	{
-		Engine::GetLogger().LogError(std::to_string(frameNum) + " is out of index!");
-		return vec2{ 0,0 };
-	}
-	else
-	{
-		return frameTexel[frameNum];
-	}
 }
\ No newline at end of file
@@ -1,28 +1,45 @@
 ﻿#pragma once
 #include <filesystem>
+#include <memory>
 #include <string>
-#include <vector>
 
 #include "vec2.h"
 #include "mat3.h"
+#include "Animation.h"
 #include "Component.h"
 #include "GameObject.h"
 
-class TextureDX11;
-class Animation;
 class GameObject;
+class SpriteDefinition;
+struct SpriteDrawItem;
+class SpriteDrawList;
 
+// One object's sprite: a shared SpriteDefinition plus which animation it's
+// playing and where. Made from a definition the caller holds, a Sprite is
+// its own allocation and nothing else; made from a path it's also a lookup
+// in Engine::GetSpriteDefinitions, which reads the file only the first time.
+// Either way the definition's collisions are added to object.
 class Sprite : public Component
 {
 public:
     Sprite(const std::filesystem::path& spriteInfoFile, GameObject* object);
-    ~Sprite();
+    Sprite(std::shared_ptr<const SpriteDefinition> definition_, GameObject* object);
 
     void Load(const std::filesystem::path& spriteInfoFile, GameObject* object);
+    void Load(std::shared_ptr<const SpriteDefinition> definition_, GameObject* object);
+    const SpriteDefinition& GetDefinition() const { return *definition; }
+
     void Draw(mat3<float> displayMatrix);
+    // Problems (bad frame or hotspot index) go to error when given, else to the log
+    bool BuildDrawItem(const mat3<float>& displayMatrix, SpriteDrawItem& item, std::string* error = nullptr);
+    // Same as Draw but into a recorded list; safe on a worker thread, so
+    // problems are left in the list for the submitting thread to log
+    void Record(const mat3<float>& displayMatrix, SpriteDrawList& list);
 
     vec2 GetHotSpot(int index);
     vec2 GetFrameSize() const;
+    // Drawn quad in object space: hotspot 0 at the origin, frameSize in extent
+    void GetLocalBounds(vec2& min, vec2& max) const;
 
     // animation
     void PlayAnimation(int anim);
@@ -30,16 +47,22 @@ public:
     bool IsAnimationDone();
     int GetCurrentAnim() const;
 
-private:
-    vec2 GetFrameTexel(int frameNum) const;
+    // draw ordering, see SpriteBatch::Draw
+    void SetLayer(unsigned layer_, unsigned depth_ = 0) { layer = layer_; depth = depth_; }
+    unsigned GetLayer() const { return layer; }
 
 private:
-    TextureDX11* texturePtr = nullptr;  //DX11 texture
-    vec2 frameSize{ 0, 0 };
+    // Texel offset of a frame in the definition's texture
+    vec2 GetFrameTexel(int frameNum, std::string* error = nullptr) const;
+    // Logs message, or keeps it in error (the first one only) when given
+    static void Report(std::string message, std::string* error);
 
-    std::vector<vec2> frameTexel;
-    std::vector<vec2> hotSpotList;
+private:
+    std::shared_ptr<const SpriteDefinition> definition;
 
     int currAnim = 0;
-    std::vector<Animation*> animations;
+    Animation animation;                // of currAnim
+
+    unsigned layer = 0;
+    unsigned depth = 0;
 };
@@ -0,0 +1,303 @@
+#include "SpriteBatch.h"
+
+#include <algorithm>
+
+#include "WorkerPool.h"
+
+namespace
+{
+    PipelineDesc MakeSpritePipelineDesc()
+    {
+        PipelineDesc desc;
+        desc.shaderPath = "assets/shaders/sprite_batch_dx11.hlsl";
+        desc.vsEntry = "VSMain";
+        desc.psEntry = "PSMain";
+        desc.layout =
+        {
+            { "POSITION", 0, VertexFormat::Float2,   0, 0 },
+            { "TEXCOORD", 0, VertexFormat::Float2,   0, 8 },
+            { "COLOR",    0, VertexFormat::UNorm8x4, 0, 16 },
+        };
+        desc.blend = BlendMode::Alpha;
+        desc.topology = PrimitiveTopology::TriangleList;
+        desc.sampler = SamplerFilter::Linear;
+        return desc;
+    }
+
+    // Same corner order as ExpandSpriteQuad, so the first 6 quad indices apply
+    constexpr float UnitQuad[8] = { 0, 0, 1, 0, 1, 1, 0, 1 };
+
+    constexpr uint32_t MinCapacity = 1024;
+
+    // Below this a flush packs on the calling thread; waking workers costs more
+    constexpr uint32_t MinSpritesPerPackTask = 4096;
+
+    // Runs pack(begin, end) over [0, count), split across the pool when it pays off.
+    // Every task writes its own slice of the output, so the result never depends
+    // on the thread count.
+    template <typename Fn>
+    void ForEachRange(WorkerPool* pool, uint32_t count, const Fn& pack)
+    {
+        uint32_t tasks = count / MinSpritesPerPackTask;
+        if (pool) tasks = std::min(tasks, pool->GetThreadCount());
+        if (!pool || tasks < 2)
+        {
+            pack(0u, count);
+            return;
+        }
+        pool->Run(tasks, [&](uint32_t task)
+        {
+            pack((uint32_t)((uint64_t)count * task / tasks), (uint32_t)((uint64_t)count * (task + 1) / tasks));
+        });
+    }
+}
+
+void MakeSpriteProjection(const float t[6], float screenW, float screenH, float m[16]) noexcept
+{
+    // Screen pixels (origin bottom-left) to NDC, column-major like the other cbuffers
+    const float sx = 2.f / screenW;
+    const float sy = 2.f / screenH;
+    for (int i = 0; i < 16; ++i) m[i] = 0.f;
+    m[0] = t[0] * sx;
+    m[1] = t[1] * sy;
+    m[4] = t[2] * sx;
+    m[5] = t[3] * sy;
+    m[10] = 1.f;
+    m[12] = t[4] * sx - 1.f;
+    m[13] = t[5] * sy - 1.f;
+    m[15] = 1.f;
+}
+
+PipelineDesc MakeInstancedSpritePipelineDesc()
+{
+    PipelineDesc desc = MakeSpritePipelineDesc();
+    desc.shaderPath = "assets/shaders/sprite_instanced_dx11.hlsl";
+    desc.layout =
+    {
+        { "POSITION",  0, VertexFormat::Float2,    0, 0 },
+        { "TRANSFORM", 0, VertexFormat::Float2,    1, 0,  1 },
+        { "TRANSFORM", 1, VertexFormat::Float2,    1, 8,  1 },
+        { "TRANSFORM", 2, VertexFormat::Float2,    1, 16, 1 },
+        { "TEXCOORD",  0, VertexFormat::UNorm16x4, 1, (uint32_t)offsetof(SpriteInstance, uvRect), 1 },
+        { "COLOR",     0, VertexFormat::UNorm8x4,  1, (uint32_t)offsetof(SpriteInstance, color), 1 },
+    };
+    return desc;
+}
+
+void ExpandSpriteQuad(const SpriteDrawItem& item, SpriteVertex* out) noexcept
+{
+    const float* t = item.transform;
+    const float u0 = item.uvRect[0], v0 = item.uvRect[1];
+    const float u1 = item.uvRect[2], v1 = item.uvRect[3];
+
+    out[0] = { t[4],               t[5],               u0, v1, item.color };
+    out[1] = { t[0] + t[4],        t[1] + t[5],        u1, v1, item.color };
+    out[2] = { t[0] + t[2] + t[4], t[1] + t[3] + t[5], u1, v0, item.color };
+    out[3] = { t[2] + t[4],        t[3] + t[5],        u0, v0, item.color };
+
+    if (item.flags & SpriteDrawItem::UVRotated)
+    {
+        // The frame's top-left sits at the rect's top-right, turning clockwise
+        out[0].u = u0; out[0].v = v0;
+        out[1].u = u0; out[1].v = v1;
+        out[2].u = u1; out[2].v = v1;
+        out[3].u = u1; out[3].v = v0;
+    }
+}
+
+void PackSpriteInstance(const SpriteDrawItem& item, SpriteInstance& out) noexcept
+{
+    const float* t = item.transform;
+    if (item.flags & SpriteDrawItem::UVRotated)
+    {
+        // Corner (x, y) samples the upright rect at (y, 1 - x): swap the axes
+        // and move the origin to where the unit quad's x axis ends
+        out.transform[0] = t[2];
+        out.transform[1] = t[3];
+        out.transform[2] = -t[0];
+        out.transform[3] = -t[1];
+        out.transform[4] = t[4] + t[0];
+        out.transform[5] = t[5] + t[1];
+    }
+    else
+    {
+        for (int i = 0; i < 6; ++i) out.transform[i] = t[i];
+    }
+    for (int i = 0; i < 4; ++i) out.uvRect[i] = PackUNorm16(item.uvRect[i]);
+    out.color = item.color;
+}
+
+SpriteBatch::~SpriteBatch()
+{
+    Shutdown();
+}
+
+void SpriteBatch::Init(IRenderDevice& device_, TransientAllocator& transient_)
+{
+    Shutdown();
+    device = &device_;
+    transient = &transient_;
+
+    pipeline = device->CreatePipeline(MakeSpritePipelineDesc());
+    instancedPipeline = device->CreatePipeline(MakeInstancedSpritePipelineDesc());
+    cornerBuffer = device->CreateBuffer({ BufferType::Vertex, ResourceUsage::Immutable, sizeof(UnitQuad) }, UnitQuad);
+    Reserve(MinCapacity);
+}
+
+void SpriteBatch::Shutdown()
+{
+    if (!device) return;
+
+    device->Destroy(pipeline);
+    device->Destroy(instancedPipeline);
+    device->Destroy(cornerBuffer);
+    device->Destroy(indexBuffer);
+
+    pipeline = {};
+    instancedPipeline = {};
+    cornerBuffer = {};
+    indexBuffer = {};
+    capacity = 0;
+    device = nullptr;
+    transient = nullptr;
+
+    items.clear();
+    queue.Clear();
+}
+
+void SpriteBatch::Begin(float screenWidth_, float screenHeight_)
+{
+    screenWidth = screenWidth_;
+    screenHeight = screenHeight_;
+    instancing = instancingRequested;
+    frameStats = {};
+    items.clear();
+    queue.Clear();
+}
+
+void SpriteBatch::Draw(const SpriteDrawItem& item, uint32_t layer, uint32_t depth)
+{
+    if (!item.texture) return;
+    const PipelineHandle active = instancing ? instancedPipeline : pipeline;
+    queue.Push(RenderKey::Make(layer, true, active.id, item.texture.id, depth), (uint32_t)items.size(),
+        RenderKey::MakeState(active.id, item.texture.id));
+    items.push_back(item);
+}
+
+void SpriteBatch::Submit(const SpriteDrawList& list)
+{
+    const PipelineHandle active = instancing ? instancedPipeline : pipeline;
+    const uint32_t base = (uint32_t)items.size();
+    for (uint32_t i = 0; i < (uint32_t)list.items.size(); ++i)
+    {
+        const SpriteDrawList::Order& o = list.order[i];
+        queue.Push(RenderKey::Make(o.layer, true, active.id, list.items[i].texture.id, o.depth), base + i,
+            RenderKey::MakeState(active.id, list.items[i].texture.id));
+    }
+    items.insert(items.end(), list.items.begin(), list.items.end());
+}
+
+void SpriteBatch::Flush()
+{
+    if (!device || items.empty()) return;
+
+    const uint32_t count = (uint32_t)items.size();
+    Reserve(count);
+
+    queue.Sort();
+    const std::vector<RenderQueue::Entry>& order = queue.GetEntries();
+
+    static constexpr float Identity[6] = { 1, 0, 0, 1, 0, 0 };
+    float projection[16];
+    MakeSpriteProjection(Identity, screenWidth, screenHeight, projection);
+    const TransientAllocation cbRange = transient->UploadConstants(projection, sizeof(projection));
+    const bool uploaded = instancing ? UploadInstances(order) : UploadVertices(order);
+    if (!cbRange || !uploaded)
+    {
+        items.clear();
+        queue.Clear();
+        return;
+    }
+    device->SetConstantBuffer(0, cbRange.buffer, cbRange.offset, cbRange.size);
+    device->SetIndexBuffer(indexBuffer, IndexFormat::UInt32);
+
+    // One draw per run of consecutive sprites sharing a texture, in sorted order
+    TextureHandle bound;
+    uint32_t runStart = 0;
+    for (uint32_t i = 1; i <= count; ++i)
+    {
+        const TextureHandle texture = items[order[runStart].index].texture;
+        if (i == count || items[order[i].index].texture != texture)
+        {
+            if (texture != bound)
+            {
+                device->SetTexture(0, texture);
+                bound = texture;
+            }
+            if (instancing) device->DrawIndexedInstanced(6, i - runStart, 0, 0, runStart);
+            else device->DrawIndexed((i - runStart) * 6, runStart * 6, 0);
+            ++frameStats.drawCalls;
+            runStart = i;
+        }
+    }
+
+    frameStats.sprites += count;
+    frameStats.stateChangesSaved += queue.GetStats().Saved();
+    items.clear();
+    queue.Clear();
+}
+
+bool SpriteBatch::UploadVertices(const std::vector<RenderQueue::Entry>& order)
+{
+    vertices.resize(order.size() * 4);
+    ForEachRange(workerPool, (uint32_t)order.size(), [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; ++i) ExpandSpriteQuad(items[order[i].index], &vertices[(size_t)i * 4]);
+    });
+    const TransientAllocation stream = transient->UploadVertices(vertices.data(),
+        (uint32_t)(vertices.size() * sizeof(SpriteVertex)));
+    if (!stream) return false;
+
+    device->SetPipeline(pipeline);
+    device->SetVertexBuffer(0, stream.buffer, sizeof(SpriteVertex), stream.offset);
+    return true;
+}
+
+bool SpriteBatch::UploadInstances(const std::vector<RenderQueue::Entry>& order)
+{
+    instances.resize(order.size());
+    ForEachRange(workerPool, (uint32_t)order.size(), [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; ++i) PackSpriteInstance(items[order[i].index], instances[i]);
+    });
+    const TransientAllocation stream = transient->UploadVertices(instances.data(),
+        (uint32_t)(instances.size() * sizeof(SpriteInstance)));
+    if (!stream) return false;
+
+    device->SetPipeline(instancedPipeline);
+    device->SetVertexBuffer(0, cornerBuffer, sizeof(float) * 2, 0);
+    device->SetVertexBuffer(1, stream.buffer, sizeof(SpriteInstance), stream.offset);
+    return true;
+}
+
+void SpriteBatch::Reserve(uint32_t spriteCount)
+{
+    if (spriteCount <= capacity) return;
+
+    uint32_t newCapacity = std::max(capacity, MinCapacity);
+    while (newCapacity < spriteCount) newCapacity *= 2;
+
+    std::vector<uint32_t> indices((size_t)newCapacity * 6);
+    for (uint32_t i = 0; i < newCapacity; ++i)
+    {
+        const uint32_t v = i * 4;
+        uint32_t* q = &indices[(size_t)i * 6];
+        q[0] = v; q[1] = v + 1; q[2] = v + 2;
+        q[3] = v; q[4] = v + 2; q[5] = v + 3;
+    }
+
+    device->Destroy(indexBuffer);
+    indexBuffer = device->CreateBuffer({ BufferType::Index, ResourceUsage::Immutable,
+        (uint32_t)(indices.size() * sizeof(uint32_t)) }, indices.data());
+    capacity = newCapacity;
+}
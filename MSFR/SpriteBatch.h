@@ -0,0 +1,193 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "RenderQueue.h"
+#include "TransientAllocator.h"
+
+class WorkerPool;
+
+// One sprite quad, already resolved to screen space.
+// transform maps the unit quad (0..1) to screen pixels, column-major 2x3:
+//   x' = t[0] * x + t[2] * y + t[4]
+//   y' = t[1] * x + t[3] * y + t[5]
+struct SpriteDrawItem
+{
+    // uvRect holds a frame stored 90 degrees clockwise (atlas rotation)
+    static constexpr uint32_t UVRotated = 1;
+
+    float transform[6] = { 1, 0, 0, 1, 0, 0 };
+    float uvRect[4] = { 0, 0, 1, 1 };   // u0, v0 (top-left), u1, v1 (bottom-right)
+    uint32_t color = 0xFFFFFFFF;        // RGBA8, R in the low byte
+    uint32_t flags = 0;
+    TextureHandle texture;
+};
+
+struct SpriteVertex
+{
+    float x, y;
+    float u, v;
+    uint32_t color;
+};
+
+// Per-instance record of the instanced path; the unit quad corners come from a
+// shared 4-vertex buffer. Layout must match sprite_instanced_dx11.hlsl.
+struct SpriteInstance
+{
+    float transform[6];     // same layout as SpriteDrawItem::transform
+    uint16_t uvRect[4];     // u0, v0, u1, v1 as UNorm16, never rotated
+    uint32_t color;
+};
+
+static_assert(sizeof(SpriteInstance) == 36, "SpriteInstance must stay 36 bytes");
+static_assert(offsetof(SpriteInstance, uvRect) == 24, "SpriteInstance layout mismatch");
+static_assert(offsetof(SpriteInstance, color) == 32, "SpriteInstance layout mismatch");
+
+constexpr uint32_t PackColor(float r, float g, float b, float a) noexcept
+{
+    auto to8 = [](float c) { return (uint32_t)((c < 0.f ? 0.f : (c > 1.f ? 1.f : c)) * 255.f + 0.5f); };
+    return to8(r) | (to8(g) << 8) | (to8(b) << 16) | (to8(a) << 24);
+}
+
+constexpr uint16_t PackUNorm16(float c) noexcept
+{
+    return (uint16_t)((c < 0.f ? 0.f : (c > 1.f ? 1.f : c)) * 65535.f + 0.5f);
+}
+
+static_assert(PackUNorm16(0.f) == 0 && PackUNorm16(1.f) == 65535 && PackUNorm16(0.5f) == 32768, "PackUNorm16");
+static_assert(PackUNorm16(-1.f) == 0 && PackUNorm16(2.f) == 65535, "PackUNorm16 must clamp");
+static_assert(PackColor(1.f, 0.f, 0.f, 1.f) == 0xFF0000FF, "PackColor puts R in the low byte");
+
+// Writes the 4 corners of an item (bottom-left, bottom-right, top-right, top-left).
+void ExpandSpriteQuad(const SpriteDrawItem& item, SpriteVertex* out) noexcept;
+
+// Packs an item into an instance record. A rotated frame is folded into the
+// transform so the shader only ever sees an upright UV rect.
+void PackSpriteInstance(const SpriteDrawItem& item, SpriteInstance& out) noexcept;
+
+// World to NDC for the sprite shaders' projection cbuffer (column-major 4x4):
+// worldToScreen (SpriteDrawItem's 2x3 layout) followed by the screen pixels
+// to NDC mapping. Identity worldToScreen gives the screen-space projection.
+void MakeSpriteProjection(const float worldToScreen[6], float screenWidth, float screenHeight, float out[16]) noexcept;
+
+// Pipeline for SpriteInstance streams: slot 0 holds the unit quad corners
+// (2 floats each), slot 1 the instances.
+PipelineDesc MakeInstancedSpritePipelineDesc();
+
+// Sprite draws recorded away from the batch, e.g. one list per worker thread.
+// Touches nothing shared, so lists can be filled concurrently; hand them to
+// SpriteBatch::Submit in a fixed order and the frame comes out exactly as if
+// the same draws had gone to SpriteBatch::Draw one by one. Clear keeps the
+// capacity, so a list reused every frame stops allocating.
+class SpriteDrawList
+{
+public:
+    void Clear()
+    {
+        items.clear();
+        order.clear();
+        errors.clear();
+    }
+
+    void Draw(const SpriteDrawItem& item, uint32_t layer = 0, uint32_t depth = 0)
+    {
+        if (!item.texture) return;
+        items.push_back(item);
+        order.push_back({ layer, depth });
+    }
+
+    // Problems met while recording; the logger isn't thread-safe, so the
+    // thread that submits the list reports them
+    void AddError(std::string message) { errors.push_back(std::move(message)); }
+    const std::vector<std::string>& GetErrors() const { return errors; }
+
+    size_t Size() const { return items.size(); }
+    bool Empty() const { return items.empty(); }
+
+private:
+    friend class SpriteBatch;
+
+    struct Order
+    {
+        uint32_t layer;
+        uint32_t depth;
+    };
+
+    std::vector<SpriteDrawItem> items;
+    std::vector<Order> order;
+    std::vector<std::string> errors;
+};
+
+// Collects sprite draws for a frame and submits them as one stream.
+// Draws are sorted by RenderKey at flush, then issued as one draw per run of
+// sprites sharing a texture: instanced by default (36 bytes per sprite), or
+// expanded to 4 vertices per sprite (80 bytes) with instancing off. Sprite
+// data and the projection go through the transient upload rings.
+class SpriteBatch
+{
+public:
+    struct FlushStats
+    {
+        uint32_t sprites = 0;
+        uint32_t drawCalls = 0;
+        int32_t stateChangesSaved = 0;    // texture/shader binds avoided by sorting; negative if it added some
+    };
+
+    SpriteBatch() = default;
+    ~SpriteBatch();
+
+    SpriteBatch(const SpriteBatch&) = delete;
+    SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+    void Init(IRenderDevice& device, TransientAllocator& transient);
+    void Shutdown();
+
+    void Begin(float screenWidth, float screenHeight);
+    // Lower layers draw first; within a layer, lower depth draws first and
+    // sprites of equal depth draw in the order they were submitted.
+    void Draw(const SpriteDrawItem& item, uint32_t layer = 0, uint32_t depth = 0);
+    // Appends a recorded list as if each of its draws were made here, in order.
+    void Submit(const SpriteDrawList& list);
+    void Flush();
+
+    // Optional: large flushes pack their sprite stream on the pool's threads.
+    void SetWorkerPool(WorkerPool* pool) { workerPool = pool; }
+
+    // Takes effect for draws recorded after the next Begin.
+    void SetInstancing(bool enable) { instancingRequested = enable; }
+    bool IsInstancing() const { return instancing; }
+
+    bool IsInitialized() const { return device != nullptr; }
+    const FlushStats& GetFrameStats() const { return frameStats; }
+
+private:
+    void Reserve(uint32_t spriteCount);
+    bool UploadVertices(const std::vector<RenderQueue::Entry>& order);
+    bool UploadInstances(const std::vector<RenderQueue::Entry>& order);
+
+    IRenderDevice* device = nullptr;
+    TransientAllocator* transient = nullptr;
+    WorkerPool* workerPool = nullptr;
+
+    PipelineHandle pipeline;
+    PipelineHandle instancedPipeline;
+    BufferHandle cornerBuffer;
+    BufferHandle indexBuffer;
+    uint32_t capacity = 0;   // sprites covered by indexBuffer
+
+    bool instancing = true;
+    bool instancingRequested = true;
+
+    float screenWidth = 1280.f;
+    float screenHeight = 720.f;
+
+    std::vector<SpriteDrawItem> items;
+    RenderQueue queue;
+    std::vector<SpriteVertex> vertices;
+    std::vector<SpriteInstance> instances;
+    FlushStats frameStats;
+};
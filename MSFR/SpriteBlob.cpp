@@ -0,0 +1,188 @@
+#include "SpriteBlob.h"
+
+#include <cstring>
+
+namespace
+{
+    bool Fail(std::string* error, const std::string& message)
+    {
+        if (error) *error = message;
+        return false;
+    }
+
+    template <typename T>
+    uint32_t Append(std::vector<uint8_t>& out, const T* items, size_t count)
+    {
+        const uint32_t offset = static_cast<uint32_t>(out.size());
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(items);
+        out.insert(out.end(), bytes, bytes + count * sizeof(T));
+        return offset;
+    }
+
+    void Align4(std::vector<uint8_t>& out)
+    {
+        out.resize((out.size() + 3) & ~size_t(3), 0);
+    }
+
+    // Header and section bounds shared by both files
+    template <typename Header>
+    bool OpenHeader(const uint8_t* data, size_t size, const char (&magic)[4], const Header*& header, std::string* error)
+    {
+        if (reinterpret_cast<uintptr_t>(data) % 4 != 0) return Fail(error, "misaligned data");
+        if (size < sizeof(Header) || std::memcmp(data, magic, 4) != 0) return Fail(error, "not a cooked file");
+        header = reinterpret_cast<const Header*>(data);
+        if (header->version != SpriteBlobFormat::Version) return Fail(error, "unsupported version " + std::to_string(header->version));
+        if (header->size < sizeof(Header) || header->size > size) return Fail(error, "truncated file");
+        return true;
+    }
+
+    bool InBounds(uint32_t offset, uint64_t count, size_t itemSize, uint32_t size)
+    {
+        return offset % 4 == 0 && offset <= size && count * itemSize <= size - offset;
+    }
+}
+
+std::vector<uint8_t> WriteSpriteBlob(const SpriteInfo& info, const std::vector<std::vector<AnimationCommandInfo>>& animations)
+{
+    SpriteBlobHeader header{};
+    std::memcpy(header.magic, SpriteBlobFormat::SpriteMagic, 4);
+    header.version = SpriteBlobFormat::Version;
+    header.frameWidth = info.frameWidth;
+    header.frameHeight = info.frameHeight;
+
+    std::vector<SpriteBlobFrame> frames;
+    for (const SpriteFrameInfo& frame : info.frames)
+    {
+        frames.push_back({ static_cast<float>(frame.x), static_cast<float>(frame.y), frame.rotated ? 1u : 0u });
+    }
+    std::vector<SpriteBlobHotSpot> hotSpots;
+    for (const SpriteFrameInfo& hotSpot : info.hotSpots)
+    {
+        hotSpots.push_back({ static_cast<float>(hotSpot.x), static_cast<float>(hotSpot.y) });
+    }
+    std::vector<SpriteBlobCollision> collisions;
+    for (const SpriteCollisionInfo& collision : info.collisions)
+    {
+        SpriteBlobCollision out{};
+        out.type = static_cast<uint32_t>(collision.type);
+        for (int i = 0; i < 4; ++i) out.values[i] = static_cast<float>(collision.values[i]);
+        collisions.push_back(out);
+    }
+    std::vector<SpriteBlobAnimation> ranges;
+    std::vector<AnimationCommandInfo> commands;
+    for (const std::vector<AnimationCommandInfo>& animation : animations)
+    {
+        ranges.push_back({ static_cast<uint32_t>(commands.size()), static_cast<uint32_t>(animation.size()) });
+        commands.insert(commands.end(), animation.begin(), animation.end());
+    }
+
+    std::vector<uint8_t> out(sizeof(header));
+    header.frameCount = static_cast<uint32_t>(frames.size());
+    header.framesOffset = Append(out, frames.data(), frames.size());
+    header.hotSpotCount = static_cast<uint32_t>(hotSpots.size());
+    header.hotSpotsOffset = Append(out, hotSpots.data(), hotSpots.size());
+    header.collisionCount = static_cast<uint32_t>(collisions.size());
+    header.collisionsOffset = Append(out, collisions.data(), collisions.size());
+    header.animationCount = static_cast<uint32_t>(ranges.size());
+    header.animationsOffset = Append(out, ranges.data(), ranges.size());
+    header.commandCount = static_cast<uint32_t>(commands.size());
+    header.commandsOffset = Append(out, commands.data(), commands.size());
+    header.textureLength = static_cast<uint32_t>(info.texture.size());
+    header.textureOffset = Append(out, info.texture.data(), info.texture.size());
+    Align4(out);
+    header.size = static_cast<uint32_t>(out.size());
+    std::memcpy(out.data(), &header, sizeof(header));
+    return out;
+}
+
+std::vector<uint8_t> WriteAnimationBlob(const std::vector<AnimationCommandInfo>& commands)
+{
+    AnimationBlobHeader header{};
+    std::memcpy(header.magic, SpriteBlobFormat::AnimationMagic, 4);
+    header.version = SpriteBlobFormat::Version;
+
+    std::vector<uint8_t> out(sizeof(header));
+    header.commandCount = static_cast<uint32_t>(commands.size());
+    header.commandsOffset = Append(out, commands.data(), commands.size());
+    header.size = static_cast<uint32_t>(out.size());
+    std::memcpy(out.data(), &header, sizeof(header));
+    return out;
+}
+
+bool SpriteBlob::Open(const uint8_t* data_, size_t size, std::string* error)
+{
+    data = nullptr;
+    header = nullptr;
+    const SpriteBlobHeader* h = nullptr;
+    if (!OpenHeader(data_, size, SpriteBlobFormat::SpriteMagic, h, error)) return false;
+
+    if (!InBounds(h->framesOffset, h->frameCount, sizeof(SpriteBlobFrame), h->size)
+        || !InBounds(h->hotSpotsOffset, h->hotSpotCount, sizeof(SpriteBlobHotSpot), h->size)
+        || !InBounds(h->collisionsOffset, h->collisionCount, sizeof(SpriteBlobCollision), h->size)
+        || !InBounds(h->animationsOffset, h->animationCount, sizeof(SpriteBlobAnimation), h->size)
+        || !InBounds(h->commandsOffset, h->commandCount, sizeof(AnimationCommandInfo), h->size)
+        || h->textureOffset > h->size || h->textureLength > h->size - h->textureOffset)
+    {
+        return Fail(error, "section out of range");
+    }
+
+    const SpriteBlobCollision* collisions = reinterpret_cast<const SpriteBlobCollision*>(data_ + h->collisionsOffset);
+    for (uint32_t i = 0; i < h->collisionCount; ++i)
+    {
+        if (collisions[i].type > static_cast<uint32_t>(SpriteCollisionInfo::Type::Circle)) return Fail(error, "unknown collision type");
+    }
+
+    const SpriteBlobAnimation* animations = reinterpret_cast<const SpriteBlobAnimation*>(data_ + h->animationsOffset);
+    const AnimationCommandInfo* commands = reinterpret_cast<const AnimationCommandInfo*>(data_ + h->commandsOffset);
+    for (uint32_t i = 0; i < h->animationCount; ++i)
+    {
+        const SpriteBlobAnimation& animation = animations[i];
+        std::string reason;
+        if (animation.firstCommand > h->commandCount || animation.commandCount > h->commandCount - animation.firstCommand)
+            return Fail(error, "animation out of range");
+        if (!ValidateAnimation(commands + animation.firstCommand, animation.commandCount, reason))
+            return Fail(error, "animation " + std::to_string(i) + ": " + reason);
+    }
+
+    data = data_;
+    header = h;
+    return true;
+}
+
+std::string_view SpriteBlob::GetTexture() const
+{
+    return std::string_view(reinterpret_cast<const char*>(data + header->textureOffset), header->textureLength);
+}
+
+const AnimationCommandInfo* SpriteBlob::GetCommands(uint32_t animation) const
+{
+    const SpriteBlobAnimation& range = Section<SpriteBlobAnimation>(header->animationsOffset)[animation];
+    return Section<AnimationCommandInfo>(header->commandsOffset) + range.firstCommand;
+}
+
+uint32_t SpriteBlob::GetCommandCount(uint32_t animation) const
+{
+    return Section<SpriteBlobAnimation>(header->animationsOffset)[animation].commandCount;
+}
+
+bool AnimationBlob::Open(const uint8_t* data_, size_t size, std::string* error)
+{
+    data = nullptr;
+    header = nullptr;
+    const AnimationBlobHeader* h = nullptr;
+    if (!OpenHeader(data_, size, SpriteBlobFormat::AnimationMagic, h, error)) return false;
+    if (!InBounds(h->commandsOffset, h->commandCount, sizeof(AnimationCommandInfo), h->size)) return Fail(error, "section out of range");
+
+    std::string reason;
+    if (!ValidateAnimation(reinterpret_cast<const AnimationCommandInfo*>(data_ + h->commandsOffset), h->commandCount, reason))
+        return Fail(error, reason);
+
+    data = data_;
+    header = h;
+    return true;
+}
+
+const AnimationCommandInfo* AnimationBlob::GetCommands() const
+{
+    return reinterpret_cast<const AnimationCommandInfo*>(data + header->commandsOffset);
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AnimationFormat.h"
+#include "SpriteFormat.h"
+
+// Cooked sprites (.sptc) and animations (.anmc), written next to their .spt
+// and .anm sources by Tools/SpriteCooker.cpp. A cooked file is the runtime
+// data laid out flat, so loading it is one read (or a view into a mapped
+// pack) plus bounds checks: no text, no tokens, no per-field conversions.
+// Sections follow the header in this order, each 4-byte aligned and found
+// through the header's offsets:
+//   .sptc  SpriteBlobHeader, frames, hot spots, collisions, animations
+//          (command ranges), commands, texture path
+//   .anmc  AnimationBlobHeader, commands
+// Cooked sprites carry their animations' commands, so the .anm files aren't
+// read at all; re-cook a sprite after editing its animations. Files hold
+// native little-endian structs and the bytes must be 4-byte aligned, which
+// file buffers and pack entries are (packs never align entries to less
+// than PackFormat::MinAlignment).
+namespace SpriteBlobFormat
+{
+    constexpr char SpriteMagic[4] = { 'S', 'P', 'T', 'B' };
+    constexpr char AnimationMagic[4] = { 'A', 'N', 'M', 'B' };
+    constexpr uint32_t Version = 1;
+}
+
+struct SpriteBlobHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t size;              // whole file
+    int32_t frameWidth;
+    int32_t frameHeight;
+    uint32_t frameCount;
+    uint32_t hotSpotCount;
+    uint32_t collisionCount;
+    uint32_t animationCount;
+    uint32_t commandCount;
+    uint32_t framesOffset;
+    uint32_t hotSpotsOffset;
+    uint32_t collisionsOffset;
+    uint32_t animationsOffset;
+    uint32_t commandsOffset;
+    uint32_t textureOffset;
+    uint32_t textureLength;
+};
+
+// Texel position of the top-left corner, as SpriteDefinition keeps it
+struct SpriteBlobFrame
+{
+    float x;
+    float y;
+    uint32_t rotated;
+};
+
+struct SpriteBlobHotSpot
+{
+    float x;
+    float y;
+};
+
+struct SpriteBlobCollision
+{
+    uint32_t type;              // SpriteCollisionInfo::Type
+    float values[4];            // rect: left bottom right top, circle: radius
+};
+
+struct SpriteBlobAnimation
+{
+    uint32_t firstCommand;
+    uint32_t commandCount;
+};
+
+struct AnimationBlobHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t size;
+    uint32_t commandCount;
+    uint32_t commandsOffset;
+};
+
+static_assert(sizeof(SpriteBlobHeader) == 68 && sizeof(SpriteBlobFrame) == 12 && sizeof(SpriteBlobHotSpot) == 8 &&
+    sizeof(SpriteBlobCollision) == 20 && sizeof(SpriteBlobAnimation) == 8 && sizeof(AnimationBlobHeader) == 20,
+    "cooked sprite structs are on-disk layouts");
+
+// animations[i] holds the commands of info.animations[i].
+std::vector<uint8_t> WriteSpriteBlob(const SpriteInfo& info, const std::vector<std::vector<AnimationCommandInfo>>& animations);
+std::vector<uint8_t> WriteAnimationBlob(const std::vector<AnimationCommandInfo>& commands);
+
+// A cooked sprite in memory. Open checks the header, the section bounds and
+// every animation (ValidateAnimation), so the accessors trust them; the
+// bytes must outlive the view.
+class SpriteBlob
+{
+public:
+    bool Open(const uint8_t* data, size_t size, std::string* error = nullptr);
+
+    std::string_view GetTexture() const;
+    int GetFrameWidth() const { return header->frameWidth; }
+    int GetFrameHeight() const { return header->frameHeight; }
+    uint32_t GetFrameCount() const { return header->frameCount; }
+    const SpriteBlobFrame* GetFrames() const { return Section<SpriteBlobFrame>(header->framesOffset); }
+    uint32_t GetHotSpotCount() const { return header->hotSpotCount; }
+    const SpriteBlobHotSpot* GetHotSpots() const { return Section<SpriteBlobHotSpot>(header->hotSpotsOffset); }
+    uint32_t GetCollisionCount() const { return header->collisionCount; }
+    const SpriteBlobCollision* GetCollisions() const { return Section<SpriteBlobCollision>(header->collisionsOffset); }
+    uint32_t GetAnimationCount() const { return header->animationCount; }
+    const AnimationCommandInfo* GetCommands(uint32_t animation) const;
+    uint32_t GetCommandCount(uint32_t animation) const;
+
+private:
+    template <typename T>
+    const T* Section(uint32_t offset) const { return reinterpret_cast<const T*>(data + offset); }
+
+    const uint8_t* data = nullptr;
+    const SpriteBlobHeader* header = nullptr;
+};
+
+class AnimationBlob
+{
+public:
+    bool Open(const uint8_t* data, size_t size, std::string* error = nullptr);
+
+    const AnimationCommandInfo* GetCommands() const;
+    uint32_t GetCommandCount() const { return header->commandCount; }
+
+private:
+    const uint8_t* data = nullptr;
+    const AnimationBlobHeader* header = nullptr;
+};
@@ -0,0 +1,232 @@
+#include "SpriteDefinition.h"
+
+#include <stdexcept>
+
+#include "AssetPack.h"
+#include "Engine.h"
+#include "SpriteBlob.h"
+#include "TextureDX11.h"
+
+namespace
+{
+    // For sprites that name no animation
+    const std::filesystem::path DefaultAnimation = "./assets/images/characters/none_front.anm";
+
+    // Loads fileName's cooked .anmc instead when it's up to date
+    void LoadAnimation(const std::filesystem::path& fileName, std::vector<AnimationCommandInfo>& commands)
+    {
+        if (fileName.extension() != ".anm")
+        {
+            throw std::runtime_error("Bad Filetype.  " + fileName.generic_string() + " not a sprite info file (.anm)");
+        }
+        const std::filesystem::path cookedFile = Engine::GetAssets().ResolveCooked(fileName, ".anmc");
+        AssetBytes bytes;
+        if (Engine::GetAssets().Read(cookedFile, bytes) == false)
+        {
+            throw std::runtime_error("Failed to load " + cookedFile.generic_string());
+        }
+
+        std::string error;
+        if (cookedFile != fileName)
+        {
+            AnimationBlob blob;
+            if (blob.Open(bytes.data, bytes.size, &error) == false)
+            {
+                throw std::runtime_error("Failed to load " + cookedFile.generic_string() + ": " + error);
+            }
+            commands.assign(blob.GetCommands(), blob.GetCommands() + blob.GetCommandCount());
+            return;
+        }
+
+        AssetStream inFile(bytes);
+        std::vector<std::string> errors;
+        const bool parsed = ParseAnimationInfo(inFile, commands, errors);
+        for (const std::string& message : errors)
+        {
+            Engine::GetLogger().LogError(message + " in anm file " + fileName.generic_string());
+        }
+        if (parsed == false || ValidateAnimation(commands.data(), commands.size(), error) == false)
+        {
+            throw std::runtime_error("Failed to load " + fileName.generic_string() + (error.empty() ? "" : ": " + error));
+        }
+    }
+}
+
+SpriteDefinition::SpriteDefinition(const std::filesystem::path& spriteInfoFile)
+{
+    if (spriteInfoFile.extension() != ".spt")
+    {
+        throw std::runtime_error("Bad Filetype.  " + spriteInfoFile.generic_string() + " not a sprite info file (.spt)");
+    }
+
+    try
+    {
+        // A cooked .sptc is one read and no parsing, and carries its animations
+        const std::filesystem::path cookedFile = Engine::GetAssets().ResolveCooked(spriteInfoFile, ".sptc");
+        AssetBytes bytes;
+        if (Engine::GetAssets().Read(cookedFile, bytes) == false)
+        {
+            throw std::runtime_error("Failed to load " + cookedFile.generic_string());
+        }
+        if (cookedFile != spriteInfoFile)
+        {
+            LoadCooked(cookedFile, bytes);
+        }
+        else
+        {
+            LoadText(spriteInfoFile, bytes);
+        }
+
+        if (frames.empty())
+        {
+            frames.push_back({ { 0, 0 }, false });
+        }
+        if (animations.empty())
+        {
+            std::vector<AnimationCommandInfo> animation;
+            LoadAnimation(DefaultAnimation, animation);
+            AddAnimation(animation.data(), animation.size());
+        }
+    }
+    catch (...)
+    {
+        // The destructor doesn't run for a constructor that throws
+        Engine::GetTextureManager().Release(texture);
+        throw;
+    }
+}
+
+SpriteDefinition::~SpriteDefinition()
+{
+    Engine::GetTextureManager().Release(texture);
+}
+
+void SpriteDefinition::LoadText(const std::filesystem::path& spriteInfoFile, const AssetBytes& bytes)
+{
+    AssetStream inFile(bytes);
+    SpriteInfo info;
+    std::vector<std::string> errors;
+    ParseSpriteInfo(inFile, info, [this](const std::string& texturePath, int& width, int& height)
+    {
+        texture = Engine::GetTextureManager().LoadAsync(texturePath, true);
+        width = static_cast<int>(texture->GetSize().x);
+        height = static_cast<int>(texture->GetSize().y);
+    }, errors);
+    for (const std::string& error : errors)
+    {
+        Engine::GetLogger().LogError(error);
+    }
+    if (texture == nullptr)
+    {
+        throw std::runtime_error("Failed to load " + spriteInfoFile.generic_string());
+    }
+
+    frameSize = { static_cast<float>(info.frameWidth), static_cast<float>(info.frameHeight) };
+    frames.reserve(info.frames.size());
+    for (const SpriteFrameInfo& frame : info.frames)
+    {
+        frames.push_back({ { static_cast<float>(frame.x), static_cast<float>(frame.y) }, frame.rotated });
+    }
+    hotSpots.reserve(info.hotSpots.size());
+    for (const SpriteFrameInfo& hotSpot : info.hotSpots)
+    {
+        hotSpots.push_back({ static_cast<float>(hotSpot.x), static_cast<float>(hotSpot.y) });
+    }
+    std::vector<AnimationCommandInfo> animation;
+    for (const std::string& file : info.animations)
+    {
+        animation.clear();
+        LoadAnimation(file, animation);
+        AddAnimation(animation.data(), animation.size());
+    }
+    collisions = std::move(info.collisions);
+}
+
+void SpriteDefinition::LoadCooked(const std::filesystem::path& cookedFile, const AssetBytes& bytes)
+{
+    SpriteBlob blob;
+    std::string error;
+    if (blob.Open(bytes.data, bytes.size, &error) == false)
+    {
+        throw std::runtime_error("Failed to load " + cookedFile.generic_string() + ": " + error);
+    }
+
+    texture = Engine::GetTextureManager().LoadAsync(blob.GetTexture(), true);
+    frameSize = { static_cast<float>(blob.GetFrameWidth()), static_cast<float>(blob.GetFrameHeight()) };
+
+    const SpriteBlobFrame* blobFrames = blob.GetFrames();
+    frames.reserve(blob.GetFrameCount());
+    for (uint32_t i = 0; i < blob.GetFrameCount(); ++i)
+    {
+        frames.push_back({ { blobFrames[i].x, blobFrames[i].y }, blobFrames[i].rotated != 0 });
+    }
+    const SpriteBlobHotSpot* blobHotSpots = blob.GetHotSpots();
+    hotSpots.reserve(blob.GetHotSpotCount());
+    for (uint32_t i = 0; i < blob.GetHotSpotCount(); ++i)
+    {
+        hotSpots.push_back({ blobHotSpots[i].x, blobHotSpots[i].y });
+    }
+    animations.reserve(blob.GetAnimationCount());
+    for (uint32_t i = 0; i < blob.GetAnimationCount(); ++i)
+    {
+        AddAnimation(blob.GetCommands(i), blob.GetCommandCount(i));
+    }
+    const SpriteBlobCollision* blobCollisions = blob.GetCollisions();
+    collisions.reserve(blob.GetCollisionCount());
+    for (uint32_t i = 0; i < blob.GetCollisionCount(); ++i)
+    {
+        SpriteCollisionInfo collision;
+        collision.type = static_cast<SpriteCollisionInfo::Type>(blobCollisions[i].type);
+        for (int v = 0; v < 4; ++v) collision.values[v] = blobCollisions[i].values[v];
+        collisions.push_back(collision);
+    }
+}
+
+void SpriteDefinition::AddAnimation(const AnimationCommandInfo* animationCommands, size_t count)
+{
+    animations.push_back({ static_cast<uint32_t>(commands.size()), static_cast<uint32_t>(count) });
+    commands.insert(commands.end(), animationCommands, animationCommands + count);
+}
+
+const SpriteDefinition::Frame* SpriteDefinition::GetFrame(int frame) const
+{
+    return frame >= 0 && frame < static_cast<int>(frames.size()) ? &frames[frame] : nullptr;
+}
+
+const vec2* SpriteDefinition::GetHotSpot(int index) const
+{
+    return index >= 0 && index < static_cast<int>(hotSpots.size()) ? &hotSpots[index] : nullptr;
+}
+
+std::shared_ptr<const SpriteDefinition> SpriteDefinitionCache::Load(const std::filesystem::path& spriteInfoFile)
+{
+    std::string key = GetPackPath(spriteInfoFile);
+    auto it = definitions.find(key);
+    if (it != definitions.end())
+    {
+        return it->second;
+    }
+    auto definition = std::make_shared<const SpriteDefinition>(spriteInfoFile);
+    definitions.emplace(std::move(key), definition);
+    return definition;
+}
+
+void SpriteDefinitionCache::Trim()
+{
+    for (auto it = definitions.begin(); it != definitions.end();)
+    {
+        if (it->second.use_count() == 1)
+        {
+            it = definitions.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void SpriteDefinitionCache::Clear()
+{
+    definitions.clear();
+}
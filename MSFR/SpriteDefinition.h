@@ -0,0 +1,93 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "vec2.h"
+#include "AnimationFormat.h"
+#include "SpriteFormat.h"
+
+class TextureDX11;
+struct AssetBytes;
+
+// Everything a sprite info file (.spt, or its cooked .sptc) says: texture,
+// frames, hot spots, animation commands and the collisions to give an
+// object. It never changes once loaded, so every Sprite of that file shares
+// one through SpriteDefinitionCache and keeps only its own playback state.
+class SpriteDefinition
+{
+public:
+    struct Frame
+    {
+        vec2 texel;             // top-left corner
+        bool rotated;           // stored 90 degrees clockwise in an atlas
+    };
+
+    // Loads the cooked .sptc instead when it's up to date (see
+    // Tools/SpriteCooker.cpp). A sprite without frames gets one at the
+    // texture's corner, and one without animations the default animation.
+    explicit SpriteDefinition(const std::filesystem::path& spriteInfoFile);
+    ~SpriteDefinition();
+
+    SpriteDefinition(const SpriteDefinition&) = delete;
+    SpriteDefinition& operator=(const SpriteDefinition&) = delete;
+
+    const TextureDX11* GetTexture() const { return texture; }
+    vec2 GetFrameSize() const { return frameSize; }
+
+    // Null when out of range
+    const Frame* GetFrame(int frame) const;
+    const vec2* GetHotSpot(int index) const;
+    int GetHotSpotCount() const { return static_cast<int>(hotSpots.size()); }
+
+    // animation must be below GetAnimationCount; commands pass ValidateAnimation
+    int GetAnimationCount() const { return static_cast<int>(animations.size()); }
+    const AnimationCommandInfo* GetCommands(int animation) const { return commands.data() + animations[animation].first; }
+    size_t GetCommandCount(int animation) const { return animations[animation].count; }
+
+    const std::vector<SpriteCollisionInfo>& GetCollisions() const { return collisions; }
+
+private:
+    void LoadText(const std::filesystem::path& spriteInfoFile, const AssetBytes& bytes);
+    void LoadCooked(const std::filesystem::path& cookedFile, const AssetBytes& bytes);
+    void AddAnimation(const AnimationCommandInfo* animationCommands, size_t count);
+
+    struct AnimationRange
+    {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    TextureDX11* texture = nullptr;     // one reference, given back by the destructor
+    vec2 frameSize{ 0, 0 };
+    std::vector<Frame> frames;
+    std::vector<vec2> hotSpots;
+    std::vector<SpriteCollisionInfo> collisions;
+    std::vector<AnimationRange> animations;
+    std::vector<AnimationCommandInfo> commands;     // all animations', back to back
+};
+
+// Sprite definitions by path. The first Load of a file reads and parses it;
+// the rest are a lookup, so spawning the thousandth enemy touches no files.
+// Main thread only, like TextureManager.
+class SpriteDefinitionCache
+{
+public:
+    // Throws like SpriteDefinition's constructor; a failed load isn't cached
+    std::shared_ptr<const SpriteDefinition> Load(const std::filesystem::path& spriteInfoFile);
+
+    // Forgets definitions no Sprite holds any more, which gives their
+    // textures back to TextureManager
+    void Trim();
+    // Forgets all of them; sprites still alive keep theirs. For shutdown.
+    void Clear();
+
+    size_t GetCount() const { return definitions.size(); }
+
+private:
+    std::unordered_map<std::string, std::shared_ptr<const SpriteDefinition>> definitions;     // by GetPackPath
+};
@@ -0,0 +1,66 @@
+#include "SpriteFont.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "AssetPack.h" //AssetStream
+#include "Engine.h" //GetAssets, GetLogger, GetSpriteBatch, GetTextLayoutCache
+#include "FontFormat.h" //ParseFontInfo
+#include "TextureDX11.h" //texturePtr
+
+SpriteFont::SpriteFont(const std::filesystem::path& fileName)
+{
+    if (fileName.extension() != ".fnt")
+    {
+        throw std::runtime_error("Bad Filetype.  " + fileName.generic_string() + " not a font metrics file (.fnt)");
+    }
+    AssetBytes bytes;
+    if (Engine::GetAssets().Read(fileName, bytes) == false)
+    {
+        throw std::runtime_error("Failed to load " + fileName.generic_string());
+    }
+    AssetStream inFile(bytes);
+
+    FontInfo info;
+    std::vector<std::string> errors;
+    const bool parsed = ParseFontInfo(inFile, info, errors);
+    for (const std::string& error : errors)
+    {
+        Engine::GetLogger().LogError(fileName.generic_string() + ": " + error);
+    }
+    if (parsed == false || metrics.Build(info) == false)
+    {
+        throw std::runtime_error("Failed to load " + fileName.generic_string());
+    }
+
+    // The page file is relative to the .fnt, as the font tools write it
+    texturePtr = Engine::GetTextureManager().LoadAsync(fileName.parent_path() / info.texture, true);
+}
+
+SpriteFont::~SpriteFont()
+{
+    Engine::GetTextureManager().Release(texturePtr);
+}
+
+void SpriteFont::Draw(std::string_view text, const mat3<float>& displayMatrix,
+    uint32_t color, unsigned layer, unsigned depth)
+{
+    Draw(Engine::GetTextLayoutCache().Get(metrics, text), displayMatrix, color, layer, depth);
+}
+
+void SpriteFont::Draw(const TextLayout& layout, const mat3<float>& displayMatrix,
+    uint32_t color, unsigned layer, unsigned depth)
+{
+    const float transform[6] = {
+        displayMatrix.column0.x, displayMatrix.column0.y,
+        displayMatrix.column1.x, displayMatrix.column1.y,
+        displayMatrix.column2.x, displayMatrix.column2.y };
+    layout.Draw(Engine::GetSpriteBatch(), texturePtr->GetHandle(), transform, color, layer, depth);
+}
+
+vec2 SpriteFont::MeasureText(std::string_view text)
+{
+    const TextLayout& layout = Engine::GetTextLayoutCache().Get(metrics, text);
+    return { layout.GetWidth(), layout.GetHeight() };
+}
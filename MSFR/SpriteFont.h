@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+#include "vec2.h"
+#include "mat3.h"
+#include "BitmapFont.h"
+
+class TextureDX11;
+
+// Bitmap font: glyph sheet plus BMFont text metrics (.fnt), see FontFormat.h.
+// Glyphs go through Engine's SpriteBatch, so a run of text is one draw call.
+// Immediate text is laid out through Engine's TextLayoutCache; text that
+// changes every frame (scores, timers) is better kept in its own TextLayout,
+// where only the glyphs that changed are laid out again.
+class SpriteFont
+{
+public:
+    explicit SpriteFont(const std::filesystem::path& fileName);
+    ~SpriteFont();
+
+    SpriteFont(const SpriteFont&) = delete;
+    SpriteFont& operator=(const SpriteFont&) = delete;
+
+    // displayMatrix maps layout space (origin on the first baseline) to screen
+    void Draw(std::string_view text, const mat3<float>& displayMatrix,
+        uint32_t color = 0xFFFFFFFF, unsigned layer = 0, unsigned depth = 0);
+    void Draw(const TextLayout& layout, const mat3<float>& displayMatrix,
+        uint32_t color = 0xFFFFFFFF, unsigned layer = 0, unsigned depth = 0);
+
+    // Returns how many glyphs were laid out again
+    uint32_t Layout(std::string_view text, TextLayout& layout) const { return layout.Update(metrics, text); }
+    vec2 MeasureText(std::string_view text);
+
+    const BitmapFont& GetMetrics() const { return metrics; }
+
+private:
+    BitmapFont metrics;
+    TextureDX11* texturePtr = nullptr;
+};
@@ -0,0 +1,105 @@
+#include "SpriteFormat.h"
+
+#include <istream>
+#include <ostream>
+
+bool ParseSpriteInfo(std::istream& in, SpriteInfo& info, const SpriteTextureSizeFn& textureSize,
+    std::vector<std::string>& errors)
+{
+    info = {};
+
+    if (!(in >> info.texture))
+    {
+        errors.push_back("Missing texture path");
+        return false;
+    }
+    if (textureSize)
+    {
+        textureSize(info.texture, info.frameWidth, info.frameHeight);
+    }
+
+    std::string text;
+    while (in >> text)
+    {
+        if (text == "FrameSize")
+        {
+            in >> info.frameWidth >> info.frameHeight;
+        }
+        else if (text == "NumFrames")
+        {
+            int numFrames = 0;
+            in >> numFrames;
+            for (int i = 0; i < numFrames; i++)
+            {
+                info.frames.push_back({ info.frameWidth * i, 0, false });
+            }
+        }
+        else if (text == "Frame" || text == "FrameRotated")
+        {
+            SpriteFrameInfo frame;
+            in >> frame.x >> frame.y;
+            frame.rotated = text == "FrameRotated";
+            info.frames.push_back(frame);
+        }
+        else if (text == "HotSpot")
+        {
+            SpriteFrameInfo hotSpot;
+            in >> hotSpot.x >> hotSpot.y;
+            info.hotSpots.push_back(hotSpot);
+        }
+        else if (text == "Anim")
+        {
+            in >> text;
+            info.animations.push_back(text);
+        }
+        else if (text == "CollisionRect")
+        {
+            SpriteCollisionInfo collision;
+            collision.type = SpriteCollisionInfo::Type::Rect;
+            in >> collision.values[0] >> collision.values[1] >> collision.values[2] >> collision.values[3];
+            info.collisions.push_back(collision);
+        }
+        else if (text == "CollisionCircle")
+        {
+            SpriteCollisionInfo collision;
+            collision.type = SpriteCollisionInfo::Type::Circle;
+            in >> collision.values[0];
+            info.collisions.push_back(collision);
+        }
+        else
+        {
+            errors.push_back("Unknown spt command " + text);
+        }
+    }
+    return true;
+}
+
+void WriteSpriteInfo(std::ostream& out, const SpriteInfo& info)
+{
+    out << info.texture << '\n';
+    out << "FrameSize " << info.frameWidth << ' ' << info.frameHeight << '\n';
+    for (const SpriteFrameInfo& frame : info.frames)
+    {
+        out << (frame.rotated ? "FrameRotated " : "Frame ") << frame.x << ' ' << frame.y << '\n';
+    }
+    for (const SpriteFrameInfo& hotSpot : info.hotSpots)
+    {
+        out << "HotSpot " << hotSpot.x << ' ' << hotSpot.y << '\n';
+    }
+    for (const std::string& anim : info.animations)
+    {
+        out << "Anim " << anim << '\n';
+    }
+    for (const SpriteCollisionInfo& collision : info.collisions)
+    {
+        if (collision.type == SpriteCollisionInfo::Type::Rect)
+        {
+            out << "CollisionRect " << collision.values[0] << ' ' << collision.values[1] << ' '
+                << collision.values[2] << ' ' << collision.values[3] << '\n';
+        }
+        else
+        {
+            out << "CollisionCircle " << collision.values[0] << '\n';
+        }
+    }
+}
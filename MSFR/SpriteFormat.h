@@ -0,0 +1,50 @@
+#pragma once
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// In-memory form of a sprite info (.spt) file:
+//   <texture path>
+//   FrameSize w h | NumFrames n | Frame x y | FrameRotated x y
+//   HotSpot x y | Anim file.anm | CollisionRect l b r t | CollisionCircle radius
+// Frame offsets are texel positions of the frame's top-left corner.
+// FrameRotated marks a frame stored 90 degrees clockwise in the texture
+// (occupying frameHeight x frameWidth texels), as written by the atlas packer.
+struct SpriteFrameInfo
+{
+    int x = 0;
+    int y = 0;
+    bool rotated = false;
+};
+
+struct SpriteCollisionInfo
+{
+    enum class Type { Rect, Circle };
+
+    Type type = Type::Rect;
+    double values[4] = {};   // rect: left bottom right top, circle: radius
+};
+
+struct SpriteInfo
+{
+    std::string texture;
+    int frameWidth = 0;
+    int frameHeight = 0;
+    std::vector<SpriteFrameInfo> frames;
+    std::vector<SpriteFrameInfo> hotSpots;    // rotated unused
+    std::vector<std::string> animations;
+    std::vector<SpriteCollisionInfo> collisions;
+};
+
+// Called once the texture path is known; returns the texture size, which is
+// the frame size until a FrameSize command says otherwise.
+using SpriteTextureSizeFn = std::function<void(const std::string& texture, int& width, int& height)>;
+
+// Unknown commands are reported through errors and skipped.
+bool ParseSpriteInfo(std::istream& in, SpriteInfo& info, const SpriteTextureSizeFn& textureSize,
+    std::vector<std::string>& errors);
+
+// Writes frames explicitly (no NumFrames), so the output does not depend on
+// the texture size.
+void WriteSpriteInfo(std::ostream& out, const SpriteInfo& info);
@@ -0,0 +1,332 @@
+#include "StaticSpriteBatch.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr float UnitQuad[8] = { 0, 0, 1, 0, 1, 1, 0, 1 };
+    constexpr uint16_t QuadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+
+    // Keeps chunk indices well inside int range for far-away or bogus bounds
+    constexpr float CellLimit = 1.0e8f;
+
+    int ToCell(float v, float invCellSize)
+    {
+        const float c = std::floor(v * invCellSize);
+        if (!(c > -CellLimit)) return (int)-CellLimit;
+        if (!(c < CellLimit)) return (int)CellLimit;
+        return (int)c;
+    }
+
+    Aabb BoundsOf(const SpriteDrawItem& item)
+    {
+        const float* t = item.transform;
+        const float xs[4] = { t[4], t[4] + t[0], t[4] + t[2], t[4] + t[0] + t[2] };
+        const float ys[4] = { t[5], t[5] + t[1], t[5] + t[3], t[5] + t[1] + t[3] };
+        Aabb bounds{ xs[0], ys[0], xs[0], ys[0] };
+        for (int i = 1; i < 4; ++i)
+        {
+            bounds.minX = std::min(bounds.minX, xs[i]);
+            bounds.minY = std::min(bounds.minY, ys[i]);
+            bounds.maxX = std::max(bounds.maxX, xs[i]);
+            bounds.maxY = std::max(bounds.maxY, ys[i]);
+        }
+        return bounds;
+    }
+
+    void Extend(Aabb& bounds, const Aabb& other)
+    {
+        bounds.minX = std::min(bounds.minX, other.minX);
+        bounds.minY = std::min(bounds.minY, other.minY);
+        bounds.maxX = std::max(bounds.maxX, other.maxX);
+        bounds.maxY = std::max(bounds.maxY, other.maxY);
+    }
+}
+
+StaticSpriteBatch::StaticSpriteBatch(float chunkSize_)
+    : chunkSize(chunkSize_ > 0.f ? chunkSize_ : 1024.f)
+    , invChunkSize(1.f / chunkSize)
+    , grid(chunkSize)
+{
+}
+
+StaticSpriteBatch::~StaticSpriteBatch()
+{
+    Shutdown();
+}
+
+void StaticSpriteBatch::Init(IRenderDevice& device_, TransientAllocator& transient_)
+{
+    Shutdown();
+    device = &device_;
+    transient = &transient_;
+
+    pipeline = device->CreatePipeline(MakeInstancedSpritePipelineDesc());
+    cornerBuffer = device->CreateBuffer({ BufferType::Vertex, ResourceUsage::Immutable, sizeof(UnitQuad) }, UnitQuad);
+    indexBuffer = device->CreateBuffer({ BufferType::Index, ResourceUsage::Immutable, sizeof(QuadIndices) }, QuadIndices);
+}
+
+void StaticSpriteBatch::Shutdown()
+{
+    if (!device) return;
+
+    // Items stay; every chunk is baked again on the next device
+    for (Chunk& chunk : chunks)
+    {
+        device->Destroy(chunk.instances);
+        chunk.instances = {};
+        chunk.runs.clear();
+        chunk.dirty = !chunk.members.empty();
+    }
+
+    device->Destroy(pipeline);
+    device->Destroy(cornerBuffer);
+    device->Destroy(indexBuffer);
+
+    pipeline = {};
+    cornerBuffer = {};
+    indexBuffer = {};
+    device = nullptr;
+    transient = nullptr;
+}
+
+uint32_t StaticSpriteBatch::Add(const SpriteDrawItem& item, uint32_t layer, uint32_t depth)
+{
+    if (!item.texture) return Invalid;
+
+    uint32_t handle;
+    if (!freeHandles.empty())
+    {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+    else
+    {
+        handle = (uint32_t)items.size();
+        items.emplace_back();
+    }
+
+    Item& entry = items[handle];
+    entry.sprite = item;
+    entry.bounds = BoundsOf(item);
+    entry.layer = layer;
+    entry.depth = depth;
+    entry.live = true;
+    Link(handle);
+    ++liveCount;
+    return handle;
+}
+
+void StaticSpriteBatch::Update(uint32_t handle, const SpriteDrawItem& item, uint32_t layer, uint32_t depth)
+{
+    if (handle >= items.size() || !items[handle].live) return;
+    if (!item.texture)
+    {
+        Remove(handle);
+        return;
+    }
+
+    Unlink(handle);
+    Item& entry = items[handle];
+    entry.sprite = item;
+    entry.bounds = BoundsOf(item);
+    entry.layer = layer;
+    entry.depth = depth;
+    Link(handle);
+}
+
+void StaticSpriteBatch::Remove(uint32_t handle)
+{
+    if (handle >= items.size() || !items[handle].live) return;
+
+    Unlink(handle);
+    items[handle].live = false;
+    freeHandles.push_back(handle);
+    --liveCount;
+}
+
+void StaticSpriteBatch::Clear()
+{
+    for (Chunk& chunk : chunks)
+    {
+        if (device) device->Destroy(chunk.instances);
+    }
+    items.clear();
+    freeHandles.clear();
+    liveCount = 0;
+    chunks.clear();
+    chunkIndex.clear();
+    gridChunks.clear();
+    grid.Clear();
+}
+
+void StaticSpriteBatch::Draw(const float worldToScreen[6], const Aabb& view, float screenWidth, float screenHeight)
+{
+    drawStats = {};
+    drawStats.chunks = (uint32_t)grid.Size();
+    if (!device || drawStats.chunks == 0) return;
+
+    visibleChunks.clear();
+    grid.Query(view, visibleChunks);
+    for (uint32_t& index : visibleChunks) index = gridChunks[index];
+    std::sort(visibleChunks.begin(), visibleChunks.end());
+
+    // Only chunks that are actually seen pay for a rebuild
+    for (uint32_t index : visibleChunks)
+    {
+        if (chunks[index].dirty) Rebuild(chunks[index]);
+    }
+    visibleChunks.erase(std::remove_if(visibleChunks.begin(), visibleChunks.end(),
+        [this](uint32_t index) { return chunks[index].runs.empty(); }), visibleChunks.end());
+
+    drawStats.chunksDrawn = (uint32_t)visibleChunks.size();
+    drawStats.chunksCulled = drawStats.chunks - drawStats.chunksDrawn;
+    if (visibleChunks.empty()) return;
+
+    float projection[16];
+    MakeSpriteProjection(worldToScreen, screenWidth, screenHeight, projection);
+    const TransientAllocation cbRange = transient->UploadConstants(projection, sizeof(projection));
+    if (!cbRange) return;
+    device->SetPipeline(pipeline);
+    device->SetConstantBuffer(0, cbRange.buffer, cbRange.offset, cbRange.size);
+    device->SetIndexBuffer(indexBuffer, IndexFormat::UInt16);
+    device->SetVertexBuffer(0, cornerBuffer, sizeof(float) * 2, 0);
+
+    // Lowest remaining layer across all visible chunks first, so a higher
+    // layer in one chunk never ends up under a lower one from its neighbour
+    cursors.assign(visibleChunks.size(), 0);
+    for (;;)
+    {
+        uint32_t layer = 0;
+        bool any = false;
+        for (size_t i = 0; i < visibleChunks.size(); ++i)
+        {
+            const std::vector<Run>& runs = chunks[visibleChunks[i]].runs;
+            if (cursors[i] < runs.size() && (!any || runs[cursors[i]].layer < layer))
+            {
+                layer = runs[cursors[i]].layer;
+                any = true;
+            }
+        }
+        if (!any) break;
+
+        for (size_t i = 0; i < visibleChunks.size(); ++i)
+        {
+            const Chunk& chunk = chunks[visibleChunks[i]];
+            size_t& cursor = cursors[i];
+            if (cursor >= chunk.runs.size() || chunk.runs[cursor].layer != layer) continue;
+
+            device->SetVertexBuffer(1, chunk.instances, sizeof(SpriteInstance), 0);
+            for (; cursor < chunk.runs.size() && chunk.runs[cursor].layer == layer; ++cursor)
+            {
+                const Run& run = chunk.runs[cursor];
+                device->SetTexture(0, run.texture);
+                device->DrawIndexedInstanced(6, run.count, 0, 0, run.start);
+                ++drawStats.drawCalls;
+                drawStats.sprites += run.count;
+            }
+        }
+    }
+}
+
+uint32_t StaticSpriteBatch::ChunkFor(const Aabb& bounds)
+{
+    const int cx = ToCell((bounds.minX + bounds.maxX) * 0.5f, invChunkSize);
+    const int cy = ToCell((bounds.minY + bounds.maxY) * 0.5f, invChunkSize);
+    const uint64_t key = (uint64_t)(uint32_t)cx << 32 | (uint32_t)cy;
+
+    auto it = chunkIndex.find(key);
+    if (it != chunkIndex.end()) return it->second;
+
+    const uint32_t index = (uint32_t)chunks.size();
+    chunks.emplace_back();
+    chunkIndex.emplace(key, index);
+    return index;
+}
+
+void StaticSpriteBatch::Link(uint32_t handle)
+{
+    Item& item = items[handle];
+    item.chunk = ChunkFor(item.bounds);
+    const uint32_t index = item.chunk;
+    Chunk& chunk = chunks[index];
+    chunk.members.push_back(handle);
+    chunk.dirty = true;
+
+    if (chunk.gridHandle == SpatialGrid::Invalid)
+    {
+        chunk.bounds = item.bounds;
+        chunk.gridHandle = grid.Insert(chunk.bounds);
+        if (gridChunks.size() <= chunk.gridHandle) gridChunks.resize(chunk.gridHandle + 1, 0);
+        gridChunks[chunk.gridHandle] = index;
+    }
+    else
+    {
+        Extend(chunk.bounds, item.bounds);
+        grid.Update(chunk.gridHandle, chunk.bounds);
+    }
+}
+
+void StaticSpriteBatch::Unlink(uint32_t handle)
+{
+    // Bounds stay as they are (only ever too large) until the chunk is rebuilt
+    Chunk& chunk = chunks[items[handle].chunk];
+    auto it = std::find(chunk.members.begin(), chunk.members.end(), handle);
+    if (it != chunk.members.end())
+    {
+        *it = chunk.members.back();
+        chunk.members.pop_back();
+    }
+    chunk.dirty = true;
+}
+
+void StaticSpriteBatch::Rebuild(Chunk& chunk)
+{
+    chunk.dirty = false;
+    chunk.runs.clear();
+    device->Destroy(chunk.instances);
+    chunk.instances = {};
+    ++drawStats.rebuilds;
+
+    if (chunk.members.empty())
+    {
+        grid.Remove(chunk.gridHandle);
+        chunk.gridHandle = SpatialGrid::Invalid;
+        return;
+    }
+
+    // Translucent keys: layer, then depth, then the order the sprites were added
+    queue.Clear();
+    Aabb bounds = items[chunk.members[0]].bounds;
+    for (uint32_t i = 0; i < (uint32_t)chunk.members.size(); ++i)
+    {
+        const Item& item = items[chunk.members[i]];
+        queue.Push(RenderKey::Make(item.layer, true, 0, item.sprite.texture.id, item.depth), i,
+            RenderKey::MakeState(0, item.sprite.texture.id));
+        Extend(bounds, item.bounds);
+    }
+    queue.Sort();
+
+    const std::vector<RenderQueue::Entry>& order = queue.GetEntries();
+    instances.resize(order.size());
+    for (uint32_t i = 0; i < (uint32_t)order.size(); ++i)
+    {
+        const Item& item = items[chunk.members[order[i].index]];
+        PackSpriteInstance(item.sprite, instances[i]);
+
+        if (chunk.runs.empty() || chunk.runs.back().layer != item.layer || chunk.runs.back().texture != item.sprite.texture)
+        {
+            chunk.runs.push_back({ item.layer, item.sprite.texture, i, 1 });
+        }
+        else
+        {
+            ++chunk.runs.back().count;
+        }
+    }
+
+    chunk.instances = device->CreateBuffer({ BufferType::Vertex, ResourceUsage::Immutable,
+        (uint32_t)(instances.size() * sizeof(SpriteInstance)) }, instances.data());
+    chunk.bounds = bounds;
+    grid.Update(chunk.gridHandle, chunk.bounds);
+}
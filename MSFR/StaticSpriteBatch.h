@@ -0,0 +1,113 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "RenderQueue.h"
+#include "SpatialGrid.h"
+#include "SpriteBatch.h"
+
+// Retained sprites for scenery that never moves (backgrounds, tiles, props).
+// Items are given once in world space and binned into square chunks by the
+// centre of their bounds. Each chunk keeps its instances sorted and baked in
+// an immutable buffer, so a frame only culls chunks against the view and binds
+// buffers; a chunk is re-baked the first time it is drawn after one of its
+// items changed. Layers are honoured across chunks, depth only within one.
+class StaticSpriteBatch
+{
+public:
+    static constexpr uint32_t Invalid = 0xFFFFFFFF;
+
+    struct DrawStats
+    {
+        uint32_t chunks = 0;
+        uint32_t chunksDrawn = 0;
+        uint32_t chunksCulled = 0;
+        uint32_t rebuilds = 0;
+        uint32_t sprites = 0;
+        uint32_t drawCalls = 0;
+    };
+
+    explicit StaticSpriteBatch(float chunkSize = 1024.f);
+    ~StaticSpriteBatch();
+
+    StaticSpriteBatch(const StaticSpriteBatch&) = delete;
+    StaticSpriteBatch& operator=(const StaticSpriteBatch&) = delete;
+
+    void Init(IRenderDevice& device, TransientAllocator& transient);
+    void Shutdown();
+
+    // item.transform maps the unit quad to world space. Returns a handle for
+    // Update/Remove, or Invalid for an item without a texture.
+    uint32_t Add(const SpriteDrawItem& item, uint32_t layer = 0, uint32_t depth = 0);
+    void Update(uint32_t handle, const SpriteDrawItem& item, uint32_t layer = 0, uint32_t depth = 0);
+    void Remove(uint32_t handle);
+    void Clear();
+
+    // worldToScreen uses SpriteDrawItem's column-major 2x3 layout; view is the
+    // visible world rect. Issues its draws immediately, so call it before the
+    // dynamic SpriteBatch is flushed to keep scenery underneath.
+    void Draw(const float worldToScreen[6], const Aabb& view, float screenWidth, float screenHeight);
+
+    size_t Size() const { return liveCount; }
+    const DrawStats& GetDrawStats() const { return drawStats; }
+
+private:
+    struct Item
+    {
+        SpriteDrawItem sprite;
+        Aabb bounds;
+        uint32_t layer = 0;
+        uint32_t depth = 0;
+        uint32_t chunk = 0;
+        bool live = false;
+    };
+
+    struct Run
+    {
+        uint32_t layer;
+        TextureHandle texture;
+        uint32_t start;
+        uint32_t count;
+    };
+
+    struct Chunk
+    {
+        std::vector<uint32_t> members;  // item handles
+        Aabb bounds;                    // may be loose until the next rebuild
+        uint32_t gridHandle = SpatialGrid::Invalid;
+        BufferHandle instances;
+        std::vector<Run> runs;          // in sorted order, split at layer or texture changes
+        bool dirty = false;
+    };
+
+    uint32_t ChunkFor(const Aabb& bounds);
+    void Link(uint32_t handle);
+    void Unlink(uint32_t handle);
+    void Rebuild(Chunk& chunk);
+
+    float chunkSize;
+    float invChunkSize;
+
+    IRenderDevice* device = nullptr;
+    TransientAllocator* transient = nullptr;
+    PipelineHandle pipeline;
+    BufferHandle cornerBuffer;
+    BufferHandle indexBuffer;
+
+    std::vector<Item> items;
+    std::vector<uint32_t> freeHandles;
+    size_t liveCount = 0;
+
+    std::vector<Chunk> chunks;
+    std::unordered_map<uint64_t, uint32_t> chunkIndex;   // cell key -> chunks[]
+    SpatialGrid grid;                                    // chunk bounds
+    std::vector<uint32_t> gridChunks;                    // grid handle -> chunks[]
+
+    std::vector<uint32_t> visibleChunks;
+    std::vector<size_t> cursors;
+    RenderQueue queue;
+    std::vector<SpriteInstance> instances;
+    DrawStats drawStats;
+};
@@ -1,13 +1,15 @@
 #include "TextureDX11.h"
 
-#include <d3dcompiler.h>
 #include <stdexcept>
 #include <vector>
 #include <cstring>
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <filesystem>
-#pragma comment(lib, "d3dcompiler.lib")
+#include <mutex>
+#include <thread>
+#include <utility>
 
 #define NOMINMAX
 #include <Windows.h>
@@ -15,7 +17,12 @@
 #include <wrl/client.h>
 #pragma comment(lib, "windowscodecs.lib")
 
+#include "AssetPack.h"
+#include "DdsCodec.h"
 #include "Engine.h"
+#include "ImageCodec.h"
+#include "TextureLoader.h"
+#include "WorkerPool.h"
 
 namespace
 {
@@ -35,9 +42,10 @@ namespace
         std::vector<uint8_t> rgba; // width * height * 4
     };
 
+    // COM is initialized per thread; decode threads come through here too
     void EnsureCOM()
     {
-        static bool once = false;
+        thread_local bool once = false;
         if (once) return;
 
         HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
@@ -48,17 +56,29 @@ namespace
         once = true;
     }
 
-    WICImageRGBA LoadImageRGBA_WIC(const std::wstring& filename)
+    void CreateFactory_WIC(ComPtr<IWICImagingFactory>& factory)
     {
         EnsureCOM();
 
-        ComPtr<IWICImagingFactory> factory;
         ThrowIfFailed(CoCreateInstance(
             CLSID_WICImagingFactory,
             nullptr,
             CLSCTX_INPROC_SERVER,
             IID_PPV_ARGS(factory.GetAddressOf())),
             "CoCreateInstance(IWICImagingFactory) failed.");
+    }
+
+    ComPtr<IWICBitmapFrameDecode> FirstFrame_WIC(IWICBitmapDecoder* decoder)
+    {
+        ComPtr<IWICBitmapFrameDecode> frame;
+        ThrowIfFailed(decoder->GetFrame(0, frame.GetAddressOf()),
+            "decoder->GetFrame(0) failed.");
+        return frame;
+    }
+
+    ComPtr<IWICBitmapFrameDecode> OpenFrame_WIC(const std::wstring& filename, ComPtr<IWICImagingFactory>& factory)
+    {
+        CreateFactory_WIC(factory);
 
         ComPtr<IWICBitmapDecoder> decoder;
         ThrowIfFailed(factory->CreateDecoderFromFilename(
@@ -68,10 +88,46 @@ namespace
             WICDecodeMetadataCacheOnDemand,
             decoder.GetAddressOf()),
             "CreateDecoderFromFilename failed.");
+        return FirstFrame_WIC(decoder.Get());
+    }
 
-        ComPtr<IWICBitmapFrameDecode> frame;
-        ThrowIfFailed(decoder->GetFrame(0, frame.GetAddressOf()),
-            "decoder->GetFrame(0) failed.");
+    // The decoder keeps the stream, which only reads bytes; they must outlive the frame
+    ComPtr<IWICBitmapFrameDecode> OpenFrame_WIC(const AssetBytes& bytes, ComPtr<IWICImagingFactory>& factory)
+    {
+        CreateFactory_WIC(factory);
+
+        ComPtr<IWICStream> stream;
+        ThrowIfFailed(factory->CreateStream(stream.GetAddressOf()), "CreateStream failed.");
+        ThrowIfFailed(stream->InitializeFromMemory(const_cast<BYTE*>(bytes.data), static_cast<DWORD>(bytes.size)),
+            "stream->InitializeFromMemory failed.");
+
+        ComPtr<IWICBitmapDecoder> decoder;
+        ThrowIfFailed(factory->CreateDecoderFromStream(
+            stream.Get(),
+            nullptr,
+            WICDecodeMetadataCacheOnDemand,
+            decoder.GetAddressOf()),
+            "CreateDecoderFromStream failed.");
+        return FirstFrame_WIC(decoder.Get());
+    }
+
+    // Reads the header only; no pixels are decoded. source is a file name
+    // or the bytes of a packed file
+    template <typename Source>
+    void ReadImageSize_WIC(const Source& source, uint32_t& width, uint32_t& height)
+    {
+        ComPtr<IWICImagingFactory> factory;
+        ComPtr<IWICBitmapFrameDecode> frame = OpenFrame_WIC(source, factory);
+        UINT w = 0, h = 0;
+        ThrowIfFailed(frame->GetSize(&w, &h), "frame->GetSize failed.");
+        width = static_cast<uint32_t>(w);
+        height = static_cast<uint32_t>(h);
+    }
+
+    WICImageRGBA LoadImageRGBA_WIC(const AssetBytes& bytes)
+    {
+        ComPtr<IWICImagingFactory> factory;
+        ComPtr<IWICBitmapFrameDecode> frame = OpenFrame_WIC(bytes, factory);
 
         UINT w = 0, h = 0;
         ThrowIfFailed(frame->GetSize(&w, &h), "frame->GetSize failed.");
@@ -136,39 +192,6 @@ namespace
         return cb;
     }
 
-    void UpdateDynamicCB(ID3D11DeviceContext* ctx, ID3D11Buffer* cb, const void* data, UINT bytes)
-    {
-        D3D11_MAPPED_SUBRESOURCE ms{};
-        ThrowIfFailed(ctx->Map(cb, 0, D3D11_MAP_WRITE_DISCARD, 0, &ms), "Map(CB) failed.");
-        std::memcpy(ms.pData, data, bytes);
-        ctx->Unmap(cb, 0);
-    }
-
-    ComPtr<ID3DBlob> CompileFromFile(const wchar_t* path, const char* entry, const char* target)
-    {
-        //std::wcout << L"CWD: " << std::filesystem::current_path().c_str() << L"\n";
-        //std::wcout << L"Shader path: " << path << L"\n";
-        //std::wcout << L"Exists? " << (std::filesystem::exists(path) ? L"YES" : L"NO") << L"\n";
-        UINT flags = 0;
-#if defined(_DEBUG)
-        flags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#endif
-        ComPtr<ID3DBlob> blob;
-        ComPtr<ID3DBlob> err;
-
-        HRESULT hr = D3DCompileFromFile(
-            path, nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE,
-            entry, target, flags, 0,
-            blob.GetAddressOf(), err.GetAddressOf());
-
-        if (FAILED(hr))
-        {
-            std::string msg = "D3DCompileFromFile failed: ";
-            if (err) msg += (const char*)err->GetBufferPointer();
-            throw std::runtime_error(msg);
-        }
-        return blob;
-    }
     static mat3<float> BuildSpriteModelToNDC(
         float x, float y, float w, float h,
         float screenW, float screenH)
@@ -186,174 +209,414 @@ namespace
         };
         return m;
     }
+
+    PipelineDesc MakeTexturePipelineDesc(const char* psEntry)
+    {
+        PipelineDesc desc;
+        desc.shaderPath = "assets/shaders/texture_dx11.hlsl";
+        desc.vsEntry = "VSMain";
+        desc.psEntry = psEntry;
+        desc.layout =
+        {
+            { "POSITION", 0, VertexFormat::Float2, 0, 0 },
+            { "TEXCOORD", 0, VertexFormat::Float2, 0, 8 },
+        };
+        desc.blend = BlendMode::Alpha;
+        desc.topology = PrimitiveTopology::TriangleList;
+        desc.sampler = SamplerFilter::Linear;
+        return desc;
+    }
+
+    // Quad and pipelines are identical for every texture, so each device
+    // holds one set for as long as any texture uses it
+    struct SharedDrawResources
+    {
+        IRenderDevice* device = nullptr;
+        uint32_t users = 0;
+        BufferHandle vertexBuffer;
+        BufferHandle indexBuffer;
+        PipelineHandle pipelineTexture;
+        PipelineHandle pipelineTexel;
+        TextureHandle placeholder;      // drawn while a texture is loading
+    };
+
+    std::vector<SharedDrawResources>& GetSharedList()
+    {
+        static std::vector<SharedDrawResources> list;
+        return list;
+    }
+
+    SharedDrawResources* FindShared(const IRenderDevice* device)
+    {
+        for (SharedDrawResources& r : GetSharedList())
+        {
+            if (r.device == device) return &r;
+        }
+        return nullptr;
+    }
+
+    void AcquireShared(IRenderDevice& device)
+    {
+        if (SharedDrawResources* existing = FindShared(&device))
+        {
+            ++existing->users;
+            return;
+        }
+
+        const VertexPT verts[4] =
+        {
+            { 0.f, 0.f, 0.f, 1.f },
+            { 1.f, 0.f, 1.f, 1.f },
+            { 1.f, 1.f, 1.f, 0.f },
+            { 0.f, 1.f, 0.f, 0.f },
+        };
+        const uint16_t indices[6] = { 0, 1, 2, 0, 2, 3 };
+
+        SharedDrawResources r;
+        r.device = &device;
+        r.users = 1;
+        r.vertexBuffer = device.CreateBuffer({ BufferType::Vertex, ResourceUsage::Immutable, sizeof(verts) }, verts);
+        r.indexBuffer = device.CreateBuffer({ BufferType::Index, ResourceUsage::Immutable, sizeof(indices) }, indices);
+        r.pipelineTexture = device.CreatePipeline(MakeTexturePipelineDesc("PSTexture"));
+        r.pipelineTexel = device.CreatePipeline(MakeTexturePipelineDesc("PSTexel"));
+
+        // Grey checkerboard, 4x4 texel squares so filtering doesn't blur it flat
+        uint32_t checker[8 * 8];
+        for (uint32_t i = 0; i < 8 * 8; ++i)
+        {
+            checker[i] = ((i % 8) / 4 + (i / 8) / 4) % 2 ? 0xFF606060 : 0xFF909090;
+        }
+        TextureDesc td{};
+        td.width = 8;
+        td.height = 8;
+        SubresourceData init{};
+        init.pixels = checker;
+        init.rowPitch = 8 * 4;
+        r.placeholder = device.CreateTexture(td, &init);
+        GetSharedList().push_back(r);
+    }
+
+    void ReleaseShared(IRenderDevice& device)
+    {
+        std::vector<SharedDrawResources>& list = GetSharedList();
+        for (size_t i = 0; i < list.size(); ++i)
+        {
+            SharedDrawResources& r = list[i];
+            if (r.device != &device || --r.users > 0) continue;
+
+            device.Destroy(r.vertexBuffer);
+            device.Destroy(r.indexBuffer);
+            device.Destroy(r.pipelineTexture);
+            device.Destroy(r.pipelineTexel);
+            device.Destroy(r.placeholder);
+            list.erase(list.begin() + i);
+            return;
+        }
+    }
+
+    // Read by decode threads
+    std::atomic<TextureDX11::Decoder> selectedDecoder{ TextureDX11::Decoder::Portable };
+    std::mutex mipSettingsMutex;
+    MipSettings mipSettings;
+
+    // A cooked .dds next to the source (see Tools/TextureCooker.cpp) is
+    // loaded instead, unless the source was saved after it was cooked
+    std::filesystem::path ResolveCooked(const std::filesystem::path& filePath)
+    {
+        return Engine::GetAssets().ResolveCooked(filePath, ".dds");
+    }
+
+    // Decode threads share one pool for large mip levels; a thread that
+    // finds it busy filters on its own rather than wait
+    void GenerateMipsShared(Image& image, MipSettings settings)
+    {
+        static std::mutex poolMutex;
+        static WorkerPool pool(std::max(std::thread::hardware_concurrency() / 2, 1u));
+
+        std::unique_lock<std::mutex> lock(poolMutex, std::try_to_lock);
+        settings.pool = lock.owns_lock() ? &pool : nullptr;
+        GenerateMips(image, settings);
+    }
 }
 
 TextureDX11::TextureDX11(const std::filesystem::path& filePath, bool enableTexel_)
     : enableTexel(enableTexel_)
 {
-    Load(Engine::GetDXDevice(), Engine::GetDXContext(), filePath);
+    Load(Engine::GetRenderDevice(), filePath);
+}
+
+TextureDX11::TextureDX11(IRenderDevice& device_, const std::filesystem::path& filePath, bool enableTexel_)
+    : enableTexel(enableTexel_)
+{
+    Load(device_, filePath);
 }
 
-TextureDX11::TextureDX11(ID3D11Device* device, ID3D11DeviceContext* ctx,
-    const std::filesystem::path& filePath, bool enableTexel_)
+TextureDX11::TextureDX11(IRenderDevice& device_, uint32_t width_, uint32_t height_, bool enableTexel_)
     : enableTexel(enableTexel_)
 {
-    Load(device, ctx, filePath);
+    Create(device_, width_, height_);
 }
 
-void TextureDX11::Load(ID3D11Device* device, ID3D11DeviceContext* ctx,
-    const std::filesystem::path& filePath)
+TextureDX11::~TextureDX11()
 {
-    if (!device || !ctx)
-        throw std::runtime_error("TextureDX11::Load: device/context is null.");
+    Release();
+}
 
-    // 1) CPU load image via WIC
-    WICImageRGBA img = LoadImageRGBA_WIC(filePath.wstring());
-    width = img.width;
-    height = img.height;
+TextureDX11::TextureDX11(TextureDX11&& other) noexcept
+{
+    *this = std::move(other);
+}
 
-    // 2) Create GPU texture
-    D3D11_TEXTURE2D_DESC td{};
-    td.Width = width;
-    td.Height = height;
-    td.MipLevels = 1;
-    td.ArraySize = 1;
-    td.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    td.SampleDesc.Count = 1;
-    td.Usage = D3D11_USAGE_IMMUTABLE;
-    td.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-
-    D3D11_SUBRESOURCE_DATA init{};
-    init.pSysMem = img.rgba.data();
-    init.SysMemPitch = width * 4;
-
-    ThrowIfFailed(device->CreateTexture2D(&td, &init, texture2D.GetAddressOf()),
-        "CreateTexture2D failed.");
-
-    // 3) SRV
-    ThrowIfFailed(device->CreateShaderResourceView(texture2D.Get(), nullptr, srv.GetAddressOf()),
-        "CreateShaderResourceView failed.");
-
-    // 4) Shared pipeline resources
-    if (!vertexBuffer || !indexBuffer) CreateQuad(device);
-    if (!sampler || !blendState || !rasterState) CreateStates(device);
-    if (!vs || !psTexture || !psTexel || !inputLayout) CreateShaders(device);
-
-    if (!constantBuffer)
-    {
-        D3D11_BUFFER_DESC cbd{};
-        cbd.ByteWidth = sizeof(CBPerDraw);
-        cbd.Usage = D3D11_USAGE_DYNAMIC;
-        cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        cbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-        ThrowIfFailed(device->CreateBuffer(&cbd, nullptr, constantBuffer.GetAddressOf()),
-            "CreateBuffer(ConstantBuffer) failed.");
+TextureDX11& TextureDX11::operator=(TextureDX11&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+
+        // The loader's callback points at other
+        other.CompleteLoad();
+        device = std::exchange(other.device, nullptr);
+        texture = std::exchange(other.texture, {});
+        placeholder = std::exchange(other.placeholder, false);
+        loader = std::exchange(other.loader, nullptr);
+        width = std::exchange(other.width, 0);
+        height = std::exchange(other.height, 0);
+        mipLevels = std::exchange(other.mipLevels, 1);
+        format = std::exchange(other.format, TextureFormat::RGBA8);
+        enableTexel = other.enableTexel;
     }
+    return *this;
 }
 
-vec2 TextureDX11::GetSize() const
+void TextureDX11::Release()
 {
-    return { (float)width, (float)height };
+    if (!device) return;
+
+    if (loadTicket) loader->Cancel(loadTicket);
+    if (texture)
+    {
+        if (!placeholder) device->Destroy(texture);
+        ReleaseShared(*device);
+    }
+
+    texture = {};
+    placeholder = false;
+    loadTicket = 0;
+    loader = nullptr;
+    device = nullptr;
 }
 
-void TextureDX11::CreateQuad(ID3D11Device* device)
+void TextureDX11::Load(IRenderDevice& device_, const std::filesystem::path& filePath)
 {
-    const VertexPT verts[4] =
-    {
-        { 0.f, 0.f, 0.f, 1.f },
-        { 1.f, 0.f, 1.f, 1.f },
-        { 1.f, 1.f, 1.f, 0.f },
-        { 0.f, 1.f, 0.f, 0.f },
-    };
+    Release();
+    device = &device_;
 
-    const uint16_t indices[6] = { 0, 1, 2, 0, 2, 3 };
+    // 1) CPU load image (cooked texture, portable codecs or WIC)
+    Image img;
+    std::string error;
+    if (!DecodeFile(ResolveCooked(filePath), img, error)) throw std::runtime_error(error);
 
-    D3D11_BUFFER_DESC vbd{};
-    vbd.ByteWidth = sizeof(verts);
-    vbd.Usage = D3D11_USAGE_IMMUTABLE;
-    vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    // 2) Create GPU texture
+    CreateFromImage(img);
 
-    D3D11_SUBRESOURCE_DATA vinit{};
-    vinit.pSysMem = verts;
+    // 3) Shared pipeline resources
+    CreateDrawResources();
+}
 
-    ThrowIfFailed(device->CreateBuffer(&vbd, &vinit, vertexBuffer.GetAddressOf()),
-        "CreateBuffer(VertexBuffer) failed.");
+void TextureDX11::LoadAsync(IRenderDevice& device_, TextureLoader& loader_, const std::filesystem::path& filePath)
+{
+    Release();
+    // Known up front so GetByteSize is right while the load is in flight
+    const std::filesystem::path source = ResolveCooked(filePath);
+    // A packed file is already mapped, so its header is read from there
+    AssetBytes packed;
+    const bool isPacked = Engine::GetAssets().ReadPacked(source, packed);
+    DDSInfo cooked;
+    if (isPacked ? ReadDDSInfo(packed.data, packed.size, cooked) : ReadDDSFileInfo(source, cooked))
+    {
+        width = cooked.width;
+        height = cooked.height;
+        mipLevels = cooked.levels;
+        format = cooked.format;
+    }
+    else
+    {
+        const bool portable = GetDecoder() == Decoder::Portable;
+        if (isPacked)
+        {
+            if (!portable || !ReadImageSize(packed.data, packed.size, width, height)) ReadImageSize_WIC(packed, width, height);
+        }
+        else if (!portable || !ReadImageFileSize(source, width, height))
+        {
+            ReadImageSize_WIC(source.wstring(), width, height);
+        }
+        mipLevels = GetMipLevelCount(width, height, GetMipSettings().maxLevels);
+        format = TextureFormat::RGBA8;
+    }
+
+    device = &device_;
+    loader = &loader_;
+    AcquireShared(*device);
+    texture = FindShared(device)->placeholder;
+    placeholder = true;
+    loadTicket = loader->Request(source, [this, filePath](const Image* image, const std::string& error)
+    {
+        FinishLoad(image, error, filePath);
+    });
+}
+
+void TextureDX11::CompleteLoad()
+{
+    if (loadTicket) loader->Complete(loadTicket);
+}
 
-    D3D11_BUFFER_DESC ibd{};
-    ibd.ByteWidth = sizeof(indices);
-    ibd.Usage = D3D11_USAGE_IMMUTABLE;
-    ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+bool TextureDX11::DecodeFile(const std::filesystem::path& filePath, Image& image, std::string& error)
+{
+    AssetBytes bytes;
+    if (!Engine::GetAssets().Read(filePath, bytes))
+    {
+        error = "Failed to load " + filePath.generic_string() + ": cannot read file";
+        return false;
+    }
 
-    D3D11_SUBRESOURCE_DATA iinit{};
-    iinit.pSysMem = indices;
+    // Cooked textures are uploaded as stored, whichever decoder is selected
+    if (IsDDS(bytes.data, bytes.size))
+    {
+        std::string reason;
+        if (DecodeDDS(bytes.data, bytes.size, image, &reason)) return true;
+        error = "Failed to load " + filePath.generic_string() + ": " + reason;
+        return false;
+    }
+    if (GetDecoder() == Decoder::Portable && DecodeImage(bytes.data, bytes.size, image))
+    {
+        GenerateMipsShared(image, GetMipSettings());
+        return true;
+    }
 
-    ThrowIfFailed(device->CreateBuffer(&ibd, &iinit, indexBuffer.GetAddressOf()),
-        "CreateBuffer(IndexBuffer) failed.");
+    try
+    {
+        WICImageRGBA img = LoadImageRGBA_WIC(bytes);
+        image.width = img.width;
+        image.height = img.height;
+        image.pixels = std::move(img.rgba);
+        image.levels = 1;
+        GenerateMipsShared(image, GetMipSettings());
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        error = "Failed to load " + filePath.generic_string() + ": " + e.what();
+        return false;
+    }
 }
 
-void TextureDX11::CreateStates(ID3D11Device* device)
+void TextureDX11::SetDecoder(Decoder decoder)
 {
-    D3D11_SAMPLER_DESC samp{};
-    samp.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-    samp.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
-    samp.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
-    samp.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
-    samp.MaxLOD = D3D11_FLOAT32_MAX;
-
-    ThrowIfFailed(device->CreateSamplerState(&samp, sampler.GetAddressOf()),
-        "CreateSamplerState failed.");
-
-    D3D11_BLEND_DESC bd{};
-    bd.RenderTarget[0].BlendEnable = TRUE;
-    bd.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
-    bd.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
-    bd.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
-    bd.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
-    bd.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_INV_SRC_ALPHA;
-    bd.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
-    bd.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
-
-    ThrowIfFailed(device->CreateBlendState(&bd, blendState.GetAddressOf()),
-        "CreateBlendState failed.");
-
-    D3D11_RASTERIZER_DESC rd{};
-    rd.FillMode = D3D11_FILL_SOLID;
-    rd.CullMode = D3D11_CULL_NONE;
-    rd.ScissorEnable = FALSE;
-    rd.DepthClipEnable = TRUE;
-
-    ThrowIfFailed(device->CreateRasterizerState(&rd, rasterState.GetAddressOf()),
-        "CreateRasterizerState failed.");
+    selectedDecoder.store(decoder);
 }
 
-void TextureDX11::CreateShaders(ID3D11Device* device)
+TextureDX11::Decoder TextureDX11::GetDecoder()
 {
-    const auto vsBlob = CompileFromFile(L"assets/shaders/texture_dx11.hlsl", "VSMain", "vs_5_0");
-    const auto psTexBlob = CompileFromFile(L"assets/shaders/texture_dx11.hlsl", "PSTexture", "ps_5_0");
-    const auto psTexelBlob = CompileFromFile(L"assets/shaders/texture_dx11.hlsl", "PSTexel", "ps_5_0");
+    return selectedDecoder.load();
+}
 
+void TextureDX11::SetMipSettings(const MipSettings& settings)
+{
+    std::lock_guard<std::mutex> lock(mipSettingsMutex);
+    mipSettings = settings;
+    mipSettings.pool = nullptr;
+}
 
-    ThrowIfFailed(device->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, vs.GetAddressOf()),
-        "CreateVertexShader failed.");
+MipSettings TextureDX11::GetMipSettings()
+{
+    std::lock_guard<std::mutex> lock(mipSettingsMutex);
+    return mipSettings;
+}
 
-    ThrowIfFailed(device->CreatePixelShader(psTexBlob->GetBufferPointer(), psTexBlob->GetBufferSize(), nullptr, psTexture.GetAddressOf()),
-        "CreatePixelShader(texture) failed.");
+void TextureDX11::CreateFromImage(const Image& image)
+{
+    width = image.width;
+    height = image.height;
+    mipLevels = image.levels;
+    format = image.format;
+
+    TextureDesc td{};
+    td.width = width;
+    td.height = height;
+    td.mipLevels = mipLevels;
+    td.format = format;
+
+    // The whole chain is one buffer, so this is one upload
+    std::vector<SubresourceData> init(mipLevels);
+    for (uint32_t level = 0; level < mipLevels; ++level)
+    {
+        init[level].pixels = image.GetLevel(level);
+        init[level].rowPitch = GetRowPitch(format, image.GetLevelWidth(level));
+    }
 
-    ThrowIfFailed(device->CreatePixelShader(psTexelBlob->GetBufferPointer(), psTexelBlob->GetBufferSize(), nullptr, psTexel.GetAddressOf()),
-        "CreatePixelShader(texel) failed.");
+    texture = device->CreateTexture(td, init.data());
+}
 
-    D3D11_INPUT_ELEMENT_DESC layout[] =
+void TextureDX11::FinishLoad(const Image* image, const std::string& error, const std::filesystem::path& filePath)
+{
+    loadTicket = 0;
+    if (!image)
     {
-        { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0,  D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 8,  D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    };
-    ThrowIfFailed(device->CreateInputLayout(layout, 2, vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), inputLayout.GetAddressOf()),
-        "CreateInputLayout failed.");
+        Engine::GetLogger().LogError(error.empty() ? "Failed to load " + filePath.generic_string() : error);
+        return;
+    }
+
+    // The shared resources stay acquired; only the texture changes
+    CreateFromImage(*image);
+    placeholder = false;
+}
+
+void TextureDX11::Create(IRenderDevice& device_, uint32_t width_, uint32_t height_)
+{
+    Release();
+    device = &device_;
+    width = width_;
+    height = height_;
+    mipLevels = 1;
+    format = TextureFormat::RGBA8;
+
+    TextureDesc td{};
+    td.width = width;
+    td.height = height;
+    td.mipLevels = 1;
+    td.format = TextureFormat::RGBA8;
+    td.usage = ResourceUsage::Dynamic;
+
+    // Start transparent rather than with undefined contents
+    std::vector<uint8_t> clear((size_t)width * height * 4, 0);
+    SubresourceData init{};
+    init.pixels = clear.data();
+    init.rowPitch = width * 4;
+
+    texture = device->CreateTexture(td, &init);
+    CreateDrawResources();
+}
+
+void TextureDX11::Update(uint32_t x, uint32_t y, uint32_t w, uint32_t h, const void* rgba, uint32_t rowPitch)
+{
+    if (!texture || w == 0 || h == 0) return;
+    device->UpdateTexture(texture, { x, y, w, h }, rgba, rowPitch);
+}
+
+void TextureDX11::CreateDrawResources()
+{
+    // Paired with ReleaseShared in Release, which only runs for a live texture
+    if (texture) AcquireShared(*device);
+}
+
+vec2 TextureDX11::GetSize() const
+{
+    return { (float)width, (float)height };
 }
 
-void TextureDX11::Draw(ID3D11DeviceContext* ctx, const mat3<float>& displayMatrix)
+void TextureDX11::Draw(IRenderDevice& device_, const mat3<float>& displayMatrix)
 {
-    if (!ctx) return;
+    if (!texture) return;
 
     const float screenW = (float)Engine::GetViewportWidth();
     const float screenH = (float)Engine::GetViewportHeight();
@@ -368,40 +631,24 @@ void TextureDX11::Draw(ID3D11DeviceContext* ctx, const mat3<float>& displayMatri
 
     const mat3<float> model_to_ndc = BuildSpriteModelToNDC(x, y, w, h, screenW, screenH);
 
+    const SharedDrawResources* shared = FindShared(device);
     const CBPerDraw cb = MakeCB(model_to_ndc, { 0,0 }, { 1,1 });
-    UpdateDynamicCB(ctx, constantBuffer.Get(), &cb, sizeof(cb));
+    const TransientAllocation cbRange = Engine::GetTransientAllocator().UploadConstants(&cb, sizeof(cb));
+    if (!cbRange) return;
 
-    ctx->IASetInputLayout(inputLayout.Get());
-    ctx->VSSetShader(vs.Get(), nullptr, 0);
-    ctx->PSSetShader(psTexture.Get(), nullptr, 0);
+    device_.SetPipeline(shared->pipelineTexture);
+    device_.SetConstantBuffer(0, cbRange.buffer, cbRange.offset, cbRange.size);
+    device_.SetTexture(0, texture);
+    device_.SetVertexBuffer(0, shared->vertexBuffer, sizeof(VertexPT), 0);
+    device_.SetIndexBuffer(shared->indexBuffer, IndexFormat::UInt16);
 
-    ID3D11Buffer* cbs[] = { constantBuffer.Get() };
-    ctx->VSSetConstantBuffers(0, 1, cbs);
-
-    ID3D11ShaderResourceView* srvs[] = { srv.Get() };
-    ctx->PSSetShaderResources(0, 1, srvs);
-
-    ID3D11SamplerState* samps[] = { sampler.Get() };
-    ctx->PSSetSamplers(0, 1, samps);
-
-    float blendFactor[4] = { 0,0,0,0 };
-    ctx->OMSetBlendState(blendState.Get(), blendFactor, 0xFFFFFFFF);
-    ctx->RSSetState(rasterState.Get());
-
-    UINT stride = sizeof(VertexPT);
-    UINT offset = 0;
-    ID3D11Buffer* vb = vertexBuffer.Get();
-    ctx->IASetVertexBuffers(0, 1, &vb, &stride, &offset);
-    ctx->IASetIndexBuffer(indexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
-    ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-
-    ctx->DrawIndexed(6, 0, 0);
+    device_.DrawIndexed(6, 0, 0);
 }
 
-void TextureDX11::Draw(ID3D11DeviceContext* ctx, const mat3<float>& displayMatrix,
+void TextureDX11::Draw(IRenderDevice& device_, const mat3<float>& displayMatrix,
     vec2 texelPos, vec2 frameSize)
 {
-    if (!ctx) return;
+    if (!texture) return;
 
     const float screenW = 1280.f;
     const float screenH = 720.f;
@@ -419,44 +666,27 @@ void TextureDX11::Draw(ID3D11DeviceContext* ctx, const mat3<float>& displayMatri
     vec2 texelPosN = { texelPos.x / (float)width,  texelPos.y / (float)height };
     vec2 frameSizeN = { frameSize.x / (float)width, frameSize.y / (float)height };
 
+    const SharedDrawResources* shared = FindShared(device);
     const CBPerDraw cb = MakeCB(model_to_ndc, texelPosN, frameSizeN);
-    UpdateDynamicCB(ctx, constantBuffer.Get(), &cb, sizeof(cb));
-
-    ctx->IASetInputLayout(inputLayout.Get());
-    ctx->VSSetShader(vs.Get(), nullptr, 0);
-    ctx->PSSetShader(psTexel.Get(), nullptr, 0);
-
-    ID3D11Buffer* cbs[] = { constantBuffer.Get() };
-    ctx->VSSetConstantBuffers(0, 1, cbs);
-    ctx->PSSetConstantBuffers(0, 1, cbs);
-
-    ID3D11ShaderResourceView* srvs[] = { srv.Get() };
-    ctx->PSSetShaderResources(0, 1, srvs);
-
-    ID3D11SamplerState* samps[] = { sampler.Get() };
-    ctx->PSSetSamplers(0, 1, samps);
-
-    float blendFactor[4] = { 0,0,0,0 };
-    ctx->OMSetBlendState(blendState.Get(), blendFactor, 0xFFFFFFFF);
-    ctx->RSSetState(rasterState.Get());
+    const TransientAllocation cbRange = Engine::GetTransientAllocator().UploadConstants(&cb, sizeof(cb));
+    if (!cbRange) return;
 
-    UINT stride = sizeof(VertexPT);
-    UINT offset = 0;
-    ID3D11Buffer* vb = vertexBuffer.Get();
-    ctx->IASetVertexBuffers(0, 1, &vb, &stride, &offset);
-    ctx->IASetIndexBuffer(indexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
-    ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    device_.SetPipeline(shared->pipelineTexel);
+    device_.SetConstantBuffer(0, cbRange.buffer, cbRange.offset, cbRange.size);
+    device_.SetTexture(0, texture);
+    device_.SetVertexBuffer(0, shared->vertexBuffer, sizeof(VertexPT), 0);
+    device_.SetIndexBuffer(shared->indexBuffer, IndexFormat::UInt16);
 
-    ctx->DrawIndexed(6, 0, 0);
+    device_.DrawIndexed(6, 0, 0);
 }
 
 void TextureDX11::Draw(const mat3<float>& displayMatrix)
 {
 
-    Draw(Engine::GetDXContext(), displayMatrix);
+    Draw(Engine::GetRenderDevice(), displayMatrix);
 }
 
 void TextureDX11::Draw(const mat3<float>& displayMatrix, vec2 texelPos, vec2 frameSize)
 {
-    Draw(Engine::GetDXContext(), displayMatrix, texelPos, frameSize);
+    Draw(Engine::GetRenderDevice(), displayMatrix, texelPos, frameSize);
 }
@@ -1,56 +1,89 @@
 #pragma once
 #include <filesystem>
-#include <wrl/client.h>
-#include <d3d11.h>
-#include <DirectXMath.h>
+#include <string>
 
 #include "vec2.h"
 #include "mat3.h"
+#include "RenderDevice.h"
+#include "MipGenerator.h"
+
+struct Image;
+class TextureLoader;
 
 class TextureDX11
 {
 public:
     TextureDX11() = default;
-    
+    ~TextureDX11();
+
+    TextureDX11(const TextureDX11&) = delete;
+    TextureDX11& operator=(const TextureDX11&) = delete;
+    TextureDX11(TextureDX11&& other) noexcept;
+    TextureDX11& operator=(TextureDX11&& other) noexcept;
+
     TextureDX11(const std::filesystem::path& filePath, bool enableTexel = false);
-    TextureDX11(ID3D11Device* device, ID3D11DeviceContext* ctx,
-        const std::filesystem::path& filePath, bool enableTexel);
+    TextureDX11(IRenderDevice& device, const std::filesystem::path& filePath, bool enableTexel);
+    // Blank, updatable texture (runtime atlas pages, generated images)
+    TextureDX11(IRenderDevice& device, uint32_t width, uint32_t height, bool enableTexel);
 
-    void Load(ID3D11Device* device, ID3D11DeviceContext* ctx,
-        const std::filesystem::path& filePath);
+    // Both loads read through Engine::GetAssets(), so packed files load like
+    // loose ones, and pick up a cooked .dds next to filePath when there is
+    // one and it's newer than filePath (see Tools/TextureCooker.cpp).
+    void Load(IRenderDevice& device, const std::filesystem::path& filePath);
+    // Returns once the file header is read, so GetSize is already right; the
+    // texture draws the device's placeholder until loader delivers the image
+    // in TextureLoader::Update, and keeps it if decoding fails.
+    void LoadAsync(IRenderDevice& device, TextureLoader& loader, const std::filesystem::path& filePath);
+    // Blocks until a LoadAsync is done. Moving a loading texture does this too.
+    void CompleteLoad();
+    bool IsLoading() const { return loadTicket != 0; }
+    void Create(IRenderDevice& device, uint32_t width, uint32_t height);
+    void Update(uint32_t x, uint32_t y, uint32_t w, uint32_t h, const void* rgba, uint32_t rowPitch);
 
-    void Draw(ID3D11DeviceContext* ctx, const mat3<float>& displayMatrix);
-    void Draw(ID3D11DeviceContext* ctx, const mat3<float>& displayMatrix,
+    void Draw(IRenderDevice& device, const mat3<float>& displayMatrix);
+    void Draw(IRenderDevice& device, const mat3<float>& displayMatrix,
         vec2 texelPos, vec2 frameSize);
     void Draw(const mat3<float>& displayMatrix);
     void Draw(const mat3<float>& displayMatrix, vec2 texelPos, vec2 frameSize);
     vec2 GetSize() const;
+    uint64_t GetByteSize() const { return GetTextureBytes(format, width, height, mipLevels); }
+    TextureHandle GetHandle() const { return texture; }
 
-private:
-    void CreateQuad(ID3D11Device* device);
-    void CreateStates(ID3D11Device* device);
-    void CreateShaders(ID3D11Device* device);
-
-    //GPU resources
-    Microsoft::WRL::ComPtr<ID3D11Buffer> vertexBuffer;
-    Microsoft::WRL::ComPtr<ID3D11Buffer> indexBuffer;
-    Microsoft::WRL::ComPtr<ID3D11InputLayout> inputLayout;
+    // Image file to RGBA8 with mips, or a cooked .dds as stored, for
+    // TextureLoader; safe on any thread.
+    static bool DecodeFile(const std::filesystem::path& filePath, Image& image, std::string& error);
 
-    Microsoft::WRL::ComPtr<ID3D11VertexShader> vs;
-    Microsoft::WRL::ComPtr<ID3D11PixelShader> psTexture;
-    Microsoft::WRL::ComPtr<ID3D11PixelShader> psTexel;
+    // Which decoder Load, LoadAsync and DecodeFile use. Portable decodes PNG
+    // and baseline JPEG with ImageCodec and leaves other formats (and JPEG
+    // variants it rejects) to WIC; Wic sends everything to WIC.
+    enum class Decoder { Portable, Wic };
+    static void SetDecoder(Decoder decoder);
+    static Decoder GetDecoder();
 
-    Microsoft::WRL::ComPtr<ID3D11Buffer> constantBuffer;
+    // Mip chains for loaded files are built by DecodeFile, on the loader's
+    // threads, and uploaded with the image. maxLevels = 1 turns them off.
+    // settings.pool is ignored: decode threads share a pool of their own.
+    static void SetMipSettings(const MipSettings& settings);
+    static MipSettings GetMipSettings();
 
-    Microsoft::WRL::ComPtr<ID3D11Texture2D> texture2D;
-    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
-    Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler;
+private:
+    void CreateDrawResources();
+    void CreateFromImage(const Image& image);
+    void FinishLoad(const Image* image, const std::string& error, const std::filesystem::path& filePath);
+    void Release();
 
-    Microsoft::WRL::ComPtr<ID3D11BlendState> blendState;
-    Microsoft::WRL::ComPtr<ID3D11RasterizerState> rasterState;
+    //GPU resources (owned by the render device). The quad and pipelines are
+    //shared by all textures on the device; per-draw constants are transient.
+    IRenderDevice* device = nullptr;
+    TextureHandle texture;
+    bool placeholder = false;       // texture is the device's shared placeholder
+    TextureLoader* loader = nullptr;
+    uint32_t loadTicket = 0;        // LoadAsync in flight
 
     // CPU cached info
     uint32_t width = 0;
     uint32_t height = 0;
+    uint32_t mipLevels = 1;
+    TextureFormat format = TextureFormat::RGBA8;
     bool enableTexel = false;
 };
@@ -0,0 +1,197 @@
+#include "TextureLoader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+TextureLoader::TextureLoader(DecodeFunction decode_, unsigned threadCount_)
+    : decode(std::move(decode_))
+    , threadCount(threadCount_ ? threadCount_ : std::max(std::thread::hardware_concurrency() / 2, 1u))
+{
+}
+
+TextureLoader::~TextureLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+uint32_t TextureLoader::Request(const std::filesystem::path& path, ReadyFunction ready)
+{
+    ++stats.requests;
+    const uint32_t ticket = nextTicket++;
+    if (nextTicket == 0) nextTicket = 1;
+
+    std::string key = path.lexically_normal().generic_string();
+    auto it = jobs.find(key);
+    if (it != jobs.end())
+    {
+        ++stats.coalesced;
+        it->second->waiters.push_back({ ticket, std::move(ready) });
+        tickets.emplace(ticket, it->second);
+        return ticket;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->path = path;
+    job->key = key;
+    job->waiters.push_back({ ticket, std::move(ready) });
+    jobs.emplace(std::move(key), job);
+    tickets.emplace(ticket, job);
+    stats.inFlight = (uint32_t)jobs.size();
+
+    Start();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(job));
+    }
+    wake.notify_one();
+    return ticket;
+}
+
+void TextureLoader::Cancel(uint32_t ticket)
+{
+    auto it = tickets.find(ticket);
+    if (it == tickets.end()) return;
+    const std::shared_ptr<Job> job = it->second;
+    tickets.erase(it);
+    ++stats.cancelled;
+
+    std::vector<Waiter>& waiters = job->waiters;
+    waiters.erase(std::remove_if(waiters.begin(), waiters.end(),
+        [ticket](const Waiter& waiter) { return waiter.ticket == ticket; }), waiters.end());
+    if (!waiters.empty()) return;
+
+    // Nobody wants it any more; a decode in progress is left to finish and
+    // is dropped by Update unless a new request joins it first
+    std::lock_guard<std::mutex> lock(mutex);
+    if (job->state != JobState::Queued) return;
+    queue.erase(std::find(queue.begin(), queue.end(), job));
+    jobs.erase(job->key);
+    stats.inFlight = (uint32_t)jobs.size();
+}
+
+void TextureLoader::Complete(uint32_t ticket)
+{
+    auto it = tickets.find(ticket);
+    if (it == tickets.end()) return;
+    const std::shared_ptr<Job> job = it->second;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (job->state == JobState::Queued)
+    {
+        queue.erase(std::find(queue.begin(), queue.end(), job));
+        job->state = JobState::Decoding;
+        lock.unlock();
+        Decode(*job);
+        lock.lock();
+        job->state = JobState::Decoded;
+    }
+    else
+    {
+        decodedSignal.wait(lock, [&job] { return job->state == JobState::Decoded; });
+        auto at = std::find(decoded.begin(), decoded.end(), job);
+        if (at != decoded.end()) decoded.erase(at);
+    }
+    lock.unlock();
+
+    Deliver(job);
+}
+
+void TextureLoader::Update()
+{
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    stats.uploadsLastFrame = 0;
+    stats.bytesLastFrame = 0;
+
+    for (;;)
+    {
+        std::shared_ptr<Job> job;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (decoded.empty()) break;
+            const uint64_t bytes = decoded.front()->image.pixels.size();
+            if (stats.uploadsLastFrame > 0 && stats.bytesLastFrame + bytes > budget.bytesPerFrame) break;
+            job = std::move(decoded.front());
+            decoded.pop_front();
+        }
+
+        if (!job->waiters.empty())
+        {
+            ++stats.uploadsLastFrame;
+            stats.bytesLastFrame += job->image.pixels.size();
+        }
+        Deliver(job);
+
+        const double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (elapsed >= budget.millisecondsPerFrame) break;
+    }
+}
+
+void TextureLoader::Start()
+{
+    if (!workers.empty()) return;
+    for (unsigned i = 0; i < threadCount; ++i)
+    {
+        workers.emplace_back(&TextureLoader::WorkerLoop, this);
+    }
+}
+
+void TextureLoader::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        wake.wait(lock, [this] { return quit || !queue.empty(); });
+        if (quit) return;
+
+        std::shared_ptr<Job> job = std::move(queue.front());
+        queue.pop_front();
+        job->state = JobState::Decoding;
+        lock.unlock();
+        Decode(*job);
+        lock.lock();
+        // Published together, so Complete never finds it decoded but unlisted
+        job->state = JobState::Decoded;
+        decoded.push_back(std::move(job));
+        decodedSignal.notify_all();
+    }
+}
+
+void TextureLoader::Decode(Job& job)
+{
+    // The job is Decoding, so nothing else touches its results
+    try
+    {
+        job.ok = decode(job.path, job.image, job.error);
+    }
+    catch (const std::exception& e)
+    {
+        job.ok = false;
+        job.error = e.what();
+    }
+    if (!job.ok && job.error.empty()) job.error = "Failed to load " + job.path.generic_string();
+}
+
+void TextureLoader::Deliver(const std::shared_ptr<Job>& job)
+{
+    // The path may be requested again from here on, as a new load
+    auto it = jobs.find(job->key);
+    if (it != jobs.end() && it->second == job) jobs.erase(it);
+    stats.inFlight = (uint32_t)jobs.size();
+    if (job->ok) ++stats.decoded;
+    else ++stats.failed;
+
+    std::vector<Waiter> waiters = std::move(job->waiters);
+    for (const Waiter& waiter : waiters) tickets.erase(waiter.ticket);
+    for (const Waiter& waiter : waiters)
+    {
+        ++stats.delivered;
+        waiter.ready(job->ok ? &job->image : nullptr, job->error);
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ImageCodec.h"
+
+// Background image decoding for textures. Request queues a file for the
+// decode threads and returns a ticket right away; requests for a file that
+// is already queued or decoding join that load instead of starting another.
+// Decoded images wait until Update, which the render thread calls once per
+// frame, and are handed to their ready callbacks there, oldest first, until
+// the frame's byte or time budget is spent (at least one image per frame, so
+// a large one can't stall the queue). Callbacks therefore run on the thread
+// calling Update or Complete, never on a decode thread.
+class TextureLoader
+{
+public:
+    // Runs on decode threads, so it must not touch the render device.
+    using DecodeFunction = std::function<bool(const std::filesystem::path& path, Image& image, std::string& error)>;
+    // image is null when decoding failed.
+    using ReadyFunction = std::function<void(const Image* image, const std::string& error)>;
+
+    struct Budget
+    {
+        uint64_t bytesPerFrame = 8u << 20;
+        double millisecondsPerFrame = 2.0;
+    };
+
+    struct Stats
+    {
+        uint32_t requests = 0;
+        uint32_t coalesced = 0;     // requests that joined a load in flight
+        uint32_t decoded = 0;
+        uint32_t failed = 0;
+        uint32_t delivered = 0;     // tickets whose callback ran
+        uint32_t cancelled = 0;
+        uint32_t inFlight = 0;      // loads not delivered yet
+        uint32_t uploadsLastFrame = 0;
+        uint64_t bytesLastFrame = 0;
+    };
+
+    // 0 threads: half the hardware cores, at least one. Threads start with
+    // the first request.
+    explicit TextureLoader(DecodeFunction decode, unsigned threadCount = 0);
+    ~TextureLoader();
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    // Tickets are never 0.
+    uint32_t Request(const std::filesystem::path& path, ReadyFunction ready);
+    // The callback won't run. The decode itself still finishes if it started.
+    void Cancel(uint32_t ticket);
+    // Blocks until the ticket's image is decoded (decoding it on this thread
+    // if no decode thread has picked it up yet), then delivers it to every
+    // request of that load, ignoring the budget.
+    void Complete(uint32_t ticket);
+    bool IsPending(uint32_t ticket) const { return tickets.count(ticket) != 0; }
+
+    void Update();
+
+    void SetBudget(const Budget& budget_) { budget = budget_; }
+    const Budget& GetBudget() const { return budget; }
+    const Stats& GetStats() const { return stats; }
+
+private:
+    enum class JobState { Queued, Decoding, Decoded };
+
+    struct Waiter
+    {
+        uint32_t ticket;
+        ReadyFunction ready;
+    };
+
+    struct Job
+    {
+        std::filesystem::path path;
+        std::string key;
+        std::vector<Waiter> waiters;    // render thread only
+
+        // state is guarded by mutex; the results belong to whoever set it
+        // to Decoding, and are read-only once it is Decoded
+        JobState state = JobState::Queued;
+        Image image;
+        std::string error;
+        bool ok = false;
+    };
+
+    void Start();
+    void WorkerLoop();
+    void Decode(Job& job);
+    void Deliver(const std::shared_ptr<Job>& job);
+
+    DecodeFunction decode;
+    unsigned threadCount;
+    Budget budget;
+    Stats stats;
+
+    // Render thread only
+    uint32_t nextTicket = 1;
+    std::unordered_map<std::string, std::shared_ptr<Job>> jobs;    // by path, until delivered
+    std::unordered_map<uint32_t, std::shared_ptr<Job>> tickets;
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable decodedSignal;
+    std::deque<std::shared_ptr<Job>> queue;
+    std::deque<std::shared_ptr<Job>> decoded;
+    bool quit = false;
+};
@@ -1,36 +1,136 @@
 #include "TextureManager.h"
 
+#include <memory>
+
 #include "Engine.h"
 #include "TextureDX11.h"
 
-TextureDX11* TextureManager::Load(ID3D11Device* device, ID3D11DeviceContext* ctx,
+TextureManager::TextureManager()
+    : loader(&TextureDX11::DecodeFile)
+{
+}
+
+TextureDX11* TextureManager::Load(IRenderDevice& device,
     const std::filesystem::path& filePath, bool enableTexel)
 {
     Key key{ filePath, enableTexel };
 
-    auto it = pathToTexture.find(key);
-    if (it == pathToTexture.end())
+    if (TextureDX11* tex = Find(key))
     {
-        auto* tex = new TextureDX11(device, ctx, filePath, enableTexel);
-        pathToTexture.emplace(key, tex);
+        tex->CompleteLoad();
         return tex;
     }
-    return it->second;
+    return Insert(key, new TextureDX11(device, filePath, enableTexel));
 }
 
 TextureDX11* TextureManager::Load(const std::filesystem::path& filePath, bool enableTexel)
 {
-    return Load(Engine::GetDXDevice(), Engine::GetDXContext(), filePath, enableTexel);
+    return Load(Engine::GetRenderDevice(), filePath, enableTexel);
+}
+
+TextureDX11* TextureManager::LoadAsync(IRenderDevice& device,
+    const std::filesystem::path& filePath, bool enableTexel)
+{
+    Key key{ filePath, enableTexel };
+
+    if (TextureDX11* tex = Find(key)) return tex;
+    auto tex = std::make_unique<TextureDX11>();
+    tex->LoadAsync(device, loader, filePath);
+    return Insert(key, tex.release());
+}
+
+TextureDX11* TextureManager::LoadAsync(const std::filesystem::path& filePath, bool enableTexel)
+{
+    return LoadAsync(Engine::GetRenderDevice(), filePath, enableTexel);
+}
+
+void TextureManager::Release(const TextureDX11* texture)
+{
+    auto it = textureToPath.find(texture);
+    if (it == textureToPath.end()) return;
+    Entry& entry = pathToTexture.at(it->second);
+    if (entry.refs == 0) return;
+
+    if (--entry.refs == 0)
+    {
+        // Kept for the next Load; Trim and new textures evict it
+        entry.idle = idle.insert(idle.end(), it->second);
+        --stats.referenced;
+    }
+}
+
+void TextureManager::SetBudget(uint64_t bytes)
+{
+    budgetBytes = bytes;
+    Trim();
+}
+
+void TextureManager::Trim()
+{
+    while (stats.residentBytes > budgetBytes && !idle.empty())
+    {
+        auto it = pathToTexture.find(idle.front());
+        idle.pop_front();
+        stats.residentBytes -= it->second.bytes;
+        --stats.textures;
+        ++stats.evictions;
+        textureToPath.erase(it->second.texture);
+        delete it->second.texture;
+        pathToTexture.erase(it);
+    }
+}
+
+void TextureManager::Update()
+{
+    loader.Update();
 }
 
 void TextureManager::Unload()
 {
     Engine::GetLogger().LogEvent("Clear Textures");
 
-    for (auto& [key, tex] : pathToTexture)
+    for (auto& [key, entry] : pathToTexture)
     {
-        delete tex;
-        tex = nullptr;
+        delete entry.texture;
+        entry.texture = nullptr;
     }
     pathToTexture.clear();
+    textureToPath.clear();
+    idle.clear();
+    stats.residentBytes = 0;
+    stats.textures = 0;
+    stats.referenced = 0;
+}
+
+TextureDX11* TextureManager::Find(const Key& key)
+{
+    auto it = pathToTexture.find(key);
+    if (it == pathToTexture.end()) return nullptr;
+
+    Entry& entry = it->second;
+    if (entry.refs++ == 0)
+    {
+        idle.erase(entry.idle);
+        ++stats.referenced;
+    }
+    ++stats.hits;
+    return entry.texture;
+}
+
+TextureDX11* TextureManager::Insert(const Key& key, TextureDX11* texture)
+{
+    Entry entry;
+    entry.texture = texture;
+    entry.refs = 1;
+    // Known before an async load finishes: the size comes from the header
+    entry.bytes = texture->GetByteSize();
+    pathToTexture.emplace(key, entry);
+    textureToPath.emplace(texture, key);
+
+    ++stats.misses;
+    ++stats.textures;
+    ++stats.referenced;
+    stats.residentBytes += entry.bytes;
+    Trim();
+    return texture;
 }
@@ -1,22 +1,86 @@
 #pragma once
+#include <cstdint>
 #include <filesystem>
+#include <list>
 #include <map>
+#include <unordered_map>
 #include <utility>
 
+#include "TextureLoader.h"
+
 class TextureDX11;
-struct ID3D11Device;
-struct ID3D11DeviceContext;
+class IRenderDevice;
 
+// Reference-counted texture cache. Every Load/LoadAsync adds a reference the
+// caller gives back with Release. Textures nobody references stay resident,
+// so a state that comes back finds them without decoding again, until the
+// cache is over its memory budget; then the longest unreferenced go first.
+// Referenced textures are never evicted, so while they alone add up to more
+// than the budget the cache stays over it.
 class TextureManager
 {
 public:
-    TextureDX11* Load(ID3D11Device* device, ID3D11DeviceContext* ctx,
+    static constexpr uint64_t DefaultBudgetBytes = 256ull << 20;
+
+    struct Stats
+    {
+        uint64_t residentBytes = 0;
+        uint32_t textures = 0;
+        uint32_t referenced = 0;
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+        uint32_t evictions = 0;
+
+        double GetHitRate() const { return hits + misses ? (double)hits / (hits + misses) : 0.0; }
+    };
+
+    TextureManager();
+
+    TextureDX11* Load(IRenderDevice& device,
         const std::filesystem::path& filePath, bool enableTexel);
     TextureDX11* Load(const std::filesystem::path& filePath, bool enableTexel);
+    // Decodes on the loader's threads and returns a texture that draws a
+    // placeholder until Update uploads it. A later Load of the same texture
+    // waits for it instead.
+    TextureDX11* LoadAsync(IRenderDevice& device,
+        const std::filesystem::path& filePath, bool enableTexel);
+    TextureDX11* LoadAsync(const std::filesystem::path& filePath, bool enableTexel);
+    // Drops a reference from Load/LoadAsync. Unknown textures are ignored,
+    // e.g. ones already freed by Unload.
+    void Release(const TextureDX11* texture);
 
+    // Unreferenced bytes are evicted while the resident total is above this.
+    void SetBudget(uint64_t bytes);
+    uint64_t GetBudget() const { return budgetBytes; }
+    // Evicts down to the budget; Load does this for every new texture.
+    void Trim();
+
+    // Uploads finished loads within the loader's budget; once per frame.
+    void Update();
+    TextureLoader& GetLoader() { return loader; }
+    const Stats& GetStats() const { return stats; }
+
+    // Frees every texture, referenced or not; for shutdown.
     void Unload();
     
 private:
     using Key = std::pair<std::filesystem::path, bool>;
-    std::map<Key, TextureDX11*> pathToTexture;
+
+    struct Entry
+    {
+        TextureDX11* texture = nullptr;
+        uint32_t refs = 0;
+        uint64_t bytes = 0;
+        std::list<Key>::iterator idle;      // into idle, while refs == 0
+    };
+
+    TextureDX11* Find(const Key& key);
+    TextureDX11* Insert(const Key& key, TextureDX11* texture);
+
+    TextureLoader loader;
+    std::map<Key, Entry> pathToTexture;
+    std::unordered_map<const TextureDX11*, Key> textureToPath;
+    std::list<Key> idle;                    // unreferenced, least recently released first
+    uint64_t budgetBytes = DefaultBudgetBytes;
+    Stats stats;
 };
@@ -0,0 +1,279 @@
+#include "Tilemap.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "TilemapFormat.h"
+
+namespace
+{
+    constexpr float UnitQuad[8] = { 0, 0, 1, 0, 1, 1, 0, 1 };
+    constexpr uint16_t QuadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+}
+
+Tilemap::Tilemap(uint32_t chunkTiles_, uint32_t maxResidentChunks_)
+    : chunkTiles(std::max(chunkTiles_, 1u))
+    , maxResidentChunks(std::max(maxResidentChunks_, 1u))
+{
+}
+
+Tilemap::~Tilemap()
+{
+    Shutdown();
+}
+
+void Tilemap::Init(IRenderDevice& device_, TransientAllocator& transient_)
+{
+    Shutdown();
+    device = &device_;
+    transient = &transient_;
+
+    pipeline = device->CreatePipeline(MakeInstancedSpritePipelineDesc());
+    cornerBuffer = device->CreateBuffer({ BufferType::Vertex, ResourceUsage::Immutable, sizeof(UnitQuad) }, UnitQuad);
+    indexBuffer = device->CreateBuffer({ BufferType::Index, ResourceUsage::Immutable, sizeof(QuadIndices) }, QuadIndices);
+}
+
+void Tilemap::Shutdown()
+{
+    if (!device) return;
+
+    // Tiles stay; chunks are baked again on the next device
+    for (uint32_t index : resident) Evict(index);
+    resident.clear();
+
+    device->Destroy(pipeline);
+    device->Destroy(cornerBuffer);
+    device->Destroy(indexBuffer);
+
+    pipeline = {};
+    cornerBuffer = {};
+    indexBuffer = {};
+    device = nullptr;
+    transient = nullptr;
+}
+
+void Tilemap::Create(uint32_t width_, uint32_t height_, const Tileset& tileset_)
+{
+    Clear();
+    width = width_;
+    height = height_;
+    tiles.assign((size_t)width * height, TilemapInfo::Empty);
+    tileset = tileset_;
+    BuildTileUVs();
+
+    chunksX = (width + chunkTiles - 1) / chunkTiles;
+    chunksY = (height + chunkTiles - 1) / chunkTiles;
+    chunks.assign((size_t)chunksX * chunksY, Chunk{});
+}
+
+void Tilemap::Load(const TilemapInfo& info, const Tileset& tileset_)
+{
+    Tileset merged = tileset_;
+    merged.tileWidth = info.tileWidth;
+    merged.tileHeight = info.tileHeight;
+    merged.margin = info.margin;
+    merged.spacing = info.spacing;
+    Create(info.width, info.height, merged);
+    if (info.tiles.size() == tiles.size()) tiles = info.tiles;
+}
+
+void Tilemap::Clear()
+{
+    for (uint32_t index : resident) Evict(index);
+    resident.clear();
+    chunks.clear();
+    tiles.clear();
+    tileUVs.clear();
+    width = height = 0;
+    chunksX = chunksY = 0;
+}
+
+void Tilemap::SetTile(uint32_t x, uint32_t y, uint16_t tile)
+{
+    if (x >= width || y >= height) return;
+    uint16_t& slot = tiles[(size_t)y * width + x];
+    if (slot == tile) return;
+    slot = tile;
+    // Baked again the next time the chunk is seen
+    chunks[(size_t)(y / chunkTiles) * chunksX + x / chunkTiles].dirty = true;
+}
+
+uint16_t Tilemap::GetTile(uint32_t x, uint32_t y) const
+{
+    if (x >= width || y >= height) return TilemapInfo::Empty;
+    return tiles[(size_t)y * width + x];
+}
+
+void Tilemap::SetOrigin(float x, float y)
+{
+    if (x == originX && y == originY) return;
+    originX = x;
+    originY = y;
+    // Positions are baked into the chunks
+    for (Chunk& chunk : chunks) chunk.dirty = true;
+}
+
+void Tilemap::Draw(const float worldToScreen[6], const Aabb& view, float screenWidth, float screenHeight)
+{
+    ++frame;
+    drawStats = {};
+    drawStats.chunks = (uint32_t)chunks.size();
+    if (!device || chunks.empty() || tileset.tileWidth == 0 || tileset.tileHeight == 0) return;
+
+    // The chunk range under the view, straight from the grid
+    const float chunkW = (float)chunkTiles * tileset.tileWidth;
+    const float chunkH = (float)chunkTiles * tileset.tileHeight;
+    const float fx0 = std::floor((view.minX - originX) / chunkW);
+    const float fy0 = std::floor((view.minY - originY) / chunkH);
+    const float fx1 = std::floor((view.maxX - originX) / chunkW);
+    const float fy1 = std::floor((view.maxY - originY) / chunkH);
+    if (!(fx1 >= 0.f && fy1 >= 0.f && fx0 < (float)chunksX && fy0 < (float)chunksY)) return;
+    const uint32_t cx0 = (uint32_t)std::max(fx0, 0.f);
+    const uint32_t cy0 = (uint32_t)std::max(fy0, 0.f);
+    const uint32_t cx1 = (uint32_t)std::min(fx1, (float)(chunksX - 1));
+    const uint32_t cy1 = (uint32_t)std::min(fy1, (float)(chunksY - 1));
+
+    bool bound = false;
+    for (uint32_t cy = cy0; cy <= cy1; ++cy)
+    {
+        for (uint32_t cx = cx0; cx <= cx1; ++cx)
+        {
+            Chunk& chunk = chunks[(size_t)cy * chunksX + cx];
+            chunk.lastSeen = frame;
+            ++drawStats.chunksVisible;
+            if (chunk.dirty) Rebuild(cx, cy);
+            if (chunk.count == 0) continue;
+
+            if (!bound)
+            {
+                float projection[16];
+                MakeSpriteProjection(worldToScreen, screenWidth, screenHeight, projection);
+                const TransientAllocation cbRange = transient->UploadConstants(projection, sizeof(projection));
+                if (!cbRange) return;
+                device->SetPipeline(pipeline);
+                device->SetConstantBuffer(0, cbRange.buffer, cbRange.offset, cbRange.size);
+                device->SetIndexBuffer(indexBuffer, IndexFormat::UInt16);
+                device->SetVertexBuffer(0, cornerBuffer, sizeof(float) * 2, 0);
+                device->SetTexture(0, tileset.texture);
+                bound = true;
+            }
+            device->SetVertexBuffer(1, chunk.instances, sizeof(SpriteInstance), 0);
+            device->DrawIndexedInstanced(6, chunk.count, 0, 0, 0);
+            ++drawStats.chunksDrawn;
+            ++drawStats.drawCalls;
+            drawStats.tiles += chunk.count;
+        }
+    }
+
+    EvictUnseen();
+    drawStats.resident = (uint32_t)resident.size();
+}
+
+void Tilemap::BuildTileUVs()
+{
+    tileUVs.clear();
+    const uint32_t tw = tileset.tileWidth, th = tileset.tileHeight;
+    const uint32_t stepX = tw + tileset.spacing, stepY = th + tileset.spacing;
+    if (tw == 0 || th == 0 || tileset.textureWidth < 2u * tileset.margin + tw || tileset.textureHeight < 2u * tileset.margin + th) return;
+
+    const uint32_t columns = (tileset.textureWidth - 2u * tileset.margin + tileset.spacing) / stepX;
+    const uint32_t rows = (tileset.textureHeight - 2u * tileset.margin + tileset.spacing) / stepY;
+    const float invW = 1.f / (float)tileset.textureWidth;
+    const float invH = 1.f / (float)tileset.textureHeight;
+    tileUVs.reserve((size_t)columns * rows * 4);
+    for (uint32_t row = 0; row < rows; ++row)
+    {
+        for (uint32_t column = 0; column < columns; ++column)
+        {
+            const uint32_t x = tileset.margin + column * stepX;
+            const uint32_t y = tileset.margin + row * stepY;
+            tileUVs.push_back(PackUNorm16((float)x * invW));
+            tileUVs.push_back(PackUNorm16((float)y * invH));
+            tileUVs.push_back(PackUNorm16((float)(x + tw) * invW));
+            tileUVs.push_back(PackUNorm16((float)(y + th) * invH));
+        }
+    }
+}
+
+void Tilemap::Rebuild(uint32_t cx, uint32_t cy)
+{
+    const uint32_t index = cy * chunksX + cx;
+    Chunk& chunk = chunks[index];
+    const bool wasResident = static_cast<bool>(chunk.instances);
+    device->Destroy(chunk.instances);
+    chunk.instances = {};
+    chunk.dirty = false;
+    ++drawStats.rebuilds;
+
+    const float tw = tileset.tileWidth, th = tileset.tileHeight;
+    const uint32_t tileCount = (uint32_t)(tileUVs.size() / 4);
+    const uint32_t x0 = cx * chunkTiles, x1 = std::min(x0 + chunkTiles, width);
+    const uint32_t y0 = cy * chunkTiles, y1 = std::min(y0 + chunkTiles, height);
+
+    instances.clear();
+    for (uint32_t y = y0; y < y1; ++y)
+    {
+        const uint16_t* row = &tiles[(size_t)y * width];
+        for (uint32_t x = x0; x < x1; ++x)
+        {
+            const uint32_t tile = row[x];
+            if (tile == TilemapInfo::Empty || tile > tileCount) continue;
+
+            SpriteInstance& instance = instances.emplace_back();
+            instance.transform[0] = tw;
+            instance.transform[1] = 0.f;
+            instance.transform[2] = 0.f;
+            instance.transform[3] = th;
+            instance.transform[4] = originX + (float)x * tw;
+            instance.transform[5] = originY + (float)y * th;
+            std::copy_n(&tileUVs[(size_t)(tile - 1) * 4], 4, instance.uvRect);
+            instance.color = 0xFFFFFFFF;
+        }
+    }
+
+    chunk.count = (uint32_t)instances.size();
+    if (chunk.count > 0)
+    {
+        chunk.instances = device->CreateBuffer({ BufferType::Vertex, ResourceUsage::Immutable,
+            (uint32_t)(instances.size() * sizeof(SpriteInstance)) }, instances.data());
+    }
+
+    const bool isResident = static_cast<bool>(chunk.instances);
+    if (isResident && !wasResident)
+    {
+        resident.push_back(index);
+    }
+    else if (!isResident && wasResident)
+    {
+        auto it = std::find(resident.begin(), resident.end(), index);
+        *it = resident.back();
+        resident.pop_back();
+    }
+}
+
+void Tilemap::Evict(uint32_t index)
+{
+    // Leaves the resident list to the caller
+    Chunk& chunk = chunks[index];
+    device->Destroy(chunk.instances);
+    chunk.instances = {};
+    chunk.count = 0;
+    chunk.dirty = true;
+}
+
+void Tilemap::EvictUnseen()
+{
+    if (resident.size() <= maxResidentChunks) return;
+
+    // Oldest first; chunks seen this frame are never dropped
+    std::sort(resident.begin(), resident.end(), [this](uint32_t a, uint32_t b) { return chunks[a].lastSeen < chunks[b].lastSeen; });
+    size_t drop = resident.size() - maxResidentChunks;
+    size_t dropped = 0;
+    while (dropped < drop && chunks[resident[dropped]].lastSeen != frame)
+    {
+        Evict(resident[dropped]);
+        ++dropped;
+        ++drawStats.evictions;
+    }
+    resident.erase(resident.begin(), resident.begin() + dropped);
+}
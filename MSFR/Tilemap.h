@@ -0,0 +1,117 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "SpatialGrid.h"
+#include "SpriteBatch.h"
+
+struct TilemapInfo;
+
+// Tile layer drawn from a grid of tileset indices. The map is split into
+// square chunks; each chunk bakes its non-empty tiles into an immutable
+// SpriteInstance buffer the first time it is seen, and again only after one
+// of its tiles changes. A frame walks the chunk range under the view (no
+// per-tile or per-chunk culling structure) and issues one instanced draw per
+// chunk. Baked chunks that leave the view stay resident until more than
+// maxResidentChunks are baked, then the longest unseen are dropped, so GPU
+// memory follows what is visible rather than the map size.
+class Tilemap
+{
+public:
+    static constexpr uint32_t DefaultChunkTiles = 32;
+    static constexpr uint32_t DefaultMaxResidentChunks = 256;
+
+    struct Tileset
+    {
+        TextureHandle texture;
+        uint32_t textureWidth = 0;
+        uint32_t textureHeight = 0;
+        uint16_t tileWidth = 0;
+        uint16_t tileHeight = 0;
+        uint16_t margin = 0;
+        uint16_t spacing = 0;
+    };
+
+    struct DrawStats
+    {
+        uint32_t chunks = 0;          // in the whole map
+        uint32_t chunksVisible = 0;
+        uint32_t chunksDrawn = 0;     // visible and not empty
+        uint32_t resident = 0;        // chunks with a baked buffer
+        uint32_t rebuilds = 0;
+        uint32_t evictions = 0;
+        uint32_t tiles = 0;
+        uint32_t drawCalls = 0;
+    };
+
+    explicit Tilemap(uint32_t chunkTiles = DefaultChunkTiles, uint32_t maxResidentChunks = DefaultMaxResidentChunks);
+    ~Tilemap();
+
+    Tilemap(const Tilemap&) = delete;
+    Tilemap& operator=(const Tilemap&) = delete;
+
+    void Init(IRenderDevice& device, TransientAllocator& transient);
+    void Shutdown();
+
+    // Tile values as in TilemapInfo: 0 empty, v > 0 is tileset tile v - 1.
+    void Create(uint32_t width, uint32_t height, const Tileset& tileset);
+    // Takes the size and tiles from info; the texture comes from the caller.
+    void Load(const TilemapInfo& info, const Tileset& tileset);
+    void Clear();
+
+    void SetTile(uint32_t x, uint32_t y, uint16_t tile);
+    uint16_t GetTile(uint32_t x, uint32_t y) const;
+
+    // World position of tile (0, 0)'s bottom-left corner; a tile is
+    // tileWidth x tileHeight world units.
+    void SetOrigin(float x, float y);
+
+    // Same conventions as StaticSpriteBatch::Draw.
+    void Draw(const float worldToScreen[6], const Aabb& view, float screenWidth, float screenHeight);
+
+    uint32_t GetWidth() const { return width; }
+    uint32_t GetHeight() const { return height; }
+    const DrawStats& GetDrawStats() const { return drawStats; }
+
+private:
+    struct Chunk
+    {
+        BufferHandle instances;
+        uint32_t count = 0;         // non-empty tiles baked
+        uint64_t lastSeen = 0;
+        bool baked = false;
+        bool dirty = true;
+    };
+
+    void BuildTileUVs();
+    void Rebuild(uint32_t chunkX, uint32_t chunkY);
+    void Evict(uint32_t index);
+    void EvictUnseen();
+
+    uint32_t chunkTiles;
+    uint32_t maxResidentChunks;
+
+    IRenderDevice* device = nullptr;
+    TransientAllocator* transient = nullptr;
+    PipelineHandle pipeline;
+    BufferHandle cornerBuffer;
+    BufferHandle indexBuffer;
+
+    Tileset tileset;
+    std::vector<uint16_t> tileUVs;   // 4 UNorm16 per tileset tile
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint16_t> tiles;
+    float originX = 0.f;
+    float originY = 0.f;
+
+    uint32_t chunksX = 0;
+    uint32_t chunksY = 0;
+    std::vector<Chunk> chunks;
+    std::vector<uint32_t> resident;  // chunks[] with a baked buffer
+    uint64_t frame = 0;
+
+    std::vector<SpriteInstance> instances;
+    DrawStats drawStats;
+};
@@ -0,0 +1,119 @@
+#include "TilemapFormat.h"
+
+#include <istream>
+#include <ostream>
+
+namespace
+{
+    constexpr char Magic[4] = { 'T', 'M', 'A', 'P' };
+    constexpr uint32_t Version = 1;
+    // Far beyond any sane map; guards the allocation against a corrupt header
+    constexpr uint64_t MaxTiles = 1ull << 28;
+    constexpr uint32_t MaxPathLength = 4096;
+
+    bool ReadU16(std::istream& in, uint16_t& value)
+    {
+        unsigned char b[2];
+        if (!in.read(reinterpret_cast<char*>(b), 2)) return false;
+        value = static_cast<uint16_t>(b[0] | b[1] << 8);
+        return true;
+    }
+
+    bool ReadU32(std::istream& in, uint32_t& value)
+    {
+        unsigned char b[4];
+        if (!in.read(reinterpret_cast<char*>(b), 4)) return false;
+        value = static_cast<uint32_t>(b[0]) | static_cast<uint32_t>(b[1]) << 8
+            | static_cast<uint32_t>(b[2]) << 16 | static_cast<uint32_t>(b[3]) << 24;
+        return true;
+    }
+
+    void WriteU16(std::ostream& out, uint16_t value)
+    {
+        const char b[2] = { static_cast<char>(value & 0xFF), static_cast<char>(value >> 8) };
+        out.write(b, 2);
+    }
+
+    void WriteU32(std::ostream& out, uint32_t value)
+    {
+        const char b[4] = { static_cast<char>(value & 0xFF), static_cast<char>(value >> 8 & 0xFF),
+            static_cast<char>(value >> 16 & 0xFF), static_cast<char>(value >> 24) };
+        out.write(b, 4);
+    }
+}
+
+bool ReadTilemap(std::istream& in, TilemapInfo& info, std::vector<std::string>& errors)
+{
+    info = {};
+
+    char magic[4] = {};
+    uint32_t version = 0;
+    if (!in.read(magic, 4) || std::char_traits<char>::compare(magic, Magic, 4) != 0)
+    {
+        errors.push_back("Not a tilemap file");
+        return false;
+    }
+    if (!ReadU32(in, version) || version != Version)
+    {
+        errors.push_back("Unsupported tilemap version " + std::to_string(version));
+        return false;
+    }
+
+    uint32_t pathLength = 0;
+    if (!ReadU32(in, info.width) || !ReadU32(in, info.height)
+        || !ReadU16(in, info.tileWidth) || !ReadU16(in, info.tileHeight)
+        || !ReadU16(in, info.margin) || !ReadU16(in, info.spacing)
+        || !ReadU32(in, pathLength))
+    {
+        errors.push_back("Truncated tilemap header");
+        return false;
+    }
+    const uint64_t count = static_cast<uint64_t>(info.width) * info.height;
+    if (count == 0 || count > MaxTiles || info.tileWidth == 0 || info.tileHeight == 0 || pathLength > MaxPathLength)
+    {
+        errors.push_back("Bad tilemap header");
+        return false;
+    }
+
+    info.tileset.resize(pathLength);
+    if (pathLength > 0 && !in.read(&info.tileset[0], pathLength))
+    {
+        errors.push_back("Truncated tilemap header");
+        return false;
+    }
+
+    info.tiles.resize(static_cast<size_t>(count));
+    std::vector<unsigned char> raw(static_cast<size_t>(count) * 2);
+    if (!in.read(reinterpret_cast<char*>(raw.data()), static_cast<std::streamsize>(raw.size())))
+    {
+        errors.push_back("Truncated tilemap data");
+        return false;
+    }
+    for (size_t i = 0; i < info.tiles.size(); ++i)
+    {
+        info.tiles[i] = static_cast<uint16_t>(raw[i * 2] | raw[i * 2 + 1] << 8);
+    }
+    return true;
+}
+
+void WriteTilemap(std::ostream& out, const TilemapInfo& info)
+{
+    out.write(Magic, 4);
+    WriteU32(out, Version);
+    WriteU32(out, info.width);
+    WriteU32(out, info.height);
+    WriteU16(out, info.tileWidth);
+    WriteU16(out, info.tileHeight);
+    WriteU16(out, info.margin);
+    WriteU16(out, info.spacing);
+    WriteU32(out, static_cast<uint32_t>(info.tileset.size()));
+    out.write(info.tileset.data(), static_cast<std::streamsize>(info.tileset.size()));
+
+    std::vector<unsigned char> raw(info.tiles.size() * 2);
+    for (size_t i = 0; i < info.tiles.size(); ++i)
+    {
+        raw[i * 2] = static_cast<unsigned char>(info.tiles[i] & 0xFF);
+        raw[i * 2 + 1] = static_cast<unsigned char>(info.tiles[i] >> 8);
+    }
+    out.write(reinterpret_cast<const char*>(raw.data()), static_cast<std::streamsize>(raw.size()));
+}
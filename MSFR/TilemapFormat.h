@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// In-memory form of a tilemap (.tmap) file. The file is binary, little-endian:
+//   char[4]  "TMAP"
+//   uint32   version (1)
+//   uint32   width, height             map size in tiles
+//   uint16   tileWidth, tileHeight     texels per tile in the tileset
+//   uint16   margin, spacing           texels around / between tileset tiles
+//   uint32   length, char[length]      tileset texture path, relative to the file
+//   uint16   tiles[width * height]     row-major, row 0 at the bottom
+// A tile value of 0 is empty; v > 0 is tileset tile v - 1, counted left to
+// right, top to bottom. Two bytes per tile keeps a 1024x1024 map at 2 MB.
+struct TilemapInfo
+{
+    static constexpr uint16_t Empty = 0;
+
+    std::string tileset;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint16_t tileWidth = 0;
+    uint16_t tileHeight = 0;
+    uint16_t margin = 0;
+    uint16_t spacing = 0;
+    std::vector<uint16_t> tiles;
+};
+
+bool ReadTilemap(std::istream& in, TilemapInfo& info, std::vector<std::string>& errors);
+void WriteTilemap(std::ostream& out, const TilemapInfo& info);
@@ -0,0 +1,334 @@
+// Offline asset pack builder.
+//
+// Writes the files under the given paths into one pack (layout in
+// AssetPack.h) that the game maps at startup, so each asset read is a
+// lookup in the sorted table of contents and a pointer into the mapping
+// instead of an open, a seek and a copy. Paths are stored relative to
+// --root, which should be the directory the game runs in.
+// A source with a cooked file next to it (a .dds from Tools/TextureCooker.cpp,
+// a .sptc or .anmc from Tools/SpriteCooker.cpp) is packed as the cooked file
+// only, since that's all the game reads; a cooked file older than its source
+// is left out instead, with a warning.
+//
+// Build (Linux, from MSFR/):
+//   g++ -std=c++17 -O2 -I. Tools/AssetPacker.cpp AssetPack.cpp ImageCodec.cpp JpegCodec.cpp -o assetpacker
+//
+// Usage:
+//   assetpacker -o <pack> [options] path...   (files, or directories searched recursively)
+//     --root <dir>     directory pack paths are relative to (default: current directory)
+//     --align <n>      entry alignment in bytes, a power of two from 4 (default: 16)
+//     --compress       zlib entries that shrink by at least an eighth; those are
+//                      inflated on every read instead of mapped
+//   assetpacker --list <pack>
+//     prints the table of contents and reads back every entry
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../AssetPack.h"
+#include "../Hash.h"
+#include "../ImageCodec.h"
+
+namespace
+{
+    struct Options
+    {
+        std::filesystem::path output;
+        std::filesystem::path root = ".";
+        std::filesystem::path list;
+        uint32_t alignment = 16;
+        bool compress = false;
+        std::vector<std::filesystem::path> inputs;
+    };
+
+    bool ParseUInt(const char* text, uint32_t& out)
+    {
+        char* end = nullptr;
+        const unsigned long v = std::strtoul(text, &end, 10);
+        if (end == text || *end != '\0' || v > 0xFFFFFFFFul) return false;
+        out = (uint32_t)v;
+        return true;
+    }
+
+    bool ParseArgs(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if ((arg == "-o" || arg == "--root" || arg == "--list") && !hasValue)
+            {
+                std::fprintf(stderr, "assetpacker: %s needs a path\n", arg.c_str());
+                return false;
+            }
+            if (arg == "-o") options.output = argv[++i];
+            else if (arg == "--root") options.root = argv[++i];
+            else if (arg == "--list") options.list = argv[++i];
+            else if (arg == "--align")
+            {
+                uint32_t& a = options.alignment;
+                if (!hasValue || !ParseUInt(argv[++i], a) || a < PackFormat::MinAlignment || (a & (a - 1)) != 0 || a > 65536)
+                {
+                    std::fprintf(stderr, "assetpacker: --align needs a power of two from 4 to 65536\n");
+                    return false;
+                }
+            }
+            else if (arg == "--compress") options.compress = true;
+            else if (arg.size() > 1 && arg[0] == '-')
+            {
+                std::fprintf(stderr, "assetpacker: unknown option %s\n", arg.c_str());
+                return false;
+            }
+            else
+            {
+                options.inputs.emplace_back(arg);
+            }
+        }
+        if (options.list.empty() && (options.output.empty() || options.inputs.empty()))
+        {
+            std::fprintf(stderr, "usage: assetpacker -o <pack> [--root dir] [--align n] [--compress] path...\n"
+                "       assetpacker --list <pack>\n");
+            return false;
+        }
+        return true;
+    }
+
+    // Extension of the cooked form of a source file, or null
+    const char* GetCookedExtension(const std::filesystem::path& path)
+    {
+        std::string ext = path.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+        if (ext == ".png" || ext == ".jpg" || ext == ".jpeg") return ".dds";
+        if (ext == ".spt") return ".sptc";
+        if (ext == ".anm") return ".anmc";
+        return nullptr;
+    }
+
+    // Pack path to file on disk
+    using FileMap = std::map<std::string, std::filesystem::path>;
+
+    bool Collect(const std::filesystem::path& input, const Options& options, FileMap& files)
+    {
+        std::error_code ec;
+        std::vector<std::filesystem::path> found;
+        if (std::filesystem::is_directory(input, ec))
+        {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(input, ec))
+            {
+                if (entry.is_regular_file()) found.push_back(entry.path());
+            }
+        }
+        else if (std::filesystem::is_regular_file(input, ec))
+        {
+            found.push_back(input);
+        }
+        else
+        {
+            std::fprintf(stderr, "assetpacker: %s not found\n", input.string().c_str());
+            return false;
+        }
+
+        const std::filesystem::path root = std::filesystem::absolute(options.root, ec).lexically_normal();
+        const std::filesystem::path output = std::filesystem::absolute(options.output, ec).lexically_normal();
+        for (const std::filesystem::path& file : found)
+        {
+            const std::filesystem::path absolute = std::filesystem::absolute(file, ec).lexically_normal();
+            if (absolute == output) continue;
+            const std::string key = GetPackPath(absolute.lexically_relative(root));
+            if (key.empty() || key.compare(0, 3, "../") == 0)
+            {
+                std::fprintf(stderr, "assetpacker: %s is outside --root\n", file.string().c_str());
+                return false;
+            }
+            files[key] = file;
+        }
+        return true;
+    }
+
+    // The game reads a packed cooked file in place of its source, see
+    // AssetFileSystem::ResolveCooked
+    void DropCookedSources(FileMap& files)
+    {
+        for (auto it = files.begin(); it != files.end();)
+        {
+            const std::string key = it->first;
+            const char* cookedExtension = GetCookedExtension(key);
+            const auto cooked = cookedExtension ? files.find(std::filesystem::path(key).replace_extension(cookedExtension).generic_string()) : files.end();
+            if (cooked == files.end())
+            {
+                ++it;
+                continue;
+            }
+
+            std::error_code ec;
+            const auto sourceTime = std::filesystem::last_write_time(it->second, ec);
+            const auto cookedTime = std::filesystem::last_write_time(cooked->second, ec);
+            if (!ec && sourceTime > cookedTime)
+            {
+                std::fprintf(stderr, "assetpacker: %s is older than %s; packing the source\n", cooked->first.c_str(), key.c_str());
+                files.erase(cooked);
+                ++it;
+            }
+            else
+            {
+                it = files.erase(it);
+            }
+        }
+    }
+
+    void Pad(std::ofstream& out, uint64_t& offset, uint64_t alignment)
+    {
+        static const char zeros[65536] = {};
+        const uint64_t padding = (alignment - offset % alignment) % alignment;
+        out.write(zeros, (std::streamsize)padding);
+        offset += padding;
+    }
+
+    int Build(const Options& options)
+    {
+        FileMap files;
+        for (const std::filesystem::path& input : options.inputs)
+        {
+            if (!Collect(input, options, files)) return 1;
+        }
+        DropCookedSources(files);
+        if (files.empty())
+        {
+            std::fprintf(stderr, "assetpacker: no files found\n");
+            return 1;
+        }
+
+        std::ofstream out(options.output, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            std::fprintf(stderr, "assetpacker: cannot write %s\n", options.output.string().c_str());
+            return 1;
+        }
+
+        // Header last, once the offsets are known
+        PackHeader header{};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        uint64_t offset = sizeof(header);
+
+        // Data in path order, so a directory's files sit together
+        std::vector<PackEntry> entries;
+        std::string names;
+        uint64_t totalSize = 0, compressedCount = 0;
+        for (const auto& [key, file] : files)
+        {
+            std::vector<uint8_t> bytes;
+            if (!LoadFile(file, bytes))
+            {
+                std::fprintf(stderr, "assetpacker: cannot read %s\n", file.string().c_str());
+                return 1;
+            }
+
+            PackEntry entry{};
+            entry.pathHash = HashString(key);
+            entry.size = bytes.size();
+            entry.nameOffset = (uint32_t)names.size();
+            entry.nameLength = (uint32_t)key.size();
+            entry.compression = PackFormat::Stored;
+            names += key;
+            totalSize += bytes.size();
+
+            if (options.compress && !bytes.empty())
+            {
+                std::vector<uint8_t> deflated = ZlibDeflate(bytes.data(), bytes.size());
+                if (deflated.size() <= bytes.size() - bytes.size() / 8)
+                {
+                    bytes = std::move(deflated);
+                    entry.compression = PackFormat::Zlib;
+                    ++compressedCount;
+                }
+            }
+
+            Pad(out, offset, options.alignment);
+            entry.offset = offset;
+            entry.storedSize = bytes.size();
+            out.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize)bytes.size());
+            offset += bytes.size();
+            entries.push_back(entry);
+        }
+
+        std::sort(entries.begin(), entries.end(), [&names](const PackEntry& a, const PackEntry& b)
+        {
+            if (a.pathHash != b.pathHash) return a.pathHash < b.pathHash;
+            return names.compare(a.nameOffset, a.nameLength, names, b.nameOffset, b.nameLength) < 0;
+        });
+
+        Pad(out, offset, alignof(PackEntry));
+        std::memcpy(header.magic, PackFormat::Magic, sizeof(header.magic));
+        header.version = PackFormat::Version;
+        header.entryCount = (uint32_t)entries.size();
+        header.alignment = options.alignment;
+        header.tocOffset = offset;
+        out.write(reinterpret_cast<const char*>(entries.data()), (std::streamsize)(entries.size() * sizeof(PackEntry)));
+        offset += entries.size() * sizeof(PackEntry);
+        header.namesOffset = offset;
+        header.namesSize = names.size();
+        out.write(names.data(), (std::streamsize)names.size());
+        offset += names.size();
+
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (!out.good())
+        {
+            std::fprintf(stderr, "assetpacker: cannot write %s\n", options.output.string().c_str());
+            return 1;
+        }
+
+        std::printf("%zu files, %u compressed; %.1f KB of assets, %.1f KB pack\n",
+            entries.size(), (uint32_t)compressedCount, totalSize / 1024.0, offset / 1024.0);
+        return 0;
+    }
+
+    int List(const Options& options)
+    {
+        AssetPack pack;
+        std::string error;
+        if (!pack.Open(options.list, &error))
+        {
+            std::fprintf(stderr, "assetpacker: %s\n", error.c_str());
+            return 1;
+        }
+
+        // Table of contents order is hash order; print by path
+        std::vector<const PackEntry*> entries;
+        for (uint32_t i = 0; i < pack.GetEntryCount(); ++i) entries.push_back(&pack.GetEntry(i));
+        std::sort(entries.begin(), entries.end(), [&pack](const PackEntry* a, const PackEntry* b)
+        {
+            return pack.GetPath(*a) < pack.GetPath(*b);
+        });
+
+        int failed = 0;
+        std::printf("%12s %12s %6s  %s\n", "size", "stored", "", "path");
+        for (const PackEntry* entry : entries)
+        {
+            const std::string path(pack.GetPath(*entry));
+            AssetBytes bytes;
+            const bool found = pack.Find(path) == entry;
+            const bool read = pack.Read(*entry, bytes) && bytes.size == entry->size;
+            if (!found || !read) ++failed;
+            std::printf("%12llu %12llu %6s  %s%s\n", (unsigned long long)entry->size, (unsigned long long)entry->storedSize,
+                entry->compression == PackFormat::Zlib ? "zlib" : "", path.c_str(),
+                !found ? "  (lookup failed)" : !read ? "  (read failed)" : "");
+        }
+        std::printf("%u entries, %d failed\n", pack.GetEntryCount(), failed);
+        return failed ? 1 : 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseArgs(argc, argv, options)) return 1;
+    return options.list.empty() ? Build(options) : List(options);
+}
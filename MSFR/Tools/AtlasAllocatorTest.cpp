@@ -0,0 +1,233 @@
+// Checks AtlasAllocator's packing, slot generations and LRU eviction.
+//
+// Skyline packing and free-rect reuse run under random allocate/free
+// traffic and are checked against every live slot: inside the page, no
+// overlap including padding, used area matching the live rects. Freed,
+// evicted and reset slots must stop resolving even once their storage is
+// reused. Eviction under a full atlas must take stale slots oldest first,
+// empty the least recently used page when no single slot is big enough, and
+// never take anything touched in the current frame.
+//
+// Build (Linux, from MSFR/):
+//   g++ -std=c++17 -O2 -I. Tools/AtlasAllocatorTest.cpp AtlasAllocator.cpp -o atlasallocatortest
+//
+// Usage:
+//   atlasallocatortest
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "../AtlasAllocator.h"
+
+namespace
+{
+    int failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (condition) return;
+        std::fprintf(stderr, "atlasallocatortest: %s\n", what);
+        ++failures;
+    }
+
+    bool Overlap(const AtlasRect& a, const AtlasRect& b)
+    {
+        return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+    }
+
+    // Content plus the padding right and below it, clipped to the page
+    AtlasRect Padded(const AtlasAllocator& atlas, const AtlasRect& rect, int padding)
+    {
+        AtlasRect padded = rect;
+        padded.width = std::min(rect.width + padding, atlas.GetPageWidth() - rect.x);
+        padded.height = std::min(rect.height + padding, atlas.GetPageHeight() - rect.y);
+        return padded;
+    }
+
+    // Every live slot in bounds and clear of every other on its page
+    bool CheckLayout(const AtlasAllocator& atlas, const std::vector<AtlasSlot>& live, int padding)
+    {
+        std::vector<uint32_t> pages(live.size());
+        std::vector<AtlasRect> rects(live.size());
+        uint64_t area = 0;
+        for (size_t i = 0; i < live.size(); ++i)
+        {
+            AtlasRect rect;
+            if (!atlas.GetRect(live[i], pages[i], rect)) return false;
+            if (rect.x < 0 || rect.y < 0 || rect.x + rect.width > atlas.GetPageWidth() || rect.y + rect.height > atlas.GetPageHeight())
+                return false;
+            rects[i] = Padded(atlas, rect, padding);
+            area += (uint64_t)rects[i].width * rects[i].height;
+        }
+        for (size_t i = 0; i < live.size(); ++i)
+        {
+            for (size_t j = i + 1; j < live.size(); ++j)
+            {
+                if (pages[i] == pages[j] && Overlap(rects[i], rects[j])) return false;
+            }
+        }
+        return atlas.GetStats().liveSlots == live.size() && atlas.GetStats().usedArea == area;
+    }
+
+    void SkylinePacking()
+    {
+        const int padding = 1;
+        AtlasAllocator atlas(256, 256, 1, padding);
+        std::vector<AtlasSlot> live;
+        uint32_t seed = 99;
+        auto next = [&seed](uint32_t n) { seed = seed * 1664525u + 1013904223u; return (int)((seed >> 8) % n); };
+        for (int i = 0; i < 2000; ++i)
+        {
+            const AtlasSlot slot = atlas.Allocate(1 + next(40), 1 + next(40));
+            if (!slot) break;
+            live.push_back(slot);
+        }
+        Check(live.size() > 40, "skyline: a page takes many small rects");
+        Check(CheckLayout(atlas, live, padding), "skyline: live rects overlap or leave the page");
+
+        // Exact fit: four quadrants fill a page with no padding
+        AtlasAllocator exact(64, 64, 1, 0);
+        const AtlasSlot quadrants[4] = { exact.Allocate(32, 32), exact.Allocate(32, 32), exact.Allocate(32, 32), exact.Allocate(32, 32) };
+        Check(quadrants[3] && CheckLayout(exact, std::vector<AtlasSlot>(quadrants, quadrants + 4), 0), "skyline: quadrants fill the page");
+        Check(exact.GetStats().usedArea == 64 * 64, "skyline: no waste for quadrants");
+    }
+
+    void FreeRectReuse()
+    {
+        const int padding = 2;
+        AtlasAllocator atlas(128, 128, 2, padding);
+        std::vector<AtlasSlot> live;
+        uint32_t seed = 4242;
+        auto next = [&seed](uint32_t n) { seed = seed * 1664525u + 1013904223u; return (int)((seed >> 8) % n); };
+
+        bool ok = true;
+        for (int step = 0; step < 20000 && ok; ++step)
+        {
+            // Every frame touches everything, so nothing is ever evicted
+            atlas.NextFrame();
+            for (AtlasSlot slot : live) atlas.Touch(slot);
+            if (live.empty() || next(100) < 55)
+            {
+                const AtlasSlot slot = atlas.Allocate(1 + next(48), 1 + next(48));
+                if (slot) live.push_back(slot);
+            }
+            else
+            {
+                const size_t victim = (size_t)next((uint32_t)live.size());
+                atlas.Free(live[victim]);
+                live[victim] = live.back();
+                live.pop_back();
+            }
+            if (step % 97 == 0) ok = CheckLayout(atlas, live, padding);
+        }
+        Check(ok && CheckLayout(atlas, live, padding), "free rects: live rects overlap or area is off");
+        Check(atlas.GetStats().evictions == 0, "free rects: touched slots are never evicted");
+
+        // A freed rect is handed out again before fresh skyline space
+        AtlasAllocator reuse(128, 128, 1, 0);
+        reuse.Allocate(32, 32);
+        const AtlasSlot middle = reuse.Allocate(32, 32);
+        reuse.Allocate(32, 32);
+        uint32_t page = 0;
+        AtlasRect before, after;
+        reuse.GetRect(middle, page, before);
+        reuse.Free(middle);
+        const AtlasSlot again = reuse.Allocate(16, 16);
+        reuse.GetRect(again, page, after);
+        Check(after.x == before.x && after.y == before.y, "free rects: reused before the skyline");
+    }
+
+    void StaleHandles()
+    {
+        AtlasAllocator atlas(64, 64, 1, 0);
+        const AtlasSlot first = atlas.Allocate(16, 16);
+        const AtlasSlot other = atlas.Allocate(16, 16);
+        atlas.Free(first);
+        uint32_t page = 0;
+        AtlasRect rect;
+        Check(!atlas.IsValid(first) && !atlas.Touch(first) && !atlas.GetRect(first, page, rect), "freed slot resolves");
+        atlas.Free(first);
+        Check(atlas.GetStats().liveSlots == 1, "freeing twice releases once");
+
+        const AtlasSlot reused = atlas.Allocate(16, 16);
+        Check((reused.id & 0xFFFFF) == (first.id & 0xFFFFF) && reused != first, "slot storage reused with a new generation");
+        Check(atlas.IsValid(reused) && !atlas.IsValid(first), "old generation resolves after reuse");
+        atlas.Free(first);
+        Check(atlas.IsValid(reused), "freeing the old generation frees the new one");
+
+        // Eviction: a full page, then a stale slot gives way
+        AtlasAllocator full(32, 32, 1, 0);
+        const AtlasSlot evicted = full.Allocate(32, 32);
+        full.NextFrame();
+        const AtlasSlot replacement = full.Allocate(32, 32);
+        Check(replacement && !full.IsValid(evicted) && !full.Touch(evicted), "evicted slot resolves");
+
+        atlas.Reset();
+        Check(!atlas.IsValid(reused) && !atlas.IsValid(other) && atlas.GetPageCount() == 0, "slots resolve after Reset");
+        Check(!atlas.IsValid(AtlasSlot{}) && !atlas.IsValid(AtlasSlot{ 0xFFFFFFFF }), "empty and unknown ids resolve");
+    }
+
+    void EvictionOrder()
+    {
+        // Four quadrants A B C D fill the only page
+        AtlasAllocator atlas(64, 64, 1, 0);
+        AtlasSlot slots[4];
+        AtlasRect rects[4];
+        uint32_t page = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            slots[i] = atlas.Allocate(32, 32);
+            atlas.GetRect(slots[i], page, rects[i]);
+        }
+        Check(!atlas.Allocate(32, 32), "full: nothing stale in the allocating frame");
+
+        // LRU becomes A, C, B, D
+        atlas.NextFrame();
+        atlas.Touch(slots[1]);
+        atlas.Touch(slots[3]);
+        atlas.NextFrame();
+
+        const int expected[4] = { 0, 2, 1, 3 };
+        for (int i = 0; i < 4; ++i)
+        {
+            const AtlasSlot slot = atlas.Allocate(32, 32);
+            AtlasRect rect;
+            atlas.GetRect(slot, page, rect);
+            const AtlasRect& want = rects[expected[i]];
+            Check(slot && !atlas.IsValid(slots[expected[i]]) && rect.x == want.x && rect.y == want.y,
+                "full: stale slots evicted least recently used first");
+        }
+        Check(atlas.GetStats().evictions == 4, "full: one eviction per allocation");
+        Check(!atlas.Allocate(32, 32) && atlas.GetStats().failedAllocations == 2, "full: slots of this frame are kept");
+
+        // No single slot fits: the least recently used page is emptied
+        AtlasAllocator pages(64, 64, 2, 0);
+        const AtlasSlot older = pages.Allocate(16, 16);
+        pages.Allocate(64, 48);
+        pages.NextFrame();
+        const AtlasSlot newer = pages.Allocate(48, 48);
+        pages.Allocate(64, 16);
+        pages.NextFrame();
+        uint32_t olderPage = 0, bigPage = 0;
+        pages.GetRect(older, olderPage, rects[0]);
+        const AtlasSlot big = pages.Allocate(64, 64);
+        pages.GetRect(big, bigPage, rects[1]);
+        Check(big && bigPage == olderPage && !pages.IsValid(older) && pages.IsValid(newer),
+            "pages: the older of two stale pages is emptied");
+        Check(pages.GetStats().pageResets == 1 && pages.GetStats().evictions == 2, "pages: both slots of the page evicted");
+        pages.Touch(newer);
+        Check(!pages.Allocate(64, 64) && pages.IsValid(newer), "pages: a page used this frame is never emptied");
+    }
+}
+
+int main()
+{
+    SkylinePacking();
+    FreeRectReuse();
+    StaleHandles();
+    EvictionOrder();
+
+    std::printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,360 @@
+// Offline sprite sheet atlas packer.
+//
+// Packs the frames of many .spt sprite sheets into a few atlas pages and
+// writes rewritten .spt files whose frame offsets point into the atlas, so
+// SpriteDefinition's frame table, Sprite::GetFrameTexel and the texel shader
+// path need no changes.
+// All frames of one sheet land on the same page (a sprite binds one texture).
+//
+// Build (Linux, from MSFR/):
+//   g++ -std=c++17 -O2 -I. Tools/AtlasPacker.cpp Tools/MaxRectsPacker.cpp SpriteFormat.cpp ImageCodec.cpp JpegCodec.cpp -o atlaspacker
+//
+// Usage:
+//   atlaspacker -o <out dir> [options] sheet.spt...
+//     --name <base>        page file name base (default: atlas)
+//     --size <n>           max page width/height (default: 2048)
+//     --padding <n>        empty texels between frames (default: 2)
+//     --extrude <n>        repeat frame edge texels outward (default: 0)
+//     --rotate             allow 90 degree rotation (batched sprite path only)
+//     --pot                round page sizes up to a power of two
+//     --texture-dir <dir>  page path prefix written into the .spt files (default: out dir)
+// Texture paths inside the input .spt files are resolved from the current
+// directory, as the game does, so run it from the game's working directory.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../ImageCodec.h"
+#include "../SpriteFormat.h"
+#include "MaxRectsPacker.h"
+
+namespace
+{
+    struct Options
+    {
+        std::filesystem::path outDir;
+        std::string name = "atlas";
+        int maxSize = 2048;
+        int padding = 2;
+        int extrude = 0;
+        bool rotate = false;
+        bool pot = false;
+        std::string textureDir;
+        std::vector<std::filesystem::path> inputs;
+    };
+
+    struct FrameSlot
+    {
+        int srcX = 0, srcY = 0;
+        PackRect placed;
+    };
+
+    struct Sheet
+    {
+        std::filesystem::path sptPath;
+        SpriteInfo info;
+        const Image* image = nullptr;
+        std::vector<FrameSlot> slots;       // unique source rects
+        std::vector<size_t> frameToSlot;
+        int page = -1;
+    };
+
+    struct Page
+    {
+        MaxRectsPacker packer;
+    };
+
+    void PrintUsage()
+    {
+        std::fprintf(stderr,
+            "usage: atlaspacker -o <out dir> [--name base] [--size n] [--padding n] [--extrude n]\n"
+            "                   [--rotate] [--pot] [--texture-dir dir] sheet.spt...\n");
+    }
+
+    bool ParseArgs(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            auto value = [&]() -> const char*
+            {
+                if (i + 1 >= argc)
+                {
+                    std::fprintf(stderr, "missing value for %s\n", arg.c_str());
+                    std::exit(2);
+                }
+                return argv[++i];
+            };
+
+            if (arg == "-o" || arg == "--out") options.outDir = value();
+            else if (arg == "--name") options.name = value();
+            else if (arg == "--size") options.maxSize = std::atoi(value());
+            else if (arg == "--padding") options.padding = std::atoi(value());
+            else if (arg == "--extrude") options.extrude = std::atoi(value());
+            else if (arg == "--rotate") options.rotate = true;
+            else if (arg == "--pot") options.pot = true;
+            else if (arg == "--texture-dir") options.textureDir = value();
+            else if (arg == "-h" || arg == "--help") return false;
+            else if (!arg.empty() && arg[0] == '-')
+            {
+                std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+                return false;
+            }
+            else options.inputs.push_back(arg);
+        }
+
+        if (options.outDir.empty() || options.inputs.empty()) return false;
+        if (options.maxSize <= 0 || options.padding < 0 || options.extrude < 0)
+        {
+            std::fprintf(stderr, "size must be positive, padding and extrude non-negative\n");
+            return false;
+        }
+        if (options.textureDir.empty()) options.textureDir = options.outDir.generic_string();
+        return true;
+    }
+
+    int NextPowerOfTwo(int v)
+    {
+        int p = 1;
+        while (p < v) p <<= 1;
+        return p;
+    }
+
+    // Copies a frame into the page, rotated clockwise if requested, then
+    // repeats its edge texels extrude times on every side.
+    void BlitFrame(const Image& src, int fx, int fy, int fw, int fh, const PackRect& placed, int extrude, Image& page)
+    {
+        const int w = placed.rotated ? fh : fw;
+        const int h = placed.rotated ? fw : fh;
+
+        for (int j = -extrude; j < h + extrude; ++j)
+        {
+            const int dy = placed.y + extrude + j;
+            if (dy < 0 || dy >= (int)page.height) continue;
+            const int cj = std::clamp(j, 0, h - 1);
+
+            for (int i = -extrude; i < w + extrude; ++i)
+            {
+                const int dx = placed.x + extrude + i;
+                if (dx < 0 || dx >= (int)page.width) continue;
+                const int ci = std::clamp(i, 0, w - 1);
+
+                // Inverse of the clockwise turn: page (i, j) <- frame (j, h' - 1 - i)
+                const int sx = fx + (placed.rotated ? cj : ci);
+                const int sy = fy + (placed.rotated ? fh - 1 - ci : cj);
+
+                uint8_t* d = page.Row(dy) + dx * 4;
+                if (sx < 0 || sy < 0 || sx >= (int)src.width || sy >= (int)src.height)
+                {
+                    std::memset(d, 0, 4);
+                }
+                else
+                {
+                    std::memcpy(d, src.Row(sy) + sx * 4, 4);
+                }
+            }
+        }
+    }
+
+    bool TryPackSheet(Sheet& sheet, MaxRectsPacker& packer, const Options& options)
+    {
+        const int w = sheet.info.frameWidth + options.extrude * 2 + options.padding;
+        const int h = sheet.info.frameHeight + options.extrude * 2 + options.padding;
+
+        MaxRectsPacker trial = packer;
+        std::vector<PackRect> placed(sheet.slots.size());
+        for (size_t i = 0; i < sheet.slots.size(); ++i)
+        {
+            if (!trial.Insert(w, h, placed[i])) return false;
+        }
+        for (size_t i = 0; i < sheet.slots.size(); ++i) sheet.slots[i].placed = placed[i];
+        packer = std::move(trial);
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseArgs(argc, argv, options))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    std::map<std::string, std::unique_ptr<Image>> images;
+    std::vector<Sheet> sheets;
+    std::set<std::string> outputNames;
+    bool failed = false;
+
+    for (const std::filesystem::path& input : options.inputs)
+    {
+        Sheet sheet;
+        sheet.sptPath = input;
+
+        std::ifstream in(input);
+        if (!in.is_open())
+        {
+            std::fprintf(stderr, "%s: cannot open\n", input.generic_string().c_str());
+            failed = true;
+            continue;
+        }
+
+        std::string imageError;
+        std::vector<std::string> errors;
+        ParseSpriteInfo(in, sheet.info, [&](const std::string& texture, int& width, int& height)
+        {
+            auto it = images.find(texture);
+            if (it == images.end())
+            {
+                auto image = std::make_unique<Image>();
+                if (!LoadPNG(texture, *image, &imageError))
+                {
+                    imageError = texture + ": " + imageError;
+                    return;
+                }
+                it = images.emplace(texture, std::move(image)).first;
+            }
+            sheet.image = it->second.get();
+            width = (int)sheet.image->width;
+            height = (int)sheet.image->height;
+        }, errors);
+
+        for (const std::string& error : errors)
+        {
+            std::fprintf(stderr, "%s: %s\n", input.generic_string().c_str(), error.c_str());
+        }
+        if (!sheet.image)
+        {
+            std::fprintf(stderr, "%s: %s\n", input.generic_string().c_str(),
+                imageError.empty() ? "no texture" : imageError.c_str());
+            failed = true;
+            continue;
+        }
+        if (!outputNames.insert(input.filename().generic_string()).second)
+        {
+            std::fprintf(stderr, "%s: duplicate output name\n", input.generic_string().c_str());
+            failed = true;
+            continue;
+        }
+
+        // Same fallback as SpriteDefinition: no frames means one frame at the origin
+        if (sheet.info.frames.empty()) sheet.info.frames.push_back({ 0, 0, false });
+
+        std::map<std::pair<int, int>, size_t> unique;
+        for (const SpriteFrameInfo& frame : sheet.info.frames)
+        {
+            if (frame.rotated)
+            {
+                std::fprintf(stderr, "%s: already packed (FrameRotated)\n", input.generic_string().c_str());
+                failed = true;
+                break;
+            }
+            auto [it, inserted] = unique.emplace(std::make_pair(frame.x, frame.y), sheet.slots.size());
+            if (inserted) sheet.slots.push_back({ frame.x, frame.y, {} });
+            sheet.frameToSlot.push_back(it->second);
+        }
+        sheets.push_back(std::move(sheet));
+    }
+    if (failed) return 1;
+
+    // Biggest sheets first gives MaxRects the best chance
+    std::vector<Sheet*> order;
+    for (Sheet& sheet : sheets) order.push_back(&sheet);
+    std::stable_sort(order.begin(), order.end(), [](const Sheet* a, const Sheet* b)
+    {
+        const uint64_t areaA = (uint64_t)a->info.frameWidth * a->info.frameHeight * a->slots.size();
+        const uint64_t areaB = (uint64_t)b->info.frameWidth * b->info.frameHeight * b->slots.size();
+        return areaA > areaB;
+    });
+
+    std::vector<Page> pages;
+    for (Sheet* sheet : order)
+    {
+        for (size_t p = 0; p < pages.size() && sheet->page < 0; ++p)
+        {
+            if (TryPackSheet(*sheet, pages[p].packer, options)) sheet->page = (int)p;
+        }
+        if (sheet->page >= 0) continue;
+
+        Page page;
+        page.packer.Reset(options.maxSize, options.maxSize, options.rotate);
+        if (!TryPackSheet(*sheet, page.packer, options))
+        {
+            std::fprintf(stderr, "%s: frames do not fit on one %dx%d page\n",
+                sheet->sptPath.generic_string().c_str(), options.maxSize, options.maxSize);
+            return 1;
+        }
+        sheet->page = (int)pages.size();
+        pages.push_back(std::move(page));
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.outDir, ec);
+
+    std::vector<Image> pageImages;
+    for (const Page& page : pages)
+    {
+        int w = std::max(1, page.packer.GetUsedWidth());
+        int h = std::max(1, page.packer.GetUsedHeight());
+        if (options.pot)
+        {
+            w = NextPowerOfTwo(w);
+            h = NextPowerOfTwo(h);
+        }
+        pageImages.emplace_back((uint32_t)w, (uint32_t)h);
+    }
+
+    size_t frameCount = 0;
+    for (Sheet& sheet : sheets)
+    {
+        Image& page = pageImages[sheet.page];
+        for (const FrameSlot& slot : sheet.slots)
+        {
+            BlitFrame(*sheet.image, slot.srcX, slot.srcY, sheet.info.frameWidth, sheet.info.frameHeight,
+                slot.placed, options.extrude, page);
+        }
+
+        SpriteInfo out = sheet.info;
+        out.texture = options.textureDir + "/" + options.name + "_" + std::to_string(sheet.page) + ".png";
+        for (size_t i = 0; i < out.frames.size(); ++i)
+        {
+            const PackRect& placed = sheet.slots[sheet.frameToSlot[i]].placed;
+            out.frames[i] = { placed.x + options.extrude, placed.y + options.extrude, placed.rotated };
+        }
+        frameCount += sheet.slots.size();
+
+        const std::filesystem::path sptOut = options.outDir / sheet.sptPath.filename();
+        std::ofstream file(sptOut);
+        WriteSpriteInfo(file, out);
+        if (!file)
+        {
+            std::fprintf(stderr, "%s: write failed\n", sptOut.generic_string().c_str());
+            return 1;
+        }
+    }
+
+    for (size_t p = 0; p < pageImages.size(); ++p)
+    {
+        const std::filesystem::path pngOut = options.outDir / (options.name + "_" + std::to_string(p) + ".png");
+        if (!SavePNG(pngOut, pageImages[p]))
+        {
+            std::fprintf(stderr, "%s: write failed\n", pngOut.generic_string().c_str());
+            return 1;
+        }
+        std::printf("%s %ux%u occupancy %.1f%%\n", pngOut.generic_string().c_str(),
+            pageImages[p].width, pageImages[p].height, pages[p].packer.GetOccupancy() * 100.0);
+    }
+    std::printf("%zu sheets, %zu unique frames, %zu pages (%zu textures before)\n",
+        sheets.size(), frameCount, pages.size(), images.size());
+    return 0;
+}
@@ -0,0 +1,307 @@
+// Scaling benchmark for multithreaded sprite draw recording.
+//
+// Records a synthetic scene (moving, rotating sprites spread over several
+// layers and textures) the way GameObjectManager::DrawAll does: serially
+// into SpriteBatch::Draw, then on 1..N WorkerPool threads into one
+// SpriteDrawList per slice merged with SpriteBatch::Submit. Every run goes
+// through the null render device and is checked against the serial run:
+// the recorded command stream and the uploaded sprite data must match
+// byte for byte.
+//
+// Build (Linux, from MSFR/):
+//   g++ -std=c++17 -O2 -pthread -I. Tools/DrawListBench.cpp SpriteBatch.cpp RenderQueue.cpp RenderDeviceNull.cpp PipelineCache.cpp TransientAllocator.cpp RingAllocator.cpp WorkerPool.cpp -o drawlistbench
+//
+// Usage:
+//   drawlistbench [options]
+//     --objects <n>    sprites per frame (default: 100000)
+//     --frames <n>     timed frames per configuration (default: 20)
+//     --threads <n>    highest thread count to try (default: hardware cores)
+//     --textures <n>   distinct textures (default: 8)
+//     --layers <n>     distinct layers (default: 4)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../RenderDeviceNull.h"
+#include "../SpriteBatch.h"
+#include "../TransientAllocator.h"
+#include "../WorkerPool.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        uint32_t objects = 100000;
+        uint32_t frames = 20;
+        unsigned threads = 0;
+        uint32_t textures = 8;
+        uint32_t layers = 4;
+    };
+
+    // Stand-in for a GameObject with a Sprite: world transform plus the
+    // frame and ordering the sprite would supply
+    struct SceneObject
+    {
+        float x, y;
+        float rotation;
+        float scale;
+        float width, height;
+        uint32_t frame;
+        uint32_t layer;
+        uint32_t texture;
+    };
+
+    struct Camera
+    {
+        float zoom;
+        float x, y;
+    };
+
+    constexpr uint32_t FramesPerRow = 8;
+    constexpr size_t MinDrawsPerSlice = 256;
+    constexpr unsigned SlicesPerThread = 4;
+
+    bool ParseUInt(const char* text, uint32_t& out)
+    {
+        char* end = nullptr;
+        const unsigned long v = std::strtoul(text, &end, 10);
+        if (end == text || *end != '\0' || v == 0 || v > 0xFFFFFFFFul) return false;
+        out = (uint32_t)v;
+        return true;
+    }
+
+    bool ParseArgs(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            uint32_t value = 0;
+            if (i + 1 >= argc || !ParseUInt(argv[i + 1], value))
+            {
+                std::fprintf(stderr, "drawlistbench: %s needs a positive number\n", arg.c_str());
+                return false;
+            }
+            ++i;
+            if (arg == "--objects") options.objects = value;
+            else if (arg == "--frames") options.frames = value;
+            else if (arg == "--threads") options.threads = value;
+            else if (arg == "--textures") options.textures = value;
+            else if (arg == "--layers") options.layers = value;
+            else
+            {
+                std::fprintf(stderr, "drawlistbench: unknown option %s\n", arg.c_str());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<SceneObject> MakeScene(const Options& options)
+    {
+        std::vector<SceneObject> scene(options.objects);
+        uint32_t seed = 12345;
+        auto next = [&seed]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) * (1.f / 16777216.f); };
+        for (SceneObject& o : scene)
+        {
+            o.x = next() * 4000.f;
+            o.y = next() * 4000.f;
+            o.rotation = next() * 6.2831853f;
+            o.scale = 0.5f + next();
+            o.width = 16.f + next() * 48.f;
+            o.height = 16.f + next() * 48.f;
+            o.frame = (uint32_t)(next() * 32.f);
+            o.layer = (uint32_t)(next() * (float)options.layers);
+            o.texture = (uint32_t)(next() * (float)options.textures);
+        }
+        return scene;
+    }
+
+    // What Sprite::BuildDrawItem does for one object: camera * model * the
+    // hotspot-centred frame quad, plus the frame's UV rect
+    SpriteDrawItem BuildItem(const SceneObject& o, const Camera& camera, const std::vector<TextureHandle>& textures)
+    {
+        const float c = std::cos(o.rotation) * o.scale * camera.zoom;
+        const float s = std::sin(o.rotation) * o.scale * camera.zoom;
+        const float hx = -0.5f * o.width;
+        const float hy = -0.5f * o.height;
+
+        SpriteDrawItem item;
+        item.transform[0] = c * o.width;
+        item.transform[1] = s * o.width;
+        item.transform[2] = -s * o.height;
+        item.transform[3] = c * o.height;
+        item.transform[4] = c * hx - s * hy + (o.x - camera.x) * camera.zoom;
+        item.transform[5] = s * hx + c * hy + (o.y - camera.y) * camera.zoom;
+
+        const float cell = 1.f / FramesPerRow;
+        item.uvRect[0] = (float)(o.frame % FramesPerRow) * cell;
+        item.uvRect[1] = (float)(o.frame / FramesPerRow) * cell;
+        item.uvRect[2] = item.uvRect[0] + cell;
+        item.uvRect[3] = item.uvRect[1] + cell;
+        item.texture = textures[o.texture];
+        return item;
+    }
+
+    // FNV-1a over the frame's commands and the sprite data they upload
+    uint64_t HashFrame(const RenderDeviceNull& device)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        auto mix = [&hash](const void* data, size_t bytes)
+        {
+            const uint8_t* p = (const uint8_t*)data;
+            for (size_t i = 0; i < bytes; ++i) hash = (hash ^ p[i]) * 1099511628211ull;
+        };
+        for (const RenderDeviceNull::Command& command : device.GetCommands())
+        {
+            const uint32_t fields[7] = { (uint32_t)command.type, command.slot, command.handle, command.count,
+                command.start, command.instanceCount, command.startInstance };
+            mix(fields, sizeof(fields));
+            if (command.type != RenderDeviceNull::CommandType::WriteBuffer) continue;
+
+            const std::vector<uint8_t>* data = device.GetBufferData(BufferHandle{ command.handle });
+            if (data && (size_t)command.start + command.count <= data->size()) mix(data->data() + command.start, command.count);
+        }
+        return hash;
+    }
+
+    struct Result
+    {
+        double recordMs = 0;   // per frame: build items and hand them to the batch
+        double flushMs = 0;    // per frame: sort, pack and upload
+        uint64_t hash = 0;     // last frame
+    };
+
+    class Bench
+    {
+    public:
+        explicit Bench(const Options& options_)
+            : options(options_)
+            , scene(MakeScene(options_))
+        {
+            const uint32_t texel = 0xFFFFFFFF;
+            TextureDesc desc;
+            desc.width = 1;
+            desc.height = 1;
+            for (uint32_t i = 0; i < options.textures; ++i)
+            {
+                const SubresourceData mip{ &texel, 4 };
+                textures.push_back(device.CreateTexture(desc, &mip));
+            }
+            transient.Init(device);
+            batch.Init(device, transient);
+        }
+
+        // threads == 0: the serial path, no pool at all
+        Result Run(unsigned threads)
+        {
+            std::unique_ptr<WorkerPool> pool;
+            if (threads > 0) pool = std::make_unique<WorkerPool>(threads);
+            batch.SetWorkerPool(pool.get());
+
+            Result result;
+            const uint32_t warmup = 2;
+            for (uint32_t frame = 0; frame < options.frames + warmup; ++frame)
+            {
+                // The same camera sequence for every configuration
+                const Camera camera{ 0.5f + 0.01f * (float)frame, 10.f * (float)frame, 5.f * (float)frame };
+
+                device.BeginFrame();
+                batch.Begin(1920.f, 1080.f);
+                const Clock::time_point start = Clock::now();
+                if (pool) RecordParallel(*pool, camera);
+                else RecordSerial(camera);
+                const Clock::time_point recorded = Clock::now();
+                batch.Flush();
+                const Clock::time_point flushed = Clock::now();
+                device.EndFrame();
+
+                if (frame < warmup) continue;
+                result.recordMs += std::chrono::duration<double, std::milli>(recorded - start).count();
+                result.flushMs += std::chrono::duration<double, std::milli>(flushed - recorded).count();
+                result.hash = HashFrame(device);
+            }
+            result.recordMs /= options.frames;
+            result.flushMs /= options.frames;
+            batch.SetWorkerPool(nullptr);
+            return result;
+        }
+
+    private:
+        void RecordSerial(const Camera& camera)
+        {
+            for (const SceneObject& o : scene)
+            {
+                batch.Draw(BuildItem(o, camera, textures), o.layer);
+            }
+        }
+
+        // Same slicing as GameObjectManager::RecordParallel
+        void RecordParallel(WorkerPool& pool, const Camera& camera)
+        {
+            const size_t count = scene.size();
+            const unsigned slices = (unsigned)std::max<size_t>(1, std::min<size_t>(
+                (size_t)pool.GetThreadCount() * SlicesPerThread, count / MinDrawsPerSlice));
+            if (lists.size() < slices) lists.resize(slices);
+
+            pool.Run(slices, [&](uint32_t slice)
+            {
+                SpriteDrawList& list = lists[slice];
+                list.Clear();
+                const size_t end = count * (slice + 1) / slices;
+                for (size_t i = count * slice / slices; i < end; ++i)
+                {
+                    list.Draw(BuildItem(scene[i], camera, textures), scene[i].layer);
+                }
+            });
+            for (unsigned slice = 0; slice < slices; ++slice) batch.Submit(lists[slice]);
+        }
+
+        Options options;
+        std::vector<SceneObject> scene;
+        RenderDeviceNull device;
+        TransientAllocator transient;
+        SpriteBatch batch;
+        std::vector<TextureHandle> textures;
+        std::vector<SpriteDrawList> lists;
+    };
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseArgs(argc, argv, options)) return 1;
+    if (options.threads == 0) options.threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::printf("%u sprites, %u textures, %u layers, %u frames\n",
+        options.objects, options.textures, options.layers, options.frames);
+
+    Bench bench(options);
+    const Result serial = bench.Run(0);
+    std::printf("%-8s %10s %10s %10s %8s  %s\n", "threads", "record ms", "flush ms", "total ms", "speedup", "output");
+    std::printf("%-8s %10.3f %10.3f %10.3f %8s  %s\n", "serial", serial.recordMs, serial.flushMs,
+        serial.recordMs + serial.flushMs, "1.00x", "reference");
+
+    bool identical = true;
+    for (unsigned threads = 1; threads <= options.threads; threads *= 2)
+    {
+        const Result r = bench.Run(threads);
+        const bool same = r.hash == serial.hash;
+        identical = identical && same;
+        std::printf("%-8u %10.3f %10.3f %10.3f %7.2fx  %s\n", threads, r.recordMs, r.flushMs, r.recordMs + r.flushMs,
+            (serial.recordMs + serial.flushMs) / (r.recordMs + r.flushMs), same ? "identical" : "MISMATCH");
+
+        // Always finish with the requested count, even when it is not a power of two
+        if (threads < options.threads && threads * 2 > options.threads) threads = options.threads / 2;
+    }
+    return identical ? 0 : 2;
+}
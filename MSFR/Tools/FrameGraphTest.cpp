@@ -0,0 +1,285 @@
+// Checks FrameGraph's culling, ordering and aliasing on the null device.
+//
+// Each case declares a small graph, compiles it and compares what Compile
+// decided (culled passes, execution order, resource lifetimes, physical
+// texture assignment) with the expected answer; the last cases execute on
+// RenderDeviceNull and check the texture pool across frames and that draws
+// made before Execute land after the back buffer clear. The "BackBuffer"
+// import plays the root, as it does in DX11App.
+//
+// Build (Linux, from MSFR/):
+//   g++ -std=c++17 -O2 -I. Tools/FrameGraphTest.cpp FrameGraph.cpp RenderDeviceNull.cpp PipelineCache.cpp -o framegraphtest
+//
+// Usage:
+//   framegraphtest
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../FrameGraph.h"
+#include "../RenderDeviceNull.h"
+
+namespace
+{
+    int failures = 0;
+
+    void Check(bool condition, const std::string& what)
+    {
+        if (condition) return;
+        std::fprintf(stderr, "framegraphtest: %s\n", what.c_str());
+        ++failures;
+    }
+
+    TextureDesc Target(uint32_t width, uint32_t height)
+    {
+        TextureDesc desc;
+        desc.width = width;
+        desc.height = height;
+        desc.usage = ResourceUsage::RenderTarget;
+        return desc;
+    }
+
+    FrameGraphResource ImportBackBuffer(FrameGraph& graph)
+    {
+        return graph.Import("BackBuffer", {}, Target(1280, 720));
+    }
+
+    std::vector<std::string> Order(const FrameGraph& graph)
+    {
+        std::vector<std::string> names;
+        for (uint32_t pass : graph.GetExecutionOrder()) names.push_back(graph.GetPassName(pass));
+        return names;
+    }
+
+    std::string Join(const std::vector<std::string>& names)
+    {
+        std::string out;
+        for (const std::string& name : names) out += (out.empty() ? "" : " ") + name;
+        return out;
+    }
+
+    void CheckOrder(const FrameGraph& graph, const std::string& expected, const char* test)
+    {
+        const std::string actual = Join(Order(graph));
+        Check(actual == expected, std::string(test) + ": order '" + actual + "', expected '" + expected + "'");
+    }
+
+    // A writes X and Y; B reads only X and is unused; C reads Y and writes
+    // the back buffer. Culling B must leave A alive for C.
+    void Diamond()
+    {
+        FrameGraph graph;
+        FrameGraphResource backBuffer = ImportBackBuffer(graph);
+        FrameGraphResource x, y;
+        const uint32_t a = graph.AddPass("A", [&](FrameGraph::Builder& b)
+        {
+            x = b.Write(b.Create("X", Target(64, 64)));
+            y = b.Write(b.Create("Y", Target(64, 64)));
+        }, nullptr);
+        const uint32_t bPass = graph.AddPass("B", [&](FrameGraph::Builder& b) { b.Read(x); }, nullptr);
+        const uint32_t c = graph.AddPass("C", [&](FrameGraph::Builder& b)
+        {
+            b.Read(y);
+            backBuffer = b.Write(backBuffer);
+        }, nullptr);
+        graph.Compile();
+
+        Check(!graph.IsCulled(a), "diamond: A is still read by C");
+        Check(graph.IsCulled(bPass), "diamond: B has no outputs");
+        Check(!graph.IsCulled(c), "diamond: C writes the back buffer");
+        CheckOrder(graph, "A C", "diamond");
+        Check(graph.GetStats().culledPasses == 1, "diamond: one culled pass");
+    }
+
+    // Chains of unused passes go entirely; side effects stay
+    void CullChains()
+    {
+        FrameGraph graph;
+        FrameGraphResource backBuffer = ImportBackBuffer(graph);
+        FrameGraphResource t, u, v;
+        graph.AddPass("Producer", [&](FrameGraph::Builder& b) { t = b.Write(b.Create("T", Target(32, 32))); }, nullptr);
+        graph.AddPass("Middle", [&](FrameGraph::Builder& b) { b.Read(t); u = b.Write(b.Create("U", Target(32, 32))); }, nullptr);
+        graph.AddPass("Unused", [&](FrameGraph::Builder& b) { b.Read(u); }, nullptr);
+        graph.AddPass("Readback", [&](FrameGraph::Builder& b)
+        {
+            v = b.Write(b.Create("V", Target(16, 16)));
+            b.SetSideEffect();
+        }, nullptr);
+        graph.AddPass("Present", [&](FrameGraph::Builder& b) { backBuffer = b.Write(backBuffer); }, nullptr);
+        graph.Compile();
+
+        CheckOrder(graph, "Readback Present", "chain");
+        Check(graph.GetResourceInfo(t).firstUse == FrameGraph::Invalid, "chain: culled resources have no lifetime");
+    }
+
+    // Declared out of order: Overwrite comes before the pass that reads the
+    // version it overwrites, so it has to move after it
+    void WriteAfterRead()
+    {
+        FrameGraph graph;
+        FrameGraphResource backBuffer = ImportBackBuffer(graph);
+        FrameGraphResource first, second, copy;
+        graph.AddPass("Draw", [&](FrameGraph::Builder& b) { first = b.Write(b.Create("R", Target(64, 64))); }, nullptr);
+        graph.AddPass("Overwrite", [&](FrameGraph::Builder& b) { second = b.Write(first); }, nullptr);
+        graph.AddPass("Copy", [&](FrameGraph::Builder& b)
+        {
+            b.Read(first);
+            copy = b.Write(b.Create("S", Target(64, 64)));
+        }, nullptr);
+        graph.AddPass("Present", [&](FrameGraph::Builder& b)
+        {
+            b.Read(second);
+            b.Read(copy);
+            backBuffer = b.Write(backBuffer);
+        }, nullptr);
+        graph.Compile();
+
+        CheckOrder(graph, "Draw Copy Overwrite Present", "write after read");
+        Check(graph.Find("R") == second, "write after read: Find returns the newest version");
+    }
+
+    // Reading a version and the one written over it can't be ordered
+    void Cycle()
+    {
+        FrameGraph graph;
+        FrameGraphResource backBuffer = ImportBackBuffer(graph);
+        FrameGraphResource first, second;
+        graph.AddPass("Draw", [&](FrameGraph::Builder& b) { first = b.Write(b.Create("R", Target(64, 64))); }, nullptr);
+        graph.AddPass("Overwrite", [&](FrameGraph::Builder& b) { second = b.Write(first); }, nullptr);
+        graph.AddPass("Both", [&](FrameGraph::Builder& b)
+        {
+            b.Read(first);
+            b.Read(second);
+            backBuffer = b.Write(backBuffer);
+        }, nullptr);
+        bool threw = false;
+        try
+        {
+            graph.Compile();
+        }
+        catch (const std::runtime_error&)
+        {
+            threw = true;
+        }
+        Check(threw, "cycle: Compile should throw");
+    }
+
+    // Blur ping-pong: A and C have the same desc and disjoint lifetimes and
+    // share a texture; B overlaps both; D has another size
+    uint32_t BuildAliasing(FrameGraph& graph)
+    {
+        FrameGraphResource backBuffer = ImportBackBuffer(graph);
+        FrameGraphResource a, b, c, d;
+        graph.AddPass("Scene", [&](FrameGraph::Builder& builder) { a = builder.Write(builder.Create("A", Target(256, 256))); }, nullptr);
+        graph.AddPass("BlurX", [&](FrameGraph::Builder& builder) { builder.Read(a); b = builder.Write(builder.Create("B", Target(256, 256))); }, nullptr);
+        graph.AddPass("BlurY", [&](FrameGraph::Builder& builder) { builder.Read(b); c = builder.Write(builder.Create("C", Target(256, 256))); }, nullptr);
+        graph.AddPass("Small", [&](FrameGraph::Builder& builder) { builder.Read(c); d = builder.Write(builder.Create("D", Target(128, 128))); }, nullptr);
+        graph.AddPass("Present", [&](FrameGraph::Builder& builder)
+        {
+            builder.Read(d);
+            backBuffer = builder.Write(backBuffer);
+        }, nullptr);
+        graph.Compile();
+        return graph.GetStats().physicalTextures;
+    }
+
+    void Aliasing()
+    {
+        FrameGraph graph;
+        BuildAliasing(graph);
+        CheckOrder(graph, "Scene BlurX BlurY Small Present", "aliasing");
+
+        const FrameGraph::ResourceInfo& a = graph.GetResourceInfo(graph.Find("A"));
+        const FrameGraph::ResourceInfo& b = graph.GetResourceInfo(graph.Find("B"));
+        const FrameGraph::ResourceInfo& c = graph.GetResourceInfo(graph.Find("C"));
+        const FrameGraph::ResourceInfo& d = graph.GetResourceInfo(graph.Find("D"));
+        Check(a.firstUse == 0 && a.lastUse == 1 && c.firstUse == 2 && c.lastUse == 3, "aliasing: lifetimes");
+        Check(a.physical == c.physical, "aliasing: A and C share a texture");
+        Check(a.physical != b.physical && b.physical != c.physical, "aliasing: B overlaps A and C");
+        Check(d.physical != a.physical && d.physical != b.physical, "aliasing: D has another size");
+        Check(graph.GetStats().transientTextures == 4 && graph.GetStats().physicalTextures == 3, "aliasing: 4 transients on 3 textures");
+        Check(graph.GetStats().physicalBytes < graph.GetStats().transientBytes, "aliasing: saves memory");
+    }
+
+    // Textures come from the pool on later frames and leave it when unused
+    void Pooling()
+    {
+        RenderDeviceNull device;
+        FrameGraph graph(2);
+        graph.Init(device);
+
+        std::vector<std::string> executed;
+        BuildAliasing(graph);
+        graph.Execute();
+        Check(graph.GetStats().texturesCreated == 3 && graph.GetStats().pooledTextures == 3, "pooling: first frame creates 3");
+
+        graph.Reset();
+        BuildAliasing(graph);
+        graph.Execute();
+        Check(graph.GetStats().texturesCreated == 0, "pooling: second frame reuses the pool");
+
+        // Nothing transient for longer than maxIdleFrames
+        for (int frame = 0; frame < 4; ++frame)
+        {
+            graph.Reset();
+            FrameGraphResource backBuffer = ImportBackBuffer(graph);
+            graph.AddPass("Present", [&](FrameGraph::Builder& b) { backBuffer = b.Write(backBuffer); },
+                [&](IRenderDevice&, const FrameGraph::Resources&) { executed.push_back("Present"); });
+            graph.Execute();
+        }
+        Check(executed.size() == 4, "pooling: execute callbacks run");
+        Check(graph.GetStats().pooledTextures == 0 && device.GetLiveResourceCount() == 0, "pooling: idle textures released");
+
+        graph.Shutdown();
+    }
+
+    // DX11App's frame: the game states draw during the program's Update,
+    // before Execute, so the back buffer must already be cleared by then
+    void ClearBeforeUpdate()
+    {
+        RenderDeviceNull device;
+        FrameGraph graph;
+        graph.Init(device);
+        const float clearColor[4] = { 0, 0, 0, 1 };
+
+        device.BeginFrame();
+        graph.Reset();
+        FrameGraphResource backBuffer = graph.ImportBackBuffer(Target(1280, 720), clearColor);
+        graph.AddPass("Scene", [&](FrameGraph::Builder& b) { backBuffer = b.Write(backBuffer); },
+            [](IRenderDevice& scene, const FrameGraph::Resources&)
+            {
+                scene.SetRenderTarget({});
+                scene.Draw(6, 0);
+            });
+        device.Draw(3, 0);      // the program's Update
+        graph.Execute();
+        device.EndFrame();
+
+        std::vector<RenderDeviceNull::CommandType> types;
+        for (const RenderDeviceNull::Command& command : device.GetCommands()) types.push_back(command.type);
+        const std::vector<RenderDeviceNull::CommandType> expected = {
+            RenderDeviceNull::CommandType::ClearRenderTarget,
+            RenderDeviceNull::CommandType::Draw,
+            RenderDeviceNull::CommandType::Draw,
+        };
+        Check(types == expected, "clear: one clear, then the Update draw, then the scene pass draw");
+        Check(device.GetCommands().size() == 3 && device.GetCommands()[1].count == 3 && device.GetCommands()[2].count == 6,
+            "clear: draws in Update then Execute order");
+    }
+}
+
+int main()
+{
+    Diamond();
+    CullChains();
+    WriteAfterRead();
+    Cycle();
+    Aliasing();
+    Pooling();
+    ClearBeforeUpdate();
+
+    std::printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}
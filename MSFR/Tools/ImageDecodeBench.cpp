@@ -0,0 +1,178 @@
+// Throughput benchmark for the portable PNG/JPEG decoders.
+//
+// Loads every .png/.jpg/.jpeg under the given files and directories into
+// memory, decodes each once to check it, then times repeated decodes and
+// reports per-file and total throughput (compressed MB/s in, megapixels/s
+// out). Files the portable decoders reject (progressive JPEG, CMYK, ...)
+// are listed and skipped; those go through WIC in the game.
+//
+// Build (Linux, from MSFR/):
+//   g++ -std=c++17 -O2 -I. Tools/ImageDecodeBench.cpp ImageCodec.cpp JpegCodec.cpp -o imagedecodebench
+// Add -DMSFR_IMAGE_NO_SSE2 to measure the scalar paths instead.
+//
+// Usage:
+//   imagedecodebench [options] [path...]     (default path: assets)
+//     --iterations <n>   timed decodes per file (default: 10)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "../ImageCodec.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        uint32_t iterations = 10;
+        std::vector<std::filesystem::path> paths;
+    };
+
+    struct Sample
+    {
+        std::filesystem::path path;
+        std::vector<uint8_t> bytes;
+    };
+
+    bool ParseUInt(const char* text, uint32_t& out)
+    {
+        char* end = nullptr;
+        const unsigned long v = std::strtoul(text, &end, 10);
+        if (end == text || *end != '\0' || v == 0 || v > 0xFFFFFFFFul) return false;
+        out = (uint32_t)v;
+        return true;
+    }
+
+    bool ParseArgs(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--iterations")
+            {
+                if (i + 1 >= argc || !ParseUInt(argv[i + 1], options.iterations))
+                {
+                    std::fprintf(stderr, "imagedecodebench: %s needs a positive number\n", arg.c_str());
+                    return false;
+                }
+                ++i;
+            }
+            else if (arg.size() > 1 && arg[0] == '-')
+            {
+                std::fprintf(stderr, "imagedecodebench: unknown option %s\n", arg.c_str());
+                return false;
+            }
+            else
+            {
+                options.paths.emplace_back(arg);
+            }
+        }
+        if (options.paths.empty()) options.paths.emplace_back("assets");
+        return true;
+    }
+
+    bool IsImage(const std::filesystem::path& path)
+    {
+        std::string ext = path.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+        return ext == ".png" || ext == ".jpg" || ext == ".jpeg";
+    }
+
+    void Collect(const std::filesystem::path& path, std::vector<std::filesystem::path>& files)
+    {
+        std::error_code ec;
+        if (std::filesystem::is_directory(path, ec))
+        {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(path, ec))
+            {
+                if (entry.is_regular_file() && IsImage(entry.path())) files.push_back(entry.path());
+            }
+        }
+        else if (std::filesystem::is_regular_file(path, ec))
+        {
+            files.push_back(path);
+        }
+        else
+        {
+            std::fprintf(stderr, "imagedecodebench: %s not found\n", path.string().c_str());
+        }
+    }
+
+    double Elapsed(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseArgs(argc, argv, options)) return 1;
+
+    std::vector<std::filesystem::path> files;
+    for (const std::filesystem::path& path : options.paths) Collect(path, files);
+    std::sort(files.begin(), files.end());
+
+    std::vector<Sample> corpus;
+    for (const std::filesystem::path& file : files)
+    {
+        Sample sample{ file, {} };
+        if (!LoadFile(file, sample.bytes))
+        {
+            std::fprintf(stderr, "imagedecodebench: cannot read %s\n", file.string().c_str());
+            continue;
+        }
+        corpus.push_back(std::move(sample));
+    }
+    if (corpus.empty())
+    {
+        std::fprintf(stderr, "imagedecodebench: no images found\n");
+        return 1;
+    }
+
+    std::printf("%zu files, %u iterations each\n", corpus.size(), options.iterations);
+    std::printf("%-40s %11s %10s %9s %9s %9s\n", "file", "size", "KB", "ms", "MB/s in", "Mpix/s");
+
+    double totalSeconds = 0.0;
+    uint64_t totalBytes = 0, totalPixels = 0;
+    uint32_t skipped = 0;
+    for (const Sample& sample : corpus)
+    {
+        Image image;
+        std::string error;
+        if (!DecodeImage(sample.bytes.data(), sample.bytes.size(), image, &error))
+        {
+            std::printf("%-40s skipped: %s\n", sample.path.filename().string().c_str(), error.c_str());
+            ++skipped;
+            continue;
+        }
+
+        const Clock::time_point start = Clock::now();
+        for (uint32_t i = 0; i < options.iterations; ++i) DecodeImage(sample.bytes.data(), sample.bytes.size(), image);
+        const double seconds = Elapsed(start);
+
+        const uint64_t bytes = (uint64_t)sample.bytes.size() * options.iterations;
+        const uint64_t pixels = (uint64_t)image.width * image.height * options.iterations;
+        totalSeconds += seconds;
+        totalBytes += bytes;
+        totalPixels += pixels;
+
+        const std::string size = std::to_string(image.width) + "x" + std::to_string(image.height);
+        std::printf("%-40s %11s %10.1f %9.3f %9.1f %9.1f\n", sample.path.filename().string().c_str(), size.c_str(),
+            sample.bytes.size() / 1024.0, seconds * 1000.0 / options.iterations, bytes / seconds / 1e6, pixels / seconds / 1e6);
+    }
+
+    if (totalSeconds > 0.0)
+    {
+        std::printf("%-40s %11s %10s %9.3f %9.1f %9.1f\n", "total", "", "", totalSeconds * 1000.0 / options.iterations,
+            totalBytes / totalSeconds / 1e6, totalPixels / totalSeconds / 1e6);
+    }
+    if (skipped) std::printf("%u files skipped\n", skipped);
+    return 0;
+}
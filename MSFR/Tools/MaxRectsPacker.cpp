@@ -0,0 +1,153 @@
+#include "MaxRectsPacker.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+namespace
+{
+    bool Contains(const PackRect& a, const PackRect& b)
+    {
+        return b.x >= a.x && b.y >= a.y
+            && b.x + b.width <= a.x + a.width
+            && b.y + b.height <= a.y + a.height;
+    }
+}
+
+MaxRectsPacker::MaxRectsPacker(int width, int height, bool allowRotation_)
+{
+    Reset(width, height, allowRotation_);
+}
+
+void MaxRectsPacker::Reset(int width, int height, bool allowRotation_)
+{
+    binWidth = width;
+    binHeight = height;
+    allowRotation = allowRotation_;
+    usedWidth = 0;
+    usedHeight = 0;
+    usedArea = 0;
+    freeRects.assign(1, { 0, 0, width, height, false });
+}
+
+bool MaxRectsPacker::Insert(int width, int height, PackRect& placed)
+{
+    if (width <= 0 || height <= 0) return false;
+    if (!FindPosition(width, height, placed)) return false;
+    Place(placed);
+    return true;
+}
+
+double MaxRectsPacker::GetOccupancy() const
+{
+    const double area = (double)usedWidth * usedHeight;
+    return area > 0 ? (double)usedArea / area : 0.0;
+}
+
+bool MaxRectsPacker::FindPosition(int width, int height, PackRect& best) const
+{
+    int bestShort = INT_MAX;
+    int bestLong = INT_MAX;
+
+    auto consider = [&](const PackRect& f, int w, int h, bool rotated)
+    {
+        if (w > f.width || h > f.height) return;
+        const int leftoverX = f.width - w;
+        const int leftoverY = f.height - h;
+        const int shortSide = std::min(leftoverX, leftoverY);
+        const int longSide = std::max(leftoverX, leftoverY);
+        if (shortSide < bestShort || (shortSide == bestShort && longSide < bestLong))
+        {
+            best = { f.x, f.y, w, h, rotated };
+            bestShort = shortSide;
+            bestLong = longSide;
+        }
+    };
+
+    for (const PackRect& f : freeRects)
+    {
+        consider(f, width, height, false);
+        if (allowRotation && width != height) consider(f, height, width, true);
+    }
+    return bestShort != INT_MAX;
+}
+
+void MaxRectsPacker::Place(const PackRect& rect)
+{
+    newFreeRects.clear();
+    for (size_t i = 0; i < freeRects.size();)
+    {
+        if (SplitFreeRect(freeRects[i], rect))
+        {
+            freeRects[i] = freeRects.back();
+            freeRects.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    PruneFreeList();
+
+    usedWidth = std::max(usedWidth, rect.x + rect.width);
+    usedHeight = std::max(usedHeight, rect.y + rect.height);
+    usedArea += (uint64_t)rect.width * rect.height;
+}
+
+bool MaxRectsPacker::SplitFreeRect(const PackRect& f, const PackRect& used)
+{
+    if (used.x >= f.x + f.width || used.x + used.width <= f.x
+        || used.y >= f.y + f.height || used.y + used.height <= f.y)
+    {
+        return false;
+    }
+
+    // Up to four maximal leftovers around the used rect
+    if (used.x > f.x)
+    {
+        newFreeRects.push_back({ f.x, f.y, used.x - f.x, f.height, false });
+    }
+    if (used.x + used.width < f.x + f.width)
+    {
+        const int x = used.x + used.width;
+        newFreeRects.push_back({ x, f.y, f.x + f.width - x, f.height, false });
+    }
+    if (used.y > f.y)
+    {
+        newFreeRects.push_back({ f.x, f.y, f.width, used.y - f.y, false });
+    }
+    if (used.y + used.height < f.y + f.height)
+    {
+        const int y = used.y + used.height;
+        newFreeRects.push_back({ f.x, y, f.width, f.y + f.height - y, false });
+    }
+    return true;
+}
+
+void MaxRectsPacker::PruneFreeList()
+{
+    // New rects only need checking against each other and the survivors
+    for (size_t i = 0; i < newFreeRects.size(); ++i)
+    {
+        bool contained = false;
+        for (size_t j = 0; j < newFreeRects.size() && !contained; ++j)
+        {
+            if (i == j || newFreeRects[j].width < 0) continue;
+            if (Contains(newFreeRects[j], newFreeRects[i]))
+            {
+                // Keep one of two identical rects
+                contained = !(Contains(newFreeRects[i], newFreeRects[j]) && i < j);
+            }
+        }
+        for (size_t j = 0; j < freeRects.size() && !contained; ++j)
+        {
+            contained = Contains(freeRects[j], newFreeRects[i]);
+        }
+        if (contained) newFreeRects[i].width = -1;
+    }
+
+    for (const PackRect& r : newFreeRects)
+    {
+        if (r.width >= 0) freeRects.push_back(r);
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+struct PackRect
+{
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    bool rotated = false;   // placed as height x width
+};
+
+// MaxRects bin packer (Jukka Jylanki, "A Thousand Ways to Pack the Bin"),
+// best-short-side-fit placement. Keeps the list of maximal free rectangles;
+// every placement splits the ones it overlaps and prunes contained ones.
+class MaxRectsPacker
+{
+public:
+    MaxRectsPacker() = default;
+    MaxRectsPacker(int width, int height, bool allowRotation);
+
+    void Reset(int width, int height, bool allowRotation);
+
+    // Returns false (and leaves the packer untouched) if the rect does not fit.
+    bool Insert(int width, int height, PackRect& placed);
+
+    int GetWidth() const { return binWidth; }
+    int GetHeight() const { return binHeight; }
+    // Extent actually covered by placed rects
+    int GetUsedWidth() const { return usedWidth; }
+    int GetUsedHeight() const { return usedHeight; }
+    uint64_t GetUsedArea() const { return usedArea; }
+    double GetOccupancy() const;
+
+private:
+    bool FindPosition(int width, int height, PackRect& best) const;
+    void Place(const PackRect& rect);
+    bool SplitFreeRect(const PackRect& freeRect, const PackRect& used);
+    void PruneFreeList();
+
+    int binWidth = 0;
+    int binHeight = 0;
+    bool allowRotation = false;
+
+    int usedWidth = 0;
+    int usedHeight = 0;
+    uint64_t usedArea = 0;
+
+    std::vector<PackRect> freeRects;
+    std::vector<PackRect> newFreeRects;
+};
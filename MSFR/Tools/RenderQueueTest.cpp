@@ -0,0 +1,147 @@
+// Checks RenderKey ordering, RenderQueue's sort and SpriteBatch draw order.
+//
+// Known keys go through RenderQueue::Sort: layer always wins, opaque draws
+// group by state, translucent draws order by depth and otherwise keep
+// submission order whatever their texture. SpriteBatch then runs on the null
+// render device: overlapping sprites with different textures, pushed the way
+// GameObjectManager::DrawAll does (layer 0, depth 0), must reach the device in
+// the order they were drawn.
+//
+// Build (Linux, from MSFR/):
+//   g++ -std=c++17 -O2 -pthread -I. Tools/RenderQueueTest.cpp SpriteBatch.cpp RenderQueue.cpp RenderDeviceNull.cpp PipelineCache.cpp TransientAllocator.cpp RingAllocator.cpp WorkerPool.cpp -o renderqueuetest
+//
+// Usage:
+//   renderqueuetest
+
+#include <cstdio>
+#include <vector>
+
+#include "../RenderDeviceNull.h"
+#include "../RenderQueue.h"
+#include "../SpriteBatch.h"
+#include "../TransientAllocator.h"
+
+namespace
+{
+    int failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (condition) return;
+        std::fprintf(stderr, "renderqueuetest: %s\n", what);
+        ++failures;
+    }
+
+    void Push(RenderQueue& queue, uint32_t layer, bool translucent, uint32_t texture, uint32_t depth)
+    {
+        queue.Push(RenderKey::Make(layer, translucent, 1, texture, depth), (uint32_t)queue.Size(), RenderKey::MakeState(1, texture));
+    }
+
+    std::vector<uint32_t> SortedIndices(RenderQueue& queue)
+    {
+        queue.Sort();
+        std::vector<uint32_t> indices;
+        for (const RenderQueue::Entry& e : queue.GetEntries()) indices.push_back(e.index);
+        return indices;
+    }
+
+    void KeyFields()
+    {
+        const uint64_t opaque = RenderKey::Make(200, false, 5, 77, 1234);
+        Check(RenderKey::GetLayer(opaque) == 200 && !RenderKey::IsTranslucent(opaque) && RenderKey::GetDepth(opaque) == 1234,
+            "opaque key fields");
+        const uint64_t translucent = RenderKey::Make(3, true, 5, 77, 0xFFFFFF);
+        Check(RenderKey::GetLayer(translucent) == 3 && RenderKey::IsTranslucent(translucent) && RenderKey::GetDepth(translucent) == 0xFFFFFF,
+            "translucent key fields");
+        Check(translucent == RenderKey::Make(3, true, 6, 78, 0xFFFFFF), "translucent keys ignore the state");
+        const uint32_t state = RenderKey::MakeState(5, 77);
+        Check(RenderKey::GetShader(state) == 5 && RenderKey::GetTexture(state) == 77, "state fields");
+    }
+
+    void OpaqueGroupsByState()
+    {
+        RenderQueue queue;
+        Push(queue, 0, false, 2, 0);
+        Push(queue, 0, false, 1, 0);
+        Push(queue, 0, false, 2, 0);
+        Push(queue, 0, false, 1, 0);
+        Check(SortedIndices(queue) == std::vector<uint32_t>{ 1, 3, 0, 2 }, "opaque draws group by texture, stable within one");
+        Check(queue.GetStats().stateChangesUnsorted == 5 && queue.GetStats().stateChangesSorted == 3 && queue.GetStats().Saved() == 2,
+            "grouping saves two binds");
+    }
+
+    void TranslucentKeepsOrder()
+    {
+        RenderQueue queue;
+        Push(queue, 1, true, 1, 0);
+        Push(queue, 0, true, 3, 5);
+        Push(queue, 0, true, 2, 0);
+        Push(queue, 0, true, 1, 0);
+        Push(queue, 0, true, 2, 0);
+        Push(queue, 0, true, 1, 5);
+        Check(SortedIndices(queue) == std::vector<uint32_t>{ 2, 3, 4, 1, 5, 0 },
+            "translucent draws sort by layer and depth, then keep submission order");
+
+        // Depth order splits the texture runs
+        queue.Clear();
+        Push(queue, 0, true, 1, 1);
+        Push(queue, 0, true, 1, 0);
+        Push(queue, 0, true, 2, 1);
+        Push(queue, 0, true, 2, 0);
+        Check(SortedIndices(queue) == std::vector<uint32_t>{ 1, 3, 0, 2 }, "translucent draws sort by depth");
+        Check(queue.GetStats().stateChangesUnsorted == 3 && queue.GetStats().stateChangesSorted == 5 && queue.GetStats().Saved() == -2,
+            "sorting reports the binds it added");
+    }
+
+    // Three overlapping sprites, the middle one on another texture
+    void SpriteBatchPainterOrder()
+    {
+        RenderDeviceNull device;
+        TransientAllocator transient;
+        transient.Init(device);
+        SpriteBatch batch;
+        batch.Init(device, transient);
+
+        const TextureHandle back{ 7 }, front{ 3 };
+        SpriteDrawItem item;
+        item.transform[0] = 64;
+        item.transform[3] = 64;
+
+        device.BeginFrame();
+        batch.Begin(256, 256);
+        item.texture = back;
+        batch.Draw(item);
+        item.texture = front;
+        item.transform[4] = 16;
+        batch.Draw(item);
+        item.texture = back;
+        item.transform[4] = 32;
+        batch.Draw(item);
+        batch.Flush();
+        device.EndFrame();
+
+        std::vector<uint32_t> textures;
+        uint32_t draws = 0;
+        for (const RenderDeviceNull::Command& command : device.GetCommands())
+        {
+            if (command.type == RenderDeviceNull::CommandType::SetTexture) textures.push_back(command.handle);
+            if (command.type == RenderDeviceNull::CommandType::DrawIndexedInstanced) ++draws;
+        }
+        Check(textures == std::vector<uint32_t>{ 7, 3, 7 } && draws == 3, "overlapping sprites keep the order they were drawn in");
+        Check(batch.GetFrameStats().stateChangesSaved == 0, "sorting saved nothing and added nothing");
+
+        batch.Shutdown();
+        transient.Shutdown();
+    }
+}
+
+int main()
+{
+    KeyFields();
+    OpaqueGroupsByState();
+    TranslucentKeepsOrder();
+    SpriteBatchPainterOrder();
+
+    std::printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,197 @@
+// Checks RingAllocator and TransientAllocator.
+//
+// RingAllocator cases with known offsets: wrapping past a tail that a fence
+// retired, alignment padding at the wrap (counted in used), exhaustion
+// while frames are in flight, and the rejected requests (zero size, larger
+// than the ring, alignment not a power of two). A randomized run then checks
+// that no allocation ever overlaps one still in flight. TransientAllocator
+// runs on the null render device: a ring that grows mid-frame must keep its
+// old buffer alive until that frame's fence completes.
+//
+// Build (Linux, from MSFR/):
+//   g++ -std=c++17 -O2 -I. Tools/RingAllocatorTest.cpp RingAllocator.cpp TransientAllocator.cpp RenderDeviceNull.cpp PipelineCache.cpp -o ringallocatortest
+//
+// Usage:
+//   ringallocatortest
+
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include "../RenderDeviceNull.h"
+#include "../RingAllocator.h"
+#include "../TransientAllocator.h"
+
+namespace
+{
+    int failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (condition) return;
+        std::fprintf(stderr, "ringallocatortest: %s\n", what);
+        ++failures;
+    }
+
+    void RejectedRequests()
+    {
+        RingAllocator ring(64);
+        Check(ring.Allocate(0) == RingAllocator::Invalid, "zero size should fail");
+        Check(ring.Allocate(65) == RingAllocator::Invalid, "more than the capacity should fail");
+        Check(ring.Allocate(8, 3) == RingAllocator::Invalid, "alignment 3 should fail");
+        Check(ring.Allocate(8, 0) == RingAllocator::Invalid, "alignment 0 should fail");
+        Check(ring.GetStats().failedAllocations == 4 && ring.GetStats().used == 0, "rejections take nothing");
+        Check(ring.Allocate(64) == 0, "the whole ring should fit");
+
+        RingAllocator empty;
+        Check(empty.Allocate(1) == RingAllocator::Invalid, "an empty ring has no space");
+    }
+
+    void WrapAfterRetire()
+    {
+        RingAllocator ring(100);
+        Check(ring.Allocate(40) == 0, "frame 1 at 0");
+        ring.EndFrame(1);
+        Check(ring.Allocate(40) == 40, "frame 2 at 40");
+        ring.EndFrame(2);
+        ring.Retire(1);
+        Check(ring.GetStats().used == 40 && ring.GetStats().framesInFlight == 1, "frame 1 retired");
+
+        // 20 tail bytes skipped, then the retired front
+        Check(ring.Allocate(30) == 0, "wraps to the retired front");
+        Check(ring.GetStats().used == 90, "skipped tail counts as used");
+        Check(ring.Allocate(20) == RingAllocator::Invalid, "must not reach frame 2");
+        Check(ring.Allocate(10) == 30, "exactly fills up to frame 2");
+        ring.EndFrame(3);
+        ring.Retire(2);
+        Check(ring.GetStats().used == 60, "frame 3 with its skipped tail remains");
+        ring.Retire(3);
+        Check(ring.GetStats().used == 0 && ring.GetStats().framesInFlight == 0, "everything retired");
+        Check(ring.Allocate(100) == 0, "an idle ring starts over at 0");
+    }
+
+    void AlignedWrap()
+    {
+        RingAllocator ring(128);
+        ring.Allocate(50);
+        ring.EndFrame(1);
+        Check(ring.Allocate(40) == 50, "frame 2 at 50");
+        ring.EndFrame(2);
+        ring.Retire(1);
+
+        Check(ring.Allocate(20, 16) == 96, "padded up to 96");
+        Check(ring.GetStats().used == 40 + 26, "padding counts as used");
+        // 112 + 16 would fit but the aligned offset 128 doesn't: wrap
+        Check(ring.Allocate(16, 16) == 0, "aligned request wraps to 0");
+        Check(ring.GetStats().used == 40 + 26 + 28, "tail skipped at the wrap counts as used");
+        Check(ring.Allocate(40, 16) == RingAllocator::Invalid, "must not reach frame 2 at 50");
+        Check(ring.Allocate(32, 16) == 16, "fits below frame 2");
+        ring.EndFrame(3);
+        ring.Retire(3);
+        Check(ring.GetStats().used == 0, "everything retired");
+    }
+
+    void Exhaustion()
+    {
+        RingAllocator ring(64);
+        for (int i = 0; i < 4; ++i)
+        {
+            Check(ring.Allocate(16) == (uint64_t)i * 16, "quarters in order");
+            ring.EndFrame((uint64_t)i + 1);
+        }
+        Check(ring.Allocate(1) == RingAllocator::Invalid, "full while every frame is in flight");
+        Check(ring.GetStats().peakUsed == 64, "peak is the whole ring");
+        ring.Retire(1);
+        Check(ring.Allocate(16) == 0, "the oldest frame's space comes back first");
+        Check(ring.Allocate(1) == RingAllocator::Invalid, "and only that");
+    }
+
+    // Random traffic against a model of what's still in flight
+    void NoOverlap()
+    {
+        struct Range
+        {
+            uint64_t begin, end, fence;
+        };
+        const uint64_t capacity = 4096;
+        RingAllocator ring(capacity);
+        std::deque<Range> live;
+        uint32_t seed = 777;
+        auto next = [&seed](uint32_t n) { seed = seed * 1664525u + 1013904223u; return (seed >> 8) % n; };
+
+        uint64_t fence = 1, completed = 0;
+        bool ok = true;
+        for (int step = 0; step < 200000 && ok; ++step)
+        {
+            const uint32_t action = next(100);
+            if (action < 80)
+            {
+                const uint64_t size = 1 + next(700);
+                const uint64_t alignment = 1ull << next(9);
+                const uint64_t offset = ring.Allocate(size, alignment);
+                if (offset == RingAllocator::Invalid) continue;
+                ok = offset % alignment == 0 && offset + size <= capacity;
+                for (const Range& r : live) ok = ok && (offset + size <= r.begin || offset >= r.end);
+                live.push_back({ offset, offset + size, fence });
+            }
+            else if (action < 95)
+            {
+                ring.EndFrame(fence++);
+            }
+            else if (completed + 1 < fence)
+            {
+                completed += 1 + next((uint32_t)(fence - completed - 1));
+                ring.Retire(completed);
+                while (!live.empty() && live.front().fence <= completed) live.pop_front();
+            }
+        }
+        Check(ok, "an allocation overlapped one in flight, was misaligned or out of bounds");
+    }
+
+    void GrowDefersRelease()
+    {
+        RenderDeviceNull device;
+        TransientAllocator transient;
+        transient.Init(device, 256, 256);
+
+        device.BeginFrame();
+        std::vector<uint8_t> data(200, 0xAB);
+        const TransientAllocation first = transient.UploadVertices(data.data(), 200);
+        Check(first && first.offset == 0, "first upload fits");
+        const TransientAllocation second = transient.UploadVertices(data.data(), 200);
+        Check(second && second.buffer.id != first.buffer.id, "second upload grows the ring");
+        Check(transient.GetStats().grows == 1 && transient.GetStats().retiredBuffers == 1, "one outgrown buffer");
+        Check(device.GetBufferData(first.buffer) != nullptr, "old buffer alive while its frame is in flight");
+        const std::vector<uint8_t>* grown = device.GetBufferData(second.buffer);
+        Check(grown && grown->size() >= 512 && std::memcmp(grown->data() + second.offset, data.data(), 200) == 0,
+            "grown ring holds the upload");
+        Check(!transient.UploadVertices(data.data(), 0), "zero-size upload is empty");
+        device.EndFrame();
+
+        device.BeginFrame();
+        std::vector<uint8_t> big(5000, 0xCD);
+        const TransientAllocation large = transient.UploadVertices(big.data(), (uint32_t)big.size());
+        Check(device.GetBufferData(first.buffer) == nullptr, "old buffer destroyed once its frame completed");
+        Check(large && transient.GetStats().grows == 2, "larger than the ring grows it to fit");
+        Check(device.GetBufferData(second.buffer) != nullptr && transient.GetStats().retiredBuffers == 1,
+            "buffer outgrown this frame waits again");
+        device.EndFrame();
+
+        transient.Shutdown();
+        Check(device.GetLiveResourceCount() == 0, "shutdown destroys retired buffers too");
+    }
+}
+
+int main()
+{
+    RejectedRequests();
+    WrapAfterRetire();
+    AlignedWrap();
+    Exhaustion();
+    NoOverlap();
+    GrowDefersRelease();
+
+    std::printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,178 @@
+// Checks ShaderCache's keys, hits and invalidation with a stub compiler.
+//
+// Every case works in a scratch directory under the system temp directory
+// and counts the stub's Compile calls: a hit must not compile, anything
+// that changes the key (source or include edits, entry, target, defines,
+// compiler tag) must. Also covers disk hits from a fresh cache, rejection
+// of a corrupted cache file, include cycles, and that failed compiles and
+// missing sources are reported and never cached.
+//
+// Build (Linux, from MSFR/):
+//   g++ -std=c++17 -O2 -I. Tools/ShaderCacheTest.cpp ShaderCache.cpp ImageCodec.cpp JpegCodec.cpp -o shadercachetest
+//
+// Usage:
+//   shadercachetest
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../ImageCodec.h"
+#include "../ShaderCache.h"
+
+namespace
+{
+    // "Bytecode" is the entry point name; sources containing ERROR fail
+    class StubCompiler : public IShaderCompiler
+    {
+    public:
+        std::string GetVersionTag() const override { return tag; }
+
+        bool Compile(const ShaderCompileRequest& request, ShaderBytecode& out, std::string& error) override
+        {
+            ++calls;
+            std::vector<uint8_t> source;
+            if (!LoadFile(request.sourcePath, source))
+            {
+                error = "cannot read source";
+                return false;
+            }
+            if (std::string(source.begin(), source.end()).find("ERROR") != std::string::npos)
+            {
+                error = "syntax error";
+                return false;
+            }
+            out.assign(request.entry.begin(), request.entry.end());
+            return true;
+        }
+
+        std::string tag = "stub 1";
+        int calls = 0;
+    };
+
+    int failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (condition) return;
+        std::fprintf(stderr, "shadercachetest: %s\n", what);
+        ++failures;
+    }
+
+    // Pushes the write time forward too, so an edit that keeps the size is
+    // seen even on file systems with coarse timestamps
+    void Write(const std::filesystem::path& path, const std::string& text)
+    {
+        std::error_code ec;
+        const bool existed = std::filesystem::exists(path, ec);
+        const auto before = existed ? std::filesystem::last_write_time(path, ec) : std::filesystem::file_time_type{};
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << text;
+        if (existed) std::filesystem::last_write_time(path, before + std::chrono::seconds(2), ec);
+    }
+}
+
+int main()
+{
+    namespace fs = std::filesystem;
+    const fs::path root = fs::temp_directory_path() / "shadercachetest";
+    std::error_code ec;
+    fs::remove_all(root, ec);
+    fs::create_directories(root / "inc", ec);
+    const fs::path cacheDir = root / "cache";
+
+    Write(root / "sprite.hlsl", "#include \"inc/common.hlsli\"\nfloat4 VSMain() {}\n");
+    Write(root / "inc/common.hlsli", "#pragma once\n#include \"../inc/common.hlsli\"\n// v1\n");
+
+    StubCompiler compiler;
+    ShaderCache cache(compiler, cacheDir);
+    const ShaderCompileRequest request{ root / "sprite.hlsl", "VSMain", "vs_5_0", {} };
+
+    // Memory hits share the bytecode; the include cycle terminates
+    auto first = cache.Get(request);
+    auto second = cache.Get(request);
+    Check(first && first == second && compiler.calls == 1, "second Get should be a memory hit");
+    Check(cache.GetStats().memoryHits == 1 && cache.GetStats().compiles == 1, "stats after a memory hit");
+
+    // Every part of the key
+    ShaderCompileRequest changed = request;
+    changed.target = "ps_5_0";
+    cache.Get(changed);
+    Check(compiler.calls == 2, "target change should recompile");
+    changed = request;
+    changed.entry = "PSMain";
+    cache.Get(changed);
+    Check(compiler.calls == 3, "entry change should recompile");
+    changed = request;
+    changed.defines = { { "INSTANCED", "1" } };
+    cache.Get(changed);
+    Check(compiler.calls == 4, "define change should recompile");
+    changed.defines = { { "INSTANCED", "0" } };
+    cache.Get(changed);
+    Check(compiler.calls == 5, "define value change should recompile");
+    compiler.tag = "stub 2";
+    cache.Get(request);
+    Check(compiler.calls == 6, "compiler tag change should recompile");
+    compiler.tag = "stub 1";
+    cache.Get(request);
+    Check(compiler.calls == 6, "restoring the tag should hit again");
+
+    // A fresh cache finds the bytecode on disk
+    {
+        ShaderCache fresh(compiler, cacheDir);
+        auto bytecode = fresh.Get(request);
+        Check(bytecode && *bytecode == *first && compiler.calls == 6 && fresh.GetStats().diskHits == 1, "fresh cache should hit disk");
+    }
+
+    // Source and include edits, same size included
+    Write(root / "inc/common.hlsli", "#pragma once\n#include \"../inc/common.hlsli\"\n// v2\n");
+    cache.Get(request);
+    Check(compiler.calls == 7, "include edit should recompile");
+    cache.Get(request);
+    Check(compiler.calls == 7, "unchanged include should hit");
+    Write(root / "sprite.hlsl", "#include \"inc/common.hlsli\"\nfloat4 VSMain() {;}\n");
+    cache.Get(request);
+    Check(compiler.calls == 8, "source edit should recompile");
+
+    // Corrupted cache file: rejected, recompiled and rewritten
+    uint64_t key = 0;
+    Check(cache.ComputeKey(request, key), "ComputeKey should succeed");
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.cso", (unsigned long long)key);
+    {
+        std::fstream file(cacheDir / name, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-1, std::ios::end);
+        file.put('#');
+    }
+    {
+        ShaderCache fresh(compiler, cacheDir);
+        Check(fresh.Get(request) && fresh.GetStats().diskRejects == 1 && compiler.calls == 9, "corrupt file should be rejected");
+    }
+    {
+        ShaderCache fresh(compiler, cacheDir);
+        Check(fresh.Get(request) && fresh.GetStats().diskHits == 1 && compiler.calls == 9, "rejected file should be rewritten");
+    }
+
+    // Failures are reported and retried, never cached
+    Write(root / "broken.hlsl", "ERROR\n");
+    const ShaderCompileRequest broken{ root / "broken.hlsl", "VSMain", "vs_5_0", {} };
+    std::string error;
+    Check(!cache.Get(broken, &error) && error == "syntax error", "compile error should be reported");
+    Check(!cache.Get(broken) && compiler.calls == 11, "failed compile should not be cached");
+    error.clear();
+    Check(!cache.Get({ root / "missing.hlsl", "VSMain", "vs_5_0", {} }, &error) && !error.empty() && compiler.calls == 11,
+        "missing source should fail before compiling");
+    Check(cache.GetStats().failures == 3, "failure count");
+
+    // In-memory cache writes nothing
+    {
+        ShaderCache memory(compiler, {});
+        Check(memory.Get(request) && memory.Get(request) && memory.GetStats().memoryHits == 1, "memory-only cache should hit");
+    }
+
+    fs::remove_all(root, ec);
+    std::printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}
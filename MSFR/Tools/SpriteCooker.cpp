@@ -0,0 +1,182 @@
+// Offline sprite and animation cooker.
+//
+// Writes <name>.sptc next to every .spt and <name>.anmc next to every .anm
+// (layouts in SpriteBlob.h). SpriteDefinition loads those in place of the
+// text when they're there and newer, with one read and no parsing. A cooked sprite has its frames spelled out
+// (NumFrames is resolved against the texture size here) and carries the
+// commands of all its animations, so loading it doesn't open the .anm files;
+// cook again after editing either.
+//
+// Build (Linux, from MSFR/):
+//   g++ -std=c++17 -O2 -I. Tools/SpriteCooker.cpp SpriteFormat.cpp AnimationFormat.cpp SpriteBlob.cpp DdsCodec.cpp ImageCodec.cpp JpegCodec.cpp -o spritecooker
+//
+// Usage:
+//   spritecooker path...     (.spt and .anm files, or directories searched recursively)
+// Texture and animation paths inside .spt files are resolved from the
+// current directory, as the game does, so run it from the game's working
+// directory.
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../AnimationFormat.h"
+#include "../DdsCodec.h"
+#include "../ImageCodec.h"
+#include "../SpriteBlob.h"
+#include "../SpriteFormat.h"
+
+namespace
+{
+    bool IsSource(const std::filesystem::path& path)
+    {
+        return path.extension() == ".spt" || path.extension() == ".anm";
+    }
+
+    void Collect(const std::filesystem::path& input, std::vector<std::filesystem::path>& files)
+    {
+        std::error_code ec;
+        if (std::filesystem::is_directory(input, ec))
+        {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(input, ec))
+            {
+                if (entry.is_regular_file() && IsSource(entry.path())) files.push_back(entry.path());
+            }
+        }
+        else if (std::filesystem::is_regular_file(input, ec) && IsSource(input))
+        {
+            files.push_back(input);
+        }
+        else
+        {
+            std::fprintf(stderr, "spritecooker: %s is not a .spt, .anm or directory\n", input.string().c_str());
+        }
+    }
+
+    bool LoadAnimation(const std::filesystem::path& path, std::vector<AnimationCommandInfo>& commands, std::string& error)
+    {
+        std::ifstream in(path);
+        if (!in.is_open())
+        {
+            error = "cannot read " + path.generic_string();
+            return false;
+        }
+        std::vector<std::string> errors;
+        const bool parsed = ParseAnimationInfo(in, commands, errors);
+        for (const std::string& message : errors)
+        {
+            std::fprintf(stderr, "spritecooker: %s: %s\n", path.string().c_str(), message.c_str());
+        }
+        if (!parsed)
+        {
+            error = "cannot parse " + path.generic_string();
+            return false;
+        }
+        if (!ValidateAnimation(commands.data(), commands.size(), error))
+        {
+            error = path.generic_string() + ": " + error;
+            return false;
+        }
+        return true;
+    }
+
+    // What the game's texture would report: the cooked .dds has the source's size
+    bool ReadTextureSize(const std::filesystem::path& texture, int& width, int& height)
+    {
+        DDSInfo info;
+        uint32_t w = 0, h = 0;
+        if (ReadDDSFileInfo(std::filesystem::path(texture).replace_extension(".dds"), info))
+        {
+            w = info.width;
+            h = info.height;
+        }
+        else if (!ReadImageFileSize(texture, w, h))
+        {
+            return false;
+        }
+        width = static_cast<int>(w);
+        height = static_cast<int>(h);
+        return true;
+    }
+
+    bool CookSprite(const std::filesystem::path& path, std::vector<uint8_t>& out, std::string& summary, std::string& error)
+    {
+        std::ifstream in(path);
+        if (!in.is_open())
+        {
+            error = "cannot read file";
+            return false;
+        }
+
+        SpriteInfo info;
+        std::vector<std::string> errors;
+        bool textureFound = true;
+        ParseSpriteInfo(in, info, [&textureFound](const std::string& texture, int& width, int& height)
+        {
+            textureFound = ReadTextureSize(texture, width, height);
+        }, errors);
+        for (const std::string& message : errors)
+        {
+            std::fprintf(stderr, "spritecooker: %s: %s\n", path.string().c_str(), message.c_str());
+        }
+        if (info.texture.empty() || !textureFound)
+        {
+            error = "cannot read the size of texture '" + info.texture + "'";
+            return false;
+        }
+
+        std::vector<std::vector<AnimationCommandInfo>> animations(info.animations.size());
+        for (size_t i = 0; i < info.animations.size(); ++i)
+        {
+            if (!LoadAnimation(info.animations[i], animations[i], error)) return false;
+        }
+
+        out = WriteSpriteBlob(info, animations);
+        summary = std::to_string(info.frames.size()) + " frames, " + std::to_string(animations.size()) + " animations";
+        return true;
+    }
+
+    bool CookAnimation(const std::filesystem::path& path, std::vector<uint8_t>& out, std::string& summary, std::string& error)
+    {
+        std::vector<AnimationCommandInfo> commands;
+        if (!LoadAnimation(path, commands, error)) return false;
+        out = WriteAnimationBlob(commands);
+        summary = std::to_string(commands.size()) + " commands";
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::filesystem::path> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        Collect(argv[i], files);
+    }
+    if (files.empty())
+    {
+        std::fprintf(stderr, "usage: spritecooker path...   (.spt and .anm files or directories)\n");
+        return 1;
+    }
+
+    int failed = 0;
+    for (const std::filesystem::path& file : files)
+    {
+        const bool sprite = file.extension() == ".spt";
+        std::vector<uint8_t> bytes;
+        std::string summary, error;
+        const bool cooked = sprite ? CookSprite(file, bytes, summary, error) : CookAnimation(file, bytes, summary, error);
+        const std::filesystem::path target = std::filesystem::path(file).replace_extension(sprite ? ".sptc" : ".anmc");
+        if (!cooked || !SaveFile(target, bytes))
+        {
+            std::fprintf(stderr, "spritecooker: %s: %s\n", file.string().c_str(), cooked ? "cannot write the cooked file" : error.c_str());
+            ++failed;
+            continue;
+        }
+        std::printf("%s: %s, %zu bytes\n", target.string().c_str(), summary.c_str(), bytes.size());
+    }
+    std::printf("%zu cooked, %d failed\n", files.size() - failed, failed);
+    return failed ? 1 : 0;
+}
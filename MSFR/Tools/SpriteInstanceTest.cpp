@@ -0,0 +1,188 @@
+// Checks the instanced sprite path against the vertex path it replaced.
+//
+// PackSpriteInstance records are expanded back to corners the way
+// sprite_instanced_dx11.hlsl does (unit quad corner through the instance
+// transform, UVs lerped across the UNorm16 rect) and compared with what
+// ExpandSpriteQuad writes for the same SpriteDrawItem: same positions, same
+// UVs within UNorm16 precision, same colors and the same winding for the
+// shared quad indices. Upright items must also keep ExpandSpriteQuad's
+// corner order (bottom-left, bottom-right, top-right, top-left); rotated
+// atlas frames fold the rotation into the transform, so their corners come
+// out in a different order and are matched by position instead.
+//
+// Build (Linux, from MSFR/):
+//   g++ -std=c++17 -O2 -pthread -I. Tools/SpriteInstanceTest.cpp SpriteBatch.cpp RenderQueue.cpp RenderDeviceNull.cpp PipelineCache.cpp TransientAllocator.cpp RingAllocator.cpp WorkerPool.cpp -o spriteinstancetest
+//
+// Usage:
+//   spriteinstancetest [--items <n>]   (random items per flag setting, default: 10000)
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "../SpriteBatch.h"
+
+namespace
+{
+    // As SpriteBatch's shared quad and index buffer
+    constexpr float UnitQuad[4][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+    constexpr int QuadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+
+    constexpr float PositionTolerance = 1e-3f;
+    // Half a UNorm16 step from packing, plus float slack from the lerp
+    constexpr float UVTolerance = 0.5f / 65535.f + 1e-6f;
+
+    int failures = 0;
+
+    void Fail(const std::string& what, int item)
+    {
+        if (failures < 20) std::fprintf(stderr, "spriteinstancetest: item %d: %s\n", item, what.c_str());
+        ++failures;
+    }
+
+    bool Near(float a, float b, float tolerance)
+    {
+        return std::fabs(a - b) <= tolerance;
+    }
+
+    // What the instanced vertex shader outputs for one corner
+    SpriteVertex ShadeCorner(const SpriteInstance& instance, int corner)
+    {
+        const float cx = UnitQuad[corner][0], cy = UnitQuad[corner][1];
+        const float* t = instance.transform;
+        const float u0 = instance.uvRect[0] / 65535.f, v0 = instance.uvRect[1] / 65535.f;
+        const float u1 = instance.uvRect[2] / 65535.f, v1 = instance.uvRect[3] / 65535.f;
+
+        SpriteVertex v;
+        v.x = t[0] * cx + t[2] * cy + t[4];
+        v.y = t[1] * cx + t[3] * cy + t[5];
+        v.u = u0 + (u1 - u0) * cx;
+        v.v = v1 + (v0 - v1) * cy;
+        v.color = instance.color;
+        return v;
+    }
+
+    bool SameVertex(const SpriteVertex& a, const SpriteVertex& b)
+    {
+        return Near(a.x, b.x, PositionTolerance) && Near(a.y, b.y, PositionTolerance)
+            && Near(a.u, b.u, UVTolerance) && Near(a.v, b.v, UVTolerance) && a.color == b.color;
+    }
+
+    float Winding(const SpriteVertex* v, const int* triangle)
+    {
+        const SpriteVertex& a = v[triangle[0]];
+        const SpriteVertex& b = v[triangle[1]];
+        const SpriteVertex& c = v[triangle[2]];
+        return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    }
+
+    void Check(const SpriteDrawItem& item, int index)
+    {
+        SpriteVertex expanded[4];
+        ExpandSpriteQuad(item, expanded);
+
+        SpriteInstance instance;
+        PackSpriteInstance(item, instance);
+        for (int i = 0; i < 4; ++i)
+        {
+            if (instance.uvRect[i] != PackUNorm16(item.uvRect[i])) Fail("uv rect not packed as UNorm16", index);
+        }
+
+        SpriteVertex shaded[4];
+        for (int corner = 0; corner < 4; ++corner) shaded[corner] = ShadeCorner(instance, corner);
+
+        const bool rotated = (item.flags & SpriteDrawItem::UVRotated) != 0;
+        for (int corner = 0; corner < 4; ++corner)
+        {
+            if (!rotated)
+            {
+                if (!SameVertex(shaded[corner], expanded[corner])) Fail("corner " + std::to_string(corner) + " differs", index);
+                continue;
+            }
+            bool found = false;
+            for (const SpriteVertex& v : expanded) found = found || SameVertex(shaded[corner], v);
+            if (!found) Fail("rotated corner " + std::to_string(corner) + " has no match", index);
+        }
+
+        for (int triangle = 0; triangle < 6; triangle += 3)
+        {
+            const float a = Winding(expanded, QuadIndices + triangle);
+            const float b = Winding(shaded, QuadIndices + triangle);
+            if ((a > 0) != (b > 0)) Fail("triangle " + std::to_string(triangle / 3) + " winding flipped", index);
+        }
+    }
+
+    // Known answers for one upright and one rotated frame
+    void CheckFixed()
+    {
+        SpriteDrawItem item;
+        const float transform[6] = { 32, 0, 0, 16, 100, 200 };   // 32x16 quad at (100, 200)
+        const float uv[4] = { 0.25f, 0.5f, 0.75f, 1.f };
+        for (int i = 0; i < 6; ++i) item.transform[i] = transform[i];
+        for (int i = 0; i < 4; ++i) item.uvRect[i] = uv[i];
+        item.color = PackColor(1.f, 0.5f, 0.f, 1.f);
+
+        SpriteVertex v[4];
+        ExpandSpriteQuad(item, v);
+        const float upright[4][4] = {
+            { 100, 200, 0.25f, 1.f }, { 132, 200, 0.75f, 1.f }, { 132, 216, 0.75f, 0.5f }, { 100, 216, 0.25f, 0.5f } };
+        for (int i = 0; i < 4; ++i)
+        {
+            if (v[i].x != upright[i][0] || v[i].y != upright[i][1] || v[i].u != upright[i][2] || v[i].v != upright[i][3])
+                Fail("upright corner " + std::to_string(i) + " not bottom-left, bottom-right, top-right, top-left", -1);
+        }
+
+        // Stored clockwise: the frame's top-left is the rect's top-right
+        item.flags = SpriteDrawItem::UVRotated;
+        ExpandSpriteQuad(item, v);
+        const float rotated[4][2] = { { 0.25f, 0.5f }, { 0.25f, 1.f }, { 0.75f, 1.f }, { 0.75f, 0.5f } };
+        for (int i = 0; i < 4; ++i)
+        {
+            if (v[i].u != rotated[i][0] || v[i].v != rotated[i][1]) Fail("rotated corner " + std::to_string(i) + " samples the wrong texel", -1);
+        }
+        Check(item, -1);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int count = 10000;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--items" && i + 1 < argc && (count = std::atoi(argv[++i])) > 0) continue;
+        std::fprintf(stderr, "usage: spriteinstancetest [--items n]\n");
+        return 1;
+    }
+
+    CheckFixed();
+
+    uint32_t seed = 12345;
+    auto next = [&seed]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) * (1.f / 16777216.f); };
+    for (int i = 0; i < count * 2; ++i)
+    {
+        // Rotated, scaled and sometimes mirrored quads anywhere on a large screen
+        SpriteDrawItem item;
+        const float angle = next() * 6.2831853f;
+        const float w = 4.f + next() * 256.f, h = 4.f + next() * 256.f;
+        const float mirror = next() < 0.2f ? -1.f : 1.f;
+        item.transform[0] = std::cos(angle) * w * mirror;
+        item.transform[1] = std::sin(angle) * w * mirror;
+        item.transform[2] = -std::sin(angle) * h;
+        item.transform[3] = std::cos(angle) * h;
+        item.transform[4] = next() * 4096.f;
+        item.transform[5] = next() * 4096.f;
+        const float u0 = next(), v0 = next();
+        item.uvRect[0] = u0;
+        item.uvRect[1] = v0;
+        item.uvRect[2] = u0 + (1.f - u0) * next();
+        item.uvRect[3] = v0 + (1.f - v0) * next();
+        item.color = PackColor(next(), next(), next(), next());
+        item.flags = i < count ? 0 : SpriteDrawItem::UVRotated;
+        Check(item, i);
+    }
+
+    std::printf("%d items, %d failures\n", count * 2 + 1, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,347 @@
+// Offline texture cooker: PNG/JPEG to block-compressed DDS.
+//
+// Decodes each image with the portable codecs, builds its mip chain with
+// MipGenerator (the same filtering the game does at load time), encodes
+// every level to BC1/BC3/BC7 with the block encoder spread over all cores
+// and writes <name>.dds next to the source or under --out. TextureDX11
+// loads <name>.dds in place of <name>.png when it's there and newer, and
+// uploads it as stored: no decoding, no mip generation, and a quarter
+// (BC3/BC7) or an eighth (BC1) of the RGBA8 memory.
+//
+// Build (Linux, from MSFR/):
+//   g++ -std=c++17 -O2 -pthread -I. Tools/TextureCooker.cpp BlockCompression.cpp DdsCodec.cpp MipGenerator.cpp ImageCodec.cpp JpegCodec.cpp WorkerPool.cpp -o texturecooker
+//
+// Usage:
+//   texturecooker [options] path...     (files, or directories searched recursively)
+//     --format <f>     auto, bc1, bc3, bc7 or rgba8 (default: auto, which is
+//                      bc1 for opaque images and bc7 for the rest)
+//     --quality <q>    fast, normal or best (default: normal)
+//     --threads <n>    encoder threads (default: one per core)
+//     --mips <n>       levels to keep, 0 = full chain (default: 0)
+//     --kaiser         Kaiser mip filter instead of box
+//     --linear         filter mips without the sRGB conversion
+//     --out <dir>      write under dir, keeping paths relative to each input directory
+//     --force          cook even when the .dds is newer than the source
+// Images whose sides aren't multiples of 4 can't be block compressed; they
+// are cooked as rgba8, which still saves decoding and mip generation.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "../BlockCompression.h"
+#include "../DdsCodec.h"
+#include "../ImageCodec.h"
+#include "../MipGenerator.h"
+#include "../WorkerPool.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    enum class Format { Auto, BC1, BC3, BC7, RGBA8 };
+
+    struct Options
+    {
+        Format format = Format::Auto;
+        BlockQuality quality = BlockQuality::Normal;
+        uint32_t threads = 0;
+        uint32_t mips = 0;
+        MipFilter filter = MipFilter::Box;
+        bool gammaCorrect = true;
+        bool force = false;
+        std::filesystem::path outDir;
+        std::vector<std::filesystem::path> paths;
+    };
+
+    struct Job
+    {
+        std::filesystem::path source;
+        std::filesystem::path target;
+    };
+
+    bool ParseUInt(const char* text, uint32_t& out)
+    {
+        char* end = nullptr;
+        const unsigned long v = std::strtoul(text, &end, 10);
+        if (end == text || *end != '\0' || v > 0xFFFFFFFFul) return false;
+        out = (uint32_t)v;
+        return true;
+    }
+
+    bool ParseFormat(const std::string& text, Format& format)
+    {
+        if (text == "auto") format = Format::Auto;
+        else if (text == "bc1") format = Format::BC1;
+        else if (text == "bc3") format = Format::BC3;
+        else if (text == "bc7") format = Format::BC7;
+        else if (text == "rgba8") format = Format::RGBA8;
+        else return false;
+        return true;
+    }
+
+    bool ParseQuality(const std::string& text, BlockQuality& quality)
+    {
+        if (text == "fast") quality = BlockQuality::Fast;
+        else if (text == "normal") quality = BlockQuality::Normal;
+        else if (text == "best") quality = BlockQuality::Best;
+        else return false;
+        return true;
+    }
+
+    bool ParseArgs(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (arg == "--format")
+            {
+                if (!hasValue || !ParseFormat(argv[++i], options.format))
+                {
+                    std::fprintf(stderr, "texturecooker: --format needs auto, bc1, bc3, bc7 or rgba8\n");
+                    return false;
+                }
+            }
+            else if (arg == "--quality")
+            {
+                if (!hasValue || !ParseQuality(argv[++i], options.quality))
+                {
+                    std::fprintf(stderr, "texturecooker: --quality needs fast, normal or best\n");
+                    return false;
+                }
+            }
+            else if (arg == "--threads" || arg == "--mips")
+            {
+                if (!hasValue || !ParseUInt(argv[++i], arg == "--threads" ? options.threads : options.mips))
+                {
+                    std::fprintf(stderr, "texturecooker: %s needs a number\n", arg.c_str());
+                    return false;
+                }
+            }
+            else if (arg == "--out")
+            {
+                if (!hasValue)
+                {
+                    std::fprintf(stderr, "texturecooker: --out needs a directory\n");
+                    return false;
+                }
+                options.outDir = argv[++i];
+            }
+            else if (arg == "--kaiser") options.filter = MipFilter::Kaiser;
+            else if (arg == "--linear") options.gammaCorrect = false;
+            else if (arg == "--force") options.force = true;
+            else if (arg.size() > 1 && arg[0] == '-')
+            {
+                std::fprintf(stderr, "texturecooker: unknown option %s\n", arg.c_str());
+                return false;
+            }
+            else
+            {
+                options.paths.emplace_back(arg);
+            }
+        }
+        if (options.paths.empty())
+        {
+            std::fprintf(stderr, "usage: texturecooker [--format f] [--quality q] [--threads n] [--mips n]\n"
+                "                     [--kaiser] [--linear] [--out dir] [--force] path...\n");
+            return false;
+        }
+        return true;
+    }
+
+    bool IsImage(const std::filesystem::path& path)
+    {
+        std::string ext = path.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+        return ext == ".png" || ext == ".jpg" || ext == ".jpeg";
+    }
+
+    std::filesystem::path TargetFor(const std::filesystem::path& file, const std::filesystem::path& root, const Options& options)
+    {
+        std::filesystem::path target = options.outDir.empty() ? file : options.outDir / file.lexically_relative(root);
+        return target.replace_extension(".dds");
+    }
+
+    void Collect(const std::filesystem::path& path, const Options& options, std::vector<Job>& jobs)
+    {
+        std::error_code ec;
+        if (std::filesystem::is_directory(path, ec))
+        {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(path, ec))
+            {
+                if (entry.is_regular_file() && IsImage(entry.path())) jobs.push_back({ entry.path(), TargetFor(entry.path(), path, options) });
+            }
+        }
+        else if (std::filesystem::is_regular_file(path, ec))
+        {
+            jobs.push_back({ path, TargetFor(path, path.parent_path(), options) });
+        }
+        else
+        {
+            std::fprintf(stderr, "texturecooker: %s not found\n", path.string().c_str());
+        }
+    }
+
+    bool IsUpToDate(const Job& job)
+    {
+        std::error_code ec;
+        const auto target = std::filesystem::last_write_time(job.target, ec);
+        if (ec) return false;
+        const auto source = std::filesystem::last_write_time(job.source, ec);
+        return !ec && target >= source;
+    }
+
+    bool IsOpaque(const Image& image)
+    {
+        const size_t texels = (size_t)image.width * image.height;
+        for (size_t i = 0; i < texels; ++i)
+        {
+            if (image.pixels[i * 4 + 3] != 255) return false;
+        }
+        return true;
+    }
+
+    TextureFormat PickFormat(const Image& image, Format format)
+    {
+        switch (format)
+        {
+        case Format::BC1: return TextureFormat::BC1;
+        case Format::BC3: return TextureFormat::BC3;
+        case Format::BC7: return TextureFormat::BC7;
+        case Format::RGBA8: return TextureFormat::RGBA8;
+        default: return IsOpaque(image) ? TextureFormat::BC1 : TextureFormat::BC7;
+        }
+    }
+
+    const char* FormatName(TextureFormat format)
+    {
+        switch (format)
+        {
+        case TextureFormat::BC1: return "bc1";
+        case TextureFormat::BC3: return "bc3";
+        case TextureFormat::BC7: return "bc7";
+        default: return "rgba8";
+        }
+    }
+
+    // Over level 0, all four channels
+    double Psnr(const Image& a, const Image& b)
+    {
+        const size_t count = (size_t)a.width * a.height * 4;
+        double sum = 0.0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const double d = (double)a.pixels[i] - b.pixels[i];
+            sum += d * d;
+        }
+        return sum == 0.0 ? INFINITY : 10.0 * std::log10(255.0 * 255.0 * count / sum);
+    }
+
+    double Elapsed(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseArgs(argc, argv, options)) return 1;
+
+    std::vector<Job> jobs;
+    for (const std::filesystem::path& path : options.paths) Collect(path, options, jobs);
+    if (jobs.empty())
+    {
+        std::fprintf(stderr, "texturecooker: no images found\n");
+        return 1;
+    }
+
+    WorkerPool pool(options.threads);
+    MipSettings mipSettings;
+    mipSettings.filter = options.filter;
+    mipSettings.gammaCorrect = options.gammaCorrect;
+    mipSettings.maxLevels = options.mips;
+    mipSettings.pool = &pool;
+
+    std::printf("%zu images, %u threads\n", jobs.size(), pool.GetThreadCount());
+    std::printf("%-40s %11s %6s %6s %10s %10s %9s %8s\n", "file", "size", "format", "levels", "KB in", "KB out", "ms", "PSNR");
+
+    uint32_t cooked = 0, skipped = 0, failed = 0;
+    uint64_t totalIn = 0, totalOut = 0;
+    const Clock::time_point allStart = Clock::now();
+    for (const Job& job : jobs)
+    {
+        if (!options.force && IsUpToDate(job))
+        {
+            ++skipped;
+            continue;
+        }
+
+        const Clock::time_point start = Clock::now();
+        Image image;
+        std::string error;
+        if (!LoadImageFile(job.source, image, &error))
+        {
+            std::fprintf(stderr, "texturecooker: %s: %s\n", job.source.string().c_str(), error.c_str());
+            ++failed;
+            continue;
+        }
+        GenerateMips(image, mipSettings);
+
+        TextureFormat format = PickFormat(image, options.format);
+        if (IsBlockCompressed(format) && (image.width % 4 || image.height % 4))
+        {
+            std::fprintf(stderr, "texturecooker: %s is %ux%u, not a multiple of 4; cooking as rgba8\n",
+                job.source.string().c_str(), image.width, image.height);
+            format = TextureFormat::RGBA8;
+        }
+
+        Image out;
+        double psnr = INFINITY;
+        if (IsBlockCompressed(format))
+        {
+            BlockEncodeSettings settings;
+            settings.format = format;
+            settings.quality = options.quality;
+            settings.pool = &pool;
+            CompressImage(image, out, settings);
+
+            Image decoded;
+            DecompressImage(out, decoded);
+            psnr = Psnr(image, decoded);
+        }
+        else
+        {
+            out = std::move(image);
+        }
+
+        const std::vector<uint8_t> bytes = EncodeDDS(out);
+        std::error_code ec;
+        if (job.target.has_parent_path()) std::filesystem::create_directories(job.target.parent_path(), ec);
+        if (!SaveFile(job.target, bytes))
+        {
+            std::fprintf(stderr, "texturecooker: cannot write %s\n", job.target.string().c_str());
+            ++failed;
+            continue;
+        }
+
+        const uint64_t sourceBytes = std::filesystem::file_size(job.source, ec);
+        totalIn += sourceBytes;
+        totalOut += bytes.size();
+        ++cooked;
+
+        const std::string size = std::to_string(out.width) + "x" + std::to_string(out.height);
+        std::printf("%-40s %11s %6s %6u %10.1f %10.1f %9.1f %8.2f\n", job.source.filename().string().c_str(), size.c_str(),
+            FormatName(format), out.levels, sourceBytes / 1024.0, bytes.size() / 1024.0, Elapsed(start) * 1000.0, psnr);
+    }
+
+    std::printf("%u cooked, %u up to date, %u failed; %.1f KB in, %.1f KB out, %.2f s\n",
+        cooked, skipped, failed, totalIn / 1024.0, totalOut / 1024.0, Elapsed(allStart));
+    return failed ? 1 : 0;
+}
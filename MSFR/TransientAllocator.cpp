@@ -0,0 +1,110 @@
+#include "TransientAllocator.h"
+
+#include <algorithm>
+
+TransientAllocator::~TransientAllocator()
+{
+    Shutdown();
+}
+
+void TransientAllocator::Init(IRenderDevice& device_, uint32_t constantBytes, uint32_t vertexBytes)
+{
+    Shutdown();
+    device = &device_;
+    frame = device->GetCurrentFrame();
+    stats = {};
+
+    CreateRing(constants, BufferType::Constant, std::max(constantBytes, ConstantBufferAlignment));
+    CreateRing(vertices, BufferType::Vertex, std::max(vertexBytes, 256u));
+}
+
+void TransientAllocator::Shutdown()
+{
+    if (!device) return;
+
+    DestroyRetired(UINT64_MAX);
+    device->Destroy(constants.buffer);
+    device->Destroy(vertices.buffer);
+    constants.buffer = {};
+    vertices.buffer = {};
+    device = nullptr;
+}
+
+TransientAllocation TransientAllocator::UploadConstants(const void* data, uint32_t bytes)
+{
+    // Whole alignment units, so a bound range never reaches into the next one
+    const uint32_t size = (bytes + ConstantBufferAlignment - 1) / ConstantBufferAlignment * ConstantBufferAlignment;
+    TransientAllocation a = Upload(constants, size, ConstantBufferAlignment);
+    if (a) device->WriteBuffer(a.buffer, a.offset, data, bytes);
+    return a;
+}
+
+TransientAllocation TransientAllocator::UploadVertices(const void* data, uint32_t bytes, uint32_t alignment)
+{
+    TransientAllocation a = Upload(vertices, bytes, alignment);
+    if (a) device->WriteBuffer(a.buffer, a.offset, data, bytes);
+    return a;
+}
+
+TransientAllocation TransientAllocator::Upload(Ring& ring, uint32_t bytes, uint32_t alignment)
+{
+    if (!device || bytes == 0) return {};
+    SyncFrame();
+
+    uint64_t offset = ring.allocator.Allocate(bytes, alignment);
+    if (offset == RingAllocator::Invalid)
+    {
+        uint64_t capacity = ring.allocator.GetCapacity() * 2;
+        while (capacity < (uint64_t)bytes + alignment) capacity *= 2;
+        if (capacity > UINT32_MAX) return {};
+
+        // Earlier draws this frame still read the old buffer
+        retired.push_back({ ring.buffer, frame });
+        stats.retiredBuffers = (uint32_t)retired.size();
+        CreateRing(ring, ring.type, capacity);
+        ++stats.grows;
+        offset = ring.allocator.Allocate(bytes, alignment);
+        if (offset == RingAllocator::Invalid) return {};
+    }
+
+    stats.bytes += bytes;
+    ++stats.allocations;
+    return { ring.buffer, (uint32_t)offset, bytes };
+}
+
+void TransientAllocator::CreateRing(Ring& ring, BufferType type, uint64_t capacity)
+{
+    ring.type = type;
+    ring.buffer = device->CreateBuffer({ type, ResourceUsage::Dynamic, (uint32_t)capacity }, nullptr);
+    ring.allocator.Reset(capacity);
+}
+
+void TransientAllocator::SyncFrame()
+{
+    const uint64_t current = device->GetCurrentFrame();
+    if (current == frame) return;
+
+    // Everything written so far belongs to the frame that just ended
+    const uint64_t completed = device->GetCompletedFrame();
+    for (Ring* ring : { &constants, &vertices })
+    {
+        ring->allocator.EndFrame(frame);
+        ring->allocator.Retire(completed);
+    }
+    DestroyRetired(completed);
+    frame = current;
+    stats.bytes = 0;
+    stats.allocations = 0;
+}
+
+void TransientAllocator::DestroyRetired(uint64_t completedFrame)
+{
+    auto done = std::remove_if(retired.begin(), retired.end(), [&](const RetiredBuffer& r)
+    {
+        if (r.frame > completedFrame) return false;
+        device->Destroy(r.buffer);
+        return true;
+    });
+    retired.erase(done, retired.end());
+    stats.retiredBuffers = (uint32_t)retired.size();
+}
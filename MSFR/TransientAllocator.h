@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "RingAllocator.h"
+
+// A range of a transient buffer, valid for the frame it was made in.
+struct TransientAllocation
+{
+    BufferHandle buffer;
+    uint32_t offset = 0;
+    uint32_t size = 0;
+    explicit operator bool() const noexcept { return static_cast<bool>(buffer); }
+};
+
+// Upload rings for data that lives one frame: per-draw constants and streamed
+// vertices. Each ring is one large dynamic buffer filled with WriteBuffer;
+// RingAllocator hands out the ranges and the device's frame fences say when a
+// frame's ranges may be written again. Frames are picked up from the device,
+// so there is nothing to call per frame. A ring that runs out of space is
+// replaced by one twice the size. Draws recorded earlier in the frame still
+// use the old buffer, so it is destroyed only once the frame's fence has
+// completed, like the ring's own ranges.
+class TransientAllocator
+{
+public:
+    static constexpr uint32_t DefaultConstantBytes = 256 * 1024;
+    static constexpr uint32_t DefaultVertexBytes = 4 * 1024 * 1024;
+
+    struct Stats
+    {
+        uint64_t bytes = 0;         // uploaded in the current frame
+        uint32_t allocations = 0;   // in the current frame
+        uint32_t grows = 0;
+        uint32_t retiredBuffers = 0;  // outgrown, waiting for their frame to complete
+    };
+
+    TransientAllocator() = default;
+    ~TransientAllocator();
+
+    TransientAllocator(const TransientAllocator&) = delete;
+    TransientAllocator& operator=(const TransientAllocator&) = delete;
+
+    void Init(IRenderDevice& device, uint32_t constantBytes = DefaultConstantBytes, uint32_t vertexBytes = DefaultVertexBytes);
+    void Shutdown();
+
+    // Copies data to a ConstantBufferAlignment boundary. Bind with
+    // SetConstantBuffer(slot, a.buffer, a.offset, a.size).
+    TransientAllocation UploadConstants(const void* data, uint32_t bytes);
+    // Bind with SetVertexBuffer(slot, a.buffer, stride, a.offset).
+    TransientAllocation UploadVertices(const void* data, uint32_t bytes, uint32_t alignment = 16);
+
+    bool IsInitialized() const { return device != nullptr; }
+    const Stats& GetStats() const { return stats; }
+
+private:
+    struct Ring
+    {
+        BufferType type = BufferType::Vertex;
+        BufferHandle buffer;
+        RingAllocator allocator;
+    };
+
+    TransientAllocation Upload(Ring& ring, uint32_t bytes, uint32_t alignment);
+    void CreateRing(Ring& ring, BufferType type, uint64_t capacity);
+    void SyncFrame();
+    void DestroyRetired(uint64_t completedFrame);
+
+    struct RetiredBuffer
+    {
+        BufferHandle buffer;
+        uint64_t frame;         // last frame that may use it
+    };
+
+    IRenderDevice* device = nullptr;
+    Ring constants;
+    Ring vertices;
+    std::vector<RetiredBuffer> retired;
+    uint64_t frame = 0;
+    Stats stats;
+};
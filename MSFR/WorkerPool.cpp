@@ -0,0 +1,75 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool(unsigned threadCount)
+{
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 1; i < threadCount; ++i)
+    {
+        workers.emplace_back(&WorkerPool::WorkerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) t.join();
+}
+
+void WorkerPool::Run(uint32_t count, const std::function<void(uint32_t)>& task)
+{
+    if (count == 0) return;
+    if (workers.empty() || count == 1)
+    {
+        for (uint32_t i = 0; i < count; ++i) task(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = &task;
+        taskCount = count;
+        nextTask = 0;
+        busy = (unsigned)workers.size();
+        ++generation;
+    }
+    wake.notify_all();
+    RunTasks();
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return busy == 0; });
+        current = nullptr;
+    }
+}
+
+void WorkerPool::WorkerLoop()
+{
+    uint64_t seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return quit || generation != seen; });
+            if (quit) return;
+            seen = generation;
+        }
+        RunTasks();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy == 0) done.notify_one();
+        }
+    }
+}
+
+void WorkerPool::RunTasks()
+{
+    for (uint32_t i = nextTask++; i < taskCount; i = nextTask++)
+    {
+        (*current)(i);
+    }
+}
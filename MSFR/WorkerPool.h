@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent threads for data-parallel loops. Run hands out task indices
+// from a shared counter and returns once every task is done; the calling
+// thread always helps, so a pool of one thread runs everything inline.
+// Which thread runs a task is unspecified, so keep per-task outputs and
+// merge them by task index when the result must be deterministic.
+class WorkerPool
+{
+public:
+    // 0 threads: one per hardware core.
+    explicit WorkerPool(unsigned threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Calls task(i) for every i in [0, count). Not reentrant.
+    void Run(uint32_t count, const std::function<void(uint32_t)>& task);
+
+    unsigned GetThreadCount() const { return (unsigned)workers.size() + 1; }
+
+private:
+    void WorkerLoop();
+    void RunTasks();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    uint64_t generation = 0;
+    unsigned busy = 0;
+    bool quit = false;
+
+    const std::function<void(uint32_t)>* current = nullptr;
+    uint32_t taskCount = 0;
+    std::atomic<uint32_t> nextTask{ 0 };
+};
@@ -0,0 +1,35 @@
+cbuffer Projection : register(b0)
+{
+    float4x4 uScreenToNDC;
+};
+
+Texture2D uTex : register(t0);
+SamplerState uSamp : register(s0);
+
+struct VSIn
+{
+    float2 pos : POSITION;
+    float2 uv : TEXCOORD;
+    float4 color : COLOR;
+};
+
+struct VSOut
+{
+    float4 pos : SV_POSITION;
+    float2 uv : TEXCOORD;
+    float4 color : COLOR;
+};
+
+VSOut VSMain(VSIn v)
+{
+    VSOut o;
+    o.pos = mul(uScreenToNDC, float4(v.pos, 0, 1));
+    o.uv = v.uv;
+    o.color = v.color;
+    return o;
+}
+
+float4 PSMain(VSOut i) : SV_TARGET
+{
+    return uTex.Sample(uSamp, i.uv) * i.color;
+}
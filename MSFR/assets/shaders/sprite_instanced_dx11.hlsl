@@ -0,0 +1,39 @@
+cbuffer Projection : register(b0)
+{
+    float4x4 uScreenToNDC;
+};
+
+Texture2D uTex : register(t0);
+SamplerState uSamp : register(s0);
+
+struct VSIn
+{
+    float2 corner : POSITION;       // unit quad, per vertex
+    float2 axisX : TRANSFORM0;      // per instance from here on
+    float2 axisY : TRANSFORM1;
+    float2 origin : TRANSFORM2;
+    float4 uvRect : TEXCOORD;       // u0, v0 (top-left), u1, v1
+    float4 color : COLOR;
+};
+
+struct VSOut
+{
+    float4 pos : SV_POSITION;
+    float2 uv : TEXCOORD;
+    float4 color : COLOR;
+};
+
+VSOut VSMain(VSIn v)
+{
+    VSOut o;
+    float2 pos = v.axisX * v.corner.x + v.axisY * v.corner.y + v.origin;
+    o.pos = mul(uScreenToNDC, float4(pos, 0, 1));
+    o.uv = float2(lerp(v.uvRect.x, v.uvRect.z, v.corner.x), lerp(v.uvRect.w, v.uvRect.y, v.corner.y));
+    o.color = v.color;
+    return o;
+}
+
+float4 PSMain(VSOut i) : SV_TARGET
+{
+    return uTex.Sample(uSamp, i.uv) * i.color;
+}